@@ -69,6 +69,7 @@ LOCAL_SRC_FILES := \
 	soundlib/MIDIMacros.cpp \
 	soundlib/MixerLoops.cpp \
 	soundlib/MixerSettings.cpp \
+	soundlib/MixerThreads.cpp \
 	soundlib/Mmcmp.cpp \
 	soundlib/ModChannel.cpp \
 	soundlib/modcommand.cpp \
@@ -96,6 +97,11 @@ LOCAL_SRC_FILES := \
 	soundlib/WAVTools.cpp \
 	soundlib/WindowedFIR.cpp \
 	soundlib/XMTools.cpp \
+	sounddsp/DSP.cpp \
+	sounddsp/AGC.cpp \
+	sounddsp/EQ.cpp \
+	sounddsp/Reverb.cpp \
+	test/TestModule.cpp \
 	test/TestToolsLib.cpp \
 	test/test.cpp
 
@@ -70,6 +70,23 @@
 
 
 
+// Compiler intrinsics do not require inline assembly and are thus available with every compiler targeting the respective instruction set.
+#if !defined(NO_INTRINSICS)
+
+#if defined(ENABLE_SSE2) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+// Generate SSE2 code using compiler intrinsics (only used when the CPU supports it).
+#define ENABLE_SSE2_INTRINSICS
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+// Generate NEON code using compiler intrinsics.
+#define ENABLE_NEON_INTRINSICS
+#endif
+
+#endif // !NO_INTRINSICS
+
+
+
 #if defined(MODPLUG_TRACKER) && defined(LIBOPENMPT_BUILD)
 
 #error "either MODPLUG_TRACKER or LIBOPENMPT_BUILD has to be defined"
@@ -112,6 +129,9 @@
 // Disable the built-in automatic gain control
 //#define NO_AGC
 
+// Disable the performance counters of the player (CSoundFile::GetPerfCounters)
+//#define NO_PERFCOUNTERS
+
 // Define to build without ASIO support; makes build possible without ASIO SDK.
 //#define NO_ASIO 
 
@@ -161,10 +181,12 @@
 //#define NO_LOGGING
 #define MPT_FILEREADER_STD_ISTREAM
 #define NO_ARCHIVE_SUPPORT
-#define NO_REVERB
-#define NO_DSP
-#define NO_EQ
-#define NO_AGC
+//#define NO_REVERB
+//#define NO_DSP
+//#define NO_EQ
+//#define NO_AGC
+//#define NO_PERFCOUNTERS
+//#define MPT_FLOATMIXER
 #define NO_ASIO
 #define NO_VST
 #define NO_PORTAUDIO
@@ -231,6 +253,15 @@
 
 
 
+#if defined(MPT_FILEREADER_STD_ISTREAM) && !defined(MPT_WITHOUT_MMAP)
+#if MPT_OS_LINUX || MPT_OS_ANDROID || MPT_OS_MACOSX_OR_IOS || MPT_OS_DRAGONFLYBSD || MPT_OS_FREEBSD || MPT_OS_OPENBSD || MPT_OS_NETBSD || MPT_OS_GENERIC_UNIX
+// Memory-map local files using POSIX mmap() instead of reading them through a std::istream
+#define MPT_FILEREADER_MMAP
+#endif
+#endif
+
+
+
 #if MPT_COMPILER_MSVC
 
 	// Use wide strings for MSVC because this is the native encoding on 
@@ -287,12 +318,8 @@
 
 // fixing stuff up
 
-#if !defined(ENABLE_MMX) && !defined(NO_REVERB)
-#define NO_REVERB // reverb requires mmx
-#endif
-
-#if !defined(ENABLE_X86) && !defined(NO_DSP)
-#define NO_DSP // DSP requires x86 inline asm
+#if (defined(ENABLE_SSE2_INTRINSICS) || defined(ENABLE_NEON_INTRINSICS)) && !defined(ENABLE_SIMD_INTRINSICS)
+#define ENABLE_SIMD_INTRINSICS // any of the vectorized code paths is available
 #endif
 
 #if defined(ENABLE_TESTS) && defined(MODPLUG_NO_FILESAVE)
@@ -630,6 +630,20 @@ static inline uint32 GetProcSupport()
 }
 #endif // ENABLE_ASM
 
+#ifdef ENABLE_SIMD_INTRINSICS
+// Returns true if the code paths generated from SSE2 / NEON compiler intrinsics can be executed on this CPU.
+static inline bool HasSIMDIntrinsicsSupport()
+{
+#if defined(ENABLE_SSE2_INTRINSICS) && defined(ENABLE_ASM) && defined(ENABLE_X86)
+	// 32-Bit x86 builds do not require SSE2, check at runtime.
+	return (GetProcSupport() & PROCSUPPORT_SSE2) != 0;
+#else
+	// SSE2 is part of the amd64 baseline, and NEON intrinsics are only enabled if the target supports them.
+	return true;
+#endif
+}
+#endif // ENABLE_SIMD_INTRINSICS
+
 
 #ifdef MODPLUG_TRACKER
 
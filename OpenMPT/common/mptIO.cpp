@@ -22,6 +22,13 @@
 
 #include <stdio.h>
 
+#if defined(MPT_FILEREADER_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -253,5 +260,44 @@ IFileDataContainer::off_t FileDataContainerStdStream::GetReadableLength(IFileDat
 
 
 
+#if defined(MPT_FILEREADER_MMAP)
+
+FileDataContainerMappedFile::FileDataContainerMappedFile(const char *filename)
+	: mapping(MAP_FAILED), mappingLength(0)
+{
+	int fd = open(filename, O_RDONLY);
+	if(fd == -1)
+	{
+		return;
+	}
+	struct stat st;
+	if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && static_cast<uint64>(st.st_size) <= static_cast<uint64>(std::numeric_limits<std::size_t>::max()))
+	{
+		mappingLength = static_cast<std::size_t>(st.st_size);
+		mapping = mmap(nullptr, mappingLength, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	// The mapping stays valid after closing the file descriptor.
+	close(fd);
+	if(mapping == MAP_FAILED)
+	{
+		mappingLength = 0;
+		return;
+	}
+	streamData = static_cast<const char *>(mapping);
+	streamLength = mappingLength;
+}
+
+FileDataContainerMappedFile::~FileDataContainerMappedFile()
+{
+	if(mapping != MAP_FAILED)
+	{
+		munmap(mapping, mappingLength);
+	}
+}
+
+#endif // MPT_FILEREADER_MMAP
+
+
+
 OPENMPT_NAMESPACE_END
 
@@ -563,7 +563,7 @@ public:
 	typedef std::size_t off_t;
 #endif
 
-private:
+protected:
 
 	const char *streamData;	// Pointer to memory-mapped file
 	off_t streamLength;		// Size of memory-mapped file in bytes
@@ -630,5 +630,33 @@ public:
 };
 
 
+#if defined(MPT_FILEREADER_MMAP)
+
+// Read-only memory mapping of a local file.
+// The loaders access the file contents directly in the page cache instead of a copy in a buffer.
+// IsValid() returns false if the file could not be mapped (e.g. because it does not exist, is empty or is not a regular file).
+class FileDataContainerMappedFile : public FileDataContainerMemory {
+
+private:
+
+	void *mapping;
+	std::size_t mappingLength;
+
+public:
+
+	FileDataContainerMappedFile(const char *filename);
+	virtual ~FileDataContainerMappedFile();
+
+private:
+
+	// non-copyable
+	FileDataContainerMappedFile(const FileDataContainerMappedFile &);
+	FileDataContainerMappedFile & operator = (const FileDataContainerMappedFile &);
+
+};
+
+#endif // MPT_FILEREADER_MMAP
+
+
 
 OPENMPT_NAMESPACE_END
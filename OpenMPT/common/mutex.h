@@ -9,19 +9,27 @@
 
 #pragma once
 
-#ifdef MODPLUG_TRACKER
+#if MPT_OS_WINDOWS
+#ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef VC_EXTRALEAN
 #define VC_EXTRALEAN
+#endif
+#ifndef NOMINMAX
 #define NOMINMAX
+#endif
 #include <windows.h>
-#endif // MODPLUG_TRACKER
+#else // !MPT_OS_WINDOWS
+#include <pthread.h>
+#endif // MPT_OS_WINDOWS
 
 OPENMPT_NAMESPACE_BEGIN
 
-#ifdef MODPLUG_TRACKER
-
 namespace Util {
 
+#if MPT_OS_WINDOWS
+
 // compatible with c++11 std::mutex, can eventually be replaced without touching any usage site
 class mutex {
 private:
@@ -44,6 +52,46 @@ public:
 	void unlock() { LeaveCriticalSection(&impl); }
 };
 
+#else // !MPT_OS_WINDOWS
+
+// compatible with c++11 std::mutex, can eventually be replaced without touching any usage site
+class mutex {
+private:
+	pthread_mutex_t impl;
+public:
+	mutex()
+	{
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_NORMAL);
+		pthread_mutex_init(&impl, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+	~mutex() { pthread_mutex_destroy(&impl); }
+	void lock() { pthread_mutex_lock(&impl); }
+	void unlock() { pthread_mutex_unlock(&impl); }
+};
+
+// compatible with c++11 std::recursive_mutex, can eventually be replaced without touching any usage site
+class recursive_mutex {
+private:
+	pthread_mutex_t impl;
+public:
+	recursive_mutex()
+	{
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&impl, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+	~recursive_mutex() { pthread_mutex_destroy(&impl); }
+	void lock() { pthread_mutex_lock(&impl); }
+	void unlock() { pthread_mutex_unlock(&impl); }
+};
+
+#endif // MPT_OS_WINDOWS
+
 // compatible with c++11 std::lock_guard, can eventually be replaced without touching any usage site
 template< typename mutex_type >
 class lock_guard {
@@ -56,6 +104,4 @@ public:
 
 } // namespace Util
 
-#endif // MODPLUG_TRACKER
-
 OPENMPT_NAMESPACE_END
@@ -184,8 +184,10 @@ OPENMPT_NAMESPACE_END
 OPENMPT_NAMESPACE_BEGIN
 #if MPT_COMPILER_MSVC && MPT_MSVC_BEFORE(2010,0)
 #define MPT_SHARED_PTR std::tr1::shared_ptr
+#define MPT_WEAK_PTR std::tr1::weak_ptr
 #else
 #define MPT_SHARED_PTR std::shared_ptr
+#define MPT_WEAK_PTR std::weak_ptr
 #endif
 
 
@@ -303,6 +303,11 @@ std::string GetBuildFeaturesString()
 		#else
 			retval += " -UNMO3";
 		#endif
+		#if defined(ENABLE_SSE2_INTRINSICS)
+			retval += " +SSE2";
+		#elif defined(ENABLE_NEON_INTRINSICS)
+			retval += " +NEON";
+		#endif
 	#endif
 	#ifdef MODPLUG_TRACKER
 		#ifdef NO_VST
@@ -223,6 +223,28 @@ LIBOPENMPT_API void openmpt_log_func_silent( const char * message, void * user )
  */
 LIBOPENMPT_API double openmpt_could_open_propability( openmpt_stream_callbacks stream_callbacks, void * stream, double effort, openmpt_log_func logfunc, void * user );
 
+/*! \brief Opaque type representing the metadata read by openmpt_probe_metadata()
+ */
+typedef struct openmpt_metadata openmpt_metadata;
+
+/*! \brief Read the metadata of a module without loading its patterns and samples
+ *
+ * Only the module header, the song message and the names are read. No mixer is set up, which makes this much faster than openmpt_module_create().
+ * \param stream_callbacks Input stream callback operations.
+ * \param stream Input stream to read the module from.
+ * \param logfunc Logging function where warning and errors are written.
+ * \param user Logging function user context.
+ * \return Metadata that has to be freed with openmpt_metadata_destroy(), or NULL if the stream could not be read as a module.
+ * \sa openmpt_metadata_get_keys(), openmpt_metadata_get()
+ */
+LIBOPENMPT_API openmpt_metadata * openmpt_probe_metadata( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * user );
+
+LIBOPENMPT_API void openmpt_metadata_destroy( openmpt_metadata * metadata );
+
+/* returns a semicolon-separated list of the available keys, which are the keys of openmpt_module_get_metadata() plus num_channels, num_samples, num_instruments, channel_names, sample_names and instrument_names (newline-terminated names) */
+LIBOPENMPT_API const char * openmpt_metadata_get_keys( openmpt_metadata * metadata );
+LIBOPENMPT_API const char * openmpt_metadata_get( openmpt_metadata * metadata, const char * key );
+
 /*! \brief Opaque type representing a libopenmpt module
  */
 typedef struct openmpt_module openmpt_module;
@@ -236,6 +258,9 @@ LIBOPENMPT_API openmpt_module * openmpt_module_create( openmpt_stream_callbacks
 
 LIBOPENMPT_API openmpt_module * openmpt_module_create_from_memory( const void * filedata, size_t filesize, openmpt_log_func logfunc, void * user, const openmpt_module_initial_ctl * ctls );
 
+/* filename is in the native narrow character encoding of the file system. On POSIX systems, the file is memory-mapped while loading. */
+LIBOPENMPT_API openmpt_module * openmpt_module_create_from_filename( const char * filename, openmpt_log_func logfunc, void * user, const openmpt_module_initial_ctl * ctls );
+
 LIBOPENMPT_API void openmpt_module_destroy( openmpt_module * mod );
 
 #define OPENMPT_MODULE_RENDER_MASTERGAIN_MILLIBEL        1
@@ -255,6 +280,8 @@ LIBOPENMPT_API int openmpt_module_set_repeat_count( openmpt_module * mod, int32_
 LIBOPENMPT_API int32_t openmpt_module_get_repeat_count( openmpt_module * mod );
 
 LIBOPENMPT_API double openmpt_module_get_duration_seconds( openmpt_module * mod );
+/* writes the durations of up to count subsongs to durations and returns the total number of subsongs (call with durations = NULL to query the number of subsongs) */
+LIBOPENMPT_API int32_t openmpt_module_get_subsong_durations_seconds( openmpt_module * mod, double * durations, int32_t count );
 
 LIBOPENMPT_API double openmpt_module_set_position_seconds( openmpt_module * mod, double seconds );
 LIBOPENMPT_API double openmpt_module_get_position_seconds( openmpt_module * mod );
@@ -143,6 +143,16 @@ LIBOPENMPT_CXX_API bool is_extension_supported( const std::string & extension );
 */
 LIBOPENMPT_CXX_API double could_open_propability( std::istream & stream, double effort = 1.0, std::ostream & log = std::clog );
 
+//! Read the metadata of a module without loading its patterns and samples
+/*!
+  Only the module header, the song message and the names are read. No mixer is set up, which makes this much faster than constructing an openmpt::module.
+  \param stream Input stream to read the module from.
+  \param log Log where warning and errors are written.
+  \return All metadata items that openmpt::module::get_metadata returns, plus "num_channels", "num_samples", "num_instruments" and the lists "channel_names", "sample_names" and "instrument_names" (each name terminated by a newline). The map is empty if the stream could not be read as a module.
+  \sa openmpt::module::get_metadata
+*/
+LIBOPENMPT_CXX_API std::map<std::string,std::string> probe_metadata( std::istream & stream, std::ostream & log = std::clog );
+
 class module_impl;
 
 class module_ext;
@@ -228,6 +238,14 @@ public:
 	  \remarks The input data can be discarded after an openmpt::module has been constructed succesfully.
 	*/
 	module( std::istream & stream, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	/*!
+	  \param filename Name of the file to load the module from, in the native narrow character encoding of the file system.
+	  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the module instance.
+	  \param ctls A map of initial ctl values, see openmpt::modules::get_ctls.
+	  \return Throw an exception derived from openmpt::exception in case the provided file cannot be opened.
+	  \remarks On POSIX systems, the file is memory-mapped while loading instead of being read into a temporary buffer, which reduces memory usage and loading time for large files.
+	*/
+	module( const std::string & filename, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
 	/*!
 	  \param data Data to load the module from.
 	  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the module instance.
@@ -323,6 +341,14 @@ public:
 	*/
 	double get_duration_seconds() const;
 
+	//! Get approximate song durations of all subsongs
+	/*!
+	  The durations are calculated only once and cached, so this is cheaper than selecting each subsong and calling openmpt::module::get_duration_seconds.
+	  \return Approximate song duration in seconds of each subsong, in the same order as openmpt::module::get_subsong_names.
+	  \sa openmpt::module::get_duration_seconds
+	*/
+	std::vector<double> get_subsong_durations_seconds() const;
+
 	//! Set approximate current song position
 	/*!
 	  \param seconds Seconds to seek to. If seconds is out of range, the position gets set to song start or end respectively.
@@ -0,0 +1,78 @@
+/*
+ * libopenmpt_bench.cpp
+ * --------------------
+ * Purpose: libopenmpt benchmark driver
+ * Notes  : Usage: libopenmpt_bench [--seconds n] [--repeat n] [output.json]
+ *          Results are written to stdout if no output file is given.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#include "BuildSettings.h"
+#include "typedefs.h"
+
+#include "libopenmpt_internal.h"
+
+#include "test/bench.h"
+
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <sstream>
+#include <string>
+
+#include <cstdlib>
+
+using namespace OpenMPT;
+
+#if defined( LIBOPENMPT_BUILD_TEST )
+
+int main( int argc, char * argv [] ) {
+	try {
+
+		Bench::Settings settings;
+		std::string output;
+		for ( int i = 1; i < argc; ++i ) {
+			const std::string arg = argv[i];
+			if ( ( arg == "--seconds" || arg == "--repeat" ) && i + 1 < argc ) {
+				std::istringstream value( argv[++i] );
+				value.imbue( std::locale::classic() );
+				if ( arg == "--seconds" ) {
+					value >> settings.renderSeconds;
+				} else {
+					value >> settings.repeat;
+				}
+			} else if ( arg.substr( 0, 1 ) != "-" && output.empty() ) {
+				output = arg;
+			} else {
+				std::cerr << "Usage: libopenmpt_bench [--seconds n] [--repeat n] [output.json]" << std::endl;
+				return 1;
+			}
+		}
+		if ( settings.renderSeconds <= 0.0 || settings.repeat < 1 ) {
+			std::cerr << "BENCH ERROR: invalid settings" << std::endl;
+			return 1;
+		}
+
+		if ( output.empty() ) {
+			Bench::RunBenchmarks( std::cout, std::cerr, settings );
+		} else {
+			std::ofstream file( output.c_str(), std::ios::binary );
+			if ( !file ) {
+				std::cerr << "BENCH ERROR: cannot write " << output << std::endl;
+				return 1;
+			}
+			Bench::RunBenchmarks( file, std::cerr, settings );
+		}
+
+	} catch ( const std::exception & e ) {
+		std::cerr << "BENCH ERROR: exception: " << ( e.what() ? e.what() : "" ) << std::endl;
+		return -1;
+	} catch ( ... ) {
+		std::cerr << "BENCH ERROR: unknown exception" << std::endl;
+		return -1;
+	}
+	return 0;
+}
+
+#endif // LIBOPENMPT_BUILD_TEST
@@ -150,6 +150,10 @@ struct openmpt_module {
 	openmpt::module_impl * impl;
 };
 
+struct openmpt_metadata {
+	std::map< std::string, std::string > values;
+};
+
 #define OPENMPT_INTERFACE_CATCH \
 	 catch ( ... ) { \
 		openmpt::report_exception( __FUNCTION__ ); \
@@ -274,6 +278,58 @@ double openmpt_could_open_propability( openmpt_stream_callbacks stream_callbacks
 	return 0.0;
 }
 
+openmpt_metadata * openmpt_probe_metadata( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * user ) {
+	try {
+		openmpt::callbacks_istream istream( stream_callbacks, stream );
+		openmpt_metadata * metadata = new openmpt_metadata();
+#ifdef MPT_ANCIENT_VS2008
+		metadata->values = openmpt::module_impl::probe_metadata( istream, std::tr1::shared_ptr<openmpt::logfunc_logger>( new openmpt::logfunc_logger( logfunc ? logfunc : openmpt_log_func_default, user ) ) );
+#else
+		metadata->values = openmpt::module_impl::probe_metadata( istream, std::make_shared<openmpt::logfunc_logger>( logfunc ? logfunc : openmpt_log_func_default, user ) );
+#endif
+		if ( metadata->values.empty() ) {
+			delete metadata;
+			return NULL;
+		}
+		return metadata;
+	} OPENMPT_INTERFACE_CATCH_TO_LOG_FUNC;
+	return NULL;
+}
+
+void openmpt_metadata_destroy( openmpt_metadata * metadata ) {
+	try {
+		delete metadata;
+	} OPENMPT_INTERFACE_CATCH;
+}
+
+const char * openmpt_metadata_get_keys( openmpt_metadata * metadata ) {
+	try {
+		OPENMPT_INTERFACE_CHECK_POINTER( metadata );
+		std::string retval;
+		bool first = true;
+		for ( std::map< std::string, std::string >::const_iterator i = metadata->values.begin(); i != metadata->values.end(); ++i ) {
+			if ( first ) {
+				first = false;
+			} else {
+				retval += ";";
+			}
+			retval += i->first;
+		}
+		return openmpt::strdup( retval.c_str() );
+	} OPENMPT_INTERFACE_CATCH;
+	return NULL;
+}
+
+const char * openmpt_metadata_get( openmpt_metadata * metadata, const char * key ) {
+	try {
+		OPENMPT_INTERFACE_CHECK_POINTER( metadata );
+		OPENMPT_INTERFACE_CHECK_POINTER( key );
+		std::map< std::string, std::string >::const_iterator i = metadata->values.find( key );
+		return openmpt::strdup( i != metadata->values.end() ? i->second.c_str() : "" );
+	} OPENMPT_INTERFACE_CATCH;
+	return NULL;
+}
+
 openmpt_module * openmpt_module_create( openmpt_stream_callbacks stream_callbacks, void * stream, openmpt_log_func logfunc, void * user, const openmpt_module_initial_ctl * ctls ) {
 	try {
 		openmpt_module * mod = (openmpt_module*)std::malloc( sizeof( openmpt_module ) );
@@ -345,6 +401,44 @@ openmpt_module * openmpt_module_create_from_memory( const void * filedata, size_
 	return NULL;
 }
 
+openmpt_module * openmpt_module_create_from_filename( const char * filename, openmpt_log_func logfunc, void * user, const openmpt_module_initial_ctl * ctls ) {
+	try {
+		openmpt_module * mod = (openmpt_module*)std::malloc( sizeof( openmpt_module ) );
+		if ( !mod ) {
+			throw std::bad_alloc();
+		}
+		mod->logfunc = logfunc ? logfunc : openmpt_log_func_default;
+		mod->user = user;
+		mod->impl = 0;
+		try {
+			if ( !filename ) {
+				throw openmpt::exception("null pointer");
+			}
+			std::map< std::string, std::string > ctls_map;
+			if ( ctls ) {
+				for ( const openmpt_module_initial_ctl * it = ctls; it->ctl; ++it ) {
+					if ( it->value ) {
+						ctls_map[ it->ctl ] = it->value;
+					} else {
+						ctls_map.erase( it->ctl );
+					}
+				}
+			}
+#ifdef MPT_ANCIENT_VS2008
+			mod->impl = new openmpt::module_impl( filename, std::tr1::shared_ptr<openmpt::logfunc_logger>( new openmpt::logfunc_logger( mod->logfunc, mod->user ) ), ctls_map );
+#else
+			mod->impl = new openmpt::module_impl( filename, std::make_shared<openmpt::logfunc_logger>( mod->logfunc, mod->user ), ctls_map );
+#endif
+			return mod;
+		} OPENMPT_INTERFACE_CATCH_TO_MOD_LOG_FUNC;
+		delete mod->impl;
+		mod->impl = 0;
+		std::free( (void*)mod );
+		mod = NULL;
+	} OPENMPT_INTERFACE_CATCH;
+	return NULL;
+}
+
 void openmpt_module_destroy( openmpt_module * mod ) {
 	try {
 		OPENMPT_INTERFACE_CHECK_SOUNDFILE( mod );
@@ -389,6 +483,20 @@ double openmpt_module_get_duration_seconds( openmpt_module * mod ) {
 	} OPENMPT_INTERFACE_CATCH_TO_LOG;
 	return 0.0;
 }
+int32_t openmpt_module_get_subsong_durations_seconds( openmpt_module * mod, double * durations, int32_t count ) {
+	try {
+		OPENMPT_INTERFACE_CHECK_SOUNDFILE( mod );
+		if ( !durations ) {
+			return mod->impl->get_num_subsongs();
+		}
+		std::vector<double> values = mod->impl->get_subsong_durations_seconds();
+		for ( std::size_t i = 0; i < values.size() && (int32_t)i < count; ++i ) {
+			durations[i] = values[i];
+		}
+		return (int32_t)values.size();
+	} OPENMPT_INTERFACE_CATCH_TO_LOG;
+	return 0;
+}
 
 double openmpt_module_set_position_seconds( openmpt_module * mod, double seconds ) {
 	try {
@@ -84,6 +84,14 @@ double could_open_propability( std::istream & stream, double effort, std::ostrea
 #endif
 }
 
+std::map<std::string,std::string> probe_metadata( std::istream & stream, std::ostream & log ) {
+#ifdef MPT_ANCIENT_VS2008
+	return openmpt::module_impl::probe_metadata( stream, std::tr1::shared_ptr<std_ostream_log>( new std_ostream_log( log ) ) );
+#else
+	return openmpt::module_impl::probe_metadata( stream, std::make_shared<std_ostream_log>( log ) );
+#endif
+}
+
 module::module( const module & ) {
 	throw exception("openmpt::module is non-copyable");
 }
@@ -108,6 +116,14 @@ module::module( std::istream & stream, std::ostream & log, const std::map< std::
 #endif
 }
 
+module::module( const std::string & filename, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+#ifdef MPT_ANCIENT_VS2008
+	impl = new module_impl( filename, std::tr1::shared_ptr<std_ostream_log>( new std_ostream_log( log ) ), ctls );
+#else
+	impl = new module_impl( filename, std::make_shared<std_ostream_log>( log ), ctls );
+#endif
+}
+
 module::module( const std::vector<std::uint8_t> & data, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
 #ifdef MPT_ANCIENT_VS2008
 	impl = new module_impl( data, std::tr1::shared_ptr<std_ostream_log>( new std_ostream_log( log ) ), ctls );
@@ -183,6 +199,9 @@ std::int32_t module::get_repeat_count() const {
 double module::get_duration_seconds() const {
 	return impl->get_duration_seconds();
 }
+std::vector<double> module::get_subsong_durations_seconds() const {
+	return impl->get_subsong_durations_seconds();
+}
 
 double module::set_position_seconds( double seconds ) {
 	return impl->set_position_seconds( seconds );
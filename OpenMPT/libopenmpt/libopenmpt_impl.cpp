@@ -15,6 +15,7 @@
 #include "libopenmpt_impl.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <limits>
@@ -28,6 +29,7 @@
 #include "soundlib/Sndfile.h"
 #include "soundlib/AudioReadTarget.h"
 #include "soundlib/FileReader.h"
+#include "soundlib/MixerThreads.h"
 
 using namespace OpenMPT;
 
@@ -279,6 +281,20 @@ static void mixersettings_to_ramping( int & ramping, const MixerSettings & setti
 		ramping = ( ramp_us + 500 ) / 1000;
 	}
 }
+// Looks up the per-stage performance counter ctls "perf.<stage>.cycles" and "perf.<stage>.calls".
+static bool get_perf_stage_ctl( const PerfCounters & counters, const std::string & ctl, uint64 & value ) {
+	for ( int stage = 0; stage < PerfCounters::numStages; ++stage ) {
+		const std::string prefix = std::string("perf.") + PerfCounters::GetStageName( static_cast<PerfCounters::Stage>( stage ) );
+		if ( ctl == prefix + ".cycles" ) {
+			value = counters.stages[stage].cycles;
+			return true;
+		} else if ( ctl == prefix + ".calls" ) {
+			value = counters.stages[stage].calls;
+			return true;
+		}
+	}
+	return false;
+}
 
 std::string module_impl::mod_string_to_utf8( const std::string & encoded ) const {
 	return mpt::ToCharset( mpt::CharsetUTF8, m_sndFile->GetCharset(), encoded );
@@ -322,6 +338,13 @@ void module_impl::init( const std::map< std::string, std::string > & ctls ) {
 	m_Gain = 1.0f;
 	m_ctl_load_skip_samples = false;
 	m_ctl_load_skip_patterns = false;
+	m_ctl_load_reference_samples = false;
+	m_load_metadata_only = false;
+	static const std::uint32_t eq_default_frequencies[MAX_EQ_BANDS] = { 120, 600, 1200, 3000, 6000, 10000 };
+	m_ctl_eq_gains.assign( MAX_EQ_BANDS, 16 );
+	m_ctl_eq_frequencies.assign( eq_default_frequencies, eq_default_frequencies + MAX_EQ_BANDS );
+	m_sndFile->SetSeekIndexInterval( 64 );
+	m_subsongDurationsSamplerate = 0;
 	for ( std::map< std::string, std::string >::const_iterator i = ctls.begin(); i != ctls.end(); ++i ) {
 		ctl_set( i->first, i->second );
 	}
@@ -334,6 +357,12 @@ void module_impl::load( CSoundFile & sndFile, const FileReader & file ) {
 	if ( m_ctl_load_skip_patterns ) {
 		load_flags &= ~CSoundFile::loadPatternData;
 	}
+	if ( m_ctl_load_reference_samples && m_fileData ) {
+		load_flags |= CSoundFile::referenceSampleData;
+	}
+	if ( m_load_metadata_only ) {
+		load_flags = CSoundFile::loadMetadataOnly;
+	}
 	if ( !sndFile.Create( file, static_cast<CSoundFile::ModLoadingFlags>( load_flags ) ) ) {
 		throw openmpt::exception("error loading file");
 	}
@@ -437,6 +466,20 @@ double module_impl::could_open_propability( std::istream & stream, double effort
 #else
 double module_impl::could_open_propability( std::istream & stream, double effort, std::shared_ptr<log_interface> log ) {
 #endif
+	if ( effort < 0.2 ) {
+		return 0.2;
+	} else if ( effort < 0.6 ) {
+		// Only run the header checks of the loaders, which does not need a CSoundFile at all
+		try {
+			if ( CSoundFile::Probe( FileReader( &stream ) ).confidence == CSoundFile::ProbeFailure ) {
+				return 0.0;
+			}
+			return 0.6;
+		} catch ( ... ) {
+			return 0.0;
+		}
+	}
+
 #ifdef MPT_ANCIENT_VS2008
 	std::tr1::shared_ptr<CSoundFile> sndFile( new CSoundFile() );
 #else
@@ -457,20 +500,12 @@ double module_impl::could_open_propability( std::istream & stream, double effort
 			}
 			sndFile->Destroy();
 			return 1.0;
-		} else if ( effort >= 0.6 ) {
+		} else {
 			if ( !sndFile->Create( FileReader( &stream ), CSoundFile::loadNoPatternOrPluginData ) ) {
 				return 0.0;
 			}
 			sndFile->Destroy();
 			return 0.8;
-		} else if ( effort >= 0.2 ) {
-			if ( !sndFile->Create( FileReader( &stream ), CSoundFile::onlyVerifyHeader ) ) {
-				return 0.0;
-			}
-			sndFile->Destroy();
-			return 0.6;
-		} else {
-			return 0.2;
 		}
 
 	} catch ( ... ) {
@@ -479,6 +514,48 @@ double module_impl::could_open_propability( std::istream & stream, double effort
 
 }
 
+#ifdef MPT_ANCIENT_VS2008
+std::map< std::string, std::string > module_impl::probe_metadata( std::istream & stream, std::tr1::shared_ptr<log_interface> log ) {
+#else
+std::map< std::string, std::string > module_impl::probe_metadata( std::istream & stream, std::shared_ptr<log_interface> log ) {
+#endif
+	std::map< std::string, std::string > retval;
+	try {
+		const module_impl impl( stream, log, metadata_only_tag() );
+		const std::vector<std::string> keys = impl.get_metadata_keys();
+		for ( std::vector<std::string>::const_iterator i = keys.begin(); i != keys.end(); ++i ) {
+			retval[ *i ] = impl.get_metadata( *i );
+		}
+		const std::vector<std::string> channel_names = impl.get_channel_names();
+		const std::vector<std::string> sample_names = impl.get_sample_names();
+		const std::vector<std::string> instrument_names = impl.get_instrument_names();
+		for ( std::vector<std::string>::const_iterator i = channel_names.begin(); i != channel_names.end(); ++i ) {
+			retval["channel_names"] += *i + "\n";
+		}
+		for ( std::vector<std::string>::const_iterator i = sample_names.begin(); i != sample_names.end(); ++i ) {
+			retval["sample_names"] += *i + "\n";
+		}
+		for ( std::vector<std::string>::const_iterator i = instrument_names.begin(); i != instrument_names.end(); ++i ) {
+			retval["instrument_names"] += *i + "\n";
+		}
+		retval["num_channels"] = Stringify( impl.get_num_channels() );
+		retval["num_samples"] = Stringify( impl.get_num_samples() );
+		retval["num_instruments"] = Stringify( impl.get_num_instruments() );
+	} catch ( ... ) {
+		retval.clear();
+	}
+	return retval;
+}
+
+#ifdef MPT_ANCIENT_VS2008
+module_impl::module_impl( std::istream & stream, std::tr1::shared_ptr<log_interface> log, metadata_only_tag ) : m_Log(log) {
+#else
+module_impl::module_impl( std::istream & stream, std::shared_ptr<log_interface> log, metadata_only_tag ) : m_Log(log) {
+#endif
+	init( std::map< std::string, std::string >() );
+	m_load_metadata_only = true;
+	load( FileReader( &stream ) );
+}
 #ifdef MPT_ANCIENT_VS2008
 module_impl::module_impl( std::istream & stream, std::tr1::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(log) {
 #else
@@ -489,6 +566,35 @@ module_impl::module_impl( std::istream & stream, std::shared_ptr<log_interface>
 	apply_libopenmpt_defaults();
 }
 #ifdef MPT_ANCIENT_VS2008
+module_impl::module_impl( const std::string & filename, std::tr1::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(log) {
+#else
+module_impl::module_impl( const std::string & filename, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(log) {
+#endif
+	init( ctls );
+#if defined(MPT_FILEREADER_MMAP)
+	{
+		MPT_SHARED_PTR<IFileDataContainer> mappedFile( new FileDataContainerMappedFile( filename.c_str() ) );
+		if ( mappedFile->IsValid() ) {
+			// keep the mapping alive if sample data is referenced from it
+			m_fileData = mappedFile;
+			load( FileReader( mappedFile ) );
+			if ( !m_ctl_load_reference_samples ) {
+				m_fileData.reset();
+			}
+			apply_libopenmpt_defaults();
+			return;
+		}
+	}
+	// fall back to reading the file (e.g. if it is a pipe or empty)
+#endif
+	std::ifstream stream( filename.c_str(), std::ios::binary );
+	if ( !stream ) {
+		throw openmpt::exception("error opening file");
+	}
+	load( FileReader( &stream ) );
+	apply_libopenmpt_defaults();
+}
+#ifdef MPT_ANCIENT_VS2008
 module_impl::module_impl( const std::vector<std::uint8_t> & data, std::tr1::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(log) {
 #else
 module_impl::module_impl( const std::vector<std::uint8_t> & data, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(log) {
@@ -688,8 +794,45 @@ std::size_t module_impl::read_interleaved_quad( std::int32_t samplerate, std::si
 }
 
 
+void module_impl::validate_subsong_durations() const {
+	// The song length depends on the mixing frequency (rounding of the tick duration),
+	// but not on anything else that can be changed through libopenmpt.
+	// Order lists are never modified after loading, so the cache only has to be thrown away if the sample rate changes.
+	if ( m_subsongDurations.size() != m_sndFile->Order.GetNumSequences() || m_subsongDurationsSamplerate != m_sndFile->m_MixerSettings.gdwMixingFreq ) {
+		m_subsongDurations.assign( m_sndFile->Order.GetNumSequences(), -1.0 );
+		m_subsongDurationsSamplerate = m_sndFile->m_MixerSettings.gdwMixingFreq;
+	}
+}
 double module_impl::get_duration_seconds() const {
-	return m_sndFile->GetLength( eNoAdjust ).duration;
+	validate_subsong_durations();
+	const SEQUENCEINDEX sequence = m_sndFile->Order.GetCurrentSequenceIndex();
+	if ( m_subsongDurations[sequence] < 0.0 ) {
+		m_subsongDurations[sequence] = m_sndFile->GetLength( eNoAdjust ).duration;
+	}
+	return m_subsongDurations[sequence];
+}
+std::vector<double> module_impl::get_subsong_durations_seconds() const {
+	validate_subsong_durations();
+	const SEQUENCEINDEX currentSequence = m_sndFile->Order.GetCurrentSequenceIndex();
+	bool otherSubsongsCalculated = false;
+	for ( SEQUENCEINDEX i = 0; i < m_sndFile->Order.GetNumSequences(); ++i ) {
+		if ( i == currentSequence || m_subsongDurations[i] >= 0.0 ) {
+			continue;
+		}
+		// GetLength() always works on the current sequence. Switching sequences does not affect the playback state.
+		m_sndFile->Order.SetSequence( i );
+		m_subsongDurations[i] = m_sndFile->GetLength( eNoAdjust ).duration;
+		otherSubsongsCalculated = true;
+	}
+	if ( m_sndFile->Order.GetCurrentSequenceIndex() != currentSequence ) {
+		m_sndFile->Order.SetSequence( currentSequence );
+	}
+	if ( otherSubsongsCalculated ) {
+		// The seek index only holds checkpoints for the last calculated subsong, so calculate the current subsong again (even if its duration is cached) to leave the index usable for seeking in it.
+		m_subsongDurations[currentSequence] = -1.0;
+	}
+	get_duration_seconds();
+	return m_subsongDurations;
 }
 void module_impl::select_subsong( std::int32_t subsong ) {
 	if ( subsong < -1 || subsong >= m_sndFile->Order.GetNumSequences() ) {
@@ -1139,7 +1282,38 @@ std::vector<std::string> module_impl::get_ctls() const {
 	std::vector<std::string> retval;
 	retval.push_back( "load_skip_samples" );
 	retval.push_back( "load_skip_patterns" );
+	retval.push_back( "load_reference_samples" );
+	retval.push_back( "load_threads" );
 	retval.push_back( "dither" );
+	retval.push_back( "simd" );
+	retval.push_back( "mixer_threads" );
+	retval.push_back( "mixer_chunk_size" );
+	retval.push_back( "mixer_skip_threshold" );
+	retval.push_back( "mixer_skipped_voice_frames" );
+	retval.push_back( "reverb" );
+	retval.push_back( "reverb_depth" );
+	retval.push_back( "reverb_preset" );
+	retval.push_back( "megabass" );
+	retval.push_back( "megabass_depth" );
+	retval.push_back( "megabass_range" );
+	retval.push_back( "surround" );
+	retval.push_back( "surround_depth" );
+	retval.push_back( "surround_delay" );
+	retval.push_back( "eq" );
+	retval.push_back( "eq_gains" );
+	retval.push_back( "eq_frequencies" );
+	retval.push_back( "agc" );
+	retval.push_back( "seek_index_interval" );
+	retval.push_back( "seek_index_memory" );
+	retval.push_back( "perf.enabled" );
+	retval.push_back( "perf.reset" );
+	for ( int stage = 0; stage < PerfCounters::numStages; ++stage ) {
+		const std::string prefix = std::string("perf.") + PerfCounters::GetStageName( static_cast<PerfCounters::Stage>( stage ) );
+		retval.push_back( prefix + ".cycles" );
+		retval.push_back( prefix + ".calls" );
+	}
+	retval.push_back( "perf.voices_mixed" );
+	retval.push_back( "perf.frames_rendered" );
 	return retval;
 }
 std::string module_impl::ctl_get( const std::string & ctl ) const {
@@ -1149,9 +1323,65 @@ std::string module_impl::ctl_get( const std::string & ctl ) const {
 		return mpt::ToString( m_ctl_load_skip_samples );
 	} else if ( ctl == "load_skip_patterns" ) {
 		return mpt::ToString( m_ctl_load_skip_patterns );
+	} else if ( ctl == "load_reference_samples" ) {
+		return mpt::ToString( m_ctl_load_reference_samples );
+	} else if ( ctl == "load_threads" ) {
+		return mpt::ToString( m_sndFile->GetLoaderThreads() );
 	} else if ( ctl == "dither" ) {
 		return mpt::ToString( static_cast<int>( m_Dither->GetMode() ) );
+	} else if ( ctl == "simd" ) {
+		return mpt::ToString( ( m_sndFile->m_MixerSettings.MixerFlags & SNDMIX_NOSIMD ) == 0 );
+	} else if ( ctl == "mixer_threads" ) {
+		return mpt::ToString( m_sndFile->m_MixerSettings.NumMixerThreads );
+	} else if ( ctl == "mixer_chunk_size" ) {
+		return mpt::ToString( m_sndFile->m_MixerSettings.GetMixBufferSize() );
+	} else if ( ctl == "mixer_skip_threshold" ) {
+		return mpt::ToString( m_sndFile->m_MixerSettings.VoiceSkipThreshold );
+	} else if ( ctl == "mixer_skipped_voice_frames" ) {
+		return mpt::ToString( m_sndFile->GetSkippedVoiceFrames() );
+	} else if ( ctl == "reverb" ) {
+		return mpt::ToString( ( m_sndFile->m_MixerSettings.DSPMask & SNDDSP_REVERB ) != 0 );
+	} else if ( ctl == "reverb_depth" ) {
+		return mpt::ToString( m_sndFile->m_Reverb.m_Settings.m_nReverbDepth * 100 / 16 );
+	} else if ( ctl == "reverb_preset" ) {
+		return mpt::ToString( m_sndFile->m_Reverb.m_Settings.m_nReverbType );
+	} else if ( ctl == "megabass" ) {
+		return mpt::ToString( ( m_sndFile->m_MixerSettings.DSPMask & SNDDSP_MEGABASS ) != 0 );
+	} else if ( ctl == "megabass_depth" ) {
+		return mpt::ToString( ( 8 - m_sndFile->m_DSP.m_Settings.m_nXBassDepth ) * 20 );
+	} else if ( ctl == "megabass_range" ) {
+		return mpt::ToString( 50 + ( m_sndFile->m_DSP.m_Settings.m_nXBassRange + 2 ) * 20 );
+	} else if ( ctl == "surround" ) {
+		return mpt::ToString( ( m_sndFile->m_MixerSettings.DSPMask & SNDDSP_SURROUND ) != 0 );
+	} else if ( ctl == "surround_depth" ) {
+		return mpt::ToString( m_sndFile->m_DSP.m_Settings.m_nProLogicDepth * 100 / 16 );
+	} else if ( ctl == "surround_delay" ) {
+		return mpt::ToString( m_sndFile->m_DSP.m_Settings.m_nProLogicDelay );
+	} else if ( ctl == "eq" ) {
+		return mpt::ToString( ( m_sndFile->m_MixerSettings.DSPMask & SNDDSP_EQ ) != 0 );
+	} else if ( ctl == "eq_gains" ) {
+		return mpt::String::Combine( m_ctl_eq_gains );
+	} else if ( ctl == "eq_frequencies" ) {
+		return mpt::String::Combine( m_ctl_eq_frequencies );
+	} else if ( ctl == "agc" ) {
+		return mpt::ToString( ( m_sndFile->m_MixerSettings.DSPMask & SNDDSP_AGC ) != 0 );
+	} else if ( ctl == "seek_index_interval" ) {
+		return mpt::ToString( m_sndFile->GetSeekIndexInterval() );
+	} else if ( ctl == "seek_index_memory" ) {
+		return mpt::ToString( m_sndFile->GetSeekIndexMemoryUsage() );
+	} else if ( ctl == "perf.enabled" ) {
+		return mpt::ToString( PerfCounters::IsEnabled() );
+	} else if ( ctl == "perf.reset" ) {
+		return mpt::ToString( false );
+	} else if ( ctl == "perf.voices_mixed" ) {
+		return mpt::ToString( m_sndFile->GetPerfCounters().voicesMixed );
+	} else if ( ctl == "perf.frames_rendered" ) {
+		return mpt::ToString( m_sndFile->GetPerfCounters().framesRendered );
 	} else {
+		uint64 value = 0;
+		if ( get_perf_stage_ctl( m_sndFile->GetPerfCounters(), ctl, value ) ) {
+			return mpt::ToString( value );
+		}
 		throw openmpt::exception("unknown ctl");
 	}
 }
@@ -1162,9 +1392,131 @@ void module_impl::ctl_set( const std::string & ctl, const std::string & value )
 		m_ctl_load_skip_samples = ConvertStrTo<bool>( value );
 	} else if ( ctl == "load_skip_patterns" ) {
 		m_ctl_load_skip_patterns = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load_reference_samples" ) {
+		m_ctl_load_reference_samples = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load_threads" ) {
+		m_sndFile->SetLoaderThreads( ConvertStrTo<uint32>( value ) );
 	} else if ( ctl == "dither" ) {
 		m_Dither->SetMode( static_cast<DitherMode>( ConvertStrTo<int>( value ) ) );
+	} else if ( ctl == "simd" ) {
+		MixerSettings settings = m_sndFile->m_MixerSettings;
+		if ( ConvertStrTo<bool>( value ) ) {
+			settings.MixerFlags &= ~SNDMIX_NOSIMD;
+		} else {
+			settings.MixerFlags |= SNDMIX_NOSIMD;
+		}
+		if ( settings.MixerFlags != m_sndFile->m_MixerSettings.MixerFlags ) {
+			m_sndFile->SetMixerSettings( settings );
+		}
+	} else if ( ctl == "mixer_threads" ) {
+		MixerSettings settings = m_sndFile->m_MixerSettings;
+		settings.NumMixerThreads = ConvertStrTo<uint32>( value );
+		if ( settings.NumMixerThreads == 0 ) {
+			settings.NumMixerThreads = MixerThreads::GetHardwareConcurrency();
+		}
+		if ( settings.NumMixerThreads != m_sndFile->m_MixerSettings.NumMixerThreads ) {
+			m_sndFile->SetMixerSettings( settings );
+		}
+	} else if ( ctl == "mixer_chunk_size" ) {
+		MixerSettings settings = m_sndFile->m_MixerSettings;
+		settings.MixBufferSize = Clamp<uint32, uint32>( ConvertStrTo<uint32>( value ), MIXBUFFERSIZE_MIN, MIXBUFFERSIZE_MAX );
+		if ( settings.MixBufferSize != m_sndFile->m_MixerSettings.MixBufferSize ) {
+			m_sndFile->SetMixerSettings( settings );
+		}
+	} else if ( ctl == "mixer_skip_threshold" ) {
+		MixerSettings settings = m_sndFile->m_MixerSettings;
+		settings.VoiceSkipThreshold = std::min( ConvertStrTo<int32>( value ), 0 );
+		if ( settings.VoiceSkipThreshold != m_sndFile->m_MixerSettings.VoiceSkipThreshold ) {
+			m_sndFile->SetMixerSettings( settings );
+		}
+	} else if ( ctl == "mixer_skipped_voice_frames" ) {
+		throw openmpt::exception("read-only ctl: " + ctl);
+	} else if ( ctl == "reverb" ) {
+		DWORD mask = m_sndFile->m_MixerSettings.DSPMask;
+		if ( ConvertStrTo<bool>( value ) ) {
+			mask |= SNDDSP_REVERB;
+		} else {
+			mask &= ~SNDDSP_REVERB;
+		}
+		m_sndFile->SetDspEffects( mask );
+	} else if ( ctl == "reverb_depth" ) {
+		m_sndFile->m_Reverb.SetReverbParameters( ConvertStrTo<uint32>( value ), m_sndFile->m_Reverb.m_Settings.m_nReverbType );
+	} else if ( ctl == "reverb_preset" ) {
+		const uint32 preset = ConvertStrTo<uint32>( value );
+		if ( preset < NUM_REVERBTYPES ) {
+			m_sndFile->m_Reverb.m_Settings.m_nReverbType = preset;
+			m_sndFile->InitPlayer();
+		}
+	} else if ( ctl == "megabass" ) {
+		DWORD mask = m_sndFile->m_MixerSettings.DSPMask;
+		if ( ConvertStrTo<bool>( value ) ) {
+			mask |= SNDDSP_MEGABASS;
+		} else {
+			mask &= ~SNDDSP_MEGABASS;
+		}
+		m_sndFile->SetDspEffects( mask );
+	} else if ( ctl == "megabass_depth" ) {
+		const uint32 gain = std::min<uint32>( ConvertStrTo<uint32>( value ) / 20, 4 );
+		m_sndFile->m_DSP.m_Settings.m_nXBassDepth = 8 - gain;
+		m_sndFile->InitPlayer();
+	} else if ( ctl == "megabass_range" ) {
+		// cutoff frequency in Hz, (range + 2) * 20 + 50
+		const uint32 cutoff = Clamp<uint32, uint32>( ConvertStrTo<uint32>( value ), 90u, 590u );
+		m_sndFile->m_DSP.m_Settings.m_nXBassRange = ( cutoff - 50 ) / 20 - 2;
+		m_sndFile->InitPlayer();
+	} else if ( ctl == "surround" ) {
+		DWORD mask = m_sndFile->m_MixerSettings.DSPMask;
+		if ( ConvertStrTo<bool>( value ) ) {
+			mask |= SNDDSP_SURROUND;
+		} else {
+			mask &= ~SNDDSP_SURROUND;
+		}
+		m_sndFile->SetDspEffects( mask );
+	} else if ( ctl == "surround_depth" ) {
+		m_sndFile->m_DSP.SetSurroundParameters( ConvertStrTo<uint32>( value ), m_sndFile->m_DSP.m_Settings.m_nProLogicDelay );
+		m_sndFile->InitPlayer();
+	} else if ( ctl == "surround_delay" ) {
+		m_sndFile->m_DSP.SetSurroundParameters( m_sndFile->m_DSP.m_Settings.m_nProLogicDepth * 100 / 16, ConvertStrTo<uint32>( value ) );
+		m_sndFile->InitPlayer();
+	} else if ( ctl == "eq" ) {
+		DWORD mask = m_sndFile->m_MixerSettings.DSPMask;
+		if ( ConvertStrTo<bool>( value ) ) {
+			mask |= SNDDSP_EQ;
+		} else {
+			mask &= ~SNDDSP_EQ;
+		}
+		m_sndFile->SetDspEffects( mask );
+	} else if ( ctl == "eq_gains" || ctl == "eq_frequencies" ) {
+		// comma-separated list with one value per band, missing bands keep their current value
+		const std::vector<std::uint32_t> values = mpt::String::Split<std::uint32_t>( value );
+		std::vector<std::uint32_t> & target = ( ctl == "eq_gains" ) ? m_ctl_eq_gains : m_ctl_eq_frequencies;
+		for ( std::size_t band = 0; band < std::min<std::size_t>( values.size(), MAX_EQ_BANDS ); ++band ) {
+			target[band] = ( ctl == "eq_gains" ) ? std::min<std::uint32_t>( values[band], 32 ) : values[band];
+		}
+		m_sndFile->SetEQGains( &m_ctl_eq_gains[0], MAX_EQ_BANDS, &m_ctl_eq_frequencies[0] );
+	} else if ( ctl == "agc" ) {
+		DWORD mask = m_sndFile->m_MixerSettings.DSPMask;
+		if ( ConvertStrTo<bool>( value ) ) {
+			mask |= SNDDSP_AGC;
+		} else {
+			mask &= ~SNDDSP_AGC;
+		}
+		m_sndFile->SetDspEffects( mask );
+	} else if ( ctl == "seek_index_interval" ) {
+		m_sndFile->SetSeekIndexInterval( ConvertStrTo<ROWINDEX>( value ) );
+	} else if ( ctl == "seek_index_memory" ) {
+		throw openmpt::exception("read-only ctl: " + ctl);
+	} else if ( ctl == "perf.reset" ) {
+		if ( ConvertStrTo<bool>( value ) ) {
+			m_sndFile->ResetPerfCounters();
+		}
+	} else if ( ctl == "perf.enabled" || ctl == "perf.voices_mixed" || ctl == "perf.frames_rendered" ) {
+		throw openmpt::exception("read-only ctl: " + ctl);
 	} else {
+		uint64 dummy = 0;
+		if ( get_perf_stage_ctl( m_sndFile->GetPerfCounters(), ctl, dummy ) ) {
+			throw openmpt::exception("read-only ctl: " + ctl);
+		}
 		throw openmpt::exception("unknown ctl: " + ctl + " := " + value);
 	}
 }
@@ -18,6 +18,7 @@
 
 // forward declarations
 namespace OpenMPT {
+class IFileDataContainer;
 class FileReader;
 class CSoundFile;
 class Dither;
@@ -65,6 +66,12 @@ protected:
 	std::unique_ptr<log_forwarder> m_LogForwarder;
 #endif
 	double m_currentPositionSeconds;
+	// File data that sample data is referenced from, must outlive m_sndFile
+#ifdef MPT_ANCIENT_VS2008
+	std::tr1::shared_ptr<OpenMPT::IFileDataContainer> m_fileData;
+#else
+	std::shared_ptr<OpenMPT::IFileDataContainer> m_fileData;
+#endif
 #ifdef MPT_ANCIENT_VS2008
 	std::tr1::shared_ptr<OpenMPT::CSoundFile> m_sndFile;
 #else
@@ -78,7 +85,16 @@ protected:
 	float m_Gain;
 	bool m_ctl_load_skip_samples;
 	bool m_ctl_load_skip_patterns;
+	bool m_ctl_load_reference_samples;
+	// Only load header fields and names, see probe_metadata()
+	bool m_load_metadata_only;
+	// Equalizer band gains (0 = -12dB, 16 = flat, 32 = +12dB) and center frequencies in Hz
+	std::vector<std::uint32_t> m_ctl_eq_gains;
+	std::vector<std::uint32_t> m_ctl_eq_frequencies;
 	std::vector<std::string> m_loaderMessages;
+	// Cached song length of each subsong (negative if not calculated yet), valid for m_subsongDurationsSamplerate
+	mutable std::vector<double> m_subsongDurations;
+	mutable std::uint32_t m_subsongDurationsSamplerate;
 public:
 	void PushToCSoundFileLog( const std::string & text ) const;
 	void PushToCSoundFileLog( int loglevel, const std::string & text ) const;
@@ -86,6 +102,7 @@ protected:
 	std::string mod_string_to_utf8( const std::string & encoded ) const;
 	void apply_mixer_settings( std::int32_t samplerate, int channels );
 	void apply_libopenmpt_defaults();
+	void validate_subsong_durations() const;
 	void init( const std::map< std::string, std::string > & ctls );
 	void load( OpenMPT::CSoundFile & sndFile, const OpenMPT::FileReader & file );
 	void load( const OpenMPT::FileReader & file );
@@ -95,6 +112,12 @@ protected:
 	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, float * interleaved );
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel_command( std::int32_t p, std::int32_t r, std::int32_t c, int command ) const;
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const;
+	struct metadata_only_tag { };
+#ifdef MPT_ANCIENT_VS2008
+	module_impl( std::istream & stream, std::tr1::shared_ptr<log_interface> log, metadata_only_tag );
+#else
+	module_impl( std::istream & stream, std::shared_ptr<log_interface> log, metadata_only_tag );
+#endif
 public:
 	static std::vector<std::string> get_supported_extensions();
 	static bool is_extension_supported( const std::string & extension );
@@ -103,11 +126,21 @@ public:
 #else
 	static double could_open_propability( std::istream & stream, double effort, std::shared_ptr<log_interface> log );
 #endif
+#ifdef MPT_ANCIENT_VS2008
+	static std::map< std::string, std::string > probe_metadata( std::istream & stream, std::tr1::shared_ptr<log_interface> log );
+#else
+	static std::map< std::string, std::string > probe_metadata( std::istream & stream, std::shared_ptr<log_interface> log );
+#endif
 #ifdef MPT_ANCIENT_VS2008
 	module_impl( std::istream & stream, std::tr1::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 #else
 	module_impl( std::istream & stream, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 #endif
+#ifdef MPT_ANCIENT_VS2008
+	module_impl( const std::string & filename, std::tr1::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+#else
+	module_impl( const std::string & filename, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+#endif
 #ifdef MPT_ANCIENT_VS2008
 	module_impl( const std::vector<std::uint8_t> & data, std::tr1::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 #else
@@ -139,6 +172,7 @@ public:
 	void set_repeat_count( std::int32_t repeat_count );
 	std::int32_t get_repeat_count() const;
 	double get_duration_seconds() const;
+	std::vector<double> get_subsong_durations_seconds() const;
 	double set_position_seconds( double seconds );
 	double get_position_seconds() const;
 	double set_position_order_row( std::int32_t order, std::int32_t row );
@@ -703,7 +703,7 @@ public:
 	{
 		ALWAYS_ASSERT(sampleFormat.IsValid());
 	}
-	virtual void DataCallback(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
+	virtual void DataCallback(mixsample_t *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
 	{
 		CMainFrame::CalcStereoVuMeters(MixSoundBuffer, countChunk, channels);
 		switch(sampleFormat.value)
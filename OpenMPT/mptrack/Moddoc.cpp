@@ -1133,6 +1133,7 @@ CHANNELINDEX CModDoc::PlayNote(UINT note, INSTRUMENTINDEX nins, SAMPLEINDEX nsmp
 		chn.nFadeOutVol = 0x10000;
 
 		m_SndFile.NoteChange(&chn, note, false, true, true);
+		m_SndFile.AddBackgroundVoice(nChn);
 		if (nVol >= 0) chn.nVolume = nVol;
 		
 		// Handle sample looping.
@@ -1191,6 +1192,7 @@ CHANNELINDEX CModDoc::PlayNote(UINT note, INSTRUMENTINDEX nins, SAMPLEINDEX nsmp
 	{
 		CriticalSection cs;
 		m_SndFile.NoteChange(&m_SndFile.m_PlayState.Chn[nChn], note);
+		if(nChn >= GetNumChannels()) m_SndFile.AddBackgroundVoice(nChn);
 		if (pause) m_SndFile.m_SongFlags.set(SONG_PAUSED);
 	}
 	return nChn;
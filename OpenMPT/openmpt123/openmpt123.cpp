@@ -238,6 +238,7 @@ static std::ostream & operator << ( std::ostream & s, const commandlineflags & f
 	s << "Output dithering: " << flags.dither << std::endl;
 	s << "Repeat count: " << flags.repeatcount << std::endl;
 	s << "Seek target: " << flags.seek_target << std::endl;
+	s << "Jobs: " << flags.jobs << std::endl;
 	s << "Standard output: " << flags.use_stdout << std::endl;
 	s << "Output filename: " << flags.output_filename << std::endl;
 	s << "Force overwrite output file: " << flags.force_overwrite << std::endl;
@@ -467,6 +468,7 @@ static void show_help( textout & log, bool with_info = true, bool longhelp = fal
 		log << "     --dither n             Dither type to use (if applicable for selected output format): [0=off,1=auto,2=0.5bit,3=1bit] [default: " << commandlineflags().dither << "]" << std::endl;
 		log << std::endl;
 		log << "     --[no-]shuffle         Shuffle playlist [default: " << commandlineflags().shuffle << "]" << std::endl;
+		log << "     --jobs n               Render n files at the same time in --render mode (0 means one per CPU) [default: " << commandlineflags().jobs << "]" << std::endl;
 		log << std::endl;
 		log << "     --repeat n             Repeat song n times (-1 means forever) [default: " << commandlineflags().repeatcount << "]" << std::endl;
 		log << "     --seek n               Seek to n seconds on start [default: " << commandlineflags().seek_target << "]" << std::endl;
@@ -1358,10 +1360,22 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 			throw exception( "file open error" );
 		}
 
+#if defined(WIN32)
 		{
 			openmpt::module mod( data_stream );
 			render_mod_file( flags, filename, filesize, mod, log, audio_stream );
 		} 
+#else
+		if ( use_stdin ) {
+			openmpt::module mod( data_stream );
+			render_mod_file( flags, filename, filesize, mod, log, audio_stream );
+		} else {
+			// Let libopenmpt map the file into memory instead of copying it from the stream.
+			file_stream.close();
+			openmpt::module mod( filename );
+			render_mod_file( flags, filename, filesize, mod, log, audio_stream );
+		}
+#endif
 
 	} catch ( prev_file & ) {
 		throw;
@@ -1382,6 +1396,98 @@ static void render_file( commandlineflags & flags, const std::string & filename,
 }
 
 
+// State shared by all worker threads of render_files_parallel().
+struct render_jobs {
+	const commandlineflags & flags;
+	textout & log;
+	mutex lock;
+	std::size_t next_job;     // next file to be picked up by a worker
+	std::size_t next_output;  // next file whose log has to be written to the console
+	std::vector<bool> done;
+	std::vector<std::string> logs;
+	std::vector<std::string> errors;
+	render_jobs( const commandlineflags & flags_, textout & log_ )
+		: flags(flags_)
+		, log(log_)
+		, next_job(0)
+		, next_output(0)
+		, done(flags_.filenames.size())
+		, logs(flags_.filenames.size())
+		, errors(flags_.filenames.size())
+	{
+		return;
+	}
+};
+
+static void render_files_worker( void * arg ) {
+	render_jobs & jobs = *static_cast<render_jobs*>( arg );
+	commandlineflags flags = jobs.flags;
+	flags.show_progress = false;
+	while ( true ) {
+		std::size_t job = 0;
+		{
+			scoped_lock<mutex> guard( jobs.lock );
+			if ( jobs.next_job >= flags.filenames.size() ) {
+				break;
+			}
+			job = jobs.next_job++;
+		}
+		std::string job_log;
+		std::string job_error;
+		try {
+			textout_string log( job_log );
+			flags.playlist_index = job;
+			file_audio_stream_raii file_audio_stream( flags, flags.filenames[ job ] + std::string(".") + flags.output_extension, log );
+			render_file( flags, flags.filenames[ job ], log, file_audio_stream );
+		} catch ( std::exception & e ) {
+			job_error = e.what();
+		} catch ( ... ) {
+			job_error = "unknown error";
+		}
+		{
+			scoped_lock<mutex> guard( jobs.lock );
+			jobs.logs[ job ].swap( job_log );
+			jobs.errors[ job ].swap( job_error );
+			jobs.done[ job ] = true;
+			// Output the logs in playlist order, as soon as all previous files are done.
+			while ( jobs.next_output < jobs.done.size() && jobs.done[ jobs.next_output ] ) {
+				jobs.log << jobs.logs[ jobs.next_output ];
+				jobs.log.writeout();
+				std::string().swap( jobs.logs[ jobs.next_output ] );
+				jobs.next_output++;
+			}
+		}
+	}
+}
+
+// Renders each file to its own output file, using flags.jobs threads that pick the next file from the playlist when they are done with the previous one.
+static void render_files_parallel( commandlineflags & flags, textout & log ) {
+	flags.apply_default_buffer_sizes();
+	render_jobs jobs( flags, log );
+	{
+		std::vector<thread*> threads;
+		try {
+			const std::size_t count = std::min( static_cast<std::size_t>( flags.jobs ), flags.filenames.size() );
+			for ( std::size_t i = 0; i < count; ++i ) {
+				threads.push_back( new thread( &render_files_worker, &jobs ) );
+			}
+		} catch ( ... ) {
+			for ( std::vector<thread*>::iterator i = threads.begin(); i != threads.end(); ++i ) {
+				delete *i;
+			}
+			throw;
+		}
+		for ( std::vector<thread*>::iterator i = threads.begin(); i != threads.end(); ++i ) {
+			delete *i;
+		}
+	}
+	for ( std::vector<std::string>::iterator error = jobs.errors.begin(); error != jobs.errors.end(); ++error ) {
+		if ( !error->empty() ) {
+			throw exception( *error );
+		}
+	}
+}
+
 static void render_files( commandlineflags & flags, textout & log, write_buffers_interface & audio_stream ) {
 	if ( flags.shuffle ) {
 		std::random_shuffle( flags.filenames.begin(), flags.filenames.end() );
@@ -1546,6 +1652,10 @@ static commandlineflags parse_openmpt123( const std::vector<std::string> & args,
 					istr >> flags.device;
 				}
 				++i;
+			} else if ( arg == "--jobs" && nextarg != "" ) {
+				std::istringstream istr( nextarg );
+				istr >> flags.jobs;
+				++i;
 			} else if ( arg == "--buffer" && nextarg != "" ) {
 				std::istringstream istr( nextarg );
 				istr >> flags.buffer;
@@ -1812,6 +1922,10 @@ static int main( int argc, char * argv [] ) {
 				}
 			} break;
 			case ModeRender: {
+				if ( flags.jobs > 1 && flags.filenames.size() > 1 ) {
+					render_files_parallel( flags, log );
+					break;
+				}
 				for ( std::vector<std::string>::iterator filename = flags.filenames.begin(); filename != flags.filenames.end(); ++filename ) {
 					flags.apply_default_buffer_sizes();
 					file_audio_stream_raii file_audio_stream( flags, *filename + std::string(".") + flags.output_extension, log );
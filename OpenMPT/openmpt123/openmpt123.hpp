@@ -88,6 +88,75 @@ public:
 
 #endif
 
+template < typename Tmutex >
+class scoped_lock {
+private:
+	Tmutex & m;
+	scoped_lock( const scoped_lock & );
+	scoped_lock & operator = ( const scoped_lock & );
+public:
+	scoped_lock( Tmutex & m_ ) : m(m_) { m.lock(); }
+	~scoped_lock() { m.unlock(); }
+};
+
+// Runs func( arg ) in a new thread, which is joined on destruction.
+class thread {
+private:
+	void (*func)( void * );
+	void * arg;
+#if defined(WIN32)
+	HANDLE impl;
+	static DWORD WINAPI entry( LPVOID self ) {
+		static_cast<thread*>( self )->func( static_cast<thread*>( self )->arg );
+		return 0;
+	}
+#else
+	pthread_t impl;
+	static void * entry( void * self ) {
+		static_cast<thread*>( self )->func( static_cast<thread*>( self )->arg );
+		return 0;
+	}
+#endif
+	thread( const thread & );
+	thread & operator = ( const thread & );
+public:
+	thread( void (*func_)( void * ), void * arg_ )
+		: func(func_)
+		, arg(arg_)
+	{
+#if defined(WIN32)
+		impl = CreateThread( NULL, 0, &entry, this, 0, NULL );
+		if ( !impl ) {
+			throw exception( "cannot create thread" );
+		}
+#else
+		if ( pthread_create( &impl, NULL, &entry, this ) != 0 ) {
+			throw exception( "cannot create thread" );
+		}
+#endif
+	}
+	~thread() {
+#if defined(WIN32)
+		WaitForSingleObject( impl, INFINITE );
+		CloseHandle( impl );
+#else
+		pthread_join( impl, NULL );
+#endif
+	}
+	// Number of threads that can run at the same time
+	static int get_hardware_concurrency() {
+#if defined(WIN32)
+		SYSTEM_INFO info;
+		GetSystemInfo( &info );
+		return std::max( 1, static_cast<int>( info.dwNumberOfProcessors ) );
+#elif defined(_SC_NPROCESSORS_ONLN)
+		return std::max( 1L, sysconf( _SC_NPROCESSORS_ONLN ) );
+#else
+		return 1;
+#endif
+	}
+};
+
 #endif
 
 struct field {
@@ -130,6 +199,24 @@ public:
 	}
 };
 
+class textout_string : public textout {
+private:
+	std::string & s;
+public:
+	textout_string( std::string & s_ )
+		: s(s_)
+	{
+		return;
+	}
+	virtual ~textout_string() {
+		writeout();
+	}
+public:
+	virtual void write( const std::string & text ) {
+		s += text;
+	}
+};
+
 class textout_ostream : public textout {
 private:
 	std::ostream & s;
@@ -268,6 +355,7 @@ struct commandlineflags {
 	bool use_float;
 	bool use_stdout;
 	bool shuffle;
+	int jobs;
 	std::size_t playlist_index;
 	std::vector<std::string> filenames;
 	std::string output_filename;
@@ -367,6 +455,7 @@ struct commandlineflags {
 		show_pattern = false;
 		use_stdout = false;
 		shuffle = false;
+		jobs = 1;
 		playlist_index = 0;
 		output_extension = "wav";
 		force_overwrite = false;
@@ -448,6 +537,12 @@ struct commandlineflags {
 		if ( mode == ModeRender && output_extension.empty() ) {
 			throw args_error_exception();
 		}
+		if ( jobs != 1 && mode != ModeRender ) {
+			throw args_error_exception();
+		}
+		if ( jobs <= 0 ) {
+			jobs = thread::get_hardware_concurrency();
+		}
 	}
 };
 
@@ -49,6 +49,11 @@
 
 #endif // _MSC_VER
 
+// Rendering several files in parallel (--jobs)
+#ifndef MPT_NEEDS_THREADS
+#define MPT_NEEDS_THREADS
+#endif
+
 #if defined(MPT_WITH_PORTAUDIO) && defined(MPT_PORTAUDIO_CALLBACK)
 #ifndef MPT_NEEDS_THREADS
 #define MPT_NEEDS_THREADS
@@ -3,6 +3,8 @@
  * -----------
  * Purpose: Mixing code for various DSPs (EQ, Mega-Bass, ...)
  * Notes  : Ugh... This should really be removed at some point.
+ *          The DC removal filter was originally written in x86 assembly. The stereo version is now
+ *          implemented using SSE2 / NEON intrinsics (both channels are processed in parallel) or plain C++.
  * Authors: Olivier Lapicque
  *          OpenMPT Devs
  * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
@@ -12,14 +14,15 @@
 #include "stdafx.h"
 #include "../soundlib/Sndfile.h"
 #include "../sounddsp/DSP.h"
-#include <math.h>
+#include <cmath>
+#if defined(ENABLE_SSE2_INTRINSICS)
+#include <emmintrin.h>
+#elif defined(ENABLE_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
 
 OPENMPT_NAMESPACE_BEGIN
 
-#if MPT_COMPILER_MSVC
-#pragma warning(disable: 4725) // instruction may be inaccurate on some Pentiums
-#endif
-
 
 #ifndef NO_DSP
 
@@ -33,10 +36,64 @@ OPENMPT_NAMESPACE_BEGIN
 // DSP Effects internal state
 
 
-extern void X86_InitMixBuffer(int *pBuffer, UINT nSamples);
+// The stereo filter processes both channels at once, using two 32-bit lanes.
+// A vector backend provides loading and storing a stereo sampling point and basic 32-bit integer arithmetic.
+
+struct DSPScalar
+{
+	struct v32 { int32 l, r; };
+
+	static forceinline v32 Set(int32 l, int32 r) { v32 v = { l, r }; return v; }
+	static forceinline int32 Left(v32 a) { return a.l; }
+	static forceinline int32 Right(v32 a) { return a.r; }
+	static forceinline v32 Load(const int32 *p) { return Set(p[0], p[1]); }
+	static forceinline void Store(int32 *p, v32 a) { p[0] = a.l; p[1] = a.r; }
+	static forceinline v32 Add(v32 a, v32 b) { return Set(a.l + b.l, a.r + b.r); }
+	static forceinline v32 Sub(v32 a, v32 b) { return Set(a.l - b.l, a.r - b.r); }
+	template<int shift>
+	static forceinline v32 Sar(v32 a) { return Set(a.l >> shift, a.r >> shift); }
+};
+
+#if defined(ENABLE_SSE2_INTRINSICS)
+
+struct DSPSIMD
+{
+	typedef __m128i v32;	// Only the lower two lanes are used
+
+	static forceinline v32 Set(int32 l, int32 r) { return _mm_setr_epi32(l, r, 0, 0); }
+	static forceinline int32 Left(v32 a) { return _mm_cvtsi128_si32(a); }
+	static forceinline int32 Right(v32 a) { return _mm_cvtsi128_si32(_mm_srli_si128(a, 4)); }
+	static forceinline v32 Load(const int32 *p) { return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)); }
+	static forceinline void Store(int32 *p, v32 a) { _mm_storel_epi64(reinterpret_cast<__m128i *>(p), a); }
+	static forceinline v32 Add(v32 a, v32 b) { return _mm_add_epi32(a, b); }
+	static forceinline v32 Sub(v32 a, v32 b) { return _mm_sub_epi32(a, b); }
+	template<int shift>
+	static forceinline v32 Sar(v32 a) { return _mm_srai_epi32(a, shift); }
+};
+
+#elif defined(ENABLE_NEON_INTRINSICS)
+
+struct DSPSIMD
+{
+	typedef int32x2_t v32;
+
+	static forceinline v32 Set(int32 l, int32 r) { return vset_lane_s32(r, vdup_n_s32(l), 1); }
+	static forceinline int32 Left(v32 a) { return vget_lane_s32(a, 0); }
+	static forceinline int32 Right(v32 a) { return vget_lane_s32(a, 1); }
+	static forceinline v32 Load(const int32 *p) { return vld1_s32(p); }
+	static forceinline void Store(int32 *p, v32 a) { vst1_s32(p, a); }
+	static forceinline v32 Add(v32 a, v32 b) { return vadd_s32(a, b); }
+	static forceinline v32 Sub(v32 a, v32 b) { return vsub_s32(a, b); }
+	template<int shift>
+	static forceinline v32 Sar(v32 a) { return vshr_n_s32(a, shift); }
+};
+
+#endif
+
 
-static void X86_StereoDCRemoval(int *, UINT count, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l, LONG *nDCRFlt_Y1r, LONG *nDCRFlt_X1r);
-static void X86_MonoDCRemoval(int *, UINT count, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l);
+template<typename TVector>
+static void StereoDCRemoval(int *, UINT count, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l, LONG *nDCRFlt_Y1r, LONG *nDCRFlt_X1r);
+static void MonoDCRemoval(int *, UINT count, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l);
 
 ///////////////////////////////////////////////////////////////////////////////////
 //
@@ -55,25 +112,10 @@ static void ShelfEQ(LONG scale,
 	float alpha, beta0, beta1, rho;
 	float wT, quad;
 
-	_asm {
-	// wT = PI*Fc/Fs
-	fild F_c
-	fldpi
-	fmulp ST(1), ST(0)
-	fild F_s
-	fdivp ST(1), ST(0)
-	fstp wT
-	// gain^2
-	fld gainDC
-	fld gainFT
-	fld gainPI
-	fmul ST(0), ST(0)
-	fstp gainPI2
-	fmul ST(0), ST(0)
-	fstp gainFT2
-	fmul ST(0), ST(0)
-	fstp gainDC2
-	}
+	wT = static_cast<float>(3.1415926535897932385 * F_c / F_s);
+	gainPI2 = gainPI * gainPI;
+	gainFT2 = gainFT * gainFT;
+	gainDC2 = gainDC * gainDC;
 
 	quad = gainPI2 + gainDC2 - (gainFT2*2);
 
@@ -82,12 +124,12 @@ static void ShelfEQ(LONG scale,
 	if (quad != 0)
 	{
 		float lambda = (gainPI2 - gainDC2) / quad;
-	alpha  = (float)(lambda - Sgn(lambda)*sqrt(lambda*lambda - 1.0f));
+	alpha  = (float)(lambda - Sgn(lambda)*std::sqrt(lambda*lambda - 1.0f));
 	}
 
 	beta0 = 0.5f * ((gainDC + gainPI) + (gainDC - gainPI) * alpha);
 	beta1 = 0.5f * ((gainDC - gainPI) + (gainDC + gainPI) * alpha);
-	rho   = (float)((sin((wT*0.5f) - (PI/4.0f))) / (sin((wT*0.5f) + (PI/4.0f))));
+	rho   = (float)((std::sin((wT*0.5f) - (PI/4.0f))) / (std::sin((wT*0.5f) + (PI/4.0f))));
 
 	quad  = 1.0f / (1.0f + rho*alpha);
 
@@ -95,22 +137,9 @@ static void ShelfEQ(LONG scale,
 	b1 = ((beta1 + rho*beta0) * quad);
 	a1 = - ((rho + alpha) * quad);
 
-	_asm {
-	fild scale
-	fld a1
-	mov eax, outA1
-	fmul ST(0), ST(1)
-	fistp dword ptr [eax]
-	fld b0
-	mov eax, outB0
-	fmul ST(0), ST(1)
-	fistp dword ptr [eax]
-	fld b1
-	mov eax, outB1
-	fmul ST(0), ST(1)
-	fistp dword ptr [eax]
-	fstp rho
-	}
+	*outA1 = Util::Round<LONG>(a1 * scale);
+	*outB0 = Util::Round<LONG>(b0 * scale);
+	*outB1 = Util::Round<LONG>(b1 * scale);
 }
 
 
@@ -154,11 +183,14 @@ CDSP::CDSP()
 
 	MemsetZero(SurroundBuffer);
 
+	m_useSIMD = true;
+
 }
 
-void CDSP::Initialize(bool bReset, DWORD MixingFreq, DWORD DSPMask)
-//-----------------------------------------------------------------
+void CDSP::Initialize(bool bReset, DWORD MixingFreq, DWORD DSPMask, bool useSIMD)
+//--------------------------------------------------------------------------------
 {
+	m_useSIMD = useSIMD;
 	if (!m_Settings.m_nProLogicDelay) m_Settings.m_nProLogicDelay = 20;
 
 	// Pro-Logic Surround
@@ -248,13 +280,13 @@ void CDSP::ProcessStereoSurround(int * MixSoundBuffer, int count)
 void CDSP::ProcessQuadSurround(int * MixSoundBuffer, int * MixRearBuffer, int count)
 //----------------------------------------------------------------------------------
 {
-	int *pr = MixSoundBuffer, hy1 = nDolbyHP_Y1;
+	int *pr = MixSoundBuffer, *prr = MixRearBuffer, hy1 = nDolbyHP_Y1;
 	for (int r=count; r; r--)
 	{
 		int vl = pr[0] >> 1;
 		int vr = pr[1] >> 1;
-		pr[(UINT)(MixRearBuffer-MixSoundBuffer)] += vl;
-		pr[((UINT)(MixRearBuffer-MixSoundBuffer))+1] += vr;
+		prr[0] += vl;
+		prr[1] += vr;
 		// Delay
 		int secho = SurroundBuffer[nSurroundPos];
 		SurroundBuffer[nSurroundPos] = (vr+vl+256) >> 9;
@@ -266,10 +298,11 @@ void CDSP::ProcessQuadSurround(int * MixSoundBuffer, int * MixRearBuffer, int co
 		hy1 = v0;
 		nDolbyLP_Y1 = v >> 8;
 		// Add echo
-		pr[(UINT)(MixRearBuffer-MixSoundBuffer)] += v;
-		pr[((UINT)(MixRearBuffer-MixSoundBuffer))+1] += v;
+		prr[0] += v;
+		prr[1] += v;
 		if (++nSurroundPos >= nSurroundSize) nSurroundPos = 0;
 		pr += 2;
+		prr += 2;
 	}
 	nDolbyHP_Y1 = hy1;
 }
@@ -293,7 +326,12 @@ void CDSP::Process(int * MixSoundBuffer, int * MixRearBuffer, int count, UINT nC
 	// Bass Expansion
 	if (DSPMask & SNDDSP_MEGABASS)
 	{
-		X86_StereoDCRemoval(MixSoundBuffer, count, &nDCRFlt_Y1l, &nDCRFlt_X1l, &nDCRFlt_Y1r, &nDCRFlt_X1r);
+#ifdef ENABLE_SIMD_INTRINSICS
+		if(m_useSIMD && HasSIMDIntrinsicsSupport())
+			StereoDCRemoval<DSPSIMD>(MixSoundBuffer, count, &nDCRFlt_Y1l, &nDCRFlt_X1l, &nDCRFlt_Y1r, &nDCRFlt_X1r);
+		else
+#endif // ENABLE_SIMD_INTRINSICS
+			StereoDCRemoval<DSPScalar>(MixSoundBuffer, count, &nDCRFlt_Y1l, &nDCRFlt_X1l, &nDCRFlt_Y1r, &nDCRFlt_X1r);
 		int *px = MixSoundBuffer;
 		int x1 = nXBassFlt_X1;
 		int y1 = nXBassFlt_Y1;
@@ -320,7 +358,7 @@ void CDSP::Process(int * MixSoundBuffer, int * MixRearBuffer, int count, UINT nC
 	// Bass Expansion
 	if (DSPMask & SNDDSP_MEGABASS)
 	{
-		X86_MonoDCRemoval(MixSoundBuffer, count, &nDCRFlt_Y1l, &nDCRFlt_X1l);
+		MonoDCRemoval(MixSoundBuffer, count, &nDCRFlt_Y1l, &nDCRFlt_X1l);
 		int *px = MixSoundBuffer;
 		int x1 = nXBassFlt_X1;
 		int y1 = nXBassFlt_Y1;
@@ -353,79 +391,40 @@ void CDSP::Process(int * MixSoundBuffer, int * MixRearBuffer, int count, UINT nC
 
 #define DCR_AMOUNT		9
 
-static void X86_StereoDCRemoval(int *pBuffer, UINT nSamples, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l, LONG *nDCRFlt_Y1r, LONG *nDCRFlt_X1r)
+template<typename TVector>
+static void StereoDCRemoval(int *pBuffer, UINT nSamples, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l, LONG *nDCRFlt_Y1r, LONG *nDCRFlt_X1r)
 {
-	int y1l=*nDCRFlt_Y1l, x1l=*nDCRFlt_X1l;
-	int y1r=*nDCRFlt_Y1r, x1r=*nDCRFlt_X1r;
-
-	_asm {
-	mov esi, pBuffer
-	mov ecx, nSamples
-stereodcr:
-	mov eax, [esi]
-	mov ebx, x1l
-	mov edx, [esi+4]
-	mov edi, x1r
-	add esi, 8
-	sub ebx, eax
-	mov x1l, eax
-	mov eax, ebx
-	sar eax, DCR_AMOUNT+1
-	sub edi, edx
-	sub eax, ebx
-	mov x1r, edx
-	add eax, y1l
-	mov edx, edi
-	sar edx, DCR_AMOUNT+1
-	mov [esi-8], eax
-	sub edx, edi
-	mov ebx, eax
-	add edx, y1r
-	sar ebx, DCR_AMOUNT
-	mov [esi-4], edx
-	mov edi, edx
-	sub eax, ebx
-	sar edi, DCR_AMOUNT
-	mov y1l, eax
-	sub edx, edi
-	dec ecx
-	mov y1r, edx
-	jnz stereodcr
+	typename TVector::v32 x1 = TVector::Set(*nDCRFlt_X1l, *nDCRFlt_X1r);
+	typename TVector::v32 y1 = TVector::Set(*nDCRFlt_Y1l, *nDCRFlt_Y1r);
+
+	for(UINT i = 0; i < nSamples; i++, pBuffer += 2)
+	{
+		const typename TVector::v32 x = TVector::Load(pBuffer);
+		const typename TVector::v32 diff = TVector::Sub(x1, x);
+		x1 = x;
+		const typename TVector::v32 y = TVector::Add(TVector::Sub(TVector::template Sar<DCR_AMOUNT + 1>(diff), diff), y1);
+		TVector::Store(pBuffer, y);
+		y1 = TVector::Sub(y, TVector::template Sar<DCR_AMOUNT>(y));
 	}
-	*nDCRFlt_Y1l = y1l;
-	*nDCRFlt_X1l = x1l;
-	*nDCRFlt_Y1r = y1r;
-	*nDCRFlt_X1r = x1r;
+
+	*nDCRFlt_Y1l = TVector::Left(y1);
+	*nDCRFlt_X1l = TVector::Left(x1);
+	*nDCRFlt_Y1r = TVector::Right(y1);
+	*nDCRFlt_X1r = TVector::Right(x1);
 }
 
 
-static void X86_MonoDCRemoval(int *pBuffer, UINT nSamples, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l)
+static void MonoDCRemoval(int *pBuffer, UINT nSamples, LONG *nDCRFlt_Y1l, LONG *nDCRFlt_X1l)
 {
-	int y1l=*nDCRFlt_Y1l, x1l=*nDCRFlt_X1l;
-	_asm {
-	mov esi, pBuffer
-	mov ecx, nSamples
-	mov edx, x1l
-	mov edi, y1l
-stereodcr:
-	mov eax, [esi]
-	mov ebx, edx
-	add esi, 4
-	sub ebx, eax
-	mov edx, eax
-	mov eax, ebx
-	sar eax, DCR_AMOUNT+1
-	sub eax, ebx
-	add eax, edi
-	mov [esi-4], eax
-	mov ebx, eax
-	sar ebx, DCR_AMOUNT
-	sub eax, ebx
-	dec ecx
-	mov edi, eax
-	jnz stereodcr
-	mov x1l, edx
-	mov y1l, edi
+	int y1l = *nDCRFlt_Y1l, x1l = *nDCRFlt_X1l;
+	for(UINT i = 0; i < nSamples; i++)
+	{
+		const int x = pBuffer[i];
+		const int diff = x1l - x;
+		x1l = x;
+		const int y = (diff >> (DCR_AMOUNT + 1)) - diff + y1l;
+		pBuffer[i] = y;
+		y1l = y - (y >> DCR_AMOUNT);
 	}
 	*nDCRFlt_Y1l = y1l;
 	*nDCRFlt_X1l = x1l;
@@ -74,6 +74,8 @@ private:
 
 	LONG SurroundBuffer[SURROUNDBUFFERSIZE];
 
+	bool m_useSIMD;
+
 public:
 	CDSP();
 public:
@@ -82,7 +84,7 @@ public:
 	bool SetXBassParameters(UINT nDepth, UINT nRange);
 	// [Surround level 0(quiet)-100(heavy)] [delay in ms, usually 5-40ms]
 	bool SetSurroundParameters(UINT nDepth, UINT nDelay);
-	void Initialize(bool bReset, DWORD MixingFreq, DWORD DSPMask);
+	void Initialize(bool bReset, DWORD MixingFreq, DWORD DSPMask, bool useSIMD);
 	void Process(int * MixSoundBuffer, int * MixRearBuffer, int count, UINT nChannels, DWORD DSPMask);
 private:
 	void ProcessStereoSurround(int * MixSoundBuffer, int count);
@@ -2,7 +2,8 @@
  * EQ.cpp
  * ------
  * Purpose: Mixing code for equalizer.
- * Notes  : Ugh... This should really be removed at some point.
+ * Notes  : The bands are processed as a cascade of biquad filters, directly on the integer mix buffer.
+ *          Both channels of a stereo buffer are filtered in parallel using SSE2 / NEON intrinsics or plain C++.
  * Authors: Olivier Lapicque
  *          OpenMPT Devs
  * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
@@ -11,8 +12,12 @@
 
 #include "stdafx.h"
 #include "../soundlib/Sndfile.h"
-#include "../soundlib/MixerLoops.h"
 #include "../sounddsp/EQ.h"
+#if defined(ENABLE_SSE2_INTRINSICS)
+#include <emmintrin.h>
+#elif defined(ENABLE_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -48,361 +53,200 @@ static const EQBANDSTRUCT gEQDefaults[MAX_EQ_BANDS*2] =
 	{0,0,0,0,0, 0,0,0,0, 1, 10000, false},
 };
 
-#ifdef ENABLE_X86
-
-#pragma warning(disable:4100)
+// The stereo filter processes both channels at once, using two 32-bit float lanes.
+// A vector backend provides conversion of a stereo sampling point from / to the mix buffer format and basic float arithmetic.
 
-#define PBS_A0	DWORD PTR [eax]
-#define PBS_A1	DWORD PTR [eax+4]
-#define PBS_A2	DWORD PTR [eax+8]
-#define PBS_B1	DWORD PTR [eax+12]
-#define PBS_B2	DWORD PTR [eax+16]
-#define PBS_X1	DWORD PTR [eax+20]
-#define PBS_X2	DWORD PTR [eax+24]
-#define PBS_Y1	DWORD PTR [eax+28]
-#define PBS_Y2	DWORD PTR [eax+32]
-
-static void EQFilter(EQBANDSTRUCT *pbs, float32 *pbuffer, UINT nCount)
-//--------------------------------------------------------------------
+struct EQScalar
 {
-	_asm {
-	mov eax, pbs		// eax = pbs
-	mov edx, nCount		// edx = nCount
-	mov ecx, pbuffer	// ecx = pbuffer
-	fld		PBS_Y2		// ST(3)=y2
-	fld		PBS_Y1		// ST(2)=y1
-	fld		PBS_X2		// ST(1)=x2
-	fld		PBS_X1		// ST(0)=x1
-EQ_Loop:
-	fld		DWORD PTR [ecx]		// ST(0):x ST(1):x1 ST(2):x2 ST(3):y1 ST(4):y2
-	fld		PBS_A0				// ST(0):a0 ST(1):x ST(2):x1 ST(3):x2 ST(4):y1 ST(5):y2
-	fmul	ST(0), ST(1)		// ST(0):a0*x
-	fld		PBS_A1				// ST(0):a1 ST(1):a0*x ST(2):x ST(3):x1 ST(4):x2 ST(5):y1 ST(6):y2
-	fmul	ST(0), ST(3)		// ST(0):a1*x1
-	add		ecx, 4
-
-	faddp	ST(1), ST(0)
-	fld		PBS_A2
-	fmul	ST(0), ST(4)
-	faddp	ST(1), ST(0)
-	fld		PBS_B1
-	fmul	ST(0), ST(5)
-	faddp	ST(1), ST(0)
-	fld		PBS_B2
-	fmul	ST(0), ST(6)
-	sub     edx, 1
-	faddp	ST(1), ST(0)
-	fst		DWORD PTR [ecx-4]		// *pbuffer = a0*x+a1*x1+a2*x2+b1*y1+b2*y2
-	// Here, ST(0)=y ST(1)=x ST(2)=x1 ST(3)=x2 ST(4)=y1 ST(5)=y2
-	fxch	ST(4)	// y1=y
-	fstp	ST(5)	// y2=y1
-	// Here, ST(0)=x ST(1)=x1 ST(2)=x2 ST(3)=y1 ST(4)=y2
-	fxch	ST(1)	// x1=x
-	fstp	ST(2)	// x2=x1
-	jnz		EQ_Loop
-	// Store x1,y1,x2,y2 and pop FPU stack
-	fstp	PBS_X1
-	fstp	PBS_X2
-	fstp	PBS_Y1
-	fstp	PBS_Y2
-	}
-}
-
+	struct v32 { float32 l, r; };
+
+	static forceinline v32 Set(float32 l, float32 r) { v32 v = { l, r }; return v; }
+	static forceinline float32 Left(v32 a) { return a.l; }
+	static forceinline float32 Right(v32 a) { return a.r; }
+	static forceinline v32 LoadMix(const int32 *p, float32 scale) { return Set(p[0] * scale, p[1] * scale); }
+	static forceinline void StoreMix(int32 *p, v32 a, float32 scale) { p[0] = (int32)(a.l * scale); p[1] = (int32)(a.r * scale); }
+	static forceinline v32 Add(v32 a, v32 b) { return Set(a.l + b.l, a.r + b.r); }
+	static forceinline v32 Mul(v32 a, v32 b) { return Set(a.l * b.l, a.r * b.r); }
+};
 
-#ifdef ENABLE_X86_AMD
+#if defined(ENABLE_SSE2_INTRINSICS)
 
-static void AMD_StereoEQ(EQBANDSTRUCT *pbl, EQBANDSTRUCT *pbr, float32 *pbuffer, UINT nCount)
-//-------------------------------------------------------------------------------------------
+struct EQSIMD
 {
-	float tmp[16];
-
-	_asm {
-	mov eax, pbl
-	mov edx, pbr
-	mov ebx, pbuffer
-	mov ecx, nCount
-	lea edi, [tmp+8]
-	and edi, 0xfffffff8
-	movd mm7, [eax+EQBANDSTRUCT.a0]
-	movd mm0, [edx+EQBANDSTRUCT.a0]
-	movd mm6, [eax+EQBANDSTRUCT.a1]
-	movd mm1, [edx+EQBANDSTRUCT.a1]
-	punpckldq mm7, mm0
-	punpckldq mm6, mm1
-	movq [edi], mm7						// [edi] = a0
-	movq [edi+8], mm6					// [edi+8] = a1
-	movd mm5, [eax+EQBANDSTRUCT.a2]
-	movd mm0, [edx+EQBANDSTRUCT.a2]
-	movd mm4, [eax+EQBANDSTRUCT.b1]
-	movd mm1, [edx+EQBANDSTRUCT.b1]
-	movd mm3, [eax+EQBANDSTRUCT.b2]
-	movd mm2, [edx+EQBANDSTRUCT.b2]
-	punpckldq mm5, mm0
-	punpckldq mm4, mm1
-	punpckldq mm3, mm2
-	movq [edi+16], mm5					// [edi+16] = a2
-	movq [edi+24], mm4					// [edi+24] = b1
-	movq [edi+32], mm3					// [edi+32] = b2
-	movd mm4, [eax+EQBANDSTRUCT.x1]
-	movd mm0, [edx+EQBANDSTRUCT.x1]
-	movd mm5, [eax+EQBANDSTRUCT.x2]
-	movd mm1, [edx+EQBANDSTRUCT.x2]
-	punpckldq mm4, mm0					// mm4 = x1
-	punpckldq mm5, mm1					// mm5 = x2
-	movd mm6, [eax+EQBANDSTRUCT.y1]
-	movd mm2, [edx+EQBANDSTRUCT.y1]
-	movd mm7, [eax+EQBANDSTRUCT.y2]
-	movd mm3, [edx+EQBANDSTRUCT.y2]
-	punpckldq mm6, mm2					// mm6 = y1
-	punpckldq mm7, mm3					// mm7 = y2
-mainloop:
-	movq mm0, [ebx]
-	movq mm3, [edi+8]
-	add ebx, 8
-	movq mm1, [edi+16]
-	pfmul mm3, mm4						// x1 * a1
-	movq mm2, [edi+32]
-	pfmul mm1, mm5						// x2 * a2
-	movq mm5, mm4						// x2 = x1
-	pfmul mm2, mm7						// y2 * b2
-	movq mm7, mm6						// y2 = y1
-	pfmul mm6, [edi+24]					// y1 * b1
-	movq mm4, mm0						// x1 = x
-	pfmul mm0, [edi]					// x * a0
-	pfadd mm6, mm1						// x2*a2 + y1*b1
-	pfadd mm6, mm2						// x2*a2 + y1*b1 + y2*b2
-	pfadd mm6, mm3						// x1*a1 + x2*a2 + y1*b1 + y2*b2
-	pfadd mm6, mm0						// x*a0 + x1*a1 + x2*a2 + y1*b1 + y2*b2
-	dec ecx
-	movq [ebx-8], mm6
-	jnz mainloop
-	movd [eax+EQBANDSTRUCT.x1], mm4
-	punpckhdq mm4, mm4
-	movd [eax+EQBANDSTRUCT.x2], mm5
-	punpckhdq mm5, mm5
-	movd [eax+EQBANDSTRUCT.y1], mm6
-	punpckhdq mm6, mm6
-	movd [eax+EQBANDSTRUCT.y2], mm7
-	punpckhdq mm7, mm7
-	movd [edx+EQBANDSTRUCT.x1], mm4
-	movd [edx+EQBANDSTRUCT.x2], mm5
-	movd [edx+EQBANDSTRUCT.y1], mm6
-	movd [edx+EQBANDSTRUCT.y2], mm7
-	emms
-	}
-}
-
-#endif // ENABLE_X86_AMD
-
+	typedef __m128 v32;	// Only the lower two lanes are used
+
+	static forceinline v32 Set(float32 l, float32 r) { return _mm_setr_ps(l, r, 0.0f, 0.0f); }
+	static forceinline float32 Left(v32 a) { return _mm_cvtss_f32(a); }
+	static forceinline float32 Right(v32 a) { return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1))); }
+	static forceinline v32 LoadMix(const int32 *p, float32 scale) { return _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))), _mm_set1_ps(scale)); }
+	static forceinline void StoreMix(int32 *p, v32 a, float32 scale) { _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_cvttps_epi32(_mm_mul_ps(a, _mm_set1_ps(scale)))); }
+	static forceinline v32 Add(v32 a, v32 b) { return _mm_add_ps(a, b); }
+	static forceinline v32 Mul(v32 a, v32 b) { return _mm_mul_ps(a, b); }
+};
 
-#ifdef ENABLE_SSE
+#elif defined(ENABLE_NEON_INTRINSICS)
 
-static void SSE_StereoEQ(EQBANDSTRUCT *pbl, EQBANDSTRUCT *pbr, float32 *pbuffer, UINT nCount)
-//-------------------------------------------------------------------------------------------
+struct EQSIMD
 {
-	static const float gk1 = 1.0f;
-	_asm {
-	mov eax, pbl
-	mov edx, pbr
-	mov ebx, pbuffer
-	mov ecx, nCount
-	movss xmm0, [eax+EQBANDSTRUCT.Gain]
-	movss xmm1, gk1
-	comiss xmm0, xmm1
-	jne doeq
-	movss xmm0, [edx+EQBANDSTRUCT.Gain]
-	comiss xmm0, xmm1
-	je done
-doeq:
-	test ecx, ecx
-	jz done
-	movss xmm6, [eax+EQBANDSTRUCT.a1]
-	movss xmm7, [eax+EQBANDSTRUCT.a2]
-	movss xmm4, [eax+EQBANDSTRUCT.x1]
-	movss xmm5, [eax+EQBANDSTRUCT.x2]
-	movlhps xmm6, xmm7		// xmm6 = [  0 | a2 |  0 | a1 ]
-	movlhps xmm4, xmm5		// xmm4 = [  0 | x2 |  0 | x1 ]
-	movss xmm2, [edx+EQBANDSTRUCT.a1]
-	movss xmm3, [edx+EQBANDSTRUCT.a2]
-	movss xmm0, [edx+EQBANDSTRUCT.x1]
-	movss xmm1, [edx+EQBANDSTRUCT.x2]
-	movlhps xmm2, xmm3		// xmm2 = [ 0 | a'2 | 0 | a'1 ]
-	movlhps xmm0, xmm1		// xmm0 = [ 0 | x'2 | 0 | x'1 ]
-	shufps xmm6, xmm2, 0x88	// xmm6 = [ a'2 | a'1 | a2 | a1 ]
-	shufps xmm4, xmm0, 0x88 // xmm4 = [ x'2 | x'1 | x2 | x1 ]
-	shufps xmm6, xmm6, 0xD8	// xmm6 = [ a'2 | a2 | a'1 | a1 ]
-	shufps xmm4, xmm4, 0xD8	// xmm4 = [ x'2 | x2 | x'1 | x1 ]
-	movss xmm7, [eax+EQBANDSTRUCT.b1]
-	movss xmm0, [eax+EQBANDSTRUCT.b2]
-	movss xmm2, [edx+EQBANDSTRUCT.b1]
-	movss xmm1, [edx+EQBANDSTRUCT.b2]
-	movlhps xmm7, xmm0		// xmm7 = [ 0 |  b2 | 0 |  b1 ]
-	movlhps xmm2, xmm1		// xmm2 = [  0 | b'2 |  0 | b'1 ]
-	shufps xmm7, xmm2, 0x88	// xmm7 = [ b'2 | b'1 | b2 | b1 ]
-	shufps xmm7, xmm7, 0xD8 // xmm7 = [ b'2 | b2 | b'1 | b1 ]
-	movss xmm5, [eax+EQBANDSTRUCT.y1]
-	movss xmm1, [eax+EQBANDSTRUCT.y2]
-	movss xmm3, [edx+EQBANDSTRUCT.y1]
-	movss xmm0, [edx+EQBANDSTRUCT.y2]
-	movlhps xmm5, xmm1		// xmm5 = [  0 |  y2 |  0 |  y1 ]
-	movlhps xmm3, xmm0		// xmm3 = [  0 | y'2 |  0 | y'1 ]
-	shufps xmm5, xmm3, 0x88 // xmm5 = [ y'2 | y'1 | y2 | y1 ]
-	shufps xmm5, xmm5, 0xD8 // xmm5 = [ y'2 |  y2 | y'1 |  y1 ]
-	movss xmm3, [eax+EQBANDSTRUCT.a0]
-	movss xmm2, [edx+EQBANDSTRUCT.a0]
-	shufps xmm3, xmm2, 0x88
-	shufps xmm3, xmm3, 0xD8	// xmm3 = [  0 |  0 | a'0 | a0 ]
-mainloop:
-	movlps xmm0, qword ptr [ebx]
-	add ebx, 8
-	movaps xmm1, xmm5		// xmm1 = [ y2r | y2l | y1r | y1l ]
-	mulps xmm1, xmm7		// xmm1 = [b2r*y2r|b2l*y2l|b1r*y1r|b1l*y1l]
-	movaps xmm2, xmm4		// xmm2 = [ x2r | x2l | x1r | x1l ]
-	mulps xmm2, xmm6		// xmm6 = [a2r*x2r|a2l*x2l|a1r*x1r|a1l*x1l]
-	shufps xmm4, xmm0, 0x44 // xmm4 = [  xr |  xl | x1r | x1l ]
-	mulps xmm0, xmm3		// xmm0 = [   0 |   0 |a0r*xr|a0l*xl]
-	shufps xmm4, xmm4, 0x4E // xmm4 = [ x1r | x1l |  xr |  xl ]
-	addps xmm1, xmm2		// xmm1 = [b2r*y2r+a2r*x2r|b2l*y2l+a2l*x2l|b1r*y1r+a1r*x1r|b1l*y1l+a1l*x1l]
-	addps xmm1, xmm0		// xmm1 = [b2r*y2r+a2r*x2r|b2l*y2l+a2l*x2l|b1r*y1r+a1r*x1r+a0r*xr|b1l*y1l+a1l*x1l+a0l*xl]
-	sub ecx, 1
-	movhlps xmm0, xmm1
-	addps xmm0, xmm1		// xmm0 = [  ? |  ? | yr(n) | yl(n) ]
-	movlps [ebx-8], xmm0
-	shufps xmm0, xmm5, 0x44
-	movaps xmm5, xmm0
-	jnz mainloop
-	movhlps xmm0, xmm4
-	movhlps xmm1, xmm5
-	movss [eax+EQBANDSTRUCT.x1], xmm4
-	movss [eax+EQBANDSTRUCT.x2], xmm0
-	movss [eax+EQBANDSTRUCT.y1], xmm5
-	movss [eax+EQBANDSTRUCT.y2], xmm1
-	shufps xmm4, xmm4, 0x01
-	shufps xmm0, xmm0, 0x01
-	shufps xmm5, xmm5, 0x01
-	shufps xmm1, xmm1, 0x01
-	movss [edx+EQBANDSTRUCT.x1], xmm4
-	movss [edx+EQBANDSTRUCT.x2], xmm0
-	movss [edx+EQBANDSTRUCT.y1], xmm5
-	movss [edx+EQBANDSTRUCT.y2], xmm1
-done:;
-	}
-}
-
-#endif // ENABLE_SSE
+	typedef float32x2_t v32;
+
+	static forceinline v32 Set(float32 l, float32 r) { return vset_lane_f32(r, vdup_n_f32(l), 1); }
+	static forceinline float32 Left(v32 a) { return vget_lane_f32(a, 0); }
+	static forceinline float32 Right(v32 a) { return vget_lane_f32(a, 1); }
+	static forceinline v32 LoadMix(const int32 *p, float32 scale) { return vmul_n_f32(vcvt_f32_s32(vld1_s32(p)), scale); }
+	static forceinline void StoreMix(int32 *p, v32 a, float32 scale) { vst1_s32(p, vcvt_s32_f32(vmul_n_f32(a, scale))); }
+	static forceinline v32 Add(v32 a, v32 b) { return vadd_f32(a, b); }
+	static forceinline v32 Mul(v32 a, v32 b) { return vmul_f32(a, b); }
+};
 
-#pragma warning(default:4100)
+#endif
 
-#else
 
-static void EQFilter(EQBANDSTRUCT *pbs, float32 *pbuffer, UINT nCount)
-//--------------------------------------------------------------------
+// Run the stereo mix buffer through all active bands. Each sampling point passes through the whole cascade before the next one is read,
+// so the buffer only has to be converted from and to float once.
+template<typename TVector>
+static void StereoEQ(EQBANDSTRUCT *pbl, EQBANDSTRUCT *pbr, const UINT *bands, UINT numBands, int32 *pbuffer, UINT nCount)
+//----------------------------------------------------------------------------------------------------------------------
 {
-	for (UINT i=0; i<nCount; i++)
+	typedef typename TVector::v32 v32;
+
+	v32 a0[MAX_EQ_BANDS], a1[MAX_EQ_BANDS], a2[MAX_EQ_BANDS], b1[MAX_EQ_BANDS], b2[MAX_EQ_BANDS];
+	v32 x1[MAX_EQ_BANDS], x2[MAX_EQ_BANDS], y1[MAX_EQ_BANDS], y2[MAX_EQ_BANDS];
+	for(UINT i = 0; i < numBands; i++)
 	{
-		float32 x = pbuffer[i];
-		float32 y = pbs->a1 * pbs->x1 + pbs->a2 * pbs->x2 + pbs->a0 * x + pbs->b1 * pbs->y1 + pbs->b2 * pbs->y2;
-		pbs->x2 = pbs->x1;
-		pbs->y2 = pbs->y1;
-		pbs->x1 = x;
-		pbuffer[i] = y;
-		pbs->y1 = y;
+		const EQBANDSTRUCT &l = pbl[bands[i]], &r = pbr[bands[i]];
+		a0[i] = TVector::Set(l.a0, r.a0);
+		a1[i] = TVector::Set(l.a1, r.a1);
+		a2[i] = TVector::Set(l.a2, r.a2);
+		b1[i] = TVector::Set(l.b1, r.b1);
+		b2[i] = TVector::Set(l.b2, r.b2);
+		x1[i] = TVector::Set(l.x1, r.x1);
+		x2[i] = TVector::Set(l.x2, r.x2);
+		y1[i] = TVector::Set(l.y1, r.y1);
+		y2[i] = TVector::Set(l.y2, r.y2);
 	}
-}
-
-#endif
 
+	for(UINT n = 0; n < nCount; n++, pbuffer += 2)
+	{
+		v32 x = TVector::LoadMix(pbuffer, 1.0f / MIXING_SCALEF);
+		for(UINT i = 0; i < numBands; i++)
+		{
+			// y = a1 * x1 + a2 * x2 + a0 * x + b1 * y1 + b2 * y2
+			v32 y = TVector::Add(TVector::Mul(a1[i], x1[i]), TVector::Mul(a2[i], x2[i]));
+			y = TVector::Add(y, TVector::Mul(a0[i], x));
+			y = TVector::Add(y, TVector::Mul(b1[i], y1[i]));
+			y = TVector::Add(y, TVector::Mul(b2[i], y2[i]));
+			x2[i] = x1[i];
+			y2[i] = y1[i];
+			x1[i] = x;
+			y1[i] = y;
+			x = y;
+		}
+		TVector::StoreMix(pbuffer, x, MIXING_SCALEF);
+	}
 
-void CEQ::ProcessMono(int *pbuffer, float *MixFloatBuffer, UINT nCount)
-//---------------------------------------------------------------------
-{
-	MonoMixToFloat(pbuffer, MixFloatBuffer, nCount, 1.0f/MIXING_SCALEF);
-	for (UINT b=0; b<MAX_EQ_BANDS; b++)
+	for(UINT i = 0; i < numBands; i++)
 	{
-		if ((gEQ[b].bEnable) && (gEQ[b].Gain != 1.0f)) EQFilter(&gEQ[b], MixFloatBuffer, nCount);
+		EQBANDSTRUCT &l = pbl[bands[i]], &r = pbr[bands[i]];
+		l.x1 = TVector::Left(x1[i]); r.x1 = TVector::Right(x1[i]);
+		l.x2 = TVector::Left(x2[i]); r.x2 = TVector::Right(x2[i]);
+		l.y1 = TVector::Left(y1[i]); r.y1 = TVector::Right(y1[i]);
+		l.y2 = TVector::Left(y2[i]); r.y2 = TVector::Right(y2[i]);
 	}
-	FloatToMonoMix(MixFloatBuffer, pbuffer, nCount, MIXING_SCALEF);
 }
 
 
-void CEQ::ProcessStereo(int *pbuffer, float *MixFloatBuffer, UINT nCount)
-//-----------------------------------------------------------------------
+static void MonoEQ(EQBANDSTRUCT *pbs, const UINT *bands, UINT numBands, int32 *pbuffer, UINT nCount)
+//--------------------------------------------------------------------------------------------------
 {
-
-#ifdef ENABLE_SSE
-
-	if(GetProcSupport() & PROCSUPPORT_SSE)
+	for(UINT n = 0; n < nCount; n++)
 	{
-		int sse_state, sse_eqstate;
-		MonoMixToFloat(pbuffer, MixFloatBuffer, nCount*2, 1.0f/MIXING_SCALEF);
-
-		_asm stmxcsr sse_state;
-		sse_eqstate = sse_state | 0xFF80; // set flush-to-zero, denormals-are-zero, round-to-zero, mask all exception, leave flags alone
-		_asm ldmxcsr sse_eqstate;
-		for (UINT b=0; b<MAX_EQ_BANDS; b++)
+		float32 x = pbuffer[n] * (1.0f / MIXING_SCALEF);
+		for(UINT i = 0; i < numBands; i++)
 		{
-			if ((gEQ[b].bEnable) || (gEQ[b+MAX_EQ_BANDS].bEnable))
-				SSE_StereoEQ(&gEQ[b], &gEQ[b+MAX_EQ_BANDS], MixFloatBuffer, nCount);
+			EQBANDSTRUCT &b = pbs[bands[i]];
+			float32 y = b.a1 * b.x1 + b.a2 * b.x2 + b.a0 * x + b.b1 * b.y1 + b.b2 * b.y2;
+			b.x2 = b.x1;
+			b.y2 = b.y1;
+			b.x1 = x;
+			b.y1 = y;
+			x = y;
 		}
-		_asm ldmxcsr sse_state;
-
-		FloatToMonoMix(MixFloatBuffer, pbuffer, nCount*2, MIXING_SCALEF);
-
-	} else
+		pbuffer[n] = (int32)(x * MIXING_SCALEF);
+	}
+}
 
-#endif // ENABLE_SSE
 
-#ifdef ENABLE_X86_AMD
+#if defined(ENABLE_SSE2_INTRINSICS)
+// Denormal filter states would slow down processing a lot when the input becomes silent.
+// This applies to the scalar code as well, so that both behave the same for very quiet input.
+#define EQ_BEGIN_FLUSH_DENORMALS() \
+	const bool flushDenormals = HasSIMDIntrinsicsSupport(); \
+	const unsigned int oldCSR = flushDenormals ? _mm_getcsr() : 0; \
+	if(flushDenormals) _mm_setcsr(oldCSR | 0x8040)	/* flush-to-zero, denormals-are-zero */
+#define EQ_END_FLUSH_DENORMALS() \
+	if(flushDenormals) _mm_setcsr(oldCSR)
+#else
+#define EQ_BEGIN_FLUSH_DENORMALS()
+#define EQ_END_FLUSH_DENORMALS()
+#endif
 
-	if(GetProcSupport() & PROCSUPPORT_AMD_3DNOW)
-	{ 
-		MonoMixToFloat(pbuffer, MixFloatBuffer, nCount*2, 1.0f/MIXING_SCALEF);
 
-		for (UINT b=0; b<MAX_EQ_BANDS; b++)
-		{
-			if (((gEQ[b].bEnable) && (gEQ[b].Gain != 1.0f))
-			 || ((gEQ[b+MAX_EQ_BANDS].bEnable) && (gEQ[b+MAX_EQ_BANDS].Gain != 1.0f)))
-				AMD_StereoEQ(&gEQ[b], &gEQ[b+MAX_EQ_BANDS], MixFloatBuffer, nCount);
-		}
+void CEQ::ProcessMono(int *pbuffer, UINT nCount)
+//----------------------------------------------
+{
+	UINT bands[MAX_EQ_BANDS];
+	UINT numBands = 0;
+	for(UINT b = 0; b < MAX_EQ_BANDS; b++)
+	{
+		if((gEQ[b].bEnable) && (gEQ[b].Gain != 1.0f)) bands[numBands++] = b;
+	}
+	if(!numBands || !nCount) return;
 
-		FloatToMonoMix(MixFloatBuffer, pbuffer, nCount*2, MIXING_SCALEF);
-		
-	} else
-#endif // ENABLE_X86_AMD
+	EQ_BEGIN_FLUSH_DENORMALS();
+	MonoEQ(gEQ, bands, numBands, pbuffer, nCount);
+	EQ_END_FLUSH_DENORMALS();
+}
 
-	{	
 
-		StereoMixToFloat(pbuffer, MixFloatBuffer, MixFloatBuffer+MIXBUFFERSIZE, nCount, 1.0f/MIXING_SCALEF);
-		
-		for (UINT bl=0; bl<MAX_EQ_BANDS; bl++)
-		{
-			if ((gEQ[bl].bEnable) && (gEQ[bl].Gain != 1.0f)) EQFilter(&gEQ[bl], MixFloatBuffer, nCount);
-		}
-		for (UINT br=MAX_EQ_BANDS; br<MAX_EQ_BANDS*2; br++)
+void CEQ::ProcessStereo(int *pbuffer, UINT nCount)
+//------------------------------------------------
+{
+	UINT bands[MAX_EQ_BANDS];
+	UINT numBands = 0;
+	for(UINT b = 0; b < MAX_EQ_BANDS; b++)
+	{
+		if(((gEQ[b].bEnable) && (gEQ[b].Gain != 1.0f))
+			|| ((gEQ[b + MAX_EQ_BANDS].bEnable) && (gEQ[b + MAX_EQ_BANDS].Gain != 1.0f)))
 		{
-			if ((gEQ[br].bEnable) && (gEQ[br].Gain != 1.0f)) EQFilter(&gEQ[br], MixFloatBuffer+MIXBUFFERSIZE, nCount);
+			bands[numBands++] = b;
 		}
-
-		FloatToStereoMix(MixFloatBuffer, MixFloatBuffer+MIXBUFFERSIZE, pbuffer, nCount, MIXING_SCALEF);
-
 	}
+	if(!numBands || !nCount) return;
+
+	EQ_BEGIN_FLUSH_DENORMALS();
+#ifdef ENABLE_SIMD_INTRINSICS
+	if(m_useSIMD && HasSIMDIntrinsicsSupport())
+		StereoEQ<EQSIMD>(gEQ, gEQ + MAX_EQ_BANDS, bands, numBands, pbuffer, nCount);
+	else
+#endif // ENABLE_SIMD_INTRINSICS
+		StereoEQ<EQScalar>(gEQ, gEQ + MAX_EQ_BANDS, bands, numBands, pbuffer, nCount);
+	EQ_END_FLUSH_DENORMALS();
 }
 
 
 CEQ::CEQ()
 //--------
+	: m_useSIMD(true)
 {
-	#if defined(ENABLE_SSE) || defined(ENABLE_X86_AMD)
-		ALWAYS_ASSERT(((uintptr_t)&(gEQ[0])) % 4 == 0);
-		ALWAYS_ASSERT(((uintptr_t)&(gEQ[1])) % 4 == 0);
-	#endif // ENABLE_SSE || ENABLE_X86_AMD
 	memcpy(gEQ, gEQDefaults, sizeof(gEQ));
 }
 
 
-void CEQ::Initialize(bool bReset, DWORD MixingFreq)
-//-------------------------------------------------
+void CEQ::Initialize(bool bReset, DWORD MixingFreq, bool useSIMD)
+//---------------------------------------------------------------
 {
+	m_useSIMD = useSIMD;
 	float32 fMixingFreq = (float32)MixingFreq;
 	// Gain = 0.5 (-6dB) .. 2 (+6dB)
 	for (UINT band=0; band<MAX_EQ_BANDS*2; band++) if (gEQ[band].bEnable)
@@ -512,15 +356,15 @@ void CEQ::SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool b
 			gEQ[i+MAX_EQ_BANDS].bEnable = false;
 		}
 	}
-	Initialize(bReset, MixingFreq);
+	Initialize(bReset, MixingFreq, m_useSIMD);
 }
 
 
-void CQuadEQ::Initialize(bool bReset, DWORD MixingFreq)
-//-----------------------------------------------------
+void CQuadEQ::Initialize(bool bReset, DWORD MixingFreq, bool useSIMD)
+//-------------------------------------------------------------------
 {
-	front.Initialize(bReset, MixingFreq);
-	rear.Initialize(bReset, MixingFreq);
+	front.Initialize(bReset, MixingFreq, useSIMD);
+	rear.Initialize(bReset, MixingFreq, useSIMD);
 }
 
 void CQuadEQ::SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool bReset, DWORD MixingFreq)
@@ -535,14 +379,14 @@ void CQuadEQ::Process(int *frontBuffer, int *rearBuffer, UINT nCount, UINT nChan
 {
 	if(nChannels == 1)
 	{
-		front.ProcessMono(frontBuffer, EQTempFloatBuffer, nCount);
+		front.ProcessMono(frontBuffer, nCount);
 	} else if(nChannels == 2)
 	{
-		front.ProcessStereo(frontBuffer, EQTempFloatBuffer, nCount);
+		front.ProcessStereo(frontBuffer, nCount);
 	} else if(nChannels == 4)
 	{
-		front.ProcessStereo(frontBuffer, EQTempFloatBuffer, nCount);
-		rear.ProcessStereo(rearBuffer, EQTempFloatBuffer, nCount);
+		front.ProcessStereo(frontBuffer, nCount);
+		rear.ProcessStereo(rearBuffer, nCount);
 	}
 }
 
@@ -2,7 +2,8 @@
  * EQ.h
  * ----
  * Purpose: Mixing code for equalizer.
- * Notes  : Ugh... This should really be removed at some point.
+ * Notes  : The bands are processed as a cascade of biquad filters, directly on the integer mix buffer.
+ *          Both channels of a stereo buffer are filtered in parallel using SSE2 / NEON intrinsics or plain C++.
  * Authors: Olivier Lapicque
  *          OpenMPT Devs
  * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
@@ -11,8 +12,6 @@
 
 #pragma once
 
-#include "../soundlib/Mixer.h"	// For MIXBUFFERSIZE
-
 OPENMPT_NAMESPACE_BEGIN
 
 #define MAX_EQ_BANDS	6
@@ -38,13 +37,15 @@ class CEQ
 //=======
 {
 private:
-	EQBANDSTRUCT gEQ[MAX_EQ_BANDS*2];
+	EQBANDSTRUCT gEQ[MAX_EQ_BANDS*2];	// Left / mono channel bands, followed by right channel bands
+	bool m_useSIMD;
 public:
 	CEQ();
 public:
-	void Initialize(bool bReset, DWORD MixingFreq);
-	void ProcessStereo(int *pbuffer, float *MixFloatBuffer, UINT nCount);
-	void ProcessMono(int *pbuffer, float *MixFloatBuffer, UINT nCount);
+	void Initialize(bool bReset, DWORD MixingFreq, bool useSIMD);
+	// Filter the mix buffer in place
+	void ProcessStereo(int *pbuffer, UINT nCount);
+	void ProcessMono(int *pbuffer, UINT nCount);
 	void SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool bReset, DWORD MixingFreq);
 };
 
@@ -56,9 +57,8 @@ class CQuadEQ
 private:
 	CEQ front;
 	CEQ rear;
-	float EQTempFloatBuffer[MIXBUFFERSIZE * 2];
 public:
-	void Initialize(bool bReset, DWORD MixingFreq);
+	void Initialize(bool bReset, DWORD MixingFreq, bool useSIMD);
 	void Process(int *frontBuffer, int *rearBuffer, UINT nCount, UINT nChannels);
 	void SetEQGains(const UINT *pGains, UINT nGains, const UINT *pFreqs, bool bReset, DWORD MixingFreq);
 };
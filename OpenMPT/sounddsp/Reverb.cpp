@@ -3,6 +3,9 @@
  * ----------
  * Purpose: Mixing code for reverb.
  * Notes  : Ugh... This should really be removed at some point.
+ *          The processing stages were originally written in MMX assembly. They are now written
+ *          in terms of a few 64-bit vector operations with the exact same semantics, which are
+ *          implemented using SSE2 / NEON intrinsics or plain C++ (see ReverbScalar below).
  * Authors: Olivier Lapicque
  *          OpenMPT Devs
  * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
@@ -12,6 +15,14 @@
 #include "stdafx.h"
 #include "../soundlib/Sndfile.h"
 #include "Reverb.h"
+#include "../soundlib/MixerLoops.h"
+#include <cmath>
+#include <cstring>
+#if defined(ENABLE_SSE2_INTRINSICS)
+#include <emmintrin.h>
+#elif defined(ENABLE_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -19,10 +30,9 @@ OPENMPT_NAMESPACE_BEGIN
 
 #ifndef NO_REVERB
 
-#pragma warning(disable:4725)	// Pentium fdiv bug
-#pragma warning(disable:4731)	// ebp modified
-
-extern void StereoFill(int *pBuffer, uint32 nSamples, mixsample_t &lpROfs, mixsample_t &lpLOfs);
+#ifndef M_PI
+#define M_PI 3.1415926535897932385
+#endif
 
 
 
@@ -41,12 +51,17 @@ CReverb::CReverb()
 	// Shared reverb state
 
 #ifndef NO_REVERB
-	MemsetZero(MixReverbBuffer);
+	MixReverbBuffer.Resize(MIXBUFFERSIZE * 2);
+#ifndef MPT_INTMIXER
+	MixReverbSendBuffer.Resize(MIXBUFFERSIZE * 2);
+	MixReverbWetBuffer.Resize(MIXBUFFERSIZE * 2);
+#endif // !MPT_INTMIXER
 #endif
 	gnRvbROfsVol = 0;
 	gnRvbLOfsVol = 0;
 
 	gnReverbSend = 0;
+	m_currentReverbType = NUM_REVERBTYPES;
 
 	gnReverbSamples = 0;
 	gnReverbDecaySamples = 0;
@@ -60,8 +75,9 @@ CReverb::CReverb()
 	g_nLastRvbIn_yr = 0;
 	g_nLastRvbOut_xl = 0;
 	g_nLastRvbOut_xr = 0;
-	gnDCRRvb_Y1 = 0;
-	gnDCRRvb_X1 = 0;
+	MemsetZero(gnDCRRvb_Y1);
+	MemsetZero(gnDCRRvb_X1);
+	m_useSIMD = true;
 
 	// Reverb mix buffers
 	MemsetZero(g_RefDelay);
@@ -268,8 +284,8 @@ void CReverb::Shutdown()
 	g_nLastRvbIn_xl = g_nLastRvbIn_xr = 0;
 	g_nLastRvbIn_yl = g_nLastRvbIn_yr = 0;
 	g_nLastRvbOut_xl = g_nLastRvbOut_xr = 0;
-	gnDCRRvb_X1 = 0;
-	gnDCRRvb_Y1 = 0;
+	MemsetZero(gnDCRRvb_X1);
+	MemsetZero(gnDCRRvb_Y1);
 
 	// Zero internal buffers
 	MemsetZero(g_LateReverb.Diffusion1);
@@ -282,21 +298,29 @@ void CReverb::Shutdown()
 }
 
 
-void CReverb::Initialize(bool bReset, uint32 MixingFreq)
-//------------------------------------------------------
+void CReverb::Initialize(bool bReset, uint32 MixingFreq, bool useSIMD, uint32 mixBufferSize)
+//-----------------------------------------------------------------------------------------
 {
+	m_useSIMD = useSIMD;
+	if(MixReverbBuffer.size() != mixBufferSize * 2)
+	{
+		MixReverbBuffer.Resize(mixBufferSize * 2);
+#ifndef MPT_INTMIXER
+		MixReverbSendBuffer.Resize(mixBufferSize * 2);
+		MixReverbWetBuffer.Resize(mixBufferSize * 2);
+#endif // !MPT_INTMIXER
+	}
 	if (m_Settings.m_nReverbType >= NUM_REVERBTYPES) m_Settings.m_nReverbType = 0;
-	static PSNDMIX_REVERB_PROPERTIES spCurrentPreset = NULL;
 	PSNDMIX_REVERB_PROPERTIES pRvbPreset = &gRvbPresets[m_Settings.m_nReverbType].Preset;
 
-	if ((pRvbPreset != spCurrentPreset) || (bReset))
+	if ((m_Settings.m_nReverbType != m_currentReverbType) || (bReset))
 	{
 		// Reverb output frequency is half of the dry output rate
 		float flOutputFrequency = (float)MixingFreq;
 		ENVIRONMENTREVERB rvb;
 
 		// Reset reverb parameters
-		spCurrentPreset = pRvbPreset;
+		m_currentReverbType = m_Settings.m_nReverbType;
 		I3dl2_to_Generic(pRvbPreset, &rvb, flOutputFrequency,
 							RVBMINREFDELAY, RVBMAXREFDELAY,
 							RVBMINRVBDELAY, RVBMAXRVBDELAY,
@@ -408,31 +432,197 @@ bool CReverb::SetReverbParameters(uint32 nDepth, uint32 nType)
 }
 
 
-int *CReverb::GetReverbSendBuffer(uint32 nSamples)
-//------------------------------------------------
+mixsample_t *CReverb::GetReverbSendBuffer(uint32 nSamples)
+//--------------------------------------------------------
 {
+#ifdef MPT_INTMIXER
+	mixsample_t *sendBuffer = MixReverbBuffer;
+#else
+	mixsample_t *sendBuffer = MixReverbSendBuffer;
+#endif // MPT_INTMIXER
 	if(!gnReverbSend)
 	{ // and we did not clear the buffer yet, do it now because we will get new data
-		StereoFill(MixReverbBuffer, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
+		StereoFill(sendBuffer, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
 	}
 	gnReverbSend = 1; // we will have to process reverb
-	return MixReverbBuffer;
+	return sendBuffer;
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Vector operations used by the reverb processing stages.
+// All of them behave exactly like the MMX instructions the reverb was originally written with
+// (the instruction names are given in the comments), so all implementations produce identical output.
+// v16 holds four int16 values, v32 holds two int32 values.
+//
+
+struct ReverbScalar
+{
+	struct v16 { int16 x[4]; };
+	struct v32 { int32 x[2]; };
+
+	// movd
+	static forceinline v16 Load16x2(const int16 *p) { v16 r = {{ p[0], p[1], 0, 0 }}; return r; }
+	static forceinline void Store16x2(int16 *p, const v16 &a) { p[0] = a.x[0]; p[1] = a.x[1]; }
+	// movq
+	static forceinline v16 Load16x4(const int16 *p) { v16 r = {{ p[0], p[1], p[2], p[3] }}; return r; }
+	static forceinline void Store16x4(int16 *p, const v16 &a) { p[0] = a.x[0]; p[1] = a.x[1]; p[2] = a.x[2]; p[3] = a.x[3]; }
+	static forceinline v32 Load32x2(const int32 *p) { v32 r = {{ p[0], p[1] }}; return r; }
+	static forceinline void Store32x2(int32 *p, const v32 &a) { p[0] = a.x[0]; p[1] = a.x[1]; }
+	// punpckldq
+	static forceinline v16 UnpackLo32(const v16 &a, const v16 &b) { v16 r = {{ a.x[0], a.x[1], b.x[0], b.x[1] }}; return r; }
+	// punpcklwd
+	static forceinline v16 UnpackLo16(const v16 &a, const v16 &b) { v16 r = {{ a.x[0], b.x[0], a.x[1], b.x[1] }}; return r; }
+	// paddsw
+	static forceinline v16 AddSat(const v16 &a, const v16 &b)
+	{
+		v16 r;
+		for(int i = 0; i < 4; i++) r.x[i] = mpt::saturate_cast<int16>(a.x[i] + b.x[i]);
+		return r;
+	}
+	// psubsw
+	static forceinline v16 SubSat(const v16 &a, const v16 &b)
+	{
+		v16 r;
+		for(int i = 0; i < 4; i++) r.x[i] = mpt::saturate_cast<int16>(a.x[i] - b.x[i]);
+		return r;
+	}
+	// pmulhw
+	static forceinline v16 MulHi(const v16 &a, const v16 &b)
+	{
+		v16 r;
+		for(int i = 0; i < 4; i++) r.x[i] = static_cast<int16>((a.x[i] * b.x[i]) >> 16);
+		return r;
+	}
+	// psraw
+	template<int shift>
+	static forceinline v16 Sar16(const v16 &a)
+	{
+		v16 r;
+		for(int i = 0; i < 4; i++) r.x[i] = static_cast<int16>(a.x[i] >> shift);
+		return r;
+	}
+	// pmaddwd (wraps around if all inputs are -32768)
+	static forceinline v32 MulAdd(const v16 &a, const v16 &b)
+	{
+		v32 r;
+		for(int i = 0; i < 2; i++) r.x[i] = static_cast<int32>(static_cast<uint32>(a.x[i * 2] * b.x[i * 2]) + static_cast<uint32>(a.x[i * 2 + 1] * b.x[i * 2 + 1]));
+		return r;
+	}
+	// packssdw a, a
+	static forceinline v16 PackSat(const v32 &a)
+	{
+		const int16 x0 = mpt::saturate_cast<int16>(a.x[0]), x1 = mpt::saturate_cast<int16>(a.x[1]);
+		v16 r = {{ x0, x1, x0, x1 }};
+		return r;
+	}
+	// paddd
+	static forceinline v32 Add32(const v32 &a, const v32 &b)
+	{
+		v32 r = {{ static_cast<int32>(static_cast<uint32>(a.x[0]) + static_cast<uint32>(b.x[0])), static_cast<int32>(static_cast<uint32>(a.x[1]) + static_cast<uint32>(b.x[1])) }};
+		return r;
+	}
+	// psubd
+	static forceinline v32 Sub32(const v32 &a, const v32 &b)
+	{
+		v32 r = {{ static_cast<int32>(static_cast<uint32>(a.x[0]) - static_cast<uint32>(b.x[0])), static_cast<int32>(static_cast<uint32>(a.x[1]) - static_cast<uint32>(b.x[1])) }};
+		return r;
+	}
+	// psrad
+	template<int shift>
+	static forceinline v32 Sar32(const v32 &a)
+	{
+		v32 r = {{ a.x[0] >> shift, a.x[1] >> shift }};
+		return r;
+	}
+};
+
+
+#if defined(ENABLE_SSE2_INTRINSICS)
+
+// Only the lower 64 bits of each register are used.
+struct ReverbSIMD
+{
+	typedef __m128i v16;
+	typedef __m128i v32;
+
+	static forceinline v16 Load16x2(const int16 *p) { int32 x; std::memcpy(&x, p, sizeof(x)); return _mm_cvtsi32_si128(x); }
+	static forceinline void Store16x2(int16 *p, v16 a) { const int32 x = _mm_cvtsi128_si32(a); std::memcpy(p, &x, sizeof(x)); }
+	static forceinline v16 Load16x4(const int16 *p) { return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)); }
+	static forceinline void Store16x4(int16 *p, v16 a) { _mm_storel_epi64(reinterpret_cast<__m128i *>(p), a); }
+	static forceinline v32 Load32x2(const int32 *p) { return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)); }
+	static forceinline void Store32x2(int32 *p, v32 a) { _mm_storel_epi64(reinterpret_cast<__m128i *>(p), a); }
+	static forceinline v16 UnpackLo32(v16 a, v16 b) { return _mm_unpacklo_epi32(a, b); }
+	static forceinline v16 UnpackLo16(v16 a, v16 b) { return _mm_unpacklo_epi16(a, b); }
+	static forceinline v16 AddSat(v16 a, v16 b) { return _mm_adds_epi16(a, b); }
+	static forceinline v16 SubSat(v16 a, v16 b) { return _mm_subs_epi16(a, b); }
+	static forceinline v16 MulHi(v16 a, v16 b) { return _mm_mulhi_epi16(a, b); }
+	template<int shift>
+	static forceinline v16 Sar16(v16 a) { return _mm_srai_epi16(a, shift); }
+	static forceinline v32 MulAdd(v16 a, v16 b) { return _mm_madd_epi16(a, b); }
+	// Duplicate the two lower int32 values first, so that the lower 64 bits of the result are the same as with MMX.
+	static forceinline v16 PackSat(v32 a) { return _mm_packs_epi32(_mm_unpacklo_epi64(a, a), a); }
+	static forceinline v32 Add32(v32 a, v32 b) { return _mm_add_epi32(a, b); }
+	static forceinline v32 Sub32(v32 a, v32 b) { return _mm_sub_epi32(a, b); }
+	template<int shift>
+	static forceinline v32 Sar32(v32 a) { return _mm_srai_epi32(a, shift); }
+};
+
+#elif defined(ENABLE_NEON_INTRINSICS)
+
+struct ReverbSIMD
+{
+	typedef int16x4_t v16;
+	typedef int32x2_t v32;
+
+	static forceinline v16 Load16x2(const int16 *p) { int32 x; std::memcpy(&x, p, sizeof(x)); return vreinterpret_s16_s32(vset_lane_s32(x, vdup_n_s32(0), 0)); }
+	static forceinline void Store16x2(int16 *p, v16 a) { const int32 x = vget_lane_s32(vreinterpret_s32_s16(a), 0); std::memcpy(p, &x, sizeof(x)); }
+	static forceinline v16 Load16x4(const int16 *p) { return vld1_s16(p); }
+	static forceinline void Store16x4(int16 *p, v16 a) { vst1_s16(p, a); }
+	static forceinline v32 Load32x2(const int32 *p) { return vld1_s32(p); }
+	static forceinline void Store32x2(int32 *p, v32 a) { vst1_s32(p, a); }
+	static forceinline v16 UnpackLo32(v16 a, v16 b) { return vreinterpret_s16_s32(vzip_s32(vreinterpret_s32_s16(a), vreinterpret_s32_s16(b)).val[0]); }
+	static forceinline v16 UnpackLo16(v16 a, v16 b) { return vzip_s16(a, b).val[0]; }
+	static forceinline v16 AddSat(v16 a, v16 b) { return vqadd_s16(a, b); }
+	static forceinline v16 SubSat(v16 a, v16 b) { return vqsub_s16(a, b); }
+	static forceinline v16 MulHi(v16 a, v16 b) { return vshrn_n_s32(vmull_s16(a, b), 16); }
+	template<int shift>
+	static forceinline v16 Sar16(v16 a) { return vshr_n_s16(a, shift); }
+	static forceinline v32 MulAdd(v16 a, v16 b) { const int32x4_t prod = vmull_s16(a, b); return vpadd_s32(vget_low_s32(prod), vget_high_s32(prod)); }
+	static forceinline v16 PackSat(v32 a) { return vqmovn_s32(vcombine_s32(a, a)); }
+	static forceinline v32 Add32(v32 a, v32 b) { return vadd_s32(a, b); }
+	static forceinline v32 Sub32(v32 a, v32 b) { return vsub_s32(a, b); }
+	template<int shift>
+	static forceinline v32 Sar32(v32 a) { return vshr_n_s32(a, shift); }
+};
+
+#endif
+
+
 // Reverb
-void CReverb::Process(int *MixSoundBuffer, uint32 nSamples)
-//---------------------------------------------------------
+void CReverb::Process(mixsample_t *MixSoundBuffer, uint32 nSamples)
+//-----------------------------------------------------------------
 {
-	if(!(GetProcSupport() & PROCSUPPORT_MMX)) return;
 	if((!gnReverbSend) && (!gnReverbSamples))
 	{ // no data is sent to reverb and reverb decayed completely
 		return;
 	}
+#ifdef MPT_INTMIXER
+	int *dryBuffer = MixSoundBuffer;
 	if(!gnReverbSend)
 	{ // no input data in MixReverbBuffer, so the buffer got not cleared in GetReverbSendBuffer(), do it now for decay
 		StereoFill(MixReverbBuffer, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
 	}
+#else
+	if(!gnReverbSend)
+	{
+		StereoFill(MixReverbSendBuffer, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
+	}
+	FloatToMonoMix(MixReverbSendBuffer, MixReverbBuffer, nSamples * 2, MIXING_SCALEF);
+	int *dryBuffer = MixReverbWetBuffer;
+	memset(dryBuffer, 0, nSamples * 2 * sizeof(int));
+#endif // MPT_INTMIXER
 
 	uint32 nIn, nOut;
 	// Dynamically adjust reverb master gains
@@ -454,41 +644,32 @@ void CReverb::Process(int *MixSoundBuffer, uint32 nSamples)
 	if (lDryVol < 8) lDryVol = 8;
 	if (lDryVol > 16) lDryVol = 16;
 	lDryVol = 16 - (((16-lDryVol) * lMaxRvbGain) >> 15);
-	X86_ReverbDryMix(MixSoundBuffer, MixReverbBuffer, lDryVol, nSamples);
-	// Downsample 2x + 1st stage of lowpass filter
-	nIn = X86_ReverbProcessPreFiltering1x(MixReverbBuffer, nSamples);
-	nOut = nIn;
-	// Main reverb processing: split into small chunks (needed for short reverb delays)
-	// Reverb Input + Low-Pass stage #2 + Pre-diffusion
-	if (nIn > 0) MMX_ProcessPreDelay(&g_RefDelay, MixReverbBuffer, nIn);
-	// Process Reverb Reflections and Late Reverberation
-	int *pRvbOut = MixReverbBuffer;
-	uint32 nRvbSamples = nOut, nCount = 0;
-	while (nRvbSamples > 0)
+	// The delay lines are only long enough for processing up to MIXBUFFERSIZE samples at once, so bigger mix chunks are split up.
+	for(uint32 offset = 0; offset < nSamples; offset += MIXBUFFERSIZE)
 	{
-		uint32 nPosRef = g_RefDelay.nRefOutPos & SNDMIX_REVERB_DELAY_MASK;
-		uint32 nPosRvb = (nPosRef - g_LateReverb.nReverbDelay) & SNDMIX_REVERB_DELAY_MASK;
-		uint32 nmax1 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRef;
-		uint32 nmax2 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRvb;
-		nmax1 = (nmax1 < nmax2) ? nmax1 : nmax2;
-		uint32 n = nRvbSamples;
-		if (n > nmax1) n = nmax1;
-		if (n > 64) n = 64;
-		// Reflections output + late reverb delay
-		MMX_ProcessReflections(&g_RefDelay, &g_RefDelay.RefOut[nPosRef*2], pRvbOut, n);
-		// Late Reverberation
-		MMX_ProcessLateReverb(&g_LateReverb, &g_RefDelay.RefOut[nPosRvb*2], pRvbOut, n);
-		// Update delay positions
-		g_RefDelay.nRefOutPos = (g_RefDelay.nRefOutPos + n) & SNDMIX_REVERB_DELAY_MASK;
-		g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos + n) & SNDMIX_REFLECTIONS_DELAY_MASK;
-		nCount += n*2;
-		pRvbOut += n*2;
-		nRvbSamples -= n;
+		const uint32 count = std::min<uint32>(nSamples - offset, MIXBUFFERSIZE);
+		int *pDry = dryBuffer + offset * 2;
+		int *pWet = MixReverbBuffer + offset * 2;
+		X86_ReverbDryMix(pDry, pWet, lDryVol, count);
+		// Downsample 2x + 1st stage of lowpass filter
+		nIn = X86_ReverbProcessPreFiltering1x(pWet, count);
+		nOut = nIn;
+#ifdef ENABLE_SIMD_INTRINSICS
+		if(m_useSIMD && HasSIMDIntrinsicsSupport())
+		{
+			ProcessWet<ReverbSIMD>(pDry, pWet, count, nIn, nOut);
+		} else
+#endif // ENABLE_SIMD_INTRINSICS
+		{
+			ProcessWet<ReverbScalar>(pDry, pWet, count, nIn, nOut);
+		}
 	}
-	// Adjust nDelayPos, in case nIn != nOut
-	g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos - nOut + nIn) & SNDMIX_REFLECTIONS_DELAY_MASK;
-	// Upsample 2x
-	MMX_ReverbProcessPostFiltering1x(MixReverbBuffer, MixSoundBuffer, nSamples);
+#ifndef MPT_INTMIXER
+	for(uint32 i = 0; i < nSamples * 2; i++)
+	{
+		MixSoundBuffer[i] += dryBuffer[i] * (1.0f / MIXING_SCALEF);
+	}
+#endif // !MPT_INTMIXER
 	// Automatically shut down if needed
 	if(gnReverbSend) gnReverbSamples = gnReverbDecaySamples; // reset decay counter
 	else if(gnReverbSamples > nSamples) gnReverbSamples -= nSamples; // decay
@@ -622,78 +803,64 @@ void CReverb::X86_ReverbProcessPostFiltering2x(const int *pRvb, int *pDry, uint3
 }
 
 
-#define DCR_AMOUNT		9
-
-// Stereo Add + DC removal
-void CReverb::MMX_ReverbProcessPostFiltering1x(const int *pRvb, int *pDry, uint32 nSamples)
-//-----------------------------------------------------------------------------------------
+template<typename TVector>
+void CReverb::ProcessWet(int *MixSoundBuffer, int *pWet, uint32 nSamples, uint32 nIn, uint32 nOut)
+//-------------------------------------------------------------------------------------------------
 {
-	int64 nDCRRvb_X1 = gnDCRRvb_X1;
-	int64 nDCRRvb_Y1 = gnDCRRvb_Y1;
-	_asm {
-	movq mm4, nDCRRvb_Y1	// mm4 = [ y1r | y1l ]
-	movq mm1, nDCRRvb_X1	// mm5 = [ x1r | x1l ]
-	mov ebx, pDry
-	mov ecx, pRvb
-	mov edx, nSamples
-stereodcr:
-	movq mm5, qword ptr [ecx]	// mm0 = [ xr | xl ]
-	movq mm3, qword ptr [ebx]	// mm3 = dry mix
-	add ecx, 8
-	psubd mm1, mm5				// mm1 = x(n-1) - x(n)
-	add ebx, 8
-	movq mm0, mm1
-	psrad mm0, DCR_AMOUNT+1
-	psubd mm0, mm1
-	paddd mm4, mm0
-	dec edx
-	paddd mm3, mm4				// add with dry mix
-	movq mm0, mm4
-	psrad mm0, DCR_AMOUNT
-	movq mm1, mm5
-	psubd mm4, mm0
-	movq qword ptr [ebx-8], mm3
-	jnz stereodcr
-	movq nDCRRvb_Y1, mm4
-	movq nDCRRvb_X1, mm5
-	emms
+	// Main reverb processing: split into small chunks (needed for short reverb delays)
+	// Reverb Input + Low-Pass stage #2 + Pre-diffusion
+	if (nIn > 0) ProcessPreDelay<TVector>(&g_RefDelay, pWet, nIn);
+	// Process Reverb Reflections and Late Reverberation
+	int *pRvbOut = pWet;
+	uint32 nRvbSamples = nOut;
+	while (nRvbSamples > 0)
+	{
+		uint32 nPosRef = g_RefDelay.nRefOutPos & SNDMIX_REVERB_DELAY_MASK;
+		uint32 nPosRvb = (nPosRef - g_LateReverb.nReverbDelay) & SNDMIX_REVERB_DELAY_MASK;
+		uint32 nmax1 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRef;
+		uint32 nmax2 = (SNDMIX_REVERB_DELAY_MASK+1) - nPosRvb;
+		nmax1 = (nmax1 < nmax2) ? nmax1 : nmax2;
+		uint32 n = nRvbSamples;
+		if (n > nmax1) n = nmax1;
+		if (n > 64) n = 64;
+		// Reflections output + late reverb delay
+		ProcessReflections<TVector>(&g_RefDelay, &g_RefDelay.RefOut[nPosRef*2], pRvbOut, n);
+		// Late Reverberation
+		ProcessLateReverb<TVector>(&g_LateReverb, &g_RefDelay.RefOut[nPosRvb*2], pRvbOut, n);
+		// Update delay positions
+		g_RefDelay.nRefOutPos = (g_RefDelay.nRefOutPos + n) & SNDMIX_REVERB_DELAY_MASK;
+		g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos + n) & SNDMIX_REFLECTIONS_DELAY_MASK;
+		pRvbOut += n*2;
+		nRvbSamples -= n;
 	}
-	gnDCRRvb_X1 = nDCRRvb_X1;
-	gnDCRRvb_Y1 = nDCRRvb_Y1;
+	// Adjust nDelayPos, in case nIn != nOut
+	g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos - nOut + nIn) & SNDMIX_REFLECTIONS_DELAY_MASK;
+	// Upsample 2x
+	ReverbProcessPostFiltering1x<TVector>(pWet, MixSoundBuffer, nSamples);
 }
 
 
-void CReverb::MMX_ReverbDCRemoval(int *pBuffer, uint32 nSamples)
-//--------------------------------------------------------------
+#define DCR_AMOUNT		9
+
+// Stereo Add + DC removal
+template<typename TVector>
+void CReverb::ReverbProcessPostFiltering1x(const int *pRvb, int *pDry, uint32 nSamples)
+//-------------------------------------------------------------------------------------
 {
-	int64 nDCRRvb_X1 = gnDCRRvb_X1;
-	int64 nDCRRvb_Y1 = gnDCRRvb_Y1;
-	_asm {
-	movq mm4, nDCRRvb_Y1	// mm4 = [ y1r | y1l ]
-	movq mm1, nDCRRvb_X1	// mm5 = [ x1r | x1l ]
-	mov ecx, pBuffer
-	mov edx, nSamples
-stereodcr:
-	movq mm5, qword ptr [ecx]	// mm0 = [ xr | xl ]
-	add ecx, 8
-	psubd mm1, mm5				// mm1 = x(n-1) - x(n)
-	movq mm0, mm1
-	psrad mm0, DCR_AMOUNT+1
-	psubd mm0, mm1
-	paddd mm4, mm0
-	dec edx
-	movq qword ptr [ecx-8], mm4
-	movq mm0, mm4
-	psrad mm0, DCR_AMOUNT
-	movq mm1, mm5
-	psubd mm4, mm0
-	jnz stereodcr
-	movq nDCRRvb_Y1, mm4
-	movq nDCRRvb_X1, mm5
-	emms
+	typedef typename TVector::v32 v32;
+	v32 y1 = TVector::Load32x2(gnDCRRvb_Y1);
+	v32 x1 = TVector::Load32x2(gnDCRRvb_X1);
+	for(uint32 i = 0; i < nSamples; i++)
+	{
+		const v32 x = TVector::Load32x2(pRvb + i * 2);
+		const v32 diff = TVector::Sub32(x1, x);	// x(n-1) - x(n)
+		y1 = TVector::Add32(y1, TVector::Sub32(TVector::template Sar32<DCR_AMOUNT + 1>(diff), diff));
+		TVector::Store32x2(pDry + i * 2, TVector::Add32(TVector::Load32x2(pDry + i * 2), y1));	// add with dry mix
+		y1 = TVector::Sub32(y1, TVector::template Sar32<DCR_AMOUNT>(y1));
+		x1 = x;
 	}
-	gnDCRRvb_X1 = nDCRRvb_X1;
-	gnDCRRvb_Y1 = nDCRRvb_Y1;
+	TVector::Store32x2(gnDCRRvb_Y1, y1);
+	TVector::Store32x2(gnDCRRvb_X1, x1);
 }
 
 
@@ -706,52 +873,32 @@ stereodcr:
 // 3. Insert the result in the reflections delay buffer
 //
 
-void CReverb::MMX_ProcessPreDelay(PSWRVBREFDELAY pPreDelay, const int *pIn, uint32 nSamples)
-//------------------------------------------------------------------------------------------
+template<typename TVector>
+void CReverb::ProcessPreDelay(SWRVBREFDELAY *pPreDelay, const int *pIn, uint32 nSamples)
+//--------------------------------------------------------------------------------------
 {
-	_asm {
-	mov eax, pPreDelay
-	mov ecx, pIn
-	mov esi, nSamples
-	lea edi, [eax+SWRVBREFDELAY.RefDelayBuffer]
-	mov ebx, dword ptr [eax+SWRVBREFDELAY.nDelayPos]
-	mov edx, dword ptr [eax+SWRVBREFDELAY.nPreDifPos]
-	movd mm6, dword ptr [eax+SWRVBREFDELAY.nCoeffs]
-	movd mm7, dword ptr [eax+SWRVBREFDELAY.History]
-	movd mm4, dword ptr [eax+SWRVBREFDELAY.nPreDifCoeffs]
-	lea eax, [eax+SWRVBREFDELAY.PreDifBuffer]
-	dec ebx
-rvbloop:
-	movq mm0, qword ptr [ecx]	// mm0 = 16-bit unsaturated reverb input [  r  |  l  ]
-	inc ebx
-	add ecx, 8
-	packssdw mm0, mm0	// mm0 = [ r | l | r | l ]
-	and ebx, SNDMIX_REFLECTIONS_DELAY_MASK
-	// Low-pass
-	psubsw mm7, mm0
-	pmulhw mm7, mm6
-	movd mm5, dword ptr [eax+edx*4]	// mm5 = [ 0 | 0 |rd |ld ] XD(n-D)
-	paddsw mm7, mm7
-	paddsw mm7, mm0
-	// Pre-Diffusion
-	movq mm0, mm7					// mm0 = [ ? | ? | r | l ] X(n)
-	inc edx
-	movq mm3, mm5
-	and edx, SNDMIX_PREDIFFUSION_DELAY_MASK
-	pmulhw mm3, mm4					// mm3 = k.Xd(n-D)
-	movq mm2, mm4
-	dec esi
-	psubsw mm0, mm3					// mm0 = X(n) - k.Xd(n-D) = Xd(n)
-	pmulhw mm2, mm0					// mm2 = k.Xd(n)
-	paddsw mm2, mm5					// mm2 = Xd(n-D) + k.Xd(n)
-	movd dword ptr [eax+edx*4], mm0
-	movd dword ptr [edi+ebx*4], mm2
-	jnz rvbloop
-	mov eax, pPreDelay
-	mov dword ptr [eax+SWRVBREFDELAY.nPreDifPos], edx
-	movd dword ptr [eax+SWRVBREFDELAY.History], mm7
-	emms
+	typedef typename TVector::v16 v16;
+	uint32 delayPos = pPreDelay->nDelayPos - 1;
+	uint32 preDifPos = pPreDelay->nPreDifPos;
+	const v16 coeffs = TVector::Load16x2(pPreDelay->nCoeffs);
+	const v16 preDifCoeffs = TVector::Load16x2(pPreDelay->nPreDifCoeffs);
+	v16 history = TVector::Load16x2(pPreDelay->History);
+	for(uint32 i = 0; i < nSamples; i++)
+	{
+		const v16 in = TVector::PackSat(TVector::Load32x2(pIn + i * 2));	// 16-bit unsaturated reverb input [ l | r | l | r ]
+		delayPos = (delayPos + 1) & SNDMIX_REFLECTIONS_DELAY_MASK;
+		// Low-pass
+		history = TVector::MulHi(TVector::SubSat(history, in), coeffs);
+		history = TVector::AddSat(TVector::AddSat(history, history), in);
+		// Pre-Diffusion
+		const v16 delayed = TVector::Load16x2(pPreDelay->PreDifBuffer + preDifPos * 2);	// Xd(n-D)
+		preDifPos = (preDifPos + 1) & SNDMIX_PREDIFFUSION_DELAY_MASK;
+		const v16 diffused = TVector::SubSat(history, TVector::MulHi(delayed, preDifCoeffs));	// X(n) - k.Xd(n-D) = Xd(n)
+		TVector::Store16x2(pPreDelay->PreDifBuffer + preDifPos * 2, diffused);
+		TVector::Store16x2(pPreDelay->RefDelayBuffer + delayPos * 2, TVector::AddSat(TVector::MulHi(preDifCoeffs, diffused), delayed));	// Xd(n-D) + k.Xd(n)
 	}
+	pPreDelay->nPreDifPos = preDifPos;
+	TVector::Store16x2(pPreDelay->History, history);
 }
 
 
@@ -767,136 +914,67 @@ rvbloop:
 //	- apply reflections master gain and accumulate in the given output
 //
 
-typedef struct _DUMMYREFARRAY
-{
-	SWRVBREFLECTION Ref1;
-	SWRVBREFLECTION Ref2;
-	SWRVBREFLECTION Ref3;
-	SWRVBREFLECTION Ref4;
-	SWRVBREFLECTION Ref5;
-	SWRVBREFLECTION Ref6;
-	SWRVBREFLECTION Ref7;
-	SWRVBREFLECTION Ref8;
-} DUMMYREFARRAY, *PDUMMYREFARRAY;
-
-
-void CReverb::MMX_ProcessReflections(PSWRVBREFDELAY pPreDelay, short int *pRefOut, int *pOut, uint32 nSamples)
-//------------------------------------------------------------------------------------------------------------
+template<typename TVector>
+void CReverb::ProcessReflections(SWRVBREFDELAY *pPreDelay, int16 *pRefOut, int *pOut, uint32 nSamples)
+//----------------------------------------------------------------------------------------------------
 {
-	_asm {
+	typedef typename TVector::v16 v16;
+	typedef typename TVector::v32 v32;
+	const int16 *delayBuffer = pPreDelay->RefDelayBuffer;
+	const SWRVBREFLECTION *reflections = pPreDelay->Reflections;
+
 	// First stage
-	push ebp
-	mov edi, pPreDelay
-	mov eax, pRefOut
-	mov ebp, nSamples
-	push eax
-	lea esi, [edi+SWRVBREFDELAY.RefDelayBuffer]
-	mov eax, dword ptr [edi+SWRVBREFDELAY.nDelayPos]
-	lea edi, [edi+SWRVBREFDELAY.Reflections]
-	mov ebx, eax
-	mov ecx, eax
-	mov edx, eax
-	sub eax, dword ptr [edi+DUMMYREFARRAY.Ref1.Delay]
-	movq mm4, qword ptr [edi+DUMMYREFARRAY.Ref1.Gains]
-	sub ebx, dword ptr [edi+DUMMYREFARRAY.Ref2.Delay]
-	movq mm5, qword ptr [edi+DUMMYREFARRAY.Ref2.Gains]
-	sub ecx, dword ptr [edi+DUMMYREFARRAY.Ref3.Delay]
-	movq mm6, qword ptr [edi+DUMMYREFARRAY.Ref3.Gains]
-	sub edx, dword ptr [edi+DUMMYREFARRAY.Ref4.Delay]
-	movq mm7, qword ptr [edi+DUMMYREFARRAY.Ref4.Gains]
-	pop edi
-	and eax, SNDMIX_REFLECTIONS_DELAY_MASK
-	and ebx, SNDMIX_REFLECTIONS_DELAY_MASK
-	and ecx, SNDMIX_REFLECTIONS_DELAY_MASK
-	and edx, SNDMIX_REFLECTIONS_DELAY_MASK
-refloop1:
-	movd mm3, dword ptr [esi+edx*4]
-	movd mm2, dword ptr [esi+ecx*4]
-	inc edx
-	inc ecx
-	movd mm1, dword ptr [esi+ebx*4]
-	movd mm0, dword ptr [esi+eax*4]
-	punpckldq mm3, mm3
-	punpckldq mm2, mm2
-	pmaddwd mm3, mm7
-	inc ebx
-	inc eax
-	pmaddwd mm2, mm6
-	punpckldq mm1, mm1
-	punpckldq mm0, mm0
-	pmaddwd mm1, mm5
-	and eax, SNDMIX_REFLECTIONS_DELAY_MASK
-	and ebx, SNDMIX_REFLECTIONS_DELAY_MASK
-	pmaddwd mm0, mm4
-	and ecx, SNDMIX_REFLECTIONS_DELAY_MASK
-	paddd mm2, mm3
-	paddd mm0, mm1
-	paddd mm0, mm2
-	and edx, SNDMIX_REFLECTIONS_DELAY_MASK
-	psrad mm0, 15
-	add edi, 4
-	packssdw mm0, mm0
-	dec ebp
-	movd dword ptr [edi-4], mm0
-	jnz refloop1
-	pop ebp
+	{
+		uint32 pos[4];
+		v16 gains[4];
+		for(int r = 0; r < 4; r++)
+		{
+			pos[r] = (pPreDelay->nDelayPos - reflections[r].Delay) & SNDMIX_REFLECTIONS_DELAY_MASK;
+			gains[r] = TVector::Load16x4(reflections[r].Gains);
+		}
+		for(uint32 i = 0; i < nSamples; i++)
+		{
+			v16 in[4];
+			for(int r = 0; r < 4; r++)
+			{
+				in[r] = TVector::Load16x2(delayBuffer + pos[r] * 2);
+				pos[r] = (pos[r] + 1) & SNDMIX_REFLECTIONS_DELAY_MASK;
+			}
+			const v32 sum = TVector::Add32(
+				TVector::Add32(TVector::MulAdd(TVector::UnpackLo32(in[0], in[0]), gains[0]), TVector::MulAdd(TVector::UnpackLo32(in[1], in[1]), gains[1])),
+				TVector::Add32(TVector::MulAdd(TVector::UnpackLo32(in[2], in[2]), gains[2]), TVector::MulAdd(TVector::UnpackLo32(in[3], in[3]), gains[3])));
+			TVector::Store16x2(pRefOut + i * 2, TVector::PackSat(TVector::template Sar32<15>(sum)));
+		}
+	}
+
 	// Second stage
-	push ebp
-	mov edi, pPreDelay
-	mov eax, pRefOut
-	mov edx, pOut
-	mov ebp, nSamples
-	movd mm7, dword ptr [edi+SWRVBREFDELAY.ReflectionsGain]
-	pxor mm0, mm0
-	push eax
-	punpcklwd mm7, mm0	// mm7 = [ 0 |g_r| 0 |g_l]
-	mov eax, dword ptr [edi+SWRVBREFDELAY.nDelayPos]
-	lea edi, [edi+SWRVBREFDELAY.Reflections]
-	mov ebx, eax
-	mov ecx, eax
-	sub eax, dword ptr [edi+DUMMYREFARRAY.Ref5.Delay]
-	movq mm4, qword ptr [edi+DUMMYREFARRAY.Ref5.Gains]
-	sub ebx, dword ptr [edi+DUMMYREFARRAY.Ref6.Delay]
-	movq mm5, qword ptr [edi+DUMMYREFARRAY.Ref6.Gains]
-	sub ecx, dword ptr [edi+DUMMYREFARRAY.Ref7.Delay]
-	movq mm6, qword ptr [edi+DUMMYREFARRAY.Ref7.Gains]
-	pop edi
-	and ecx, SNDMIX_REFLECTIONS_DELAY_MASK
-	and ebx, SNDMIX_REFLECTIONS_DELAY_MASK
-	and eax, SNDMIX_REFLECTIONS_DELAY_MASK
-	psrad mm7, 3	// For 28-bit final output: 16+15-3 = 28
-refloop2:
-	movd mm2, dword ptr [esi+ecx*4]
-	movd mm1, dword ptr [esi+ebx*4]
-	movd mm0, dword ptr [esi+eax*4]
-	movd mm3, dword ptr [edi]			// mm3 = output of previous reflections
-	punpckldq mm2, mm2
-	inc ecx
-	pmaddwd mm2, mm6
-	punpckldq mm1, mm1
-	inc ebx
-	pmaddwd mm1, mm5
-	punpckldq mm0, mm0
-	inc eax
-	pmaddwd mm0, mm4
-	and ecx, SNDMIX_REFLECTIONS_DELAY_MASK
-	and ebx, SNDMIX_REFLECTIONS_DELAY_MASK
-	paddd mm0, mm2
-	paddd mm0, mm1
-	add edi, 4
-	psrad mm0, 15
-	and eax, SNDMIX_REFLECTIONS_DELAY_MASK
-	packssdw mm0, mm0
-	paddsw mm0, mm3
-	add edx, 8
-	movd dword ptr [edi-4], mm0		// late reverb stereo input
-	punpcklwd mm0, mm0
-	pmaddwd mm0, mm7				// Apply reflections gain
-	dec ebp
-	movq qword ptr [edx-8], mm0		// At this, point, this is the only output of the reverb
-	jnz refloop2
-	pop ebp
-	emms
+	{
+		// For 28-bit final output: 16+15-3 = 28
+		const int16 masterGains[4] = { static_cast<int16>(pPreDelay->ReflectionsGain[0] >> 3), 0, static_cast<int16>(pPreDelay->ReflectionsGain[1] >> 3), 0 };
+		const v16 masterGain = TVector::Load16x4(masterGains);
+		uint32 pos[3];
+		v16 gains[3];
+		for(int r = 0; r < 3; r++)
+		{
+			pos[r] = (pPreDelay->nDelayPos - reflections[r + 4].Delay) & SNDMIX_REFLECTIONS_DELAY_MASK;
+			gains[r] = TVector::Load16x4(reflections[r + 4].Gains);
+		}
+		for(uint32 i = 0; i < nSamples; i++)
+		{
+			v16 in[3];
+			for(int r = 0; r < 3; r++)
+			{
+				in[r] = TVector::Load16x2(delayBuffer + pos[r] * 2);
+				pos[r] = (pos[r] + 1) & SNDMIX_REFLECTIONS_DELAY_MASK;
+			}
+			const v32 sum = TVector::Add32(
+				TVector::Add32(TVector::MulAdd(TVector::UnpackLo32(in[0], in[0]), gains[0]), TVector::MulAdd(TVector::UnpackLo32(in[2], in[2]), gains[2])),
+				TVector::MulAdd(TVector::UnpackLo32(in[1], in[1]), gains[1]));
+			// Add output of previous reflections
+			const v16 out = TVector::AddSat(TVector::PackSat(TVector::template Sar32<15>(sum)), TVector::Load16x2(pRefOut + i * 2));
+			TVector::Store16x2(pRefOut + i * 2, out);	// late reverb stereo input
+			TVector::Store32x2(pOut + i * 2, TVector::MulAdd(TVector::UnpackLo16(out, out), masterGain));	// Apply reflections gain. At this point, this is the only output of the reverb
+		}
 	}
 }
 
@@ -906,112 +984,69 @@ refloop2:
 // Late reverberation (with SW reflections)
 //
 
-void CReverb::MMX_ProcessLateReverb(PSWLATEREVERB pReverb, short int *pRefOut, int *pMixOut, uint32 nSamples)
-//-----------------------------------------------------------------------------------------------------------
+template<typename TVector>
+void CReverb::ProcessLateReverb(SWLATEREVERB *pReverb, const int16 *pRefOut, int *pMixOut, uint32 nSamples)
+//---------------------------------------------------------------------------------------------------------
 {
-	_asm {
-	push ebp
-	mov ebx, pReverb
-	mov esi, pRefOut
-	mov edi, pMixOut
-	mov ebp, nSamples
-	mov ecx, dword ptr [ebx+SWLATEREVERB.nDelayPos]
-	movq mm3, qword ptr [ebx+SWLATEREVERB.RvbOutGains]
-	movq mm5, qword ptr [ebx+SWLATEREVERB.nDifCoeffs]
-	movq mm6, qword ptr [ebx+SWLATEREVERB.nDecayLP]
-	movq mm7, qword ptr [ebx+SWLATEREVERB.LPHistory]
-rvbloop:
-	sub ecx, RVBDLY2L_LEN
-	movd mm0, dword ptr [esi]
-	lea edx, [ecx+RVBDLY2L_LEN - RVBDLY2R_LEN]
-	and ecx, RVBDLY_MASK
-	and edx, RVBDLY_MASK
-	movd mm1, dword ptr [ebx+SWLATEREVERB.Delay2+ecx*4]
-	movd mm2, dword ptr [ebx+SWLATEREVERB.Delay2+edx*4]
-	add ecx, RVBDLY2L_LEN - RVBDIF1R_LEN
-	punpckldq mm0, mm0
-	and ecx, RVBDLY_MASK
-	punpckldq mm1, mm2
-	psraw mm0, 2			// mm0 = stereo input
-	psubsw mm7, mm1
-	movzx eax, word ptr [ebx+SWLATEREVERB.Diffusion1+ecx*4+2]
-	pmulhw mm7, mm6
-	add ecx, RVBDIF1R_LEN - RVBDIF1L_LEN
-	add esi, 4
-	paddsw mm7, mm7
-	paddsw mm7, mm1		// mm7 = low-passed decay
-	movq mm1, qword ptr [ebx+SWLATEREVERB.nDecayDC]
-	and ecx, RVBDLY_MASK
-	shl eax, 16
-	pmaddwd mm1, mm7	// apply decay gain
-	movzx edx, word ptr [ebx+SWLATEREVERB.Diffusion1+ecx*4]
-	add ecx, RVBDIF1L_LEN
-	psrad mm1, 15		// mm1 = decay [  r  |  l  ]
-	and ecx, RVBDLY_MASK
-	packssdw mm1, mm1
-	or eax, edx
-	paddsw mm1, mm0		// mm1 = input + decay		[ r | l | r | l ]
-	movd mm2, eax		// mm2 = diffusion1 history	[ 0 | 0 | rd| ld] Xd(n-D)
-	pmulhw mm2, mm5		// mm2 = k.Xd(n-D)
-	movq mm4, mm1		// mm4 = reverb output
-	movq mm0, mm5
-	psubsw mm1, mm2		// mm1 = X(n) - k.Xd(n-D) = Xd(n)
-	movd mm2, eax
-	pmulhw mm0, mm1		// mm0 = k.Xd(n)
-	movd dword ptr [ebx+SWLATEREVERB.Diffusion1+ecx*4], mm1
-	paddsw mm0, mm2		// mm0 = Xd(n-D) + k.Xd(n)
-	mov eax, ecx
-	// Insert the diffusion output in the reverb delay line
-	movd dword ptr [ebx+SWLATEREVERB.Delay1+ecx*4], mm0
-	sub ecx, RVBDLY1R_LEN
-	sub eax, RVBDLY1L_LEN
-	punpckldq mm0, mm0
-	and ecx, RVBDLY_MASK
-	and eax, RVBDLY_MASK
-	paddsw mm4, mm0		// accumulate with reverb output
-	// Input to second diffuser
-	movd mm0, dword ptr [ebx+SWLATEREVERB.Delay1+ecx*4]
-	movd mm1, dword ptr [ebx+SWLATEREVERB.Delay1+eax*4]
-	add ecx, RVBDLY1R_LEN - RVBDIF2R_LEN
-	and ecx, RVBDLY_MASK
-	punpckldq mm1, mm0
-	movzx eax, word ptr [ebx+SWLATEREVERB.Diffusion2+ecx*4+2]
-	paddsw mm4, mm1
-	pmaddwd mm1, qword ptr [ebx+SWLATEREVERB.Dif2InGains]
-	add ecx, RVBDIF2R_LEN - RVBDIF2L_LEN
-	and ecx, RVBDLY_MASK
-	psrad mm1, 15
-	movzx edx, word ptr [ebx+SWLATEREVERB.Diffusion2+ecx*4]
-	packssdw mm1, mm1	// mm1 = 2nd diffuser input [ r | l | r | l ]
-	shl eax, 16
-	psubsw mm4, mm1		// accumulate with reverb output
-	or eax, edx
-	add ecx, RVBDIF2L_LEN
-	movd mm2, eax		// mm2 = diffusion2 history
-	and ecx, RVBDLY_MASK
-	pmulhw mm2, mm5		// mm2 = k.Xd(n-D)
-	movq mm0, mm5
-	psubsw mm1, mm2		// mm1 = X(n) - k.Xd(n-D) = Xd(n)
-	movd mm2, eax
-	pmulhw mm0, mm1		// mm0 = k.Xd(n)
-	movd dword ptr [ebx+SWLATEREVERB.Diffusion2+ecx*4], mm1
-	movq mm1, qword ptr [edi]
-	paddsw mm0, mm2		// mm0 = Xd(n-D) + k.Xd(n)
-	paddsw mm4, mm0		// accumulate with reverb output
-	movd dword ptr [ebx+SWLATEREVERB.Delay2+ecx*4], mm0
-	pmaddwd mm4, mm3	// mm4 = [   r   |   l   ]
-	inc ecx
-	add edi, 8
-	and ecx, RVBDLY_MASK
-	paddd mm4, mm1
-	dec ebp
-	movq qword ptr [edi-8], mm4
-	jnz rvbloop
-	pop ebp
-	movq qword ptr [ebx+SWLATEREVERB.LPHistory], mm7
-	mov dword ptr [ebx+SWLATEREVERB.nDelayPos], ecx
-	emms
+	typedef typename TVector::v16 v16;
+	typedef typename TVector::v32 v32;
+	const v16 rvbOutGains = TVector::Load16x4(pReverb->RvbOutGains);
+	const v16 difCoeffs = TVector::Load16x4(pReverb->nDifCoeffs);
+	const v16 decayDC = TVector::Load16x4(pReverb->nDecayDC);
+	const v16 decayLP = TVector::Load16x4(pReverb->nDecayLP);
+	const v16 dif2InGains = TVector::Load16x4(pReverb->Dif2InGains);
+	v16 lpHistory = TVector::Load16x4(pReverb->LPHistory);
+	uint32 pos = pReverb->nDelayPos & RVBDLY_MASK;
+
+	for(uint32 i = 0; i < nSamples; i++)
+	{
+		const v16 in = TVector::template Sar16<2>(TVector::UnpackLo32(TVector::Load16x2(pRefOut + i * 2), TVector::Load16x2(pRefOut + i * 2)));	// stereo input [ l | r | l | r ]
+
+		// Low-passed decay
+		const v16 delay2 = TVector::UnpackLo32(
+			TVector::Load16x2(pReverb->Delay2 + ((pos - RVBDLY2L_LEN) & RVBDLY_MASK) * 2),
+			TVector::Load16x2(pReverb->Delay2 + ((pos - RVBDLY2R_LEN) & RVBDLY_MASK) * 2));
+		lpHistory = TVector::MulHi(TVector::SubSat(lpHistory, delay2), decayLP);
+		lpHistory = TVector::AddSat(TVector::AddSat(lpHistory, lpHistory), delay2);
+		// Apply decay gain, add input
+		v16 x = TVector::AddSat(TVector::PackSat(TVector::template Sar32<15>(TVector::MulAdd(decayDC, lpHistory))), in);
+		v16 rvbOut = x;
+
+		// First diffuser
+		const int16 dif1History[2] = { pReverb->Diffusion1[((pos - RVBDIF1L_LEN) & RVBDLY_MASK) * 2], pReverb->Diffusion1[((pos - RVBDIF1R_LEN) & RVBDLY_MASK) * 2 + 1] };
+		v16 delayed = TVector::Load16x2(dif1History);	// Xd(n-D)
+		x = TVector::SubSat(x, TVector::MulHi(delayed, difCoeffs));	// X(n) - k.Xd(n-D) = Xd(n)
+		TVector::Store16x2(pReverb->Diffusion1 + pos * 2, x);
+		v16 diffused = TVector::AddSat(TVector::MulHi(difCoeffs, x), delayed);	// Xd(n-D) + k.Xd(n)
+		// Insert the diffusion output in the reverb delay line
+		TVector::Store16x2(pReverb->Delay1 + pos * 2, diffused);
+		rvbOut = TVector::AddSat(rvbOut, TVector::UnpackLo32(diffused, diffused));	// accumulate with reverb output
+
+		// Input to second diffuser
+		const v16 delay1 = TVector::UnpackLo32(
+			TVector::Load16x2(pReverb->Delay1 + ((pos - RVBDLY1L_LEN) & RVBDLY_MASK) * 2),
+			TVector::Load16x2(pReverb->Delay1 + ((pos - RVBDLY1R_LEN) & RVBDLY_MASK) * 2));
+		rvbOut = TVector::AddSat(rvbOut, delay1);
+		x = TVector::PackSat(TVector::template Sar32<15>(TVector::MulAdd(delay1, dif2InGains)));	// 2nd diffuser input [ l | r | l | r ]
+		rvbOut = TVector::SubSat(rvbOut, x);	// accumulate with reverb output
+
+		// Second diffuser
+		const int16 dif2History[2] = { pReverb->Diffusion2[((pos - RVBDIF2L_LEN) & RVBDLY_MASK) * 2], pReverb->Diffusion2[((pos - RVBDIF2R_LEN) & RVBDLY_MASK) * 2 + 1] };
+		delayed = TVector::Load16x2(dif2History);	// Xd(n-D)
+		x = TVector::SubSat(x, TVector::MulHi(delayed, difCoeffs));	// X(n) - k.Xd(n-D) = Xd(n)
+		TVector::Store16x2(pReverb->Diffusion2 + pos * 2, x);
+		diffused = TVector::AddSat(TVector::MulHi(difCoeffs, x), delayed);	// Xd(n-D) + k.Xd(n)
+		rvbOut = TVector::AddSat(rvbOut, diffused);	// accumulate with reverb output
+		TVector::Store16x2(pReverb->Delay2 + pos * 2, diffused);
+
+		const v32 out = TVector::MulAdd(rvbOut, rvbOutGains);	// [ l | r ]
+		TVector::Store32x2(pMixOut + i * 2, TVector::Add32(out, TVector::Load32x2(pMixOut + i * 2)));
+
+		pos = (pos + 1) & RVBDLY_MASK;
 	}
+
+	TVector::Store16x4(pReverb->LPHistory, lpHistory);
+	pReverb->nDelayPos = pos;
 }
 
 
@@ -1019,109 +1054,29 @@ rvbloop:
 static int32 OnePoleLowPassCoef(int32 scale, float g, float F_c, float F_s)
 //-------------------------------------------------------------------------
 {
-	float cosw; // cos(2*PI*Fc/Fs)
-	float scale_over_1mg; // scale / (1.0f - g);
-	int32 result;
-
 	if (g > 0.999999f) return 0;
-	_asm {
-	fild scale
-	fld1
-	fld g
-	fld ST(0)
-	fmulp ST(1), ST(0)
-	fst g
-	fsubp ST(1), ST(0)
-	fdivp ST(1), ST(0)
-	fstp scale_over_1mg
-	fld F_c
-	fld F_s
-	fdivp ST(1), ST(0)
-	fldpi
-	fadd ST(0), ST(0)
-	fmulp ST(1), ST(0)
-	fcos
-	fstp cosw
-	fld g
-	fadd ST(0), ST(0)
-	fld1
-	fld cosw
-	fsubp ST(1), ST(0)
-	fmulp ST(1), ST(0)	// 2g*(1 cos(w))
-	fld g
-	fmul ST(0), ST(0)
-	fld1
-	fld cosw
-	fmul ST(0), ST(0)
-	fsubp ST(1), ST(0)
-	fmulp ST(1), ST(0)	// g*g*((1-cos w)^2)
-	fsubp ST(1), ST(0)
-	fsqrt
-	fld g
-	fmul cosw
-	faddp ST(1), ST(0)
-	fld1
-	fsubrp ST(1), ST(0)	// (1-gcos(w)-sqrt(2g(1-cos w) - g2(1-(cos w)^2)))
-	fld scale_over_1mg
-	fmulp ST(1), ST(0)
-	fistp result
-	}
-	return result;
+
+	g *= g;
+	double scale_over_1mg = scale / (1.0 - g);
+	double cosw = std::cos(2.0 * M_PI * F_c / F_s);
+	return Util::Round<int32>((1.0 - (std::sqrt((g + g) * (1.0 - cosw) - g * g * (1.0 - cosw * cosw)) + g * cosw)) * scale_over_1mg);
 }
 
 
+// Convert millibels to a linear factor
 static int32 mBToLinear(int32 scale, int32 value_mB)
 {
-	// factor = log2(10)/(100*20)
-	const float _factor = 3.321928094887362304f / (100.0f * 20.0f);
-	long result;
-
 	if (!value_mB) return scale;
 	if (value_mB <= -10000) return 0;
-	_asm {
-	fild value_mB		// Load dB value
-	fld _factor			// Load the log2(10)/(20*65536) factor
-	fmulp ST(1), ST(0)	// ST(0) = value_dB/(20*65536)
-	fist result			// Store integer exponent
-	fisub result		// ST(0) = -1 <= (value_dB*log2(10)/(65536*20)) <= 1
-	f2xm1				// ST(0) = 2^(value_dB*log2(10)/(65536*20))-1
-	fild result			// load integer exponent
-	fild scale			// Load scale factor
-	fscale				// ST(0) = scale * 2^ST(1)
-	fstp ST(1)			// Remove the integer from the stack
-	fmul ST(1), ST(0)	// multiply with fractional part
-	faddp ST(1), ST(0)	// add 1*scale*integer_part
-	fistp result		// Convert to integer
-	}
-	return result;
+	return Util::Round<int32>(scale * std::pow(10.0, value_mB * (1.0 / 2000.0)));
 }
 
 
 static float mBToLinear(int32 value_mB)
 {
-	// factor = log2(10)/(100*20)
-	const float _factor = 3.321928094887362304f / (100.0f * 20.0f);
-	long result;
-	float fresult;
-
 	if (!value_mB) return 1;
 	if (value_mB <= -100000) return 0;
-	_asm {
-	fild value_mB		// Load dB value
-	fld _factor			// Load the log2(10)/(20*65536) factor
-	fmulp ST(1), ST(0)	// ST(0) = value_dB/(20*65536)
-	fist result			// Store integer exponent
-	fisub result		// ST(0) = -1 <= (value_dB*log2(10)/(65536*20)) <= 1
-	f2xm1				// ST(0) = 2^(value_dB*log2(10)/(65536*20))-1
-	fild result			// load integer exponent
-	fld1				// Load scale factor
-	fscale				// ST(0) = scale * 2^ST(1)
-	fstp ST(1)			// Remove the integer from the stack
-	fmul ST(1), ST(0)	// multiply with fractional part
-	faddp ST(1), ST(0)	// add 1*scale*integer_part
-	fstp fresult		// Convert to integer
-	}
-	return fresult;
+	return static_cast<float>(std::pow(10.0, value_mB * (1.0 / 2000.0)));
 }
 
 #endif // NO_REVERB
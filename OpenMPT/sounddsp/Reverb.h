@@ -10,7 +10,7 @@
 
 #pragma once
 
-#include "../soundlib/Mixer.h"	// For MIXBUFFERSIZE
+#include "../soundlib/Mixer.h"	// For MIXBUFFERSIZE and AlignedMixBuffer
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -138,13 +138,21 @@ public:
 
 	// Shared reverb state
 private:
-	int MixReverbBuffer[MIXBUFFERSIZE * 2];
+	// Send buffers hold one mix chunk (see Initialize())
+	AlignedMixBuffer<int> MixReverbBuffer;
+#ifndef MPT_INTMIXER
+	// The reverb itself works on fixed point data. With the floating point mixer, voices are mixed into a separate send buffer,
+	// which is converted into MixReverbBuffer, and the reverb output is collected in MixReverbWetBuffer before it is added to the dry mix.
+	AlignedMixBuffer<mixsample_t> MixReverbSendBuffer;
+	AlignedMixBuffer<int> MixReverbWetBuffer;
+#endif // !MPT_INTMIXER
 public:
 	mixsample_t gnRvbROfsVol, gnRvbLOfsVol;
 
 private:
 
 	uint32 gnReverbSend;
+	uint32 m_currentReverbType;	// Preset the reverb parameters are currently set up for
 
 	uint32 gnReverbSamples;
 	uint32 gnReverbDecaySamples;
@@ -158,8 +166,9 @@ private:
 	int g_nLastRvbIn_yr;
 	int g_nLastRvbOut_xl;
 	int g_nLastRvbOut_xr;
-	int64 gnDCRRvb_Y1;
-	int64 gnDCRRvb_X1;
+	int32 gnDCRRvb_Y1[2];
+	int32 gnDCRRvb_X1[2];
+	bool m_useSIMD;
 
 	// Reverb mix buffers
 	SWRVBREFDELAY g_RefDelay;
@@ -168,13 +177,14 @@ private:
 public:
 	CReverb();
 public:
-	void Initialize(bool bReset, uint32 MixingFreq);
+	// mixBufferSize is the maximum number of frames passed to GetReverbSendBuffer() and Process().
+	void Initialize(bool bReset, uint32 MixingFreq, bool useSIMD, uint32 mixBufferSize = MIXBUFFERSIZE);
 
 	// can be called multiple times or never (if no data is sent to reverb)
-	int *GetReverbSendBuffer(uint32 nSamples);
+	mixsample_t *GetReverbSendBuffer(uint32 nSamples);
 
 	// call once after all data has been sent.
-	void Process(int *MixSoundBuffer, uint32 nSamples);
+	void Process(mixsample_t *MixSoundBuffer, uint32 nSamples);
 
 	// [Reverb level 0(quiet)-100(loud)], [REVERBTYPE_XXXX]
 	bool SetReverbParameters(uint32 nDepth, uint32 nType);
@@ -183,16 +193,19 @@ private:
 	// Pre/Post resampling and filtering
 	uint32 X86_ReverbProcessPreFiltering1x(int *pWet, uint32 nSamples);
 	uint32 X86_ReverbProcessPreFiltering2x(int *pWet, uint32 nSamples);
-	void MMX_ReverbProcessPostFiltering1x(const int *pRvb, int *pDry, uint32 nSamples);
 	void X86_ReverbProcessPostFiltering2x(const int *pRvb, int *pDry, uint32 nSamples);
-	void MMX_ReverbDCRemoval(int *pBuffer, uint32 nSamples);
 	void X86_ReverbDryMix(int *pDry, int *pWet, int lDryVol, uint32 nSamples);
+
+	// The following functions are implemented for several vector instruction sets, see Reverb.cpp
+	// Process the wet signal (pre-delay, reflections, late reverb) and add it to the dry mix
+	template<typename TVector> void ProcessWet(int *MixSoundBuffer, int *pWet, uint32 nSamples, uint32 nIn, uint32 nOut);
+	template<typename TVector> void ReverbProcessPostFiltering1x(const int *pRvb, int *pDry, uint32 nSamples);
 	// Process pre-diffusion and pre-delay
-	void MMX_ProcessPreDelay(PSWRVBREFDELAY pPreDelay, const int *pIn, uint32 nSamples);
+	template<typename TVector> static void ProcessPreDelay(SWRVBREFDELAY *pPreDelay, const int *pIn, uint32 nSamples);
 	// Process reflections
-	void MMX_ProcessReflections(PSWRVBREFDELAY pPreDelay, short int *pRefOut, int *pMixOut, uint32 nSamples);
+	template<typename TVector> static void ProcessReflections(SWRVBREFDELAY *pPreDelay, int16 *pRefOut, int *pMixOut, uint32 nSamples);
 	// Process Late Reverb (SW Reflections): stereo reflections output, 32-bit reverb output, SW reverb gain
-	void MMX_ProcessLateReverb(PSWLATEREVERB pReverb, short int *pRefOut, int *pMixOut, uint32 nSamples);
+	template<typename TVector> static void ProcessLateReverb(SWLATEREVERB *pReverb, const int16 *pRefOut, int *pMixOut, uint32 nSamples);
 };
 
 
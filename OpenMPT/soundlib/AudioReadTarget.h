@@ -19,6 +19,38 @@
 OPENMPT_NAMESPACE_BEGIN
 
 
+#ifndef MPT_INTMIXER
+
+// Write the floating point mix buffer directly to floating point output buffers.
+// Returns false for all other output formats, which go through the fixed point conversion.
+template<bool clipOutput, typename Tsample>
+bool CopyFloatMixBuffer(Tsample * /*outputBuffer*/, Tsample * const * /*outputBuffers*/, std::size_t /*offset*/, const float * /*mixBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/)
+{
+	return false;
+}
+
+template<bool clipOutput>
+bool CopyFloatMixBuffer(float *outputBuffer, float * const *outputBuffers, std::size_t offset, const float *mixBuffer, std::size_t channels, std::size_t countChunk)
+{
+	if(outputBuffer)
+	{
+		ConvertInterleavedFloatToInterleaved<clipOutput>(outputBuffer + (channels * offset), mixBuffer, channels, countChunk);
+	}
+	if(outputBuffers)
+	{
+		float *buffers[4] = { nullptr, nullptr, nullptr, nullptr };
+		for(std::size_t channel = 0; channel < channels; ++channel)
+		{
+			buffers[channel] = outputBuffers[channel] + offset;
+		}
+		ConvertInterleavedFloatToNonInterleaved<clipOutput>(buffers, mixBuffer, channels, countChunk);
+	}
+	return true;
+}
+
+#endif // !MPT_INTMIXER
+
+
 template<typename Tsample, bool clipOutput = false>
 class AudioReadTargetBuffer
 	: public IAudioReadTarget
@@ -29,6 +61,10 @@ private:
 protected:
 	Tsample *outputBuffer;
 	Tsample * const *outputBuffers;
+#ifndef MPT_INTMIXER
+	// Fixed point copy of the mix buffer for integer output formats
+	std::vector<int> intBuffer;
+#endif // !MPT_INTMIXER
 public:
 	AudioReadTargetBuffer(Dither &dither_, Tsample *buffer, Tsample * const *buffers)
 		: countRendered(0)
@@ -41,20 +77,37 @@ public:
 	virtual ~AudioReadTargetBuffer() { }
 	std::size_t GetRenderedCount() const { return countRendered; }
 public:
-	virtual void DataCallback(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
+	virtual void DataCallback(mixsample_t *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
 	{
 		// Convert to output sample format and optionally perform dithering and clipping if needed
 
 		const SampleFormat sampleFormat = SampleFormatTraits<Tsample>::sampleFormat;
 
+#ifdef MPT_INTMIXER
+		int *mixBuffer = MixSoundBuffer;
+#else
+		if(CopyFloatMixBuffer<clipOutput>(outputBuffer, outputBuffers, countRendered, MixSoundBuffer, channels, countChunk))
+		{
+			// Floating point output does not need a round trip through fixed point
+			countRendered += countChunk;
+			return;
+		}
+		if(intBuffer.size() < channels * countChunk)
+		{
+			intBuffer.resize(channels * countChunk);
+		}
+		int *mixBuffer = &intBuffer[0];
+		FloatToMonoMix(MixSoundBuffer, mixBuffer, static_cast<uint32>(channels * countChunk), MIXING_SCALEF);
+#endif // MPT_INTMIXER
+
 		if(sampleFormat.IsInt())
 		{
-			dither.Process(MixSoundBuffer, countChunk, channels, sampleFormat.GetBitsPerSample());
+			dither.Process(mixBuffer, countChunk, channels, sampleFormat.GetBitsPerSample());
 		}
 
 		if(outputBuffer)
 		{
-			ConvertInterleavedFixedPointToInterleaved<MIXING_FRACTIONAL_BITS, clipOutput>(outputBuffer + (channels * countRendered), MixSoundBuffer, channels, countChunk);
+			ConvertInterleavedFixedPointToInterleaved<MIXING_FRACTIONAL_BITS, clipOutput>(outputBuffer + (channels * countRendered), mixBuffer, channels, countChunk);
 		}
 		if(outputBuffers)
 		{
@@ -63,7 +116,7 @@ public:
 			{
 				buffers[channel] = outputBuffers[channel] + countRendered;
 			}
-			ConvertInterleavedFixedPointToNonInterleaved<MIXING_FRACTIONAL_BITS, clipOutput>(buffers, MixSoundBuffer, channels, countChunk);
+			ConvertInterleavedFixedPointToNonInterleaved<MIXING_FRACTIONAL_BITS, clipOutput>(buffers, mixBuffer, channels, countChunk);
 		}
 
 		countRendered += countChunk;
@@ -74,13 +127,17 @@ public:
 #ifndef MODPLUG_TRACKER
 
 template<typename Tsample>
-void ApplyGainBeforeConversionIfAppropriate(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk, float gainFactor)
+void ApplyGainBeforeConversionIfAppropriate(mixsample_t *MixSoundBuffer, std::size_t channels, std::size_t countChunk, float gainFactor)
 {
 	// Apply final output gain for non floating point output
+#ifdef MPT_INTMIXER
 	ApplyGain(MixSoundBuffer, channels, countChunk, Util::Round<int32>(gainFactor * (1<<16)));
+#else
+	ApplyGain(MixSoundBuffer, nullptr, 0, channels, countChunk, gainFactor);
+#endif // MPT_INTMIXER
 }
 template<>
-void ApplyGainBeforeConversionIfAppropriate<float>(int * /*MixSoundBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/, float /*gainFactor*/)
+inline void ApplyGainBeforeConversionIfAppropriate<float>(mixsample_t * /*MixSoundBuffer*/, std::size_t /*channels*/, std::size_t /*countChunk*/, float /*gainFactor*/)
 {
 	// nothing
 }
@@ -91,7 +148,7 @@ void ApplyGainAfterConversionIfAppropriate(Tsample * /*buffer*/, Tsample * const
 	// nothing
 }
 template<>
-void ApplyGainAfterConversionIfAppropriate<float>(float *buffer, float * const *buffers, std::size_t countRendered, std::size_t channels, std::size_t countChunk, float gainFactor)
+inline void ApplyGainAfterConversionIfAppropriate<float>(float *buffer, float * const *buffers, std::size_t countRendered, std::size_t channels, std::size_t countChunk, float gainFactor)
 {
 	// Apply final output gain for floating point output after conversion so we do not suffer underflow or clipping
 	ApplyGain(buffer, buffers, countRendered, channels, countChunk, gainFactor);
@@ -114,7 +171,7 @@ public:
 	}
 	virtual ~AudioReadTargetGainBuffer() { }
 public:
-	virtual void DataCallback(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
+	virtual void DataCallback(mixsample_t *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
 	{
 		const std::size_t countRendered = Tbase::GetRenderedCount();
 
@@ -23,11 +23,14 @@
 #include "stdafx.h"
 #include "Sndfile.h"
 #include "MixerLoops.h"
+#include "MixerThreads.h"
 #include <cfloat>	// For FLT_EPSILON
 #ifdef MPT_INTMIXER
 #include "IntMixer.h"
+#include "IntMixerSIMD.h"
 #else
 #include "FloatMixer.h"
+#include "FloatMixerSIMD.h"
 #endif // MPT_INTMIXER
 #include <algorithm>
 
@@ -106,6 +109,48 @@ const MixFuncInterface Functions[5 * 16] =
 #undef BuildMixFuncTable
 
 
+#ifdef ENABLE_SIMD_INTRINSICS
+
+#ifdef MPT_INTMIXER
+// Same as above, but using the vectorized interpolation and mixing functors. Output is identical to the scalar functions.
+#define BuildMixFuncTableRamp(resampling, filter, ramp) \
+	SampleLoopBlock<I8M, resampling<I8M>, filter<I8M>, MixMono ## ramp ## SIMD<I8M> >, \
+	SampleLoopBlock<I16M, resampling<I16M>, filter<I16M>, MixMono ## ramp ## SIMD<I16M> >, \
+	SampleLoopBlock<I8S, resampling<I8S>, filter<I8S>, MixStereo ## ramp ## SIMD<I8S> >, \
+	SampleLoopBlock<I16S, resampling<I16S>, filter<I16S>, MixStereo ## ramp ## SIMD<I16S> >
+#else
+// Same as above, but using the vectorized interpolation functors. The compiler already vectorizes the floating point mixing functors well enough.
+#define BuildMixFuncTableRamp(resampling, filter, ramp) \
+	SampleLoop<I8M, resampling<I8M>, filter<I8M>, MixMono ## ramp<I8M> >, \
+	SampleLoop<I16M, resampling<I16M>, filter<I16M>, MixMono ## ramp<I16M> >, \
+	SampleLoop<I8S, resampling<I8S>, filter<I8S>, MixStereo ## ramp<I8S> >, \
+	SampleLoop<I16S, resampling<I16S>, filter<I16S>, MixStereo ## ramp<I16S> >
+#endif // MPT_INTMIXER
+
+#define BuildMixFuncTableFilter(resampling, filter) \
+	BuildMixFuncTableRamp(resampling, filter, NoRamp), \
+	BuildMixFuncTableRamp(resampling, filter, Ramp)
+
+#define BuildMixFuncTable(resampling) \
+	BuildMixFuncTableFilter(resampling, NoFilter), \
+	BuildMixFuncTableFilter(resampling, ResonantFilter)
+
+const MixFuncInterface FunctionsSIMD[5 * 16] =
+{
+	BuildMixFuncTable(NoInterpolation),				// No SRC
+	BuildMixFuncTable(LinearInterpolation),			// Linear SRC
+	BuildMixFuncTable(FastSincInterpolation),		// Fast Sinc (Cubic Spline) SRC
+	BuildMixFuncTable(PolyphaseInterpolationSIMD),	// Kaiser SRC
+	BuildMixFuncTable(FIRFilterInterpolationSIMD),	// FIR SRC
+};
+
+#undef BuildMixFuncTableRamp
+#undef BuildMixFuncTableFilter
+#undef BuildMixFuncTable
+
+#endif // ENABLE_SIMD_INTRINSICS
+
+
 static forceinline ResamplingIndex ResamplingModeToMixFlags(uint8 resamplingMode)
 //-------------------------------------------------------------------------------
 {
@@ -125,12 +170,12 @@ static forceinline ResamplingIndex ResamplingModeToMixFlags(uint8 resamplingMode
 
 /////////////////////////////////////////////////////////////////////////
 
-// Returns the number of samples (in 16.16 format) that are going to be read from a sample, given a mix buffer length and the channel's playback speed.
+// Returns the number of samples (in 32.32 format) that are going to be read from a sample, given a mix buffer length and the channel's playback speed.
 // Result is negative in case of backwards-playing sample.
-static forceinline int32 BufferLengthToSamples(int32 mixBufferCount, const ModChannel &chn)
+static forceinline int64 BufferLengthToSamples(int32 mixBufferCount, const ModChannel &chn)
 //-----------------------------------------------------------------------------------------
 {
-	return (mixBufferCount * chn.nInc + static_cast<int32>(chn.nPosLo));
+	return (mixBufferCount * chn.nInc + static_cast<int64>(chn.nPosLo));
 }
 
 
@@ -138,7 +183,8 @@ static forceinline int32 BufferLengthToSamples(int32 mixBufferCount, const ModCh
 static forceinline int32 SamplesToBufferLength(int32 numSamples, const ModChannel &chn)
 //-------------------------------------------------------------------------------------
 {
-	return std::max(1, ((numSamples << 16)/* + static_cast<int32>(chn.nPosLo) + 0xFFFF*/) / std::abs(chn.nInc));
+	const int64 inc = chn.nInc < 0 ? -chn.nInc : chn.nInc;
+	return static_cast<int32>(Clamp<int64, int64>((static_cast<int64>(numSamples) << SAMPLEPOS_FRACBITS) / inc, 1, int32_max));
 }
 
 
@@ -147,7 +193,7 @@ static forceinline int32 GetSampleCount(ModChannel &chn, int32 nSamples, bool IT
 //---------------------------------------------------------------------------------------
 {
 	int32 nLoopStart = chn.dwFlags[CHN_LOOP] ? chn.nLoopStart : 0;
-	int32 nInc = chn.nInc;
+	int64 nInc = chn.nInc;
 
 	if ((nSamples <= 0) || (!nInc) || (!chn.nLength)) return 0;
 	// Under zero ?
@@ -156,9 +202,9 @@ static forceinline int32 GetSampleCount(ModChannel &chn, int32 nSamples, bool IT
 		if (nInc < 0)
 		{
 			// Invert loop for bidi loops
-			int32 nDelta = ((nLoopStart - chn.nPos) << 16) - (chn.nPosLo & 0xffff);
-			chn.nPos = nLoopStart + (nDelta >> 16);
-			chn.nPosLo = nDelta & 0xffff;
+			int64 nDelta = (static_cast<int64>(nLoopStart - chn.nPos) << SAMPLEPOS_FRACBITS) - chn.nPosLo;
+			chn.nPos = nLoopStart + static_cast<int32>(nDelta >> SAMPLEPOS_FRACBITS);
+			chn.nPosLo = static_cast<uint32>(nDelta);
 			if (((int32)chn.nPos < nLoopStart) || (chn.nPos >= (nLoopStart+chn.nLength)/2))
 			{
 				chn.nPos = nLoopStart; chn.nPosLo = 0;
@@ -201,9 +247,9 @@ static forceinline int32 GetSampleCount(ModChannel &chn, int32 nSamples, bool IT
 			chn.dwFlags.set(CHN_PINGPONGFLAG);
 			// adjust loop position
 			int32 nDeltaHi = (chn.nPos - chn.nLength);
-			int32 nDeltaLo = 0x10000 - (chn.nPosLo & 0xffff);
-			chn.nPos = chn.nLength - nDeltaHi - (nDeltaLo>>16);
-			chn.nPosLo = nDeltaLo & 0xffff;
+			int64 nDeltaLo = SAMPLEPOS_ONE - chn.nPosLo;
+			chn.nPos = chn.nLength - nDeltaHi - static_cast<int32>(nDeltaLo >> SAMPLEPOS_FRACBITS);
+			chn.nPosLo = static_cast<uint32>(nDeltaLo);
 			// Impulse Tracker's software mixer would put a -2 (instead of -1) in the following line (doesn't happen on a GUS)
 			if ((chn.nPos <= chn.nLoopStart) || (chn.nPos >= chn.nLength)) chn.nPos = chn.nLength - (ITBidiMode ? 2 : 1);
 		} else
@@ -225,58 +271,197 @@ static forceinline int32 GetSampleCount(ModChannel &chn, int32 nSamples, bool IT
 		if ((nPos < 0) || (nInc < 0)) return 0;
 	}
 	if ((nPos < 0) || (nPos >= (int32)chn.nLength)) return 0;
-	int32 nPosLo = (uint16)chn.nPosLo, nSmpCount = nSamples;
+	// With 32.32 positions, the whole chunk can be checked at once without overflowing.
+	const int64 nPosLo = chn.nPosLo;
+	const int64 nPosFull = (static_cast<int64>(nPos) << SAMPLEPOS_FRACBITS) + nPosLo;
+	int64 nSmpCount = nSamples;
 	if (nInc < 0)
 	{
-		int32 nInv = -nInc;
-		int32 maxsamples = 16384 / ((nInv>>16)+1);
-		if (maxsamples < 2) maxsamples = 2;
-		if (nSamples > maxsamples) nSamples = maxsamples;
-		int32 nDeltaHi = (nInv>>16) * (nSamples - 1);
-		int32 nDeltaLo = (nInv&0xffff) * (nSamples - 1);
-		int32 nPosDest = nPos - nDeltaHi + ((nPosLo - nDeltaLo) >> 16);
+		int64 nInv = -nInc;
+		int64 nPosDest = (nPosFull - nInv * (nSamples - 1)) >> SAMPLEPOS_FRACBITS;
 		if (nPosDest < nLoopStart)
 		{
-			nSmpCount = (uint32)(((((int64)nPos - nLoopStart) << 16) + nPosLo - 1) / nInv) + 1;
+			nSmpCount = (((static_cast<int64>(nPos) - nLoopStart) << SAMPLEPOS_FRACBITS) + nPosLo - 1) / nInv + 1;
 		}
 	} else
 	{
-		int32 maxsamples = 16384 / ((nInc>>16)+1);
-		if (maxsamples < 2) maxsamples = 2;
-		if (nSamples > maxsamples) nSamples = maxsamples;
-		int32 nDeltaHi = (nInc>>16) * (nSamples - 1);
-		int32 nDeltaLo = (nInc&0xffff) * (nSamples - 1);
-		int32 nPosDest = nPos + nDeltaHi + ((nPosLo + nDeltaLo)>>16);
+		int64 nPosDest = (nPosFull + nInc * (nSamples - 1)) >> SAMPLEPOS_FRACBITS;
 		if (nPosDest >= (int32)chn.nLength)
 		{
-			nSmpCount = (uint32)(((((int64)chn.nLength - nPos) << 16) - nPosLo - 1) / nInc) + 1;
+			nSmpCount = (((static_cast<int64>(chn.nLength) - nPos) << SAMPLEPOS_FRACBITS) - nPosLo - 1) / nInc + 1;
 		}
 	}
 #ifdef _DEBUG
 	{
-		int32 nDeltaHi = (nInc>>16) * (nSmpCount - 1);
-		int32 nDeltaLo = (nInc&0xffff) * (nSmpCount - 1);
-		int32 nPosDest = nPos + nDeltaHi + ((nPosLo + nDeltaLo)>>16);
+		int64 nPosDest = (nPosFull + nInc * (nSmpCount - 1)) >> SAMPLEPOS_FRACBITS;
 		if ((nPosDest < 0) || (nPosDest > (int32)chn.nLength))
 		{
 			Log("Incorrect delta:\n");
-			Log("nSmpCount=%d: nPos=%5d.x%04X Len=%5d Inc=%2d.x%04X\n",
-				nSmpCount, nPos, nPosLo, chn.nLength, chn.nInc>>16, chn.nInc&0xffff);
+			Log("nSmpCount=%d: nPos=%5d.x%08X Len=%5d Inc=%2d.x%08X\n",
+				static_cast<int32>(nSmpCount), nPos, static_cast<uint32>(nPosLo), chn.nLength, static_cast<int32>(chn.nInc >> SAMPLEPOS_FRACBITS), static_cast<uint32>(chn.nInc));
 			return 0;
 		}
 	}
 #endif
 	if (nSmpCount <= 1) return 1;
 	if (nSmpCount > nSamples) return nSamples;
-	return nSmpCount;
+	return static_cast<int32>(nSmpCount);
+}
+
+// For referenced sample data, find out if the current playback position has to be read from the sample data itself or from its head or tail window.
+// nSmpCount is limited so that the whole chunk is read from the same place.
+static forceinline const int8 *GetExternalSampleRegion(const ModChannel &chn, const ModSample &smp, int32 &nSmpCount)
+//------------------------------------------------------------------------------------------------------------------
+{
+	// The interpolation reads up to InterpolationMaxLookahead sampling points in either direction, see ModSample for the window sizes.
+	const int64 headEnd = InterpolationMaxLookahead;
+	const int64 tailStart = static_cast<int64>(smp.nLength) - (ModSample::externalTailStart - InterpolationMaxLookahead);
+	const int64 pos = chn.nPos;
+	const int64 inc = chn.nInc;
+
+	const int8 *pointer;
+	int64 boundary;	// First position in playback direction that must not be read through pointer
+	if(pos < headEnd)
+	{
+		pointer = static_cast<const int8 *>(smp.GetExternalHead());
+		boundary = inc > 0 ? headEnd : -1;
+	} else if(pos < tailStart)
+	{
+		pointer = static_cast<const int8 *>(smp.pSample);
+		boundary = inc > 0 ? tailStart : headEnd - 1;
+	} else
+	{
+		pointer = static_cast<const int8 *>(smp.GetExternalTail());
+		boundary = inc > 0 ? -1 : tailStart - 1;
+	}
+
+	if(boundary >= 0)
+	{
+		// Number of output samples until boundary is reached
+		int64 count;
+		if(inc > 0)
+			count = ((((boundary - pos) << SAMPLEPOS_FRACBITS) - chn.nPosLo - 1) / inc) + 1;
+		else
+			count = ((((pos - boundary - 1) << SAMPLEPOS_FRACBITS) + chn.nPosLo) / -inc) + 1;
+		if(count < nSmpCount)
+			nSmpCount = static_cast<int32>(std::max<int64>(count, 1));
+	}
+	return pointer;
 }
 
+
+// Returns true if the next nSmpCount output samples of a voice are provably not louder than maxLevel (in fixed point mix scale),
+// according to the peak summary of the sample. In that case, the voice does not have to be mixed.
+static forceinline bool IsVoiceInaudible(const ModChannel &chn, const void *samplePointer, int32 nSmpCount, uint32 maxLevel)
+//-------------------------------------------------------------------------------------------------------------------------
+{
+	const ModSample *smp = chn.pModSample;
+	if(smp == nullptr || samplePointer != smp->pSample)
+	{
+		return false;
+	}
+
+	// Highest volume during this chunk
+	int32 maxVol = std::max(std::abs(chn.leftVol), std::abs(chn.rightVol));
+	if(chn.nRampLength)
+	{
+		const int32 startLeft = chn.rampLeftVol >> VOLUMERAMPPRECISION, startRight = chn.rampRightVol >> VOLUMERAMPPRECISION;
+		const int32 endLeft = (chn.rampLeftVol + chn.leftRamp * nSmpCount) >> VOLUMERAMPPRECISION;
+		const int32 endRight = (chn.rampRightVol + chn.rightRamp * nSmpCount) >> VOLUMERAMPPRECISION;
+		maxVol = std::max(maxVol, std::max(std::max(std::abs(startLeft), std::abs(startRight)), std::max(std::abs(endLeft), std::abs(endRight))));
+	}
+	// Interpolation may overshoot the sampling points a bit, hence the factor 2.
+	uint32 maxPeak = maxVol ? maxLevel / (2 * static_cast<uint32>(maxVol)) : uint16_max;
+#ifndef NO_FILTER
+	if(chn.dwFlags[CHN_FILTER])
+	{
+		// The resonant filter might amplify its input and keeps ringing with silent input, so only skip completely silent filtered voices.
+		if(chn.nFilter_Y[0][0] != 0 || chn.nFilter_Y[0][1] != 0 || chn.nFilter_Y[1][0] != 0 || chn.nFilter_Y[1][1] != 0)
+		{
+			return false;
+		}
+		maxPeak = 0;
+	}
+#endif // NO_FILTER
+
+	// Sampling points read by the interpolation
+	const int64 readLength = BufferLengthToSamples(nSmpCount, chn) >> SAMPLEPOS_FRACBITS;
+	int64 first = chn.nPos, last = chn.nPos + readLength;
+	if(first > last)
+	{
+		std::swap(first, last);
+	}
+	first = std::max<int64>(first - InterpolationMaxLookahead, 0);
+	last = std::min<int64>(last + InterpolationMaxLookahead + 1, uint32_max);
+	if(!smp->IsQuieterThan(static_cast<SmpLength>(first), static_cast<SmpLength>(last), maxPeak))
+	{
+		return false;
+	}
+	// Near the loop end, the loop wrap-around buffer also contains the sampling points at the loop start.
+	if(chn.dwFlags[CHN_LOOP] && last + InterpolationMaxLookahead >= static_cast<int64>(chn.nLoopEnd)
+		&& !smp->IsQuieterThan(chn.nLoopStart, chn.nLoopStart + 2 * InterpolationMaxLookahead, maxPeak))
+	{
+		return false;
+	}
+	return true;
+}
+
+
+// Minimum amount of work for mixing voices in parallel; below that, the synchronisation overhead outweighs the gain.
+enum
+{
+	PARALLEL_MIN_VOICES_PER_THREAD = 2,
+	PARALLEL_MIN_CHUNK_SIZE = 64,
+};
+
+
+// Voices that are mixed by MixVoicesParallel, and the per-thread results that have to be added to the global state afterwards.
+struct ParallelMixJob
+{
+	CSoundFile *sndFile;
+	const CHANNELINDEX *voices;	// Indices into ChnMix
+	uint32 numVoices;
+	int count;
+	mixsample_t ofsR[MixerThreads::maxThreads];
+	mixsample_t ofsL[MixerThreads::maxThreads];
+	CHANNELINDEX numMixed[MixerThreads::maxThreads];
+	uint64 numSkipped[MixerThreads::maxThreads];
+};
+
+
+void CSoundFile::MixVoicesParallel(void *param, uint32 worker)
+//------------------------------------------------------------
+{
+	ParallelMixJob &job = *static_cast<ParallelMixJob *>(param);
+	CSoundFile &sndFile = *job.sndFile;
+	const uint32 numThreads = sndFile.m_MixerThreads->GetNumThreads();
+
+	// The first thread can mix directly into the global buffer, all others use a private buffer.
+	mixsample_t *buffer = sndFile.MixSoundBuffer;
+	if(worker != 0)
+	{
+		buffer = sndFile.m_MixerThreads->GetBuffer(worker);
+		InitMixBuffer(buffer, job.count * 2);
+	}
+
+	job.ofsR[worker] = job.ofsL[worker] = 0;
+	job.numMixed[worker] = 0;
+	job.numSkipped[worker] = 0;
+	for(uint32 i = worker; i < job.numVoices; i += numThreads)
+	{
+		ModChannel &chn = sndFile.m_PlayState.Chn[sndFile.m_PlayState.ChnMix[job.voices[i]]];
+		if(sndFile.MixVoice(chn, buffer, job.count, job.ofsR[worker], job.ofsL[worker], job.numSkipped[worker], false))
+		{
+			job.numMixed[worker]++;
+		}
+	}
+}
+
+
 // Render count * number of channels samples
 void CSoundFile::CreateStereoMix(int count)
 //-----------------------------------------
 {
-	mixsample_t *pOfsL, *pOfsR;
-
 	if (!count) return;
 
 	// Resetting sound buffer
@@ -285,39 +470,38 @@ void CSoundFile::CreateStereoMix(int count)
 
 	CHANNELINDEX nchmixed = 0;
 
-	const bool ITPingPongMode = IsITPingPongMode();
 	const bool realtimeMix = !IsRenderingToDisc();
 
+	// Voices that go straight into the dry mix buffer can be mixed in parallel, as long as no voice can be skipped because of the channel limit
+	// (which depends on the mixing order). Private buffers are added up afterwards, so the output is identical to serial mixing.
+#ifdef MPT_INTMIXER
+	const bool canMixParallel = m_MixerThreads && m_MixerThreads->GetNumThreads() > 1 && count >= PARALLEL_MIN_CHUNK_SIZE
+		&& (!realtimeMix || m_nMixChannels <= m_MixerSettings.m_nMaxMixChannels);
+#else
+	// Floating point addition is not associative, so the result would depend on how the voices are distributed.
+	const bool canMixParallel = false;
+#endif
+	CHANNELINDEX parallelVoices[MAX_CHANNELS];
+	CHANNELINDEX numParallelVoices = 0;
+
 	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
 	{
 		ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
-		uint32 functionNdx = 0;
 
 		if(!chn.pCurrentSample) continue;
-		pOfsR = &gnDryROfsVol;
-		pOfsL = &gnDryLOfsVol;
-		if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
-		if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
-	#ifndef NO_FILTER
-		if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
-	#endif
-
-		const MixFuncTable::ResamplingIndex resamplingMode = MixFuncTable::ResamplingModeToMixFlags(chn.resamplingMode);
-		functionNdx |= resamplingMode;
+		mixsample_t *pOfsR = &gnDryROfsVol;
+		mixsample_t *pOfsL = &gnDryLOfsVol;
 
 		mixsample_t *pbuffer = MixSoundBuffer;
 #ifndef NO_REVERB
-#ifdef ENABLE_MMX
-		if(GetProcSupport() & PROCSUPPORT_MMX)
+		// S99 forces reverb on a channel even if the global reverb is disabled, as it always did in OpenMPT. CReverb::Process() is
+		// always called, so the send buffer is processed whenever it was filled here.
+		if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
 		{
-			if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
-			{
-				pbuffer = m_Reverb.GetReverbSendBuffer(count);
-				pOfsR = &m_Reverb.gnRvbROfsVol;
-				pOfsL = &m_Reverb.gnRvbLOfsVol;
-			}
+			pbuffer = m_Reverb.GetReverbSendBuffer(count);
+			pOfsR = &m_Reverb.gnRvbROfsVol;
+			pOfsL = &m_Reverb.gnRvbLOfsVol;
 		}
-#endif
 #endif
 		if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
 			pbuffer = MixRearBuffer;
@@ -342,163 +526,274 @@ void CSoundFile::CreateStereoMix(int count)
 			}
 		}
 
-		// Calculate offset of loop wrap-around buffer for this sample.
-		const int8 * const samplePointer = static_cast<const int8 *>(chn.pCurrentSample);
-		const int8 * lookaheadPointer = nullptr;
-		const SmpLength lookaheadStart = chn.nLoopEnd - InterpolationMaxLookahead;
-		// We only need to apply the loop wrap-around logic if the sample is actually looping and if interpolation is applied.
-		// If there is no interpolation happening, there is no lookahead happening the sample read-out is exact.
-		if(chn.dwFlags[CHN_LOOP] && resamplingMode != MixFuncTable::ndxNoInterpolation)
+		if(canMixParallel && pbuffer == MixSoundBuffer)
 		{
-			const bool loopEndsAtSampleEnd = chn.pModSample->uFlags[CHN_LOOP] && chn.pModSample->nLoopEnd == chn.pModSample->nLength;
-			const bool inSustainLoop = chn.InSustainLoop();
+			parallelVoices[numParallelVoices++] = static_cast<CHANNELINDEX>(nChn);
+			continue;
+		}
 
-			// Do not enable wraparound magic if we're previewing a custom loop!
-			if(inSustainLoop || chn.nLoopEnd == chn.pModSample->nLoopEnd)
-			{
-				SmpLength lookaheadOffset = (loopEndsAtSampleEnd ? 0 : (3 * InterpolationMaxLookahead)) + chn.pModSample->nLength - chn.nLoopEnd;
-				if(inSustainLoop)
-				{
-					lookaheadOffset += 4 * InterpolationMaxLookahead;
-				}
-				lookaheadPointer = samplePointer + lookaheadOffset * chn.pModSample->GetBytesPerSample();
-			}
+		const bool naddmix = MixVoice(chn, pbuffer, count, *pOfsR, *pOfsL, m_nSkippedVoiceFrames, nchmixed >= m_MixerSettings.m_nMaxMixChannels && realtimeMix);
+		if(naddmix)
+		{
+			nchmixed++;
+		}
+	
+		if(naddmix && nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixState)
+		{
+			m_MixPlugins[nMixPlugin - 1].pMixState->ResetSilence();
 		}
+	}
 
-		////////////////////////////////////////////////////
-		CHANNELINDEX naddmix = 0;
-		int nsamples = count;
-		// Keep mixing this sample until the buffer is filled.
-		do
+	if(numParallelVoices > 0 && numParallelVoices >= PARALLEL_MIN_VOICES_PER_THREAD * m_MixerThreads->GetNumThreads())
+	{
+		ParallelMixJob job;
+		job.sndFile = this;
+		job.voices = parallelVoices;
+		job.numVoices = numParallelVoices;
+		job.count = count;
+		m_MixerThreads->Run(MixVoicesParallel, &job);
+
+		// Deterministic reduction: Integer addition does not depend on the order in which the voices were mixed.
+		gnDryROfsVol += job.ofsR[0];
+		gnDryLOfsVol += job.ofsL[0];
+		nchmixed += job.numMixed[0];
+		m_nSkippedVoiceFrames += job.numSkipped[0];
+		for(uint32 worker = 1; worker < m_MixerThreads->GetNumThreads(); worker++)
 		{
-			uint32 nrampsamples = nsamples;
-			int32 nSmpCount;
-			if(chn.nRampLength > 0)
+			const mixsample_t *buffer = m_MixerThreads->GetBuffer(worker);
+			for(int i = 0; i < count * 2; i++)
 			{
-				if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
+				MixSoundBuffer[i] += buffer[i];
 			}
-
-			if((nSmpCount = GetSampleCount(chn, nrampsamples, ITPingPongMode)) <= 0)
+			gnDryROfsVol += job.ofsR[worker];
+			gnDryLOfsVol += job.ofsL[worker];
+			nchmixed += job.numMixed[worker];
+			m_nSkippedVoiceFrames += job.numSkipped[worker];
+		}
+	} else
+	{
+		// Not worth the effort
+		for(CHANNELINDEX i = 0; i < numParallelVoices; i++)
+		{
+			ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[parallelVoices[i]]];
+			if(MixVoice(chn, MixSoundBuffer, count, gnDryROfsVol, gnDryLOfsVol, m_nSkippedVoiceFrames, false))
 			{
-				// Stopping the channel
-				chn.pCurrentSample = nullptr;
-				chn.nLength = 0;
-				chn.nPos = 0;
-				chn.nPosLo = 0;
-				chn.nRampLength = 0;
-				EndChannelOfs(chn, pbuffer, nsamples);
-				*pOfsR += chn.nROfs;
-				*pOfsL += chn.nLOfs;
-				chn.nROfs = chn.nLOfs = 0;
-				chn.dwFlags.reset(CHN_PINGPONGFLAG);
-				break;
+				nchmixed++;
 			}
+		}
+	}
 
-			// Should we mix this channel ?
-			if((nchmixed >= m_MixerSettings.m_nMaxMixChannels && realtimeMix)	// Too many channels
-				|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))			// Channel is completely silent
-			{
-				int32 delta = BufferLengthToSamples(nSmpCount, chn);
-				chn.nPosLo = delta & 0xFFFF;
-				chn.nPos += (delta >> 16);
-				chn.nROfs = chn.nLOfs = 0;
-				pbuffer += nSmpCount * 2;
-				naddmix = 0;
-			} else
-			{
-				// Do mixing
+	m_nMixStat = std::max<CHANNELINDEX>(m_nMixStat, nchmixed);
+#ifndef NO_PERFCOUNTERS
+	m_PerfCounters.voicesMixed += nchmixed;
+#endif // NO_PERFCOUNTERS
+}
 
-				// Loop wrap-around magic.
-				if(lookaheadPointer != nullptr)
-				{
-					const int32 readLength = BufferLengthToSamples(nSmpCount, chn) >> 16;
-					
-					chn.pCurrentSample = samplePointer;
-					if(chn.nPos >= lookaheadStart)
-					{
-						const int32 oldCount = nSmpCount;
-
-						// When going backwards - we can only go back up to lookaheadStart.
-						// When going forwards - read through the whole pre-computed wrap-around buffer if possible.
-						const int32 samplesToRead = chn.nInc < 0
-							? (chn.nPos - lookaheadStart)
-							: 2 * InterpolationMaxLookahead - (chn.nPos - lookaheadStart);
-						nSmpCount = SamplesToBufferLength(samplesToRead, chn);
-						Limit(nSmpCount, 1, oldCount);
-						chn.pCurrentSample = lookaheadPointer;
-					} else if(chn.nInc > 0 && chn.nPos + readLength >= lookaheadStart && nSmpCount > 1)
-					{
-						// We shouldn't read that far if we're not using the pre-computed wrap-around buffer.
-						const int32 oldCount = nSmpCount;
-						nSmpCount = SamplesToBufferLength(lookaheadStart - chn.nPos, chn);
-						Limit(nSmpCount, 1, oldCount - 1);
-					}
-				}
 
+// Mix count sampling points of a voice into pbuffer. Volume offsets of voices that stop playing are added to ofsR / ofsL.
+// If skipMixing is true, the sample position is advanced without actually mixing anything.
+// Returns true if the voice was actually mixed.
+bool CSoundFile::MixVoice(ModChannel &chn, mixsample_t *pbuffer, int count, mixsample_t &ofsR, mixsample_t &ofsL, uint64 &skippedFrames, bool skipMixing)
+//-----------------------------------------------------------------------------------------------------------------------------------------------------
+{
+	const bool ITPingPongMode = IsITPingPongMode();
+	const bool skipInaudible = !(m_MixerSettings.MixerFlags & SNDMIX_NOVOICESKIP);
+
+	const MixFuncInterface *mixFunctions = MixFuncTable::Functions;
+#ifdef ENABLE_SIMD_INTRINSICS
+	if(!(m_MixerSettings.MixerFlags & SNDMIX_NOSIMD) && HasSIMDIntrinsicsSupport())
+	{
+		mixFunctions = MixFuncTable::FunctionsSIMD;
+	}
+#endif
+
+	uint32 functionNdx = 0;
+	if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
+	if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
+#ifndef NO_FILTER
+	if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
+#endif
+
+	const MixFuncTable::ResamplingIndex resamplingMode = MixFuncTable::ResamplingModeToMixFlags(chn.resamplingMode);
+	functionNdx |= resamplingMode;
+
+	// Calculate offset of loop wrap-around buffer for this sample.
+	const int8 * const samplePointer = static_cast<const int8 *>(chn.pCurrentSample);
+	const int8 * lookaheadPointer = nullptr;
+	// Referenced sample data has no lookahead around it, so the sample start and end are read from the head and tail windows of a separate buffer.
+	const ModSample * const externalSample = (chn.pModSample != nullptr && chn.pModSample->IsReferenced() && samplePointer == chn.pModSample->pSample) ? chn.pModSample : nullptr;
+	const int8 * const lookaheadBase = externalSample != nullptr ? static_cast<const int8 *>(externalSample->GetExternalTail()) : samplePointer;
+	const SmpLength lookaheadStart = chn.nLoopEnd - InterpolationMaxLookahead;
+	// We only need to apply the loop wrap-around logic if the sample is actually looping and if interpolation is applied.
+	// If there is no interpolation happening, there is no lookahead happening the sample read-out is exact.
+	if(chn.dwFlags[CHN_LOOP] && resamplingMode != MixFuncTable::ndxNoInterpolation)
+	{
+		const bool loopEndsAtSampleEnd = chn.pModSample->uFlags[CHN_LOOP] && chn.pModSample->nLoopEnd == chn.pModSample->nLength;
+		const bool inSustainLoop = chn.InSustainLoop();
 
-				mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
-				chn.nROfs = - *(pbufmax-2);
-				chn.nLOfs = - *(pbufmax-1);
+		// Do not enable wraparound magic if we're previewing a custom loop!
+		if(inSustainLoop || chn.nLoopEnd == chn.pModSample->nLoopEnd)
+		{
+			SmpLength lookaheadOffset = (loopEndsAtSampleEnd ? 0 : (3 * InterpolationMaxLookahead)) + chn.pModSample->nLength - chn.nLoopEnd;
+			if(inSustainLoop)
+			{
+				lookaheadOffset += 4 * InterpolationMaxLookahead;
+			}
+			lookaheadPointer = lookaheadBase + lookaheadOffset * chn.pModSample->GetBytesPerSample();
+		}
+	}
+
+	////////////////////////////////////////////////////
+	bool naddmix = false;
+	int nsamples = count;
+	// Keep mixing this sample until the buffer is filled.
+	do
+	{
+		uint32 nrampsamples = nsamples;
+		int32 nSmpCount;
+		if(chn.nRampLength > 0)
+		{
+			if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
+		}
 
-				uint32 targetpos = chn.nPos + (BufferLengthToSamples(nSmpCount, chn) >> 16);
-				MixFuncTable::Functions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
-				ASSERT(chn.nPos == targetpos);
+		if((nSmpCount = GetSampleCount(chn, nrampsamples, ITPingPongMode)) <= 0)
+		{
+			// Stopping the channel
+			chn.pCurrentSample = nullptr;
+			chn.nLength = 0;
+			chn.nPos = 0;
+			chn.nPosLo = 0;
+			chn.nRampLength = 0;
+			EndChannelOfs(chn, pbuffer, nsamples);
+			ofsR += chn.nROfs;
+			ofsL += chn.nLOfs;
+			chn.nROfs = chn.nLOfs = 0;
+			chn.dwFlags.reset(CHN_PINGPONGFLAG);
+			break;
+		}
 
-				chn.nROfs += *(pbufmax-2);
-				chn.nLOfs += *(pbufmax-1);
-				pbuffer = pbufmax;
-				naddmix = 1;
+		// Should we mix this channel ?
+		if(skipMixing	// Too many channels
+			|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))			// Channel is completely silent
+		{
+			int64 delta = BufferLengthToSamples(nSmpCount, chn);
+			chn.nPosLo = static_cast<uint32>(delta);
+			chn.nPos += static_cast<int32>(delta >> SAMPLEPOS_FRACBITS);
+			chn.nROfs = chn.nLOfs = 0;
+			pbuffer += nSmpCount * 2;
+			naddmix = false;
+		} else if(skipInaudible && IsVoiceInaudible(chn, samplePointer, nSmpCount, m_nVoiceSkipLevel))
+		{
+			// Sample data is silent (or too quiet to be heard): Only advance position and volume ramp like the mixer would
+			int64 delta = BufferLengthToSamples(nSmpCount, chn);
+			chn.nPosLo = static_cast<uint32>(delta);
+			chn.nPos += static_cast<int32>(delta >> SAMPLEPOS_FRACBITS);
+			if(chn.nRampLength)
+			{
+				chn.rampLeftVol += chn.leftRamp * nSmpCount;
+				chn.rampRightVol += chn.rightRamp * nSmpCount;
+				chn.leftVol = chn.rampLeftVol >> VOLUMERAMPPRECISION;
+				chn.rightVol = chn.rampRightVol >> VOLUMERAMPPRECISION;
 			}
-			nsamples -= nSmpCount;
-			if (chn.nRampLength)
+			chn.nROfs = chn.nLOfs = 0;
+			pbuffer += nSmpCount * 2;
+			skippedFrames += nSmpCount;
+			naddmix = false;
+		} else
+		{
+			// Do mixing
+
+			const int8 *currentPointer = samplePointer;
+			if(externalSample != nullptr)
 			{
-				if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
+				currentPointer = GetExternalSampleRegion(chn, *externalSample, nSmpCount);
+				chn.pCurrentSample = currentPointer;
+			}
+
+			// Loop wrap-around magic.
+			if(lookaheadPointer != nullptr)
+			{
+				const int32 readLength = static_cast<int32>(BufferLengthToSamples(nSmpCount, chn) >> SAMPLEPOS_FRACBITS);
+				
+				chn.pCurrentSample = currentPointer;
+				if(chn.nPos >= lookaheadStart)
 				{
-					// Ramping is done
-					chn.nRampLength = 0;
-					chn.leftVol = chn.newLeftVol;
-					chn.rightVol = chn.newRightVol;
-					chn.rightRamp = chn.leftRamp = 0;
-					if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
-					{
-						chn.nLength = 0;
-						chn.pCurrentSample = nullptr;
-					}
-				} else
+					const int32 oldCount = nSmpCount;
+
+					// When going backwards - we can only go back up to lookaheadStart.
+					// When going forwards - read through the whole pre-computed wrap-around buffer if possible.
+					const int32 samplesToRead = chn.nInc < 0
+						? (chn.nPos - lookaheadStart)
+						: 2 * InterpolationMaxLookahead - (chn.nPos - lookaheadStart);
+					nSmpCount = SamplesToBufferLength(samplesToRead, chn);
+					Limit(nSmpCount, 1, oldCount);
+					chn.pCurrentSample = lookaheadPointer;
+				} else if(chn.nInc > 0 && chn.nPos + readLength >= lookaheadStart && nSmpCount > 1)
 				{
-					chn.nRampLength -= nSmpCount;
+					// We shouldn't read that far if we're not using the pre-computed wrap-around buffer.
+					const int32 oldCount = nSmpCount;
+					nSmpCount = SamplesToBufferLength(lookaheadStart - chn.nPos, chn);
+					Limit(nSmpCount, 1, oldCount - 1);
 				}
 			}
 
-			// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
-			// Test case: PTInstrSwap.mod
-			if(m_SongFlags[SONG_PT1XMODE] && chn.nPos >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns])
+
+			mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
+			chn.nROfs = - *(pbufmax-2);
+			chn.nLOfs = - *(pbufmax-1);
+
+			uint32 targetpos = chn.nPos + static_cast<int32>(BufferLengthToSamples(nSmpCount, chn) >> SAMPLEPOS_FRACBITS);
+			mixFunctions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
+			ASSERT(chn.nPos == targetpos);
+
+			chn.nROfs += *(pbufmax-2);
+			chn.nLOfs += *(pbufmax-1);
+			pbuffer = pbufmax;
+			naddmix = true;
+		}
+		nsamples -= nSmpCount;
+		if (chn.nRampLength)
+		{
+			if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
 			{
-				const ModSample &smp = Samples[chn.nNewIns];
-				chn.pModSample = &smp;
-				chn.pCurrentSample = smp.pSample;
-				chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
-				chn.nLoopStart = smp.nLoopStart;
-				chn.nLoopEnd = smp.nLoopEnd;
-				chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : smp.nLength;
-				chn.nPos = chn.nLoopStart;
-				if(!chn.pCurrentSample)
+				// Ramping is done
+				chn.nRampLength = 0;
+				chn.leftVol = chn.newLeftVol;
+				chn.rightVol = chn.newRightVol;
+				chn.rightRamp = chn.leftRamp = 0;
+				if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
 				{
-					break;
+					chn.nLength = 0;
+					chn.pCurrentSample = nullptr;
 				}
+			} else
+			{
+				chn.nRampLength -= nSmpCount;
 			}
-		} while(nsamples > 0);
+		}
 
-		// Restore sample pointer in case it got changed through loop wrap-around
-		chn.pCurrentSample = samplePointer;
-		nchmixed += naddmix;
-	
-		if(naddmix && nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixState)
+		// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
+		// Test case: PTInstrSwap.mod
+		if(m_SongFlags[SONG_PT1XMODE] && chn.nPos >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns])
 		{
-			m_MixPlugins[nMixPlugin - 1].pMixState->ResetSilence();
+			const ModSample &smp = Samples[chn.nNewIns];
+			chn.pModSample = &smp;
+			chn.pCurrentSample = smp.pSample;
+			chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
+			chn.nLoopStart = smp.nLoopStart;
+			chn.nLoopEnd = smp.nLoopEnd;
+			chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : smp.nLength;
+			chn.nPos = chn.nLoopStart;
+			if(!chn.pCurrentSample)
+			{
+				break;
+			}
 		}
-	}
-	m_nMixStat = std::max<CHANNELINDEX>(m_nMixStat, nchmixed);
+	} while(nsamples > 0);
+
+	// Restore sample pointer in case it got changed through loop wrap-around
+	chn.pCurrentSample = samplePointer;
+	return naddmix;
 }
 
 
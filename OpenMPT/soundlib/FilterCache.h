@@ -0,0 +1,88 @@
+/*
+ * FilterCache.h
+ * -------------
+ * Purpose: Lookup table for resonant filter coefficients, so that they don't have to be calculated again every time a channel's filter changes.
+ * Notes  : The table is filled on demand by CSoundFile::SetupChannelFilter(), see Snd_flt.cpp.
+ *          Entries are allocated per resonance value, as most modules only use a few of them.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+//===============
+class FilterCache
+//===============
+{
+public:
+
+	// Filter formulas with different coefficients for the same parameters
+	enum Mode
+	{
+		modeIT = 0,			// Impulse Tracker filter, indexed by computed cutoff (0...254)
+		modeNormalRange,	// Non-IT filter, indexed by cutoff (0...127)
+		modeExtendedRange,	// Non-IT filter with extended filter range, indexed by cutoff (0...127)
+		numModes
+	};
+
+	enum
+	{
+		numCutoffs = 255,
+		numResonances = 128,
+	};
+
+	// Lowpass coefficients (the highpass A0 coefficient is derived from fg)
+	struct Coefficients
+	{
+		float fg, fb0, fb1;
+		bool valid;
+
+		Coefficients() : fg(0.0f), fb0(0.0f), fb1(0.0f), valid(false) { }
+	};
+
+	FilterCache() : mixingFreq(0) { }
+
+	// Forget all coefficients and release the memory.
+	void Clear()
+	{
+		for(size_t mode = 0; mode < numModes; mode++)
+		{
+			for(size_t res = 0; res < numResonances; res++)
+			{
+				std::vector<Coefficients>().swap(entries[mode][res]);
+			}
+		}
+		mixingFreq = 0;
+	}
+
+	// Get the table entry for the given parameters. If it is not valid yet, the caller has to fill it in.
+	// The table is cleared if the mixing frequency changed since the last call.
+	Coefficients &Get(Mode mode, int cutoff, int resonance, uint32 freq)
+	{
+		if(freq != mixingFreq)
+		{
+			Clear();
+			mixingFreq = freq;
+		}
+		std::vector<Coefficients> &row = entries[mode][resonance];
+		if(row.empty())
+		{
+			row.resize(numCutoffs);
+		}
+		return row[cutoff];
+	}
+
+protected:
+	std::vector<Coefficients> entries[numModes][numResonances];
+	// Mixing frequency the coefficients were calculated for
+	uint32 mixingFreq;
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -19,11 +19,14 @@ OPENMPT_NAMESPACE_BEGIN
 template<int channelsOut, int channelsIn, typename out, typename in, int int2float>
 struct IntToFloatTraits : public MixerTraits<channelsOut, channelsIn, out, in>
 {
-	static_assert(std::numeric_limits<input_t>::is_integer, "Input must be integer");
-	static_assert(!std::numeric_limits<output_t>::is_integer, "Output must be floating point");
+	typedef MixerTraits<channelsOut, channelsIn, out, in> base_t;
+	typedef typename base_t::input_t input_t;
+	typedef typename base_t::output_t output_t;
 
 	static forceinline output_t Convert(const input_t x)
 	{
+		static_assert(std::numeric_limits<input_t>::is_integer, "Input must be integer");
+		static_assert(!std::numeric_limits<output_t>::is_integer, "Output must be floating point");
 		return static_cast<output_t>(x) * (static_cast<output_t>(1.0f) / static_cast<output_t>(int2float));
 	}
 };
@@ -40,19 +43,24 @@ typedef IntToFloatTraits<2, 2, mixsample_t, int16, -int16_min> Int16SToFloatS;
 template<class Traits>
 struct LinearInterpolation
 {
-	forceinline void Start(const ModChannel &, const CResampler &) { }
+	const typename Traits::output_t *linearTable;
+
+	forceinline void Start(const ModChannel &, const CResampler &resampler)
+	{
+		linearTable = resampler.LinearTablef;
+	}
 
 	forceinline void End(const ModChannel &) { }
 
 	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
 	{
 		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
-		const Traits::output_t fract = CResampler::LinearTablef[posLo >> 8];
+		const typename Traits::output_t fract = linearTable[posLo >> 8];
 
 		for(int i = 0; i < Traits::numChannelsIn; i++)
 		{
-			Traits::output_t srcVol = Traits::Convert(inBuffer[i]);
-			Traits::output_t destVol = Traits::Convert(inBuffer[i + Traits::numChannelsIn]);
+			typename Traits::output_t srcVol = Traits::Convert(inBuffer[i]);
+			typename Traits::output_t destVol = Traits::Convert(inBuffer[i + Traits::numChannelsIn]);
 
 			outSample[i] = srcVol + fract * (destVol - srcVol);
 		}
@@ -63,13 +71,19 @@ struct LinearInterpolation
 template<class Traits>
 struct FastSincInterpolation
 {
-	forceinline void Start(const ModChannel &, const CResampler &) { }
+	const typename Traits::output_t *fastSincTable;
+
+	forceinline void Start(const ModChannel &, const CResampler &resampler)
+	{
+		fastSincTable = resampler.FastSincTablef;
+	}
+
 	forceinline void End(const ModChannel &) { }
 
 	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
 	{
 		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
-		const Traits::output_t *lut = CResampler::FastSincTablef + ((posLo >> 6) & 0x3FC);
+		const typename Traits::output_t *lut = fastSincTable + ((posLo >> 6) & 0x3FC);
 
 		for(int i = 0; i < Traits::numChannelsIn; i++)
 		{
@@ -90,8 +104,9 @@ struct PolyphaseInterpolation
 
 	forceinline void Start(const ModChannel &chn, const CResampler &resampler)
 	{
-		sinc = (((chn.nInc > 0x13000) || (chn.nInc < -0x13000)) ?
-			(((chn.nInc > 0x18000) || (chn.nInc < -0x18000)) ? resampler.gDownsample2x : resampler.gDownsample13x) : resampler.gKaiserSinc);
+		// Switch to the downsampling filters above 1.1875x / 1.5x speed
+		sinc = (((chn.nInc > SAMPLEPOS_ONE * 0x13 / 0x10) || (chn.nInc < -SAMPLEPOS_ONE * 0x13 / 0x10)) ?
+			(((chn.nInc > SAMPLEPOS_ONE * 0x18 / 0x10) || (chn.nInc < -SAMPLEPOS_ONE * 0x18 / 0x10)) ? resampler.gDownsample2x : resampler.gDownsample13x) : resampler.gKaiserSinc);
 	}
 
 	forceinline void End(const ModChannel &) { }
@@ -99,7 +114,7 @@ struct PolyphaseInterpolation
 	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
 	{
 		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
-		const Traits::output_t *lut = sinc + ((posLo >> (16 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+		const typename Traits::output_t *lut = sinc + ((posLo >> (16 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
 
 		for(int i = 0; i < Traits::numChannelsIn; i++)
 		{
@@ -124,7 +139,7 @@ struct FIRFilterInterpolation
 
 	forceinline void Start(const ModChannel &, const CResampler &resampler)
 	{
-		WFIRlut = resampler.m_WindowedFIR.lut;
+		WFIRlut = resampler.WFIRlut;
 	}
 
 	forceinline void End(const ModChannel &) { }
@@ -132,7 +147,7 @@ struct FIRFilterInterpolation
 	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
 	{
 		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
-		const Traits::output_t * const lut = WFIRlut + (((posLo + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+		const typename Traits::output_t * const lut = WFIRlut + (((posLo + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
 
 		for(int i = 0; i < Traits::numChannelsIn; i++)
 		{
@@ -160,8 +175,8 @@ struct NoRamp
 
 	forceinline void Start(const ModChannel &chn)
 	{
-		lVol = static_cast<Traits::output_t>(chn.leftVol) * (1.0f / 4096.0f);
-		rVol = static_cast<Traits::output_t>(chn.rightVol) * (1.0f / 4096.0f);
+		lVol = static_cast<typename Traits::output_t>(chn.leftVol) * (1.0f / 4096.0f);
+		rVol = static_cast<typename Traits::output_t>(chn.rightVol) * (1.0f / 4096.0f);
 	}
 
 	forceinline void End(const ModChannel &) { }
@@ -190,9 +205,10 @@ struct Ramp
 template<class Traits>
 struct MixMonoFastNoRamp : public NoRamp<Traits>
 {
-	forceinline void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &chn, typename Traits::output_t * const outBuffer)
+	typedef NoRamp<Traits> base_t;
+	forceinline void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &, typename Traits::output_t * const outBuffer)
 	{
-		Traits::output_t vol = outSample[0] * lVol;
+		typename Traits::output_t vol = outSample[0] * base_t::lVol;
 		for(int i = 0; i < Traits::numChannelsOut; i++)
 		{
 			outBuffer[i] += vol;
@@ -204,10 +220,11 @@ struct MixMonoFastNoRamp : public NoRamp<Traits>
 template<class Traits>
 struct MixMonoNoRamp : public NoRamp<Traits>
 {
+	typedef NoRamp<Traits> base_t;
 	forceinline void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &, typename Traits::output_t * const outBuffer)
 	{
-		outBuffer[0] += outSample[0] * lVol;
-		outBuffer[1] += outSample[0] * rVol;
+		outBuffer[0] += outSample[0] * base_t::lVol;
+		outBuffer[1] += outSample[0] * base_t::rVol;
 	}
 };
 
@@ -229,10 +246,11 @@ struct MixMonoRamp : public Ramp
 template<class Traits>
 struct MixStereoNoRamp : public NoRamp<Traits>
 {
+	typedef NoRamp<Traits> base_t;
 	forceinline void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &, typename Traits::output_t * const outBuffer)
 	{
-		outBuffer[0] += outSample[0] * lVol;
-		outBuffer[1] += outSample[1] * rVol;
+		outBuffer[0] += outSample[0] * base_t::lVol;
+		outBuffer[1] += outSample[1] * base_t::rVol;
 	}
 };
 
@@ -291,7 +309,7 @@ struct ResonantFilter
 	}
 
 	// Filter values are clipped to double the input range
-#define ClipFilter(x) Clamp(x, static_cast<Traits::output_t>(-2.0f), static_cast<Traits::output_t>(2.0f))
+#define ClipFilter(x) Clamp(x, static_cast<typename Traits::output_t>(-2.0f), static_cast<typename Traits::output_t>(2.0f))
 
 	forceinline void operator() (typename Traits::outbuf_t &outSample, const ModChannel &chn)
 	{
@@ -299,7 +317,7 @@ struct ResonantFilter
 
 		for(int i = 0; i < Traits::numChannelsIn; i++)
 		{
-			Traits::output_t val = outSample[i] * chn.nFilter_A0 + ClipFilter(fy[i][0]) * chn.nFilter_B0 + ClipFilter(fy[i][1]) * chn.nFilter_B1;
+			typename Traits::output_t val = outSample[i] * chn.nFilter_A0 + ClipFilter(fy[i][0]) * chn.nFilter_B0 + ClipFilter(fy[i][1]) * chn.nFilter_B1;
 			fy[i][1] = fy[i][0];
 			fy[i][0] = val - (outSample[i] * chn.nFilter_HP);
 			outSample[i] = val;
@@ -0,0 +1,104 @@
+/*
+ * FloatMixerSIMD.h
+ * ----------------
+ * Purpose: Vectorized floating point mixer classes (SSE2 / NEON compiler intrinsics)
+ * Notes  : Unlike the fixed point versions, these functors sum up the products in a different order than
+ *          their scalar counterparts in FloatMixer.h, so the output differs in the last bits of the mantissa.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "FloatMixer.h"
+#include "MixerSIMD.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+#ifdef ENABLE_SIMD_INTRINSICS
+
+
+//////////////////////////////////////////////////////////////////////////
+// Vector primitives
+
+// The tap loaders return 16-bit values, scale them back to [-1, 1]
+#define SIMD_TAPSCALEF (1.0f / 32768.0f)
+
+#if defined(ENABLE_SSE2_INTRINSICS)
+
+// Sum of all eight products
+static forceinline float SIMD_DotProduct8f(simd_taps_t x, const float *coeffs)
+{
+	const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+	const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+	__m128 sum = _mm_add_ps(_mm_mul_ps(lo, _mm_loadu_ps(coeffs)), _mm_mul_ps(hi, _mm_loadu_ps(coeffs + 4)));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(sum);
+}
+
+#elif defined(ENABLE_NEON_INTRINSICS)
+
+// Sum of all eight products
+static forceinline float SIMD_DotProduct8f(simd_taps_t x, const float *coeffs)
+{
+	float32x4_t sum = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), vld1q_f32(coeffs));
+	sum = vmlaq_f32(sum, vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), vld1q_f32(coeffs + 4));
+	const float32x2_t sum2 = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+	return vget_lane_f32(vpadd_f32(sum2, sum2), 0);
+}
+
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interpolation templates
+
+template<class Traits>
+struct PolyphaseInterpolationSIMD : public PolyphaseInterpolation<Traits>
+{
+	typedef PolyphaseInterpolation<Traits> base_t;
+
+	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
+	{
+		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
+		const SINC_TYPE *lut = base_t::sinc + ((posLo >> (16 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+
+		simd_taps_t taps[Traits::numChannelsIn];
+		SIMDTapLoader<Traits::numChannelsIn, typename Traits::input_t>::Load(taps, inBuffer);
+
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			outSample[i] = SIMD_DotProduct8f(taps[i], lut) * SIMD_TAPSCALEF;
+		}
+	}
+};
+
+
+template<class Traits>
+struct FIRFilterInterpolationSIMD : public FIRFilterInterpolation<Traits>
+{
+	typedef FIRFilterInterpolation<Traits> base_t;
+
+	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
+	{
+		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
+		const WFIR_TYPE * const lut = base_t::WFIRlut + (((posLo + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+
+		simd_taps_t taps[Traits::numChannelsIn];
+		SIMDTapLoader<Traits::numChannelsIn, typename Traits::input_t>::Load(taps, inBuffer);
+
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			outSample[i] = SIMD_DotProduct8f(taps[i], lut) * SIMD_TAPSCALEF;
+		}
+	}
+};
+
+#undef SIMD_TAPSCALEF
+
+
+#endif // ENABLE_SIMD_INTRINSICS
+
+OPENMPT_NAMESPACE_END
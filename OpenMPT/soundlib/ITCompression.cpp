@@ -322,22 +322,48 @@ ITDecompression::ITDecompression(FileReader &file, ModSample &sample, bool it215
 		while(writtenSamples < sample.nLength && file.AreBytesLeft())
 		{
 			chunk = file.ReadChunk(file.ReadUint16LE());
-
-			// Initialise bit reader
-			dataPos = 0;
-			bitPos = 0;
-			remBits = 8;
-			mem1 = mem2 = 0;
-
-			if(mptSample.GetElementarySampleSize() > 1)
-				Uncompress<IT16BitParams>(static_cast<int16 *>(mptSample.pSample) + chn);
-			else
-				Uncompress<IT8BitParams>(static_cast<int8 *>(mptSample.pSample) + chn);
+			DecompressChunk(chn);
 		}
 	}
 }
 
 
+ITDecompression::ITDecompression(ModSample &sample, bool it215) : mptSample(sample), is215(it215)
+//-----------------------------------------------------------------------------------------------
+{
+	writtenSamples = writePos = 0;
+}
+
+
+SmpLength ITDecompression::DecompressBlock(FileReader block, ModSample &sample, uint8 chn, SmpLength position, bool it215)
+//-----------------------------------------------------------------------------------------------------------------------
+{
+	ITDecompression decompressor(sample, it215);
+	decompressor.writtenSamples = position;
+	decompressor.writePos = position * sample.GetNumChannels();
+	decompressor.chunk = block;
+	decompressor.DecompressChunk(chn);
+	return decompressor.writtenSamples - position;
+}
+
+
+// Decompress the block in "chunk" into the given channel, continuing at writtenSamples.
+void ITDecompression::DecompressChunk(uint8 chn)
+//----------------------------------------------
+{
+	// Initialise bit reader
+	dataPos = 0;
+	bitPos = 0;
+	remBits = 8;
+	mem1 = mem2 = 0;
+
+	if(mptSample.GetElementarySampleSize() > 1)
+		Uncompress<IT16BitParams>(static_cast<int16 *>(mptSample.pSample) + chn);
+	else
+		Uncompress<IT8BitParams>(static_cast<int8 *>(mptSample.pSample) + chn);
+}
+
+
 template<typename Properties>
 void ITDecompression::Uncompress(void *target)
 //--------------------------------------------
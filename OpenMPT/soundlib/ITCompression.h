@@ -76,7 +76,18 @@ class ITDecompression
 public:
 	ITDecompression(FileReader &file, ModSample &sample, bool it215);
 
+	// Number of samples per channel that are stored in one compressed block.
+	static SmpLength GetBlockLength(const ModSample &sample) { return static_cast<SmpLength>(ITCompression::blockSize / sample.GetElementarySampleSize()); }
+
+	// Decompress a single block of one channel into the already allocated sample, starting at the given sample position.
+	// Blocks do not share any state, so different blocks of the same sample can be decompressed at the same time.
+	// Returns the number of samples written, which is less than GetBlockLength() for the last block or if the block is corrupted.
+	static SmpLength DecompressBlock(FileReader block, ModSample &sample, uint8 chn, SmpLength position, bool it215);
+
 protected:
+	ITDecompression(ModSample &sample, bool it215);
+	void DecompressChunk(uint8 chn);
+
 	FileReader chunk;			// Currnetly processed block
 	ModSample &mptSample;		// Sample that is being processed
 
@@ -95,8 +95,9 @@ struct PolyphaseInterpolation
 
 	forceinline void Start(const ModChannel &chn, const CResampler &resampler)
 	{
-		sinc = (((chn.nInc > 0x13000) || (chn.nInc < -0x13000)) ?
-			(((chn.nInc > 0x18000) || (chn.nInc < -0x18000)) ? resampler.gDownsample2x : resampler.gDownsample13x) : resampler.gKaiserSinc);
+		// Switch to the downsampling filters above 1.1875x / 1.5x speed
+		sinc = (((chn.nInc > SAMPLEPOS_ONE * 0x13 / 0x10) || (chn.nInc < -SAMPLEPOS_ONE * 0x13 / 0x10)) ?
+			(((chn.nInc > SAMPLEPOS_ONE * 0x18 / 0x10) || (chn.nInc < -SAMPLEPOS_ONE * 0x18 / 0x10)) ? resampler.gDownsample2x : resampler.gDownsample13x) : resampler.gKaiserSinc);
 	}
 
 	forceinline void End(const ModChannel &) { }
@@ -129,7 +130,7 @@ struct FIRFilterInterpolation
 
 	forceinline void Start(const ModChannel &, const CResampler &resampler)
 	{
-		WFIRlut = resampler.m_WindowedFIR.lut;
+		WFIRlut = resampler.WFIRlut;
 	}
 
 	forceinline void End(const ModChannel &) { }
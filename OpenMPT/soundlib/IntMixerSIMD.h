@@ -0,0 +1,276 @@
+/*
+ * IntMixerSIMD.h
+ * --------------
+ * Purpose: Vectorized fixed point mixer classes (SSE2 / NEON compiler intrinsics)
+ * Notes  : All functors in this file must produce exactly the same output as their scalar counterparts in IntMixer.h.
+ *          Integer arithmetic wraps around in the same way in both implementations, so this is guaranteed
+ *          as long as the order of multiplications and shifts is preserved.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "IntMixer.h"
+#include "MixerSIMD.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+#ifdef ENABLE_SIMD_INTRINSICS
+
+
+//////////////////////////////////////////////////////////////////////////
+// Vector primitives
+
+#if defined(ENABLE_SSE2_INTRINSICS)
+
+// Low 32 bits of a 32x32 bit multiplication (SSE2 has no pmulld)
+static forceinline __m128i SSE2_MulLo32(__m128i a, __m128i b)
+{
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static forceinline simd_taps_t SIMD_LoadCoefficients(const int16 *lut)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut));
+}
+
+// Sum of all eight products
+static forceinline int32 SIMD_DotProduct8(simd_taps_t x, simd_taps_t coeffs)
+{
+	__m128i sum = _mm_madd_epi16(x, coeffs);
+	sum = _mm_add_epi32(sum, _mm_unpackhi_epi64(sum, sum));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+// Sums of the first four and the last four products
+static forceinline void SIMD_DotProduct4x2(simd_taps_t x, simd_taps_t coeffs, int32 &sum1, int32 &sum2)
+{
+	__m128i sum = _mm_madd_epi16(x, coeffs);
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	sum1 = _mm_cvtsi128_si32(sum);
+	sum2 = _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+}
+
+#elif defined(ENABLE_NEON_INTRINSICS)
+
+static forceinline int32 NEON_HorizontalSum(int32x4_t x)
+{
+	const int32x2_t sum = vadd_s32(vget_low_s32(x), vget_high_s32(x));
+	return vget_lane_s32(vpadd_s32(sum, sum), 0);
+}
+
+static forceinline simd_taps_t SIMD_LoadCoefficients(const int16 *lut)
+{
+	return vld1q_s16(lut);
+}
+
+// Sum of all eight products
+static forceinline int32 SIMD_DotProduct8(simd_taps_t x, simd_taps_t coeffs)
+{
+	const int32x4_t lo = vmull_s16(vget_low_s16(x), vget_low_s16(coeffs));
+	return NEON_HorizontalSum(vmlal_s16(lo, vget_high_s16(x), vget_high_s16(coeffs)));
+}
+
+// Sums of the first four and the last four products
+static forceinline void SIMD_DotProduct4x2(simd_taps_t x, simd_taps_t coeffs, int32 &sum1, int32 &sum2)
+{
+	sum1 = NEON_HorizontalSum(vmull_s16(vget_low_s16(x), vget_low_s16(coeffs)));
+	sum2 = NEON_HorizontalSum(vmull_s16(vget_high_s16(x), vget_high_s16(coeffs)));
+}
+
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interpolation templates
+
+template<class Traits>
+struct PolyphaseInterpolationSIMD : public PolyphaseInterpolation<Traits>
+{
+	typedef PolyphaseInterpolation<Traits> base_t;
+
+	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
+	{
+		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
+		const SINC_TYPE *lut = base_t::sinc + ((posLo >> (16 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+
+		simd_taps_t taps[Traits::numChannelsIn];
+		SIMDTapLoader<Traits::numChannelsIn, typename Traits::input_t>::Load(taps, inBuffer);
+		const simd_taps_t coeffs = SIMD_LoadCoefficients(lut);
+
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			outSample[i] = SIMD_DotProduct8(taps[i], coeffs) >> SINC_QUANTSHIFT;
+		}
+	}
+};
+
+
+template<class Traits>
+struct FIRFilterInterpolationSIMD : public FIRFilterInterpolation<Traits>
+{
+	typedef FIRFilterInterpolation<Traits> base_t;
+
+	forceinline void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const int32 posLo)
+	{
+		static_assert(Traits::numChannelsIn <= Traits::numChannelsOut, "Too many input channels");
+		const int16 * const lut = base_t::WFIRlut + (((posLo + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+
+		simd_taps_t taps[Traits::numChannelsIn];
+		SIMDTapLoader<Traits::numChannelsIn, typename Traits::input_t>::Load(taps, inBuffer);
+		const simd_taps_t coeffs = SIMD_LoadCoefficients(lut);
+
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			int32 vol1, vol2;
+			SIMD_DotProduct4x2(taps[i], coeffs, vol1, vol2);
+			outSample[i] = ((vol1 >> 1) + (vol2 >> 1)) >> (WFIR_16BITSHIFT - 1);
+		}
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Block mixing templates (add a block of samples to stereo mix, for use with SampleLoopBlock)
+// Two sampling points (four output values) are processed per iteration, the remainder is handled by the scalar functor.
+
+template<class Traits>
+struct MixMonoNoRampSIMD : public MixMonoNoRamp<Traits>
+{
+	typedef MixMonoNoRamp<Traits> base_t;
+	forceinline void operator() (const typename Traits::outbuf_t *inBlock, int numSamples, const ModChannel &chn, typename Traits::output_t * const outBuffer)
+	{
+		int i = 0;
+#if defined(ENABLE_SSE2_INTRINSICS)
+		const __m128i vol = _mm_set_epi32(base_t::rVol, base_t::lVol, base_t::rVol, base_t::lVol);
+		for(; i + 2 <= numSamples; i += 2)
+		{
+			// Only the first value of each input sampling point is valid: s0 ? s1 ? => s0 s0 s1 s1
+			const __m128i in = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(inBlock[i])), _MM_SHUFFLE(2, 2, 0, 0));
+			__m128i *out = reinterpret_cast<__m128i *>(outBuffer + i * 2);
+			_mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), SSE2_MulLo32(in, vol)));
+		}
+#elif defined(ENABLE_NEON_INTRINSICS)
+		const int32x4_t vol = vcombine_s32(vcreate_s32((uint64)(uint32)base_t::lVol | ((uint64)(uint32)base_t::rVol << 32)), vcreate_s32((uint64)(uint32)base_t::lVol | ((uint64)(uint32)base_t::rVol << 32)));
+		for(; i + 2 <= numSamples; i += 2)
+		{
+			const int32x2_t mono = vld2_s32(inBlock[i]).val[0];
+			const int32x2x2_t dup = vzip_s32(mono, mono);
+			int32 *out = outBuffer + i * 2;
+			vst1q_s32(out, vmlaq_s32(vld1q_s32(out), vcombine_s32(dup.val[0], dup.val[1]), vol));
+		}
+#endif
+		for(; i < numSamples; i++)
+		{
+			base_t::operator() (inBlock[i], chn, outBuffer + i * 2);
+		}
+	}
+};
+
+
+template<class Traits>
+struct MixStereoNoRampSIMD : public MixStereoNoRamp<Traits>
+{
+	typedef MixStereoNoRamp<Traits> base_t;
+	forceinline void operator() (const typename Traits::outbuf_t *inBlock, int numSamples, const ModChannel &chn, typename Traits::output_t * const outBuffer)
+	{
+		int i = 0;
+#if defined(ENABLE_SSE2_INTRINSICS)
+		const __m128i vol = _mm_set_epi32(base_t::rVol, base_t::lVol, base_t::rVol, base_t::lVol);
+		for(; i + 2 <= numSamples; i += 2)
+		{
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inBlock[i]));
+			__m128i *out = reinterpret_cast<__m128i *>(outBuffer + i * 2);
+			_mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), SSE2_MulLo32(in, vol)));
+		}
+#elif defined(ENABLE_NEON_INTRINSICS)
+		const int32x4_t vol = vcombine_s32(vcreate_s32((uint64)(uint32)base_t::lVol | ((uint64)(uint32)base_t::rVol << 32)), vcreate_s32((uint64)(uint32)base_t::lVol | ((uint64)(uint32)base_t::rVol << 32)));
+		for(; i + 2 <= numSamples; i += 2)
+		{
+			int32 *out = outBuffer + i * 2;
+			vst1q_s32(out, vmlaq_s32(vld1q_s32(out), vld1q_s32(inBlock[i]), vol));
+		}
+#endif
+		for(; i < numSamples; i++)
+		{
+			base_t::operator() (inBlock[i], chn, outBuffer + i * 2);
+		}
+	}
+};
+
+
+// Volume ramping: The ramp values of two consecutive sampling points are kept in one vector and advanced by twice the ramp increment.
+template<class Traits, class ScalarMix, bool monoInput>
+struct MixRampSIMD : public ScalarMix
+{
+	forceinline void operator() (const typename Traits::outbuf_t *inBlock, int numSamples, const ModChannel &chn, typename Traits::output_t * const outBuffer)
+	{
+		int i = 0;
+#if defined(ENABLE_SSE2_INTRINSICS) || defined(ENABLE_NEON_INTRINSICS)
+		const int pairs = numSamples / 2;
+		if(pairs > 0)
+		{
+			const uint32 lRamp0 = static_cast<uint32>(ScalarMix::lRamp), rRamp0 = static_cast<uint32>(ScalarMix::rRamp);
+			const uint32 lInc = static_cast<uint32>(chn.leftRamp), rInc = static_cast<uint32>(chn.rightRamp);
+#if defined(ENABLE_SSE2_INTRINSICS)
+			__m128i ramp = _mm_set_epi32(rRamp0 + 2 * rInc, lRamp0 + 2 * lInc, rRamp0 + rInc, lRamp0 + lInc);
+			const __m128i step = _mm_set_epi32(2 * rInc, 2 * lInc, 2 * rInc, 2 * lInc);
+			for(; i < pairs * 2; i += 2)
+			{
+				__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inBlock[i]));
+				if(monoInput)
+				{
+					in = _mm_shuffle_epi32(in, _MM_SHUFFLE(2, 2, 0, 0));
+				}
+				__m128i *out = reinterpret_cast<__m128i *>(outBuffer + i * 2);
+				_mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), SSE2_MulLo32(in, _mm_srai_epi32(ramp, VOLUMERAMPPRECISION))));
+				ramp = _mm_add_epi32(ramp, step);
+			}
+#elif defined(ENABLE_NEON_INTRINSICS)
+			const int32 init[4] = { static_cast<int32>(lRamp0 + lInc), static_cast<int32>(rRamp0 + rInc), static_cast<int32>(lRamp0 + 2 * lInc), static_cast<int32>(rRamp0 + 2 * rInc) };
+			const int32 inc[4] = { static_cast<int32>(2 * lInc), static_cast<int32>(2 * rInc), static_cast<int32>(2 * lInc), static_cast<int32>(2 * rInc) };
+			int32x4_t ramp = vld1q_s32(init);
+			const int32x4_t step = vld1q_s32(inc);
+			for(; i < pairs * 2; i += 2)
+			{
+				int32x4_t in;
+				if(monoInput)
+				{
+					const int32x2_t mono = vld2_s32(inBlock[i]).val[0];
+					const int32x2x2_t dup = vzip_s32(mono, mono);
+					in = vcombine_s32(dup.val[0], dup.val[1]);
+				} else
+				{
+					in = vld1q_s32(inBlock[i]);
+				}
+				int32 *out = outBuffer + i * 2;
+				vst1q_s32(out, vmlaq_s32(vld1q_s32(out), in, vshrq_n_s32(ramp, VOLUMERAMPPRECISION)));
+				ramp = vaddq_s32(ramp, step);
+			}
+#endif
+			ScalarMix::lRamp = static_cast<int32>(lRamp0 + static_cast<uint32>(pairs * 2) * lInc);
+			ScalarMix::rRamp = static_cast<int32>(rRamp0 + static_cast<uint32>(pairs * 2) * rInc);
+		}
+#endif
+		for(; i < numSamples; i++)
+		{
+			ScalarMix::operator() (inBlock[i], chn, outBuffer + i * 2);
+		}
+	}
+};
+
+template<class Traits>
+struct MixMonoRampSIMD : public MixRampSIMD<Traits, MixMonoRamp<Traits>, true> { };
+
+template<class Traits>
+struct MixStereoRampSIMD : public MixRampSIMD<Traits, MixStereoRamp<Traits>, false> { };
+
+
+#endif // ENABLE_SIMD_INTRINSICS
+
+OPENMPT_NAMESPACE_END
@@ -89,8 +89,8 @@ STATIC_ASSERT(sizeof(_669Sample) == 25);
 #endif
 
 
-bool CSoundFile::Read669(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeader669(FileReader file)
+//---------------------------------------------------------------------
 {
 	_669FileHeader fileHeader;
 
@@ -100,6 +100,17 @@ bool CSoundFile::Read669(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.samples > 64
 		|| fileHeader.restartPos >= 128
 		|| fileHeader.patterns > 128)
+	{
+		return ProbeResult(ProbeFailure, sizeof(_669FileHeader));
+	}
+	return ProbeResult(ProbeWeak, sizeof(_669FileHeader));
+}
+
+
+bool CSoundFile::Read669(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeader669(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -107,6 +118,10 @@ bool CSoundFile::Read669(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	_669FileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	//bool has669Ext = fileHeader.sig == _669FileHeader::magic669Ext;
 
 	InitializeGlobals();
@@ -103,8 +103,8 @@ STATIC_ASSERT(sizeof(AMFFileHeader) == 41);
 #endif
 
 
-bool CSoundFile::ReadAMF_Asylum(FileReader &file, ModLoadingFlags loadFlags)
-//--------------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderAMF_Asylum(FileReader file)
+//----------------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -113,6 +113,17 @@ bool CSoundFile::ReadAMF_Asylum(FileReader &file, ModLoadingFlags loadFlags)
 		|| strncmp(fileHeader.signature, "ASYLUM Music Format V1.0", 25)
 		|| fileHeader.numSamples > 64
 		|| !file.CanRead(256 + 64 * sizeof(AsylumSampleHeader) + 64 * 4 * 8 * fileHeader.numPatterns))
+	{
+		return ProbeResult(ProbeFailure, sizeof(AsylumFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(AsylumFileHeader));
+}
+
+
+bool CSoundFile::ReadAMF_Asylum(FileReader &file, ModLoadingFlags loadFlags)
+//--------------------------------------------------------------------------
+{
+	if(ProbeFileHeaderAMF_Asylum(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -120,6 +131,10 @@ bool CSoundFile::ReadAMF_Asylum(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	AsylumFileHeader fileHeader;
+	file.ReadStruct(fileHeader);
+
 	InitializeGlobals();
 	InitializeChannels();
 	m_nType = MOD_TYPE_AMF0;
@@ -364,8 +379,8 @@ static void AMFReadPattern(CPattern &pattern, CHANNELINDEX chn, FileReader &file
 }
 
 
-bool CSoundFile::ReadAMF_DSMI(FileReader &file, ModLoadingFlags loadFlags)
-//------------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderAMF_DSMI(FileReader file)
+//--------------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -374,6 +389,17 @@ bool CSoundFile::ReadAMF_DSMI(FileReader &file, ModLoadingFlags loadFlags)
 		|| memcmp(fileHeader.amf, "AMF", 3)
 		|| fileHeader.version < 8 || fileHeader.version > 14
 		|| ((fileHeader.numChannels < 1 || fileHeader.numChannels > 32) && fileHeader.version >= 10))
+	{
+		return ProbeResult(ProbeFailure, sizeof(AMFFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(AMFFileHeader));
+}
+
+
+bool CSoundFile::ReadAMF_DSMI(FileReader &file, ModLoadingFlags loadFlags)
+//------------------------------------------------------------------------
+{
+	if(ProbeFileHeaderAMF_DSMI(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -381,6 +407,10 @@ bool CSoundFile::ReadAMF_DSMI(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	AMFFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 	InitializeChannels();
 
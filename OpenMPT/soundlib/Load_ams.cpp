@@ -381,8 +381,8 @@ STATIC_ASSERT(sizeof(AMSSampleHeader) == 17);
 #endif
 
 
-bool CSoundFile::ReadAMS(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderAMS(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -392,6 +392,17 @@ bool CSoundFile::ReadAMS(FileReader &file, ModLoadingFlags loadFlags)
 		|| !file.Skip(fileHeader.extraSize)
 		|| !file.CanRead(fileHeader.numSamps * sizeof(AMSSampleHeader))
 		|| fileHeader.versionHigh != 0x01)
+	{
+		return ProbeResult(ProbeFailure, 7 + sizeof(AMSFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, 7 + sizeof(AMSFileHeader));
+}
+
+
+bool CSoundFile::ReadAMS(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderAMS(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -399,6 +410,11 @@ bool CSoundFile::ReadAMS(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Seek(7);
+	AMSFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+	file.Skip(fileHeader.extraSize);
+
 	InitializeGlobals();
 
 	m_nType = MOD_TYPE_AMS;
@@ -750,28 +766,41 @@ STATIC_ASSERT(sizeof(AMS2Description) == 11);
 #endif
 
 
-bool CSoundFile::ReadAMS2(FileReader &file, ModLoadingFlags loadFlags)
-//--------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderAMS2(FileReader file)
+//----------------------------------------------------------------------
 {
 	file.Rewind();
 
+	std::string songName;
 	AMS2FileHeader fileHeader;
-	if(!file.ReadMagic("AMShdr\x1A"))
+	if(!file.ReadMagic("AMShdr\x1A")
+		|| !ReadAMSString(songName, file)
+		|| !file.ReadConvertEndianness(fileHeader)
+		|| fileHeader.versionHigh != 2 || fileHeader.versionLow > 2)
 	{
-		return false;
+		return ProbeResult(ProbeFailure, 8 + sizeof(AMS2FileHeader));
 	}
+	return ProbeResult(ProbeSuccess, 8 + sizeof(AMS2FileHeader));
+}
 
-	InitializeGlobals();
 
-	if(!ReadAMSString(songName, file)
-		|| !file.ReadConvertEndianness(fileHeader)
-		|| fileHeader.versionHigh != 2 || fileHeader.versionLow > 2)
+bool CSoundFile::ReadAMS2(FileReader &file, ModLoadingFlags loadFlags)
+//--------------------------------------------------------------------
+{
+	if(ProbeFileHeaderAMS2(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
 	{
 		return true;
 	}
+
+	InitializeGlobals();
+
+	file.Seek(7);
+	AMS2FileHeader fileHeader;
+	ReadAMSString(songName, file);
+	file.ReadConvertEndianness(fileHeader);
 	
 	m_nType = MOD_TYPE_AMS2;
 	m_nInstruments = fileHeader.numIns;
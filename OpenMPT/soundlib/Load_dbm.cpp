@@ -293,8 +293,8 @@ static void ReadDBMEnvelopeChunk(FileReader chunk, enmEnvelopeTypes envType, CSo
 }
 
 
-bool CSoundFile::ReadDBM(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderDBM(FileReader file)
+//---------------------------------------------------------------------
 {
 	DBMFileHeader fileHeader;
 
@@ -302,6 +302,17 @@ bool CSoundFile::ReadDBM(FileReader &file, ModLoadingFlags loadFlags)
 	if(!file.ReadStruct(fileHeader)
 		|| memcmp(fileHeader.dbm0, "DBM0", 4)
 		|| fileHeader.trkVerHi > 3)
+	{
+		return ProbeResult(ProbeFailure, sizeof(DBMFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(DBMFileHeader));
+}
+
+
+bool CSoundFile::ReadDBM(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderDBM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -309,6 +320,10 @@ bool CSoundFile::ReadDBM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	DBMFileHeader fileHeader;
+	file.ReadStruct(fileHeader);
+
 	ChunkReader chunkFile(file);
 	ChunkReader::ChunkList<DBMChunk> chunks = chunkFile.ReadChunks<DBMChunk>(1);
 
@@ -92,8 +92,8 @@ static void ReadDIGIPatternEntry(FileReader &file, ModCommand &m, CSoundFile &sn
 }
 
 
-bool CSoundFile::ReadDIGI(FileReader &file, ModLoadingFlags loadFlags)
-//--------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderDIGI(FileReader file)
+//----------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -103,6 +103,17 @@ bool CSoundFile::ReadDIGI(FileReader &file, ModLoadingFlags loadFlags)
 		|| !fileHeader.numChannels
 		|| fileHeader.numChannels > 8
 		|| fileHeader.lastOrdIndex > 127)
+	{
+		return ProbeResult(ProbeFailure, sizeof(DIGIFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(DIGIFileHeader));
+}
+
+
+bool CSoundFile::ReadDIGI(FileReader &file, ModLoadingFlags loadFlags)
+//--------------------------------------------------------------------
+{
+	if(ProbeFileHeaderDIGI(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -110,6 +121,10 @@ bool CSoundFile::ReadDIGI(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	DIGIFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	// Globals
 	InitializeGlobals();
 	InitializeChannels();
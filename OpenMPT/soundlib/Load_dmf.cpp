@@ -956,14 +956,25 @@ static PATTERNINDEX ConvertDMFPattern(FileReader &file, DMFPatternSettings &sett
 }
 
 
-bool CSoundFile::ReadDMF(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderDMF(FileReader file)
+//---------------------------------------------------------------------
 {
 	DMFFileHeader fileHeader;
 	file.Rewind();
 	if(!file.ReadStruct(fileHeader)
 		|| memcmp(fileHeader.signature, "DDMF", 4)
 		|| !fileHeader.version || fileHeader.version > 10)
+	{
+		return ProbeResult(ProbeFailure, sizeof(DMFFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(DMFFileHeader));
+}
+
+
+bool CSoundFile::ReadDMF(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderDMF(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -971,6 +982,10 @@ bool CSoundFile::ReadDMF(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	DMFFileHeader fileHeader;
+	file.ReadStruct(fileHeader);
+
 	InitializeGlobals();
 	mpt::String::Read<mpt::String::spacePadded>(songName, fileHeader.songname);
 	mpt::String::Read<mpt::String::spacePadded>(songArtist, fileHeader.composer);
@@ -126,8 +126,8 @@ STATIC_ASSERT(sizeof(DSMSampleHeader) == 64);
 #endif
 
 
-bool CSoundFile::ReadDSM(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderDSM(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -135,9 +135,9 @@ bool CSoundFile::ReadDSM(FileReader &file, ModLoadingFlags loadFlags)
 	char fileMagic1[4];
 	char fileMagic2[4];
 
-	if(!file.ReadArray(fileMagic0)) return false;
-	if(!file.ReadArray(fileMagic1)) return false;
-	if(!file.ReadArray(fileMagic2)) return false;
+	if(!file.ReadArray(fileMagic0)) return ProbeResult(ProbeFailure, 12 + sizeof(DSMChunk));
+	if(!file.ReadArray(fileMagic1)) return ProbeResult(ProbeFailure, 12 + sizeof(DSMChunk));
+	if(!file.ReadArray(fileMagic2)) return ProbeResult(ProbeFailure, 12 + sizeof(DSMChunk));
 
 	if(!memcmp(fileMagic0, "RIFF", 4)
 		&& !memcmp(fileMagic2, "DSMF", 4))
@@ -151,7 +151,7 @@ bool CSoundFile::ReadDSM(FileReader &file, ModLoadingFlags loadFlags)
 		file.Skip(4);
 	} else
 	{
-		return false;
+		return ProbeResult(ProbeFailure, 12 + sizeof(DSMChunk));
 	}
 
 	DSMChunk chunkHeader;
@@ -160,6 +160,17 @@ bool CSoundFile::ReadDSM(FileReader &file, ModLoadingFlags loadFlags)
 	// Technically, the song chunk could be anywhere in the file, but we're going to simplify
 	// things by not using a chunk header here and just expect it to be right at the beginning.
 	if(memcmp(chunkHeader.magic, "SONG", 4))
+	{
+		return ProbeResult(ProbeFailure, 12 + sizeof(DSMChunk));
+	}
+	return ProbeResult(ProbeSuccess, 12 + sizeof(DSMChunk));
+}
+
+
+bool CSoundFile::ReadDSM(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderDSM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -167,6 +178,12 @@ bool CSoundFile::ReadDSM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	// The song chunk follows the file header, which is four bytes longer in the alternative format
+	file.Rewind();
+	file.Seek(file.ReadMagic("DSMF") ? 16 : 12);
+	DSMChunk chunkHeader;
+	file.ReadConvertEndianness(chunkHeader);
+
 	DSMSongHeader songHeader;
 	file.ReadStructPartial(songHeader, chunkHeader.size);
 	songHeader.ConvertEndianness();
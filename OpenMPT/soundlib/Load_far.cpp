@@ -135,8 +135,8 @@ STATIC_ASSERT(sizeof(FARSampleHeader) == 48);
 #endif
 
 
-bool CSoundFile::ReadFAR(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderFAR(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -145,6 +145,17 @@ bool CSoundFile::ReadFAR(FileReader &file, ModLoadingFlags loadFlags)
 		|| memcmp(fileHeader.magic, "FAR\xFE", 4) != 0
 		|| memcmp(fileHeader.eof, "\x0D\x0A\x1A", 3)
 		|| file.GetLength() < static_cast<size_t>(fileHeader.headerLength))
+	{
+		return ProbeResult(ProbeFailure, sizeof(FARFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(FARFileHeader));
+}
+
+
+bool CSoundFile::ReadFAR(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderFAR(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -152,6 +163,10 @@ bool CSoundFile::ReadFAR(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	FARFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	// Globals
 	InitializeGlobals();
 	m_nType = MOD_TYPE_FAR;
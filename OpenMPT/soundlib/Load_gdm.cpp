@@ -125,16 +125,17 @@ STATIC_ASSERT(sizeof(GDMSampleHeader) == 62);
 #endif
 
 
-bool CSoundFile::ReadGDM(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+// 1-MOD, 2-MTM, 3-S3M, 4-669, 5-FAR, 6-ULT, 7-STM, 8-MED
+static const MODTYPE gdmFormatOrigin[] =
 {
-	file.Rewind();
+	MOD_TYPE_NONE, MOD_TYPE_MOD, MOD_TYPE_MTM, MOD_TYPE_S3M, MOD_TYPE_669, MOD_TYPE_FAR, MOD_TYPE_ULT, MOD_TYPE_STM, MOD_TYPE_MED
+};
 
-	// 1-MOD, 2-MTM, 3-S3M, 4-669, 5-FAR, 6-ULT, 7-STM, 8-MED
-	const MODTYPE gdmFormatOrigin[] =
-	{
-		MOD_TYPE_NONE, MOD_TYPE_MOD, MOD_TYPE_MTM, MOD_TYPE_S3M, MOD_TYPE_669, MOD_TYPE_FAR, MOD_TYPE_ULT, MOD_TYPE_STM, MOD_TYPE_MED
-	};
+
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderGDM(FileReader file)
+//---------------------------------------------------------------------
+{
+	file.Rewind();
 
 	GDMFileHeader fileHeader;
 	if(!file.ReadConvertEndianness(fileHeader)
@@ -144,6 +145,17 @@ bool CSoundFile::ReadGDM(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.formatMajorVer != 1 || fileHeader.formatMinorVer != 0
 		|| fileHeader.originalFormat >= CountOf(gdmFormatOrigin)
 		|| fileHeader.originalFormat == 0)
+	{
+		return ProbeResult(ProbeFailure, sizeof(GDMFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(GDMFileHeader));
+}
+
+
+bool CSoundFile::ReadGDM(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderGDM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -151,6 +163,10 @@ bool CSoundFile::ReadGDM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	GDMFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 	m_nType = gdmFormatOrigin[fileHeader.originalFormat];
 	m_ContainerType = MOD_CONTAINERTYPE_GDM;
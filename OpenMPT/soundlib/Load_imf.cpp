@@ -394,17 +394,48 @@ static void ImportIMFEffect(ModCommand &m)
 	}
 }
 
-bool CSoundFile::ReadIMF(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderIMF(FileReader file)
+//---------------------------------------------------------------------
 {
 	IMFFileHeader fileHeader;
 	file.Rewind();
 	if(!file.ReadConvertEndianness(fileHeader)
 		|| memcmp(fileHeader.im10, "IM10", 4))
+	{
+		return ProbeResult(ProbeFailure, sizeof(IMFFileHeader));
+	}
+
+	// At least one channel must be enabled or muted, and all status values must be known
+	bool haveChannels = false;
+	for(uint8 chn = 0; chn < 32; chn++)
+	{
+		if(fileHeader.channels[chn].status > 2)
+		{
+			return ProbeResult(ProbeFailure, sizeof(IMFFileHeader));
+		} else if(fileHeader.channels[chn].status < 2)
+		{
+			haveChannels = true;
+		}
+	}
+	return ProbeResult(haveChannels ? ProbeSuccess : ProbeFailure, sizeof(IMFFileHeader));
+}
+
+
+bool CSoundFile::ReadIMF(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderIMF(file).confidence == ProbeFailure)
 	{
 		return false;
+	} else if(loadFlags == onlyVerifyHeader)
+	{
+		return true;
 	}
 
+	IMFFileHeader fileHeader;
+	file.Rewind();
+	file.ReadConvertEndianness(fileHeader);
+
 
 	// Read channel configuration
 	std::bitset<32> ignoreChannels; // bit set for each channel that's completely disabled
@@ -438,9 +469,6 @@ bool CSoundFile::ReadIMF(FileReader &file, ModLoadingFlags loadFlags)
 	if(!detectedChannels)
 	{
 		return false;
-	} else if(loadFlags == onlyVerifyHeader)
-	{
-		return true;
 	}
 
 	InitializeGlobals();
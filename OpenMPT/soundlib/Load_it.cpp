@@ -25,6 +25,7 @@
 #include <list>
 #include "../common/version.h"
 #include "ITTools.h"
+#include "ITCompression.h"
 #include <time.h>
 
 OPENMPT_NAMESPACE_BEGIN
@@ -290,6 +291,32 @@ static void CopyPatternName(CPattern &pattern, FileReader &file)
 }
 
 
+// Move the file position behind the data of a sample without decoding it.
+static void SkipITSample(FileReader &file, SmpLength length, SampleIO sampleIO)
+//----------------------------------------------------------------------------
+{
+	const uint8 bytesPerSample = sampleIO.GetBitDepth() / 8;
+	if(sampleIO.GetEncoding() == SampleIO::IT214 || sampleIO.GetEncoding() == SampleIO::IT215)
+	{
+		// Compressed samples are stored in blocks of 32 KiB (uncompressed size) per channel, each prefixed with its packed length.
+		const SmpLength blockLength = ITCompression::blockSize / bytesPerSample;
+		for(uint8 chn = 0; chn < sampleIO.GetNumChannels(); chn++)
+		{
+			for(SmpLength skipped = 0; skipped < length && file.AreBytesLeft(); skipped += blockLength)
+			{
+				file.Skip(file.ReadUint16LE());
+			}
+		}
+	} else if(sampleIO.GetEncoding() == SampleIO::ADPCM)
+	{
+		file.Skip(16 + (length + 1) / 2);
+	} else
+	{
+		file.Skip(static_cast<FileReader::off_t>(length) * bytesPerSample * sampleIO.GetNumChannels());
+	}
+}
+
+
 // Get version of Schism Tracker that was used to create an IT/S3M file.
 std::string CSoundFile::GetSchismTrackerVersion(uint16 cwtv)
 //----------------------------------------------------------
@@ -317,8 +344,8 @@ std::string CSoundFile::GetSchismTrackerVersion(uint16 cwtv)
 }
 
 
-bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
-//------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderIT(FileReader file)
+//--------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -328,6 +355,17 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.insnum > 0xFF
 		|| fileHeader.smpnum >= MAX_SAMPLES
 		|| !file.CanRead(fileHeader.ordnum + (fileHeader.insnum + fileHeader.smpnum + fileHeader.patnum) * 4))
+	{
+		return ProbeResult(ProbeFailure, sizeof(ITFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(ITFileHeader));
+}
+
+
+bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
+//------------------------------------------------------------------
+{
+	if(ProbeFileHeaderIT(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -335,6 +373,10 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	ITFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 
 	bool interpretModPlugMade = false;
@@ -626,6 +668,9 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 	}
 
 	// Reading Samples
+	// The sample data is decoded after all sample headers have been read, so that it can be done by several threads.
+	SampleReadQueue sampleQueue(GetLoaderThreads());
+	std::vector<FileReader::off_t> queuedSampleOffsets;
 	m_nSamples = std::min(fileHeader.smpnum, SAMPLEINDEX(MAX_SAMPLES - 1));
 	for(SAMPLEINDEX i = 0; i < GetNumSamples(); i++)
 	{
@@ -638,14 +683,27 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 
 				mpt::String::Read<mpt::String::spacePadded>(m_szNames[i + 1], sampleHeader.name);
 
-				if((loadFlags & loadSampleData) && file.Seek(sampleOffset))
+				if(file.Seek(sampleOffset))
 				{
-					sampleHeader.GetSampleFormat(fileHeader.cwtv).ReadSample(Samples[i + 1], file);
-					lastSampleOffset = std::max(lastSampleOffset, file.GetPosition());
+					if(loadFlags & loadSampleData)
+					{
+						sampleQueue.Add(sampleHeader.GetSampleFormat(fileHeader.cwtv), Samples[i + 1], file, (loadFlags & referenceSampleData) != 0);
+						queuedSampleOffsets.push_back(file.GetPosition());
+					} else
+					{
+						// Still find the end of the sample data, as the extensions are stored behind it.
+						SkipITSample(file, Samples[i + 1].nLength, sampleHeader.GetSampleFormat(fileHeader.cwtv));
+						lastSampleOffset = std::max(lastSampleOffset, file.GetPosition());
+					}
 				}
 			}
 		}
 	}
+	sampleQueue.Read();
+	for(size_t i = 0; i < queuedSampleOffsets.size(); i++)
+	{
+		lastSampleOffset = std::max(lastSampleOffset, queuedSampleOffsets[i] + static_cast<FileReader::off_t>(sampleQueue.GetBytesRead(i)));
+	}
 	m_nSamples = std::max(SAMPLEINDEX(1), GetNumSamples());
 
 	m_nMinPeriod = 8;
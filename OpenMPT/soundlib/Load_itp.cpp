@@ -64,6 +64,29 @@ static inline bool ReadITPString(std::string &dest, FileReader &file)
 #endif // MODPLUG_TRACKER
 
 
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderITP(FileReader file)
+//---------------------------------------------------------------------
+{
+#ifndef MODPLUG_TRACKER
+	MPT_UNREFERENCED_PARAMETER(file);
+	return ProbeResult(ProbeFailure, 12 + 4 + 24 + 4);
+#else // MODPLUG_TRACKER
+
+	file.Rewind();
+
+	// Check file ID
+	if(!file.CanRead(12 + 4 + 24 + 4)
+		|| file.ReadUint32LE() != ITP_FILE_ID				// Magic bytes
+		|| file.ReadUint32LE() > ITP_VERSION)				// Format version
+	{
+		return ProbeResult(ProbeFailure, 12 + 4 + 24 + 4);
+	}
+	return ProbeResult(ProbeSuccess, 12 + 4 + 24 + 4);
+
+#endif // MODPLUG_TRACKER
+}
+
+
 bool CSoundFile::ReadITProject(FileReader &file, ModLoadingFlags loadFlags)
 //-------------------------------------------------------------------------
 {
@@ -76,12 +99,7 @@ bool CSoundFile::ReadITProject(FileReader &file, ModLoadingFlags loadFlags)
 	uint32 version;
 	FileReader::off_t size;
 
-	file.Rewind();
-
-	// Check file ID
-	if(!file.CanRead(12 + 4 + 24 + 4)
-		|| file.ReadUint32LE() != ITP_FILE_ID				// Magic bytes
-		|| (version = file.ReadUint32LE()) > ITP_VERSION)	// Format version
+	if(ProbeFileHeaderITP(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -89,6 +107,9 @@ bool CSoundFile::ReadITProject(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Seek(4);
+	version = file.ReadUint32LE();
+
 	InitializeGlobals();
 	ReadITPString(songName, file);
 
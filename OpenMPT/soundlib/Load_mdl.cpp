@@ -288,9 +288,26 @@ static void UnpackMDLTrack(ModCommand *pat, UINT nChannels, UINT nRows, UINT nTr
 
 
 
-bool CSoundFile::ReadMDL(const uint8 *lpStream, const DWORD dwMemLength, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMDL(FileReader file)
+//---------------------------------------------------------------------
 {
+	file.Rewind();
+	if(!file.CanRead(1024)
+		|| !file.ReadMagic("DMDL")
+		|| (file.ReadUint8() & 0xF0) > 0x10)
+	{
+		return ProbeResult(ProbeFailure, 1024);
+	}
+	return ProbeResult(ProbeSuccess, 1024);
+}
+
+
+bool CSoundFile::ReadMDL(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	file.Rewind();
+	const uint8 *lpStream = reinterpret_cast<const uint8 *>(file.GetRawData());
+	const DWORD dwMemLength = file.GetLength();
 	DWORD dwMemPos, dwPos, blocklen, dwTrackPos;
 	const MDLFileHeader *pmsh = (const MDLFileHeader *)lpStream;
 	MDLInfoBlock *pmib;
@@ -305,8 +322,7 @@ bool CSoundFile::ReadMDL(const uint8 *lpStream, const DWORD dwMemLength, ModLoad
 	UINT nvolenv, npanenv, npitchenv;
 	std::vector<ROWINDEX> patternLength;
 
-	if ((!lpStream) || (dwMemLength < 1024)) return false;
-	if ((pmsh->id != 0x4C444D44) || ((pmsh->version & 0xF0) > 0x10)) return false;
+	if(ProbeFileHeaderMDL(file).confidence == ProbeFailure) return false;
 	else if(loadFlags == onlyVerifyHeader) return true;
 #ifdef MDL_LOG
 	Log("MDL v%d.%d\n", pmsh->version>>4, pmsh->version&0x0f);
@@ -502,9 +502,33 @@ static void MedConvert(ModCommand *p, const MMD0SONGHEADER *pmsh)
 }
 
 
-bool CSoundFile::ReadMed(const uint8 *lpStream, const DWORD dwMemLength, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMED(FileReader file)
+//---------------------------------------------------------------------
 {
+	file.Rewind();
+	if(!file.CanRead(0x200) || !file.ReadMagic("MMD"))
+	{
+		return ProbeResult(ProbeFailure, 0x200);
+	}
+	const uint8 version = file.ReadUint8();
+	file.Skip(4);	// Module length
+	const uint32 songOffset = file.ReadUint32BE();
+	if(version < '0' || version > '3'
+		|| !songOffset
+		|| static_cast<uint64>(songOffset) + sizeof(MMD0SONGHEADER) >= file.GetLength())
+	{
+		return ProbeResult(ProbeFailure, 0x200);
+	}
+	return ProbeResult(ProbeSuccess, 0x200);
+}
+
+
+bool CSoundFile::ReadMed(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	file.Rewind();
+	const uint8 *lpStream = reinterpret_cast<const uint8 *>(file.GetRawData());
+	const DWORD dwMemLength = file.GetLength();
 	const MEDMODULEHEADER *pmmh;
 	const MMD0SONGHEADER *pmsh;
 	const MMD2SONGHEADER *pmsh2;
@@ -515,15 +539,11 @@ bool CSoundFile::ReadMed(const uint8 *lpStream, const DWORD dwMemLength, ModLoad
 	UINT deftempo;
 	int playtransp = 0;
 
-	if ((!lpStream) || (dwMemLength < 0x200)) return false;
+	if(ProbeFileHeaderMED(file).confidence == ProbeFailure) return false;
+	else if(loadFlags == onlyVerifyHeader) return true;
 	pmmh = (MEDMODULEHEADER *)lpStream;
-	if (((pmmh->id & 0x00FFFFFF) != 0x444D4D) || (!pmmh->song)) return false;
-	// Check for 'MMDx'
 	DWORD dwSong = BigEndian(pmmh->song);
-	if ((dwSong >= dwMemLength) || (dwSong + sizeof(MMD0SONGHEADER) >= dwMemLength)) return false;
 	version = (signed char)((pmmh->id >> 24) & 0xFF);
-	if ((version < '0') || (version > '3')) return false;
-	else if(loadFlags == onlyVerifyHeader) return true;
 #ifdef MED_LOG
 	Log("\nLoading MMD%c module (flags=0x%02X)...\n", version, BigEndian(pmmh->mmdflags));
 	Log("  modlen   = %d\n", BigEndian(pmmh->modlen));
@@ -468,9 +468,58 @@ UINT CSoundFile::MapMidiInstrument(DWORD dwBankProgram, UINT nChannel, UINT nNot
 #define MIDIGLOBAL_XGSYSTEMON		0x0200
 
 
-bool CSoundFile::ReadMID(const uint8 *lpStream, DWORD dwMemLength, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMID(FileReader file)
+//---------------------------------------------------------------------
 {
+	file.Rewind();
+
+	// Detect RMI files
+	if(file.GetLength() > 12 && file.ReadMagic("RIFF") && file.Skip(4) && file.ReadMagic("RMID"))
+	{
+		while(file.BytesLeft() > 8)
+		{
+			char id[4];
+			file.ReadArray(id);
+			const uint32 length = file.ReadUint32LE();
+			if(!memcmp(id, "data", 4) && length < file.BytesLeft())
+			{
+				file = file.ReadChunk(length);
+				break;
+			}
+			if(length >= file.BytesLeft())
+			{
+				return ProbeResult(ProbeFailure, sizeof(MIDIFILEHEADER) + 8);
+			}
+			file.Skip(length);
+		}
+	}
+	file.Rewind();
+
+	// MIDI File Header, followed by the first track
+	if(file.GetLength() < sizeof(MIDIFILEHEADER) + 8 || !file.ReadMagic("MThd"))
+	{
+		return ProbeResult(ProbeFailure, sizeof(MIDIFILEHEADER) + 8);
+	}
+	const uint32 trackPos = 8 + file.ReadUint32BE();
+	file.Skip(2);
+	const uint16 numTracks = file.ReadUint16BE();
+	if(trackPos >= file.GetLength() - 8
+		|| !numTracks
+		|| !file.Seek(trackPos)
+		|| !file.ReadMagic("MTrk"))
+	{
+		return ProbeResult(ProbeFailure, sizeof(MIDIFILEHEADER) + 8);
+	}
+	return ProbeResult(ProbeSuccess, sizeof(MIDIFILEHEADER) + 8);
+}
+
+
+bool CSoundFile::ReadMID(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	file.Rewind();
+	const uint8 *lpStream = reinterpret_cast<const uint8 *>(file.GetRawData());
+	DWORD dwMemLength = file.GetLength();
 	const MIDIFILEHEADER *pmfh = (const MIDIFILEHEADER *)lpStream;
 	const MIDITRACKHEADER *pmth;
 	MODCHANNELSTATE chnstate[MAX_BASECHANNELS];
@@ -489,11 +538,14 @@ bool CSoundFile::ReadMID(const uint8 *lpStream, DWORD dwMemLength, ModLoadingFla
 	ROWINDEX importPatternLen = 128;
 #endif // MODPLUG_TRACKER
 
+	if(ProbeFileHeaderMID(file).confidence == ProbeFailure) return false;
+	else if(loadFlags == onlyVerifyHeader) return true;
+
 	// Fix import parameters
 	Limit(importSpeed, 2, 6);
 	Limit(importPatternLen, ROWINDEX(1), MAX_PATTERN_ROWS);
 
-	// Detect RMI files
+	// Unwrap RMI files
 	if ((dwMemLength > 12)
 	 && (*(DWORD *)(lpStream) == IFFID_RIFF)
 	 && (*(DWORD *)(lpStream+8) == 0x44494D52))
@@ -518,13 +570,9 @@ bool CSoundFile::ReadMID(const uint8 *lpStream, DWORD dwMemLength, ModLoadingFla
 		}
 	}
 	// MIDI File Header
-	if ((dwMemLength < sizeof(MIDIFILEHEADER)+8) || (pmfh->id != 0x6468544D)) return false;
 	dwMemPos = 8 + BigEndian(pmfh->len);
-	if (dwMemPos >= dwMemLength - 8) return false;
 	pmth = (MIDITRACKHEADER *)(lpStream+dwMemPos);
 	tracks = BigEndianW(pmfh->wTrks);
-	if ((pmth->id != 0x6B72544D) || (!tracks)) return false;
-	else if(loadFlags == onlyVerifyHeader) return true;
 	miditracks.resize(tracks);
 
 	// Reading File...
@@ -1200,7 +1248,12 @@ bool CSoundFile::ReadMID(const uint8 *lpStream, DWORD dwMemLength, ModLoadingFla
 
 #else // !MODPLUG_TRACKER
 
-bool CSoundFile::ReadMID(const BYTE * /*lpStream*/, DWORD /*dwMemLength*/, ModLoadingFlags /*loadFlags*/)
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMID(FileReader /*file*/)
+{
+	return ProbeResult(ProbeFailure);
+}
+
+bool CSoundFile::ReadMID(FileReader & /*file*/, ModLoadingFlags /*loadFlags*/)
 {
 	return false;
 }
@@ -15,13 +15,24 @@
 OPENMPT_NAMESPACE_BEGIN
 
 
-bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMO3(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 
 	// No valid MO3 file (magic bytes: "MO3")
 	if(!file.CanRead(8) || !file.ReadMagic("MO3"))
+	{
+		return ProbeResult(ProbeFailure, 8);
+	}
+	return ProbeResult(ProbeSuccess, 8);
+}
+
+
+bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderMO3(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -29,6 +40,8 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Seek(3);
+
 #ifdef NO_MO3
 	// As of November 2013, the format revision is 5; Versions > 31 are unlikely to exist in the next few years,
 	// so we will just ignore those if there's no UNMO3 library to tell us if the file is valid or not
@@ -495,63 +495,91 @@ void CSoundFile::ReadMODPatternEntry(FileReader &file, ModCommand &m) const
 }
 
 
-bool CSoundFile::ReadMod(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+// Get the number of channels from the MOD magic bytes at offset 1080, or 0 if they are unknown.
+// If the magic bytes identify the tracker, its name is returned in madeWithTracker.
+static CHANNELINDEX GetMODChannels(const char (&magic)[4], const char *&madeWithTracker)
+//--------------------------------------------------------------------------------------
 {
-	char magic[4];
-	if(!file.Seek(1080) || !file.ReadArray(magic))
-	{
-		return false;
-	}
-
-	InitializeGlobals();
-	m_nChannels = 4;
-
-	// Check MOD Magic
 	if(IsMagic(magic, "M.K.")		// ProTracker and compatible
 		|| IsMagic(magic, "M!K!")	// ProTracker (64+ patterns)
 		|| IsMagic(magic, "M&K!")	// NoiseTracker
 		|| IsMagic(magic, "N.T.")	// NoiseTracker
 		|| IsMagic(magic, "FEST"))	// jobbig.mod by Mahoney
 	{
-		m_nChannels = 4;
+		return 4;
 	} else if(IsMagic(magic, "CD81"))	// Falcon
 	{
-		m_nChannels = 8;
 		madeWithTracker = "Falcon";
+		return 8;
 	} else if(IsMagic(magic, "OKTA")	// Oktalyzer
 		|| IsMagic(magic, "OCTA"))		// Oktalyzer
 	{
-		m_nChannels = 8;
 		madeWithTracker = "Oktalyzer";
+		return 8;
 	} else if((!memcmp(magic, "FLT", 3) || !memcmp(magic, "EXO", 3)) && magic[3] >= '4' && magic[3] <= '9')
 	{
 		// FLTx / EXOx - Startrekker by Exolon / Fairlight
-		m_nChannels = magic[3] - '0';
 		madeWithTracker = "Startrekker";
+		return magic[3] - '0';
 	} else if(magic[0] >= '1' && magic[0] <= '9' && !memcmp(magic + 1, "CHN", 3))
 	{
 		// xCHN - Many trackers
-		m_nChannels = magic[0] - '0';
+		return magic[0] - '0';
 	} else if(magic[0] >= '1' && magic[0] <= '9' && magic[1]>='0' && magic[1] <= '9'
 		&& (!memcmp(magic + 2, "CH", 2) || !memcmp(magic + 2, "CN", 2)))
 	{
 		// xxCN / xxCH - Many trackers
-		m_nChannels = (magic[0] - '0') * 10 + magic[1] - '0';
+		return (magic[0] - '0') * 10 + magic[1] - '0';
 	} else if(!memcmp(magic, "TDZ", 3) && magic[3] >= '4' && magic[3] <= '9')
 	{
 		// TDZx - TakeTracker
-		m_nChannels = magic[3] - '0';
 		madeWithTracker = "TakeTracker";
-	} else
+		return magic[3] - '0';
+	}
+	return 0;
+}
+
+
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMOD(FileReader file)
+//---------------------------------------------------------------------
+{
+	char magic[4];
+	const char *madeWithTracker = nullptr;
+	if(!file.Seek(1080)
+		|| !file.ReadArray(magic)
+		|| !GetMODChannels(magic, madeWithTracker))
 	{
-		return false;
+		return ProbeResult(ProbeFailure, 1080 + 4);
 	}
-	if(loadFlags == onlyVerifyHeader)
+	return ProbeResult(ProbeSuccess, 1080 + 4);
+}
+
+
+bool CSoundFile::ReadMod(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderMOD(file).confidence == ProbeFailure)
+	{
+		return false;
+	} else if(loadFlags == onlyVerifyHeader)
 	{
 		return true;
 	}
 
+	char magic[4];
+	file.Seek(1080);
+	file.ReadArray(magic);
+
+	InitializeGlobals();
+
+	// Check MOD Magic
+	const char *trackerName = nullptr;
+	m_nChannels = GetMODChannels(magic, trackerName);
+	if(trackerName != nullptr)
+	{
+		madeWithTracker = trackerName;
+	}
+
 	LimitMax(m_nChannels, MAX_BASECHANNELS);
 
 	// Startrekker 8 channel mod (needs special treatment, see below)
@@ -804,19 +832,65 @@ enum STVersions
 };
 
 
-bool CSoundFile::ReadM15(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+// 15-sample modules have no magic bytes, so the probe only applies the same sanity checks to the header as the loader.
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderM15(FileReader file)
+//---------------------------------------------------------------------
 {
+	const uint32 headerSize = 20 + sizeof(MODSampleHeader) * 15 + sizeof(MODFileHeader);
 	file.Rewind();
 
 	char songname[20];
 	file.ReadArray(songname);
 	if(!IsValidName(songname, sizeof(songname), ' ')
 		|| !file.CanRead(sizeof(MODSampleHeader) * 15 + sizeof(MODFileHeader)))
+	{
+		return ProbeResult(ProbeFailure, headerSize);
+	}
+
+	for(SAMPLEINDEX smp = 1; smp <= 15; smp++)
+	{
+		MODSampleHeader sampleHeader;
+		file.ReadConvertEndianness(sampleHeader);
+		if(!IsValidName(sampleHeader.name, sizeof(sampleHeader.name), 14)
+			|| sampleHeader.volume > 64
+			|| (sampleHeader.finetune >> 4) != 0
+			|| sampleHeader.length > 32768)
+		{
+			return ProbeResult(ProbeFailure, headerSize);
+		}
+	}
+
+	MODFileHeader fileHeader;
+	file.ReadStruct(fileHeader);
+	// No more than 128 positions. ST's GUI limits tempo to [1, 220].
+	if(fileHeader.numOrders > 128 || fileHeader.restartPos == 0 || fileHeader.restartPos > 220)
+	{
+		return ProbeResult(ProbeFailure, headerSize);
+	}
+	for(ORDERINDEX ord = 0; ord < CountOf(fileHeader.orderList); ord++)
+	{
+		// 64 patterns max.
+		if(fileHeader.orderList[ord] > 63)
+		{
+			return ProbeResult(ProbeFailure, headerSize);
+		}
+	}
+	return ProbeResult(ProbeWeak, headerSize);
+}
+
+
+bool CSoundFile::ReadM15(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderM15(file).confidence == ProbeFailure)
 	{
 		return false;
 	}
 
+	file.Rewind();
+	char songname[20];
+	file.ReadArray(songname);
+
 	InitializeGlobals();
 	m_nChannels = 4;
 
@@ -830,15 +904,6 @@ bool CSoundFile::ReadM15(FileReader &file, ModLoadingFlags loadFlags)
 	{
 		MODSampleHeader sampleHeader;
 		ReadSample(file, sampleHeader, Samples[smp], m_szNames[smp]);
-
-		// Sanity checks
-		if(!IsValidName(sampleHeader.name, sizeof(sampleHeader.name), 14)
-			|| sampleHeader.volume > 64
-			|| (sampleHeader.finetune >> 4) != 0
-			|| sampleHeader.length > 32768)
-		{
-			return false;
-		}
 		ASSERT(sampleHeader.finetune == 0);
 
 		totalSampleLen += Samples[smp].nLength;
@@ -867,21 +932,6 @@ bool CSoundFile::ReadM15(FileReader &file, ModLoadingFlags loadFlags)
 	MODFileHeader fileHeader;
 	file.ReadStruct(fileHeader);
 
-	// Sanity check: No more than 128 positions. ST's GUI limits tempo to [1, 220].
-	if(fileHeader.numOrders > 128 || fileHeader.restartPos == 0 || fileHeader.restartPos > 220)
-	{
-		return false;
-	}
-
-	for(ORDERINDEX ord = 0; ord < CountOf(fileHeader.orderList); ord++)
-	{
-		// Sanity check: 64 patterns max.
-		if(fileHeader.orderList[ord] > 63)
-		{
-			return false;
-		}
-	}
-
 	Order.ReadFromArray(fileHeader.orderList);
 	PATTERNINDEX numPatterns = GetNumPatterns(file, Order, fileHeader.numOrders, totalSampleLen, m_nChannels, false);
 
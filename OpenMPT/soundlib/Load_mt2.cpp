@@ -429,8 +429,8 @@ static void ReadMT2Automation(uint16 version, FileReader &file)
 }
 
 
-bool CSoundFile::ReadMT2(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMT2(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 	MT2FileHeader fileHeader;
@@ -438,6 +438,17 @@ bool CSoundFile::ReadMT2(FileReader &file, ModLoadingFlags loadFlags)
 		|| memcmp(fileHeader.signature, "MT20", 4)
 		|| fileHeader.version < 0x200 || fileHeader.version >= 0x300
 		|| fileHeader.numOrders > 256)
+	{
+		return ProbeResult(ProbeFailure, sizeof(MT2FileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(MT2FileHeader));
+}
+
+
+bool CSoundFile::ReadMT2(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderMT2(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -445,6 +456,10 @@ bool CSoundFile::ReadMT2(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	MT2FileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 	InitializeChannels();
 	m_nType = MOD_TYPE_MT2;
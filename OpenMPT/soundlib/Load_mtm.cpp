@@ -99,8 +99,8 @@ STATIC_ASSERT(sizeof(MTMSampleHeader) == 37);
 #endif
 
 
-bool CSoundFile::ReadMTM(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderMTM(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 	MTMFileHeader fileHeader;
@@ -112,6 +112,17 @@ bool CSoundFile::ReadMTM(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.lastPattern >= MAX_PATTERNS
 		|| fileHeader.beatsPerTrack == 0
 		|| !file.CanRead(sizeof(MTMSampleHeader) * fileHeader.numSamples + 128 + 192 * fileHeader.numTracks + 64 * (fileHeader.lastPattern + 1) + fileHeader.commentSize))
+	{
+		return ProbeResult(ProbeFailure, sizeof(MTMFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(MTMFileHeader));
+}
+
+
+bool CSoundFile::ReadMTM(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderMTM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -119,6 +130,10 @@ bool CSoundFile::ReadMTM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	MTMFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 	mpt::String::Read<mpt::String::maybeNullTerminated>(songName, fileHeader.songName);
 	m_nType = MOD_TYPE_MTM;
@@ -282,15 +282,51 @@ static void ReadOKTPattern(FileReader &chunk, PATTERNINDEX nPat, CSoundFile &snd
 }
 
 
-bool CSoundFile::ReadOKT(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderOKT(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 	if(!file.ReadMagic("OKTASONG"))
+	{
+		return ProbeResult(ProbeFailure, 8 + sizeof(OktIffChunk));
+	}
+
+	// The loader needs a channel setup chunk, which is usually the first chunk.
+	while(file.AreBytesLeft())
+	{
+		OktIffChunk iffHead;
+		if(!file.ReadConvertEndianness(iffHead))
+		{
+			break;
+		}
+
+		FileReader chunk = file.ReadChunk(iffHead.chunksize);
+		if(!chunk.IsValid())
+		{
+			break;
+		}
+		if(iffHead.signature == OktIffChunk::idCMOD && chunk.GetLength() >= 8)
+		{
+			return ProbeResult(ProbeSuccess, 8 + sizeof(OktIffChunk));
+		}
+	}
+	return ProbeResult(ProbeFailure, 8 + sizeof(OktIffChunk));
+}
+
+
+bool CSoundFile::ReadOKT(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderOKT(file).confidence == ProbeFailure)
 	{
 		return false;
+	} else if(loadFlags == onlyVerifyHeader)
+	{
+		return true;
 	}
 
+	file.Seek(8);
+
 	// prepare some arrays to store offsets etc.
 	std::vector<FileReader> patternChunks;
 	std::vector<FileReader> sampleChunks;
@@ -335,11 +371,6 @@ bool CSoundFile::ReadOKT(FileReader &file, ModLoadingFlags loadFlags)
 				ChnSettings[m_nChannels].Reset();
 				ChnSettings[m_nChannels++].nPan = (((nChn & 3) == 1) || ((nChn & 3) == 2)) ? 0xC0 : 0x40;
 			}
-
-			if(loadFlags == onlyVerifyHeader)
-			{
-				return true;
-			}
 			break;
 
 		case OktIffChunk::idSAMP:
@@ -254,22 +254,26 @@ static uint8 ConvertPSMPorta(uint8 param, bool newFormat)
 }
 
 
-bool CSoundFile::ReadPSM(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderPSM(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 	PSMFileHeader fileHeader;
-	if(!file.ReadConvertEndianness(fileHeader))
+	if(!file.ReadConvertEndianness(fileHeader)
+		|| memcmp(fileHeader.formatID, "PSM ", 4)
+		|| fileHeader.fileSize != file.BytesLeft()
+		|| memcmp(fileHeader.fileInfoID, "FILE", 4))
 	{
-		return false;
+		return ProbeResult(ProbeFailure, sizeof(PSMFileHeader));
 	}
+	return ProbeResult(ProbeSuccess, sizeof(PSMFileHeader));
+}
 
-	bool newFormat = false; // The game "Sinaria" uses a slightly modified PSM structure
 
-	// Check header
-	if(memcmp(fileHeader.formatID, "PSM ", 4)
-		|| fileHeader.fileSize != file.BytesLeft()
-		|| memcmp(fileHeader.fileInfoID, "FILE", 4))
+bool CSoundFile::ReadPSM(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderPSM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -277,6 +281,12 @@ bool CSoundFile::ReadPSM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	PSMFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
+	bool newFormat = false; // The game "Sinaria" uses a slightly modified PSM structure
+
 	// Yep, this seems to be a valid file.
 	InitializeGlobals();
 	m_nType = MOD_TYPE_PSM;
@@ -1124,8 +1134,8 @@ STATIC_ASSERT(sizeof(PSM16PatternHeader) == 4);
 #endif
 
 
-bool CSoundFile::ReadPSM16(FileReader &file, ModLoadingFlags loadFlags)
-//---------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderPSM16(FileReader file)
+//-----------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -1138,6 +1148,17 @@ bool CSoundFile::ReadPSM16(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.patternVersion != 0 // 255ch pattern version not supported (did anyone use this?)
 		|| (fileHeader.songType & 3) != 0
 		|| std::max(fileHeader.numChannelsPlay, fileHeader.numChannelsReal) == 0)
+	{
+		return ProbeResult(ProbeFailure, sizeof(PSM16FileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(PSM16FileHeader));
+}
+
+
+bool CSoundFile::ReadPSM16(FileReader &file, ModLoadingFlags loadFlags)
+//---------------------------------------------------------------------
+{
+	if(ProbeFileHeaderPSM16(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -1145,6 +1166,10 @@ bool CSoundFile::ReadPSM16(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	PSM16FileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	// Seems to be valid!
 	InitializeGlobals();
 	madeWithTracker = "Epic MegaGames MASI (Old Version)";
@@ -136,8 +136,8 @@ STATIC_ASSERT(sizeof(PTMSampleHeader) == 80);
 #endif
 
 
-bool CSoundFile::ReadPTM(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderPTM(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -153,6 +153,17 @@ bool CSoundFile::ReadPTM(FileReader &file, ModLoadingFlags loadFlags)
 		|| !fileHeader.numSamples || fileHeader.numSamples > 255
 		|| !fileHeader.numPatterns || fileHeader.numPatterns > 128
 		|| !file.CanRead(fileHeader.numSamples * sizeof(PTMSampleHeader)))
+	{
+		return ProbeResult(ProbeFailure, sizeof(PTMFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(PTMFileHeader));
+}
+
+
+bool CSoundFile::ReadPTM(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderPTM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -160,6 +171,10 @@ bool CSoundFile::ReadPTM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	PTMFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 	m_nType = MOD_TYPE_PTM;
 
@@ -183,8 +183,8 @@ struct FixPixPlayPanning
 };
 
 
-bool CSoundFile::ReadS3M(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderS3M(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -195,6 +195,17 @@ bool CSoundFile::ReadS3M(FileReader &file, ModLoadingFlags loadFlags)
 		|| memcmp(fileHeader.magic, "SCRM", 4)
 		|| fileHeader.fileType != S3MFileHeader::idS3MType
 		|| (fileHeader.formatVersion != S3MFileHeader::oldVersion && fileHeader.formatVersion != S3MFileHeader::newVersion))
+	{
+		return ProbeResult(ProbeFailure, sizeof(S3MFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(S3MFileHeader));
+}
+
+
+bool CSoundFile::ReadS3M(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderS3M(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -202,6 +213,10 @@ bool CSoundFile::ReadS3M(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	S3MFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 
 	// ST3 ignored Zxx commands, so if we find that a file was made with ST3, we should erase all MIDI macros.
@@ -137,8 +137,8 @@ STATIC_ASSERT(sizeof(STMPatternData) == 4*64*4);
 #endif
 
 
-bool CSoundFile::ReadSTM(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderSTM(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -148,6 +148,17 @@ bool CSoundFile::ReadSTM(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.dosEof != 0x1A
 		|| (mpt::strnicmp(fileHeader.trackername, "!SCREAM!", 8)
 			&& mpt::strnicmp(fileHeader.trackername, "BMOD2STM", 8)))
+	{
+		return ProbeResult(ProbeFailure, sizeof(STMFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(STMFileHeader));
+}
+
+
+bool CSoundFile::ReadSTM(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderSTM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -155,6 +166,10 @@ bool CSoundFile::ReadSTM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	STMFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 	m_nType = MOD_TYPE_STM;
 
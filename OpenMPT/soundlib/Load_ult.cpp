@@ -376,8 +376,8 @@ struct PostFixUltCommands
 };
 
 
-bool CSoundFile::ReadUlt(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderULT(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 	UltFileHeader fileHeader;
@@ -387,6 +387,17 @@ bool CSoundFile::ReadUlt(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.version < '1'
 		|| fileHeader.version > '4'
 		|| memcmp(fileHeader.signature, "MAS_UTrack_V00", sizeof(fileHeader.signature)) != 0)
+	{
+		return ProbeResult(ProbeFailure, sizeof(UltFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(UltFileHeader));
+}
+
+
+bool CSoundFile::ReadUlt(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderULT(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -394,6 +405,10 @@ bool CSoundFile::ReadUlt(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	UltFileHeader fileHeader;
+	file.ReadStruct(fileHeader);
+
 	InitializeGlobals();
 	mpt::String::Read<mpt::String::maybeNullTerminated>(songName, fileHeader.songName);
 
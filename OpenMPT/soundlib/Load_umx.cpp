@@ -170,19 +170,38 @@ static void ReadUMXExportTableEntry(FileReader &chunk, int32 &objClass, int32 &o
 }
 
 
-bool CSoundFile::ReadUMX(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderUMX(FileReader file)
+//---------------------------------------------------------------------
 {
 	file.Rewind();
 	UMXFileHeader fileHeader;
 	if(!file.ReadConvertEndianness(fileHeader)
 		|| fileHeader.magic != UMXFileHeader::magicBytes
-		|| !file.Seek(fileHeader.nameOffset))
+		|| !file.Seek(fileHeader.nameOffset)
+		|| !file.Seek(fileHeader.importOffset)
+		|| !file.Seek(fileHeader.exportOffset))
+	{
+		return ProbeResult(ProbeFailure, sizeof(UMXFileHeader));
+	}
+	// Whether the package contains any music can only be found out by reading the name and object tables.
+	return ProbeResult(ProbeSuccess, sizeof(UMXFileHeader));
+}
+
+
+bool CSoundFile::ReadUMX(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderUMX(file).confidence == ProbeFailure)
 	{
 		return false;
 	}
 
+	file.Rewind();
+	UMXFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	// Read name table
+	file.Seek(fileHeader.nameOffset);
 	std::vector<std::string> names;
 	names.reserve(fileHeader.nameCount);
 	for(uint32 i = 0; i < fileHeader.nameCount; i++)
@@ -191,10 +210,7 @@ bool CSoundFile::ReadUMX(FileReader &file, ModLoadingFlags loadFlags)
 	}
 
 	// Read import table
-	if(!file.Seek(fileHeader.importOffset))
-	{
-		return false;
-	}
+	file.Seek(fileHeader.importOffset);
 
 	std::vector<int32> classes;
 	classes.reserve(fileHeader.importCount);
@@ -208,10 +224,7 @@ bool CSoundFile::ReadUMX(FileReader &file, ModLoadingFlags loadFlags)
 	}
 
 	// Read export table
-	if(!file.Seek(fileHeader.exportOffset))
-	{
-		return false;
-	}
+	file.Seek(fileHeader.exportOffset);
 
 	// Now we can be pretty sure that we're doing the right thing.
 	InitializeGlobals();
@@ -42,8 +42,8 @@ bool CopyWavChannel(ModSample &sample, const FileReader &file, size_t channelInd
 }
 
 
-bool CSoundFile::ReadWav(FileReader &file, ModLoadingFlags loadFlags)
-//-------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderWAV(FileReader file)
+//---------------------------------------------------------------------
 {
 	WAVReader wavFile(file);
 
@@ -53,6 +53,17 @@ bool CSoundFile::ReadWav(FileReader &file, ModLoadingFlags loadFlags)
 		|| wavFile.GetBitsPerSample() == 0
 		|| wavFile.GetBitsPerSample() > 32
 		|| (wavFile.GetSampleFormat() != WAVFormatChunk::fmtPCM && wavFile.GetSampleFormat() != WAVFormatChunk::fmtFloat))
+	{
+		return ProbeResult(ProbeFailure, 12 + 8 + sizeof(WAVFormatChunk));
+	}
+	return ProbeResult(ProbeSuccess, 12 + 8 + sizeof(WAVFormatChunk));
+}
+
+
+bool CSoundFile::ReadWav(FileReader &file, ModLoadingFlags loadFlags)
+//-------------------------------------------------------------------
+{
+	if(ProbeFileHeaderWAV(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -60,6 +71,8 @@ bool CSoundFile::ReadWav(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	WAVReader wavFile(file);
+
 	InitializeGlobals();
 	m_nChannels = std::max(wavFile.GetNumChannels(), uint16(2));
 	if(Patterns.Insert(0, 64) || Patterns.Insert(1, 64))
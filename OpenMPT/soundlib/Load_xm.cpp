@@ -123,8 +123,8 @@ static std::vector<SAMPLEINDEX> AllocateXMSamples(CSoundFile &sndFile, SAMPLEIND
 
 
 // Read .XM patterns
-static void ReadXMPatterns(FileReader &file, const XMFileHeader &fileHeader, CSoundFile &sndFile)
-//-----------------------------------------------------------------------------------------------
+static void ReadXMPatterns(FileReader &file, const XMFileHeader &fileHeader, CSoundFile &sndFile, bool loadPatterns)
+//------------------------------------------------------------------------------------------------------------------
 {
 	// Reading patterns
 	sndFile.Patterns.ResizeArray(fileHeader.patterns);
@@ -155,7 +155,7 @@ static void ReadXMPatterns(FileReader &file, const XMFileHeader &fileHeader, CSo
 		file.Seek(curPos + headerSize);
 		FileReader patternChunk = file.ReadChunk(packedSize);
 
-		if(sndFile.Patterns.Insert(pat, numRows) || packedSize == 0)
+		if(!loadPatterns || sndFile.Patterns.Insert(pat, numRows) || packedSize == 0)
 		{
 			continue;
 		}
@@ -262,8 +262,8 @@ enum TrackerVersions
 DECLARE_FLAGSET(TrackerVersions)
 
 
-bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
-//------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderXM(FileReader file)
+//--------------------------------------------------------------------
 {
 	file.Rewind();
 
@@ -273,6 +273,17 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 		|| fileHeader.channels > MAX_BASECHANNELS
 		|| mpt::strnicmp(fileHeader.signature, "Extended Module: ", 17)
 		|| !file.CanRead(fileHeader.orders))
+	{
+		return ProbeResult(ProbeFailure, sizeof(XMFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(XMFileHeader));
+}
+
+
+bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
+//------------------------------------------------------------------
+{
+	if(ProbeFileHeaderXM(file).confidence == ProbeFailure)
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -280,6 +291,10 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 		return true;
 	}
 
+	file.Rewind();
+	XMFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
 	InitializeGlobals();
 	InitializeChannels();
 	ChangeModTypeTo(MOD_TYPE_XM);
@@ -341,12 +356,14 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 
 	if(fileHeader.version >= 0x0104)
 	{
-		ReadXMPatterns(file, fileHeader, *this);
+		ReadXMPatterns(file, fileHeader, *this, (loadFlags & loadPatternData) != 0);
 	}
 
 	// In case of XM versions < 1.04, we need to memorize the sample flags for all samples, as they are not stored immediately after the sample headers.
 	std::vector<SampleIO> sampleFlags;
 	uint8 sampleReserved = 0;
+	// Sample data of XM 1.04+ files is decoded after all instruments have been read, so that it can be done by several threads.
+	SampleReadQueue sampleQueue(GetLoaderThreads());
 	int instrType = -1;
 
 	// Reading instruments
@@ -428,6 +445,11 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 			}
 
 			// Read sample headers
+			if(GetNumSamples() + instrHeader.numSamples >= MAX_SAMPLES)
+			{
+				// Sample slots may have to be reused, which needs to know which samples actually contain data.
+				sampleQueue.Read();
+			}
 			std::vector<SAMPLEINDEX> sampleSlots = AllocateXMSamples(*this, instrHeader.numSamples);
 
 			// Update sample assignment map
@@ -484,14 +506,15 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 					// Sample 15 in dirtysex.xm by J/M/T/M is a 16-bit sample with an odd size of 0x18B according to the header, while the real sample size would be 0x18A.
 					// Always read as many bytes as specified in the header, even if the sample reader would probably read less bytes.
 					FileReader sampleChunk = file.ReadChunk(sampleFlags[sample].GetEncoding() != SampleIO::ADPCM ? sampleSize[sample] : (16 + (sampleSize[sample] + 1) / 2));
-					if(sample < sampleSlots.size())
+					if(sample < sampleSlots.size() && (loadFlags & loadSampleData))
 					{
-						sampleFlags[sample].ReadSample(Samples[sampleSlots[sample]], sampleChunk);
+						sampleQueue.Add(sampleFlags[sample], Samples[sampleSlots[sample]], sampleChunk);
 					}
 				}
 			}
 		}
 	}
+	sampleQueue.Read();
 
 	if(sampleReserved == 0 && madeWith[verNewModPlug] && memchr(fileHeader.songName, '\0', sizeof(fileHeader.songName)) != nullptr)
 	{
@@ -502,8 +525,9 @@ bool CSoundFile::ReadXM(FileReader &file, ModLoadingFlags loadFlags)
 	if(fileHeader.version < 0x0104)
 	{
 		// Load Patterns and Samples (Version 1.02 and 1.03)
-		ReadXMPatterns(file, fileHeader, *this);
+		ReadXMPatterns(file, fileHeader, *this, (loadFlags & loadPatternData) != 0);
 
+		// The sample data has to be read even if it is not wanted, as the song message follows it.
 		for(SAMPLEINDEX sample = 1; sample <= GetNumSamples(); sample++)
 		{
 			sampleFlags[sample - 1].ReadSample(Samples[sample], file);
@@ -492,4 +492,144 @@ std::string MIDIMacroConfig::GetSafeMacro(const char *macro) const
 }
 
 
+CompiledMIDIMacro::CompiledMIDIMacro()
+//------------------------------------
+	: numOps(0)
+{
+	MemsetZero(source);
+}
+
+
+// Translate a macro string into output byte operations. See Impulse Tracker's MIDI.TXT for detailed information on each possible character.
+// This must produce exactly the same bytes as the string would have produced if it was interpreted directly.
+void CompiledMIDIMacro::Compile(const char (&macro)[MACRO_LENGTH])
+//----------------------------------------------------------------
+{
+	memcpy(source, macro, MACRO_LENGTH);
+	numOps = 0;
+
+	bool firstNibble = true;
+	uint8 highNibble = 0;			// first nibble of the current byte
+	bool highIsChannel = false;		// first nibble of the current byte is the 'c' variable
+
+	for(size_t pos = 0; pos < (MACRO_LENGTH - 1) && macro[pos]; pos++)
+	{
+		bool isNibble = false;		// did we parse a nibble or a byte value?
+		bool isChannel = false;		// nibble is the 'c' variable
+		uint8 nibble = 0;
+		OpType type = opConstant;
+
+		const char c = macro[pos];
+		if(c >= '0' && c <= '9')
+		{
+			isNibble = true;
+			nibble = static_cast<uint8>(c - '0');
+		} else if(c >= 'A' && c <= 'F')
+		{
+			isNibble = true;
+			nibble = static_cast<uint8>(c - 'A' + 0x0A);
+		} else if(c == 'c')
+		{
+			isNibble = true;
+			isChannel = true;
+		} else if(c == 'n')
+		{
+			type = opNote;
+		} else if(c == 'v')
+		{
+			type = opVelocity;
+		} else if(c == 'u')
+		{
+			type = opVolume;
+		} else if(c == 'x')
+		{
+			type = opPan;
+		} else if(c == 'y')
+		{
+			type = opRealPan;
+		} else if(c == 'a')
+		{
+			type = opBankHigh;
+		} else if(c == 'b')
+		{
+			type = opBankLow;
+		} else if(c == 'p')
+		{
+			type = opProgram;
+		} else if(c == 'z')
+		{
+			type = opParam;
+		} else
+		{
+			// Unrecognized byte (e.g. space char)
+			continue;
+		}
+
+		if(isNibble)
+		{
+			if(firstNibble)
+			{
+				highNibble = nibble;
+				highIsChannel = isChannel;
+			} else
+			{
+				Op &op = ops[numOps++];
+				op.value = 0;
+				if(highIsChannel && isChannel)
+				{
+					op.type = opChannelBoth;
+				} else if(highIsChannel)
+				{
+					op.type = opChannelHigh;
+					op.value = nibble;
+				} else if(isChannel)
+				{
+					op.type = opChannelLow;
+					op.value = highNibble;
+				} else
+				{
+					op.type = opConstant;
+					op.value = static_cast<uint8>((highNibble << 4) | nibble);
+				}
+			}
+			firstNibble = !firstNibble;
+		} else
+		{
+			if(!firstNibble)
+			{
+				// From MIDI.TXT: '9n' is exactly the same as '09 n' or '9 n' -- so finish current byte first
+				ops[numOps].type = static_cast<uint8>(highIsChannel ? opChannel : opConstant);
+				ops[numOps].value = highIsChannel ? 0 : highNibble;
+				numOps++;
+			}
+			ops[numOps].type = static_cast<uint8>(type);
+			ops[numOps].value = 0;
+			numOps++;
+			firstNibble = true;
+		}
+	}
+	if(!firstNibble)
+	{
+		// Finish current byte
+		ops[numOps].type = static_cast<uint8>(highIsChannel ? opChannel : opConstant);
+		ops[numOps].value = highIsChannel ? 0 : highNibble;
+		numOps++;
+	}
+}
+
+
+void CompiledMIDIMacroConfig::Compile(const MIDIMacroConfig &config)
+//------------------------------------------------------------------
+{
+	for(size_t i = 0; i < CountOf(sfx); i++)
+	{
+		sfx[i].Compile(config.szMidiSFXExt[i]);
+	}
+	for(size_t i = 0; i < CountOf(zxx); i++)
+	{
+		zxx[i].Compile(config.szMidiZXXExt[i]);
+	}
+}
+
+
 OPENMPT_NAMESPACE_END
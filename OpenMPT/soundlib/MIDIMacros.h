@@ -167,4 +167,84 @@ STATIC_ASSERT(sizeof(MIDIMacroConfig) == sizeof(MIDIMacroConfigData)); // this i
 #pragma pack(pop)
 #endif
 
+
+// A macro string translated into a list of output bytes, so that it does not have to be parsed again on every tick.
+//=====================
+class CompiledMIDIMacro
+//=====================
+{
+public:
+	// How each output byte is formed
+	enum OpType
+	{
+		opConstant = 0,		// value
+		opChannelLow,		// (value << 4) | MIDI channel, e.g. "9c"
+		opChannelHigh,		// (MIDI channel << 4) | value, e.g. "c0"
+		opChannelBoth,		// (MIDI channel << 4) | MIDI channel, i.e. "cc"
+		opChannel,			// MIDI channel on its own, e.g. "c n"
+		opNote,				// n: note value (last triggered note)
+		opVelocity,			// v: velocity
+		opVolume,			// u: volume (calculated)
+		opPan,				// x: pan set
+		opRealPan,			// y: calculated pan
+		opBankHigh,			// a: high byte of bank select
+		opBankLow,			// b: low byte of bank select
+		opProgram,			// p: program select
+		opParam,			// z: macro data
+	};
+
+	struct Op
+	{
+		uint8 type;
+		uint8 value;
+	};
+
+	Op ops[MACRO_LENGTH - 1];
+	uint8 numOps;
+
+	CompiledMIDIMacro();
+
+	// Translate a macro string. The string is remembered so that later changes to it can be detected by IsUpToDate().
+	void Compile(const char (&macro)[MACRO_LENGTH]);
+
+	bool IsUpToDate(const char (&macro)[MACRO_LENGTH]) const { return !memcmp(source, macro, MACRO_LENGTH); }
+
+protected:
+	char source[MACRO_LENGTH];
+};
+
+
+// Compiled versions of the parametered and fixed macros of a MIDIMacroConfig.
+// Macros are recompiled on access if their string has been edited since they were compiled, so the config can still be modified directly.
+//===========================
+class CompiledMIDIMacroConfig
+//===========================
+{
+public:
+	// Compile all macros of the given config.
+	void Compile(const MIDIMacroConfig &config);
+
+	const CompiledMIDIMacro &GetParameteredMacro(const MIDIMacroConfig &config, size_t macroIndex)
+	{
+		return Get(sfx[macroIndex], config.szMidiSFXExt[macroIndex]);
+	}
+	const CompiledMIDIMacro &GetFixedMacro(const MIDIMacroConfig &config, size_t macroIndex)
+	{
+		return Get(zxx[macroIndex], config.szMidiZXXExt[macroIndex]);
+	}
+
+protected:
+	static const CompiledMIDIMacro &Get(CompiledMIDIMacro &compiled, const char (&macro)[MACRO_LENGTH])
+	{
+		if(!compiled.IsUpToDate(macro))
+		{
+			compiled.Compile(macro);
+		}
+		return compiled;
+	}
+
+	CompiledMIDIMacro sfx[NUM_MACROS];
+	CompiledMIDIMacro zxx[128];
+};
+
 OPENMPT_NAMESPACE_END
@@ -10,9 +10,15 @@
 
 #pragma once
 
+#include <vector>
+#include <cstring>
+
 OPENMPT_NAMESPACE_BEGIN
 
+// The fixed point mixer is used unless MPT_FLOATMIXER is defined (see BuildSettings.h).
+#ifndef MPT_FLOATMIXER
 #define MPT_INTMIXER
+#endif
 
 #ifdef MPT_INTMIXER
 typedef int32 mixsample_t;
@@ -21,7 +27,11 @@ enum { MIXING_FILTER_PRECISION = 13 };	// Fixed point resonant filter bits
 typedef float mixsample_t;
 #endif
 
+// Number of frames that are mixed at once by default (see MixerSettings::MixBufferSize).
+// This is also the block size for plugins, so chunks are never bigger than this while plugins are active.
 #define MIXBUFFERSIZE 512
+#define MIXBUFFERSIZE_MIN 16
+#define MIXBUFFERSIZE_MAX 16384
 
 #define VOLUMERAMPPRECISION 12	// Fractional bits in volume ramp variables
 
@@ -45,4 +55,44 @@ const float MIXING_SCALEF = static_cast<float>(1 << MIXING_FRACTIONAL_BITS);
 // The biggest sampling point size is currently 16-bit stereo = 2 * 2 bytes.
 #define MaxSamplingPointSize		4u
 
+
+
+// Heap-allocated mix buffer whose start is aligned to a cache line.
+// A few elements of padding follow the end, as some SIMD loops process up to one vector more than requested.
+template<typename T>
+//====================
+class AlignedMixBuffer
+//====================
+{
+public:
+	enum { alignment = 64, padding = 16 };
+
+	AlignedMixBuffer() : m_data(nullptr), m_size(0) { }
+
+	// Reallocate the buffer for the given number of elements. The new buffer is zeroed.
+	void Resize(std::size_t size)
+	{
+		m_storage.assign((size + padding) * sizeof(T) + alignment - 1, 0);
+		const std::size_t offset = (alignment - (reinterpret_cast<std::size_t>(&m_storage[0]) & (alignment - 1))) & (alignment - 1);
+		m_data = reinterpret_cast<T *>(&m_storage[offset]);
+		m_size = size;
+	}
+
+	void Clear() { if(m_data) std::memset(m_data, 0, (m_size + padding) * sizeof(T)); }
+
+	std::size_t size() const { return m_size; }
+	operator T * () { return m_data; }
+	operator const T * () const { return m_data; }
+
+protected:
+	std::vector<char> m_storage;
+	T *m_data;
+	std::size_t m_size;
+
+private:
+	AlignedMixBuffer(const AlignedMixBuffer &);
+	AlignedMixBuffer & operator= (const AlignedMixBuffer &);
+};
+
+
 OPENMPT_NAMESPACE_END
@@ -35,6 +35,7 @@ struct MixerTraits
 
 //////////////////////////////////////////////////////////////////////////
 // Interpolation templates
+// The last parameter of operator() is the fractional sample position, reduced to 16 bits (0...0xFFFF).
 
 template<class Traits>
 struct NoInterpolation
@@ -70,7 +71,7 @@ static void SampleLoop(ModChannel &chn, const CResampler &resampler, typename Tr
 	ModChannel &c = chn;
 	const typename Traits::input_t * MPT_RESTRICT inSample = static_cast<const typename Traits::input_t *>(c.pCurrentSample) + c.nPos * Traits::numChannelsIn;
 
-	int32 smpPos = c.nPosLo;	// 16.16 sample position relative to c.nPos
+	int64 smpPos = c.nPosLo;	// 32.32 sample position relative to c.nPos
 
 	InterpolationFunc interpolate;
 	FilterFunc filter;
@@ -85,7 +86,7 @@ static void SampleLoop(ModChannel &chn, const CResampler &resampler, typename Tr
 	while(samples--)
 	{
 		typename Traits::outbuf_t outSample;
-		interpolate(outSample, inSample + (smpPos >> 16) * Traits::numChannelsIn, (smpPos & 0xFFFF));
+		interpolate(outSample, inSample + static_cast<int32>(smpPos >> 32) * Traits::numChannelsIn, static_cast<int32>(static_cast<uint32>(smpPos) >> 16));
 		filter(outSample, c);
 		mix(outSample, c, outBuffer);
 		outBuffer += Traits::numChannelsOut;
@@ -97,11 +98,61 @@ static void SampleLoop(ModChannel &chn, const CResampler &resampler, typename Tr
 	filter.End(c);
 	interpolate.End(c);
 
-	c.nPos += smpPos >> 16;
-	c.nPosLo = smpPos & 0xFFFF;
+	c.nPos += static_cast<int32>(smpPos >> 32);
+	c.nPosLo = static_cast<uint32>(smpPos);
 }
 
-// Type of the SampleLoop function above
+
+// Number of sampling points that are rendered into a temporary buffer by SampleLoopBlock before they are mixed into the output buffer.
+enum { MIXING_BLOCK_SIZE = 64 };
+
+// Same as SampleLoop, but interpolation / filtering and mixing are done in two separate passes over short blocks,
+// so that the mix functor can process several sampling points at once (see IntMixerSIMD.h).
+// MixFunc must provide operator() (const outbuf_t *inBlock, int numSamples, const ModChannel &chn, output_t *outBuffer).
+template<class Traits, class InterpolationFunc, class FilterFunc, class MixFunc>
+static void SampleLoopBlock(ModChannel &chn, const CResampler &resampler, typename Traits::output_t * MPT_RESTRICT outBuffer, int numSamples)
+{
+	ModChannel &c = chn;
+	const typename Traits::input_t * MPT_RESTRICT inSample = static_cast<const typename Traits::input_t *>(c.pCurrentSample) + c.nPos * Traits::numChannelsIn;
+
+	int64 smpPos = c.nPosLo;	// 32.32 sample position relative to c.nPos
+
+	InterpolationFunc interpolate;
+	FilterFunc filter;
+	MixFunc mix;
+
+	// Do initialisation if necessary
+	interpolate.Start(c, resampler);
+	filter.Start(c);
+	mix.Start(c);
+
+	ALIGN(16) typename Traits::outbuf_t block[MIXING_BLOCK_SIZE];
+
+	int samples = numSamples;
+	while(samples > 0)
+	{
+		const int blockSize = std::min<int>(samples, MIXING_BLOCK_SIZE);
+		for(int i = 0; i < blockSize; i++)
+		{
+			interpolate(block[i], inSample + static_cast<int32>(smpPos >> 32) * Traits::numChannelsIn, static_cast<int32>(static_cast<uint32>(smpPos) >> 16));
+			filter(block[i], c);
+
+			smpPos += c.nInc;
+		}
+		mix(block, blockSize, c, outBuffer);
+		outBuffer += blockSize * Traits::numChannelsOut;
+		samples -= blockSize;
+	}
+
+	mix.End(c);
+	filter.End(c);
+	interpolate.End(c);
+
+	c.nPos += static_cast<int32>(smpPos >> 32);
+	c.nPosLo = static_cast<uint32>(smpPos);
+}
+
+// Type of the SampleLoop / SampleLoopBlock functions above
 typedef void (*MixFuncInterface)(ModChannel &, const CResampler &, mixsample_t *, int);
 
 OPENMPT_NAMESPACE_END
@@ -174,7 +174,7 @@ static void SSE2_StereoMixToFloat(const int32 *pSrc, float *pOut1, float *pOut2,
 	__m128 i2fc = _mm_load_ps1(&_i2fc);
 	const __m128i *in = reinterpret_cast<const __m128i *>(pSrc);
 
-	// We may read beyond the wanted length... this works because we know that we will always work on our buffers of size MIXBUFFERSIZE
+	// We may read beyond the wanted length... this works because we know that we will always work on our mix buffers, which are padded at the end (see AlignedMixBuffer)
 	nCount = (nCount + 3) / 4;
 	do
 	{
@@ -201,7 +201,7 @@ static void SSE2_FloatToStereoMix(const float *pIn1, const float *pIn2, int32 *p
 	__m128 f2ic = _mm_load_ps1(&_f2ic);
 	__m128i *out = reinterpret_cast<__m128i *>(pOut);
 
-	// We may read beyond the wanted length... this works because we know that we will always work on our buffers of size MIXBUFFERSIZE
+	// We may read beyond the wanted length... this works because we know that we will always work on our mix buffers, which are padded at the end (see AlignedMixBuffer)
 	nCount = (nCount + 3) / 4;
 	do
 	{
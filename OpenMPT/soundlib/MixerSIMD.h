@@ -0,0 +1,145 @@
+/*
+ * MixerSIMD.h
+ * -----------
+ * Purpose: Vector primitives shared by the vectorized fixed point and floating point mixer classes (SSE2 / NEON compiler intrinsics)
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#if defined(ENABLE_SSE2_INTRINSICS)
+#include <emmintrin.h>
+#elif defined(ENABLE_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
+OPENMPT_NAMESPACE_BEGIN
+
+#ifdef ENABLE_SIMD_INTRINSICS
+
+
+//////////////////////////////////////////////////////////////////////////
+// Vector primitives
+
+#if defined(ENABLE_SSE2_INTRINSICS)
+
+typedef __m128i simd_taps_t;	// 8 x int16
+
+// Split LRLRLRLR into LLLLRRRR
+static forceinline __m128i SSE2_DeinterleaveStereo16(__m128i x)
+{
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 1, 2, 0));
+	x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(3, 1, 2, 0));
+	return _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+#elif defined(ENABLE_NEON_INTRINSICS)
+
+typedef int16x8_t simd_taps_t;	// 8 x int16
+
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Tap loaders: Fetch the sampling points -3...+4 around the current position of each channel
+// and convert them to 16-bit integers (equivalent to IntToIntTraits::Convert).
+
+template<int channels, typename T>
+struct SIMDTapLoader;
+
+#if defined(ENABLE_SSE2_INTRINSICS)
+
+template<>
+struct SIMDTapLoader<1, int8>
+{
+	static forceinline void Load(simd_taps_t (&taps)[1], const int8 *in)
+	{
+		taps[0] = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in - 3)));
+	}
+};
+
+template<>
+struct SIMDTapLoader<1, int16>
+{
+	static forceinline void Load(simd_taps_t (&taps)[1], const int16 *in)
+	{
+		taps[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in - 3));
+	}
+};
+
+template<>
+struct SIMDTapLoader<2, int8>
+{
+	static forceinline void Load(simd_taps_t (&taps)[2], const int8 *in)
+	{
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in - 6));
+		const __m128i lo = SSE2_DeinterleaveStereo16(_mm_unpacklo_epi8(_mm_setzero_si128(), x));
+		const __m128i hi = SSE2_DeinterleaveStereo16(_mm_unpackhi_epi8(_mm_setzero_si128(), x));
+		taps[0] = _mm_unpacklo_epi64(lo, hi);
+		taps[1] = _mm_unpackhi_epi64(lo, hi);
+	}
+};
+
+template<>
+struct SIMDTapLoader<2, int16>
+{
+	static forceinline void Load(simd_taps_t (&taps)[2], const int16 *in)
+	{
+		const __m128i lo = SSE2_DeinterleaveStereo16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in - 6)));
+		const __m128i hi = SSE2_DeinterleaveStereo16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2)));
+		taps[0] = _mm_unpacklo_epi64(lo, hi);
+		taps[1] = _mm_unpackhi_epi64(lo, hi);
+	}
+};
+
+#elif defined(ENABLE_NEON_INTRINSICS)
+
+template<>
+struct SIMDTapLoader<1, int8>
+{
+	static forceinline void Load(simd_taps_t (&taps)[1], const int8 *in)
+	{
+		taps[0] = vshll_n_s8(vld1_s8(in - 3), 8);
+	}
+};
+
+template<>
+struct SIMDTapLoader<1, int16>
+{
+	static forceinline void Load(simd_taps_t (&taps)[1], const int16 *in)
+	{
+		taps[0] = vld1q_s16(in - 3);
+	}
+};
+
+template<>
+struct SIMDTapLoader<2, int8>
+{
+	static forceinline void Load(simd_taps_t (&taps)[2], const int8 *in)
+	{
+		const int8x8x2_t x = vld2_s8(in - 6);
+		taps[0] = vshll_n_s8(x.val[0], 8);
+		taps[1] = vshll_n_s8(x.val[1], 8);
+	}
+};
+
+template<>
+struct SIMDTapLoader<2, int16>
+{
+	static forceinline void Load(simd_taps_t (&taps)[2], const int16 *in)
+	{
+		const int16x8x2_t x = vld2q_s16(in - 6);
+		taps[0] = x.val[0];
+		taps[1] = x.val[1];
+	}
+};
+
+#endif
+
+
+#endif // ENABLE_SIMD_INTRINSICS
+
+OPENMPT_NAMESPACE_END
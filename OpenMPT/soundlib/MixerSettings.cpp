@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "MixerSettings.h"
 #include "Snd_defs.h"
+#include "Mixer.h"
 #include "../common/misc_util.h"
 
 OPENMPT_NAMESPACE_BEGIN
@@ -30,11 +31,20 @@ MixerSettings::MixerSettings()
 
 	m_nPreAmp = 128;
 
+	NumMixerThreads = 1;
+	MixBufferSize = MIXBUFFERSIZE;
+	VoiceSkipThreshold = 0;
+
 	VolumeRampUpMicroseconds = 363; // 16 @44100
 	VolumeRampDownMicroseconds = 952; // 42 @44100
 
 }
 
+uint32 MixerSettings::GetMixBufferSize() const
+{
+	return Clamp<uint32, uint32>(MixBufferSize, MIXBUFFERSIZE_MIN, MIXBUFFERSIZE_MAX);
+}
+
 int32 MixerSettings::GetVolumeRampUpSamples() const
 {
 	return Util::muldivr(VolumeRampUpMicroseconds, gdwMixingFreq, 1000000);
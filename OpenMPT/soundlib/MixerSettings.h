@@ -24,6 +24,17 @@ struct MixerSettings
 	DWORD gnChannels;
 	DWORD m_nPreAmp;
 
+	// Number of threads that mix voices in parallel (1 = all voices are mixed in the calling thread)
+	uint32 NumMixerThreads;
+
+	// Number of frames that are mixed at once (MIXBUFFERSIZE by default). Bigger chunks reduce the per-chunk overhead when rendering offline.
+	uint32 MixBufferSize;
+	uint32 GetMixBufferSize() const;
+
+	// Voices whose output is provably quieter than this level (in dBFS, e.g. -96) are not mixed.
+	// 0 only skips voices whose sample data is completely silent, which does not change the output at all.
+	int32 VoiceSkipThreshold;
+
 	int32 VolumeRampUpMicroseconds;
 	int32 VolumeRampDownMicroseconds;
 	int32 GetVolumeRampUpMicroseconds() const { return VolumeRampUpMicroseconds; }
@@ -0,0 +1,243 @@
+/*
+ * MixerThreads.cpp
+ * ----------------
+ * Purpose: Worker threads for mixing several voices of one CSoundFile in parallel.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "MixerThreads.h"
+#include "../common/misc_util.h"
+
+#if MPT_OS_WINDOWS
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+struct MixerThreads::Worker
+{
+	JobFunc func;
+	void *param;
+	uint32 index;
+	bool quit;
+#if MPT_OS_WINDOWS
+	HANDLE thread;
+	HANDLE startEvent;	// auto-reset
+	HANDLE doneEvent;	// auto-reset
+#else
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool start;
+	bool done;
+#endif
+};
+
+
+#if MPT_OS_WINDOWS
+
+static DWORD WINAPI MixerThreadEntry(LPVOID param)
+//------------------------------------------------
+{
+	MixerThreads::WorkerLoop(*static_cast<MixerThreads::Worker *>(param));
+	return 0;
+}
+
+#else
+
+static void *MixerThreadEntry(void *param)
+//----------------------------------------
+{
+	MixerThreads::WorkerLoop(*static_cast<MixerThreads::Worker *>(param));
+	return nullptr;
+}
+
+#endif
+
+
+MixerThreads::MixerThreads(uint32 numThreads, uint32 bufferSize)
+//--------------------------------------------------------------
+	: m_bufferSize(bufferSize)
+	, m_numThreads(1)
+{
+	numThreads = Clamp<uint32, uint32>(numThreads, 1, maxThreads);
+	// Round up to whole cache lines, so that threads never write to the same line
+	const uint32 lineSize = AlignedMixBuffer<mixsample_t>::alignment / sizeof(mixsample_t);
+	m_bufferStride = (bufferSize * 2 + AlignedMixBuffer<mixsample_t>::padding + lineSize - 1) / lineSize * lineSize;
+	m_buffers.Resize(numThreads * m_bufferStride);
+	for(uint32 i = 1; i < numThreads; i++)
+	{
+		Worker *worker = new Worker();
+		worker->func = nullptr;
+		worker->param = nullptr;
+		worker->index = i;
+		worker->quit = false;
+#if MPT_OS_WINDOWS
+		worker->startEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		worker->doneEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		worker->thread = CreateThread(NULL, 0, MixerThreadEntry, worker, 0, NULL);
+		if(worker->thread == NULL)
+		{
+			CloseHandle(worker->startEvent);
+			CloseHandle(worker->doneEvent);
+			delete worker;
+			break;
+		}
+#else
+		worker->start = false;
+		worker->done = false;
+		pthread_mutex_init(&worker->mutex, NULL);
+		pthread_cond_init(&worker->cond, NULL);
+		if(pthread_create(&worker->thread, NULL, MixerThreadEntry, worker) != 0)
+		{
+			pthread_cond_destroy(&worker->cond);
+			pthread_mutex_destroy(&worker->mutex);
+			delete worker;
+			break;
+		}
+#endif
+		m_workers.push_back(worker);
+	}
+	// If thread creation failed, we simply continue with fewer threads.
+	m_numThreads = static_cast<uint32>(m_workers.size()) + 1;
+}
+
+
+MixerThreads::~MixerThreads()
+//---------------------------
+{
+	for(std::vector<Worker *>::iterator it = m_workers.begin(); it != m_workers.end(); it++)
+	{
+		Worker *worker = *it;
+#if MPT_OS_WINDOWS
+		worker->quit = true;
+		SetEvent(worker->startEvent);
+		WaitForSingleObject(worker->thread, INFINITE);
+		CloseHandle(worker->thread);
+		CloseHandle(worker->startEvent);
+		CloseHandle(worker->doneEvent);
+#else
+		pthread_mutex_lock(&worker->mutex);
+		worker->quit = true;
+		pthread_cond_broadcast(&worker->cond);
+		pthread_mutex_unlock(&worker->mutex);
+		pthread_join(worker->thread, NULL);
+		pthread_cond_destroy(&worker->cond);
+		pthread_mutex_destroy(&worker->mutex);
+#endif
+		delete worker;
+	}
+}
+
+
+void MixerThreads::WorkerLoop(Worker &worker)
+//-------------------------------------------
+{
+	while(true)
+	{
+#if MPT_OS_WINDOWS
+		WaitForSingleObject(worker.startEvent, INFINITE);
+		if(worker.quit)
+		{
+			break;
+		}
+		worker.func(worker.param, worker.index);
+		SetEvent(worker.doneEvent);
+#else
+		pthread_mutex_lock(&worker.mutex);
+		while(!worker.start && !worker.quit)
+		{
+			pthread_cond_wait(&worker.cond, &worker.mutex);
+		}
+		if(!worker.start)
+		{
+			pthread_mutex_unlock(&worker.mutex);
+			break;
+		}
+		worker.start = false;
+		pthread_mutex_unlock(&worker.mutex);
+
+		worker.func(worker.param, worker.index);
+
+		pthread_mutex_lock(&worker.mutex);
+		worker.done = true;
+		pthread_cond_broadcast(&worker.cond);
+		pthread_mutex_unlock(&worker.mutex);
+#endif
+	}
+}
+
+
+void MixerThreads::Run(JobFunc func, void *param)
+//-----------------------------------------------
+{
+	for(std::vector<Worker *>::iterator it = m_workers.begin(); it != m_workers.end(); it++)
+	{
+		Worker *worker = *it;
+#if MPT_OS_WINDOWS
+		worker->func = func;
+		worker->param = param;
+		SetEvent(worker->startEvent);
+#else
+		pthread_mutex_lock(&worker->mutex);
+		worker->func = func;
+		worker->param = param;
+		worker->start = true;
+		worker->done = false;
+		pthread_cond_broadcast(&worker->cond);
+		pthread_mutex_unlock(&worker->mutex);
+#endif
+	}
+
+	func(param, 0);
+
+#if MPT_OS_WINDOWS
+	if(!m_workers.empty())
+	{
+		HANDLE events[maxThreads];
+		for(size_t i = 0; i < m_workers.size(); i++)
+		{
+			events[i] = m_workers[i]->doneEvent;
+		}
+		WaitForMultipleObjects(static_cast<DWORD>(m_workers.size()), events, TRUE, INFINITE);
+	}
+#else
+	for(std::vector<Worker *>::iterator it = m_workers.begin(); it != m_workers.end(); it++)
+	{
+		Worker *worker = *it;
+		pthread_mutex_lock(&worker->mutex);
+		while(!worker->done)
+		{
+			pthread_cond_wait(&worker->cond, &worker->mutex);
+		}
+		pthread_mutex_unlock(&worker->mutex);
+	}
+#endif
+}
+
+
+uint32 MixerThreads::GetHardwareConcurrency()
+//-------------------------------------------
+{
+#if MPT_OS_WINDOWS
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return Clamp<uint32, uint32>(info.dwNumberOfProcessors, 1, maxThreads);
+#elif defined(_SC_NPROCESSORS_ONLN)
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return Clamp<uint32, uint32>(count > 0 ? static_cast<uint32>(count) : 1, 1, maxThreads);
+#else
+	return 1;
+#endif
+}
+
+
+OPENMPT_NAMESPACE_END
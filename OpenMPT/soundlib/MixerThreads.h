@@ -0,0 +1,65 @@
+/*
+ * MixerThreads.h
+ * --------------
+ * Purpose: Worker threads for mixing several voices of one CSoundFile in parallel.
+ *          Also used by SampleReadQueue for decoding samples while loading (with a buffer size of 0).
+ * Notes  : The threads are kept alive between calls to Run(), so that handing work to them only costs a few synchronisation calls per mix chunk.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "Mixer.h"
+#include <vector>
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+//================
+class MixerThreads
+//================
+{
+public:
+	// Called once per thread by Run(), with worker = 0 ... GetNumThreads() - 1.
+	typedef void (*JobFunc)(void *param, uint32 worker);
+
+	// Maximum number of threads (including the calling thread)
+	enum { maxThreads = 64 };
+
+	// Starts numThreads - 1 additional threads. bufferSize is the mix chunk size in frames.
+	MixerThreads(uint32 numThreads, uint32 bufferSize);
+	~MixerThreads();
+
+	uint32 GetNumThreads() const { return m_numThreads; }
+	uint32 GetBufferSize() const { return m_bufferSize; }
+
+	// Private accumulation buffer of the given worker, big enough for one mix chunk of interleaved stereo data.
+	// Each buffer starts on its own cache line.
+	mixsample_t *GetBuffer(uint32 worker) { return m_buffers + worker * m_bufferStride; }
+
+	// Calls func(param, worker) on all threads (worker 0 is the calling thread) and returns when all of them have finished.
+	void Run(JobFunc func, void *param);
+
+	// Default number of threads for this system
+	static uint32 GetHardwareConcurrency();
+
+	// Thread state and main loop, only public for the platform-specific thread entry point.
+	struct Worker;
+	static void WorkerLoop(Worker &worker);
+
+protected:
+	std::vector<Worker *> m_workers;
+	AlignedMixBuffer<mixsample_t> m_buffers;
+	uint32 m_bufferSize;
+	uint32 m_bufferStride;
+	uint32 m_numThreads;
+
+private:
+	MixerThreads(const MixerThreads &);
+	MixerThreads & operator= (const MixerThreads &);
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -36,22 +36,22 @@ struct ALIGN(32) ModChannel
 	};
 
 	// Information used in the mixer (should be kept tight for better caching)
-	// Byte sizes are for 32-bit builds and 32-bit integer / float mixer
+	// Byte sizes are for 64-bit builds and 32-bit integer / float mixer
+	int64 nInc;				// 32.32 fixed point sample speed relative to mixing frequency (SAMPLEPOS_ONE = one sample per output sample, 2 * SAMPLEPOS_ONE = two samples per output sample, etc...)
 	const void *pCurrentSample;	// Currently playing sample (nullptr if no sample is playing)
 	uint32 nPos;			// Current play position
-	uint32 nPosLo;			// 16-bit fractional part of play position
-	int32 nInc;				// 16.16 fixed point sample speed relative to mixing frequency (0x10000 = one sample per output sample, 0x20000 = two samples per output sample, etc...)
+	uint32 nPosLo;			// 32-bit fractional part of play position
 	int32 leftVol;			// 0...4096 (12 bits, since 16 bits + 12 bits = 28 bits = 0dB in integer mixer, see MIXING_ATTENUATION)
 	int32 rightVol;			// dito
 	int32 leftRamp;			// Ramping delta, 20.12 fixed point (see VOLUMERAMPPRECISION)
 	int32 rightRamp;		// dito
-	// Up to here: 32 bytes
+	// Up to here: 40 bytes
 	int32 rampLeftVol;		// Current ramping volume, 20.12 fixed point (see VOLUMERAMPPRECISION)
 	int32 rampRightVol;		// dito
 	mixsample_t nFilter_Y[2][2];					// Filter memory - two history items per sample channel
 	mixsample_t nFilter_A0, nFilter_B0, nFilter_B1;	// Filter coeffs
 	mixsample_t nFilter_HP;
-	// Up to here: 72 bytes
+	// Up to here: 80 bytes
 
 	SmpLength nLength;
 	SmpLength nLoopStart;
@@ -59,17 +59,22 @@ struct ALIGN(32) ModChannel
 	FlagSet<ChannelFlags> dwFlags;
 	mixsample_t nROfs, nLOfs;
 	uint32 nRampLength;
-	// Up to here: 100 bytes
-
 	const ModSample *pModSample;			// Currently assigned sample slot (can already be stopped)
+	// Up to here: 128 bytes - everything that is needed for mixing a chunk of a voice
 
-	// Information not used in the mixer
+	// Information that is used once per mix chunk or when a volume ramp ends
 	const ModInstrument *pModInstrument;	// Currently assigned instrument slot
+	int32 newLeftVol, newRightVol;
+	int32 nFadeOutVol;
+	CHANNELINDEX nMasterChn;
+	uint8 resamplingMode;
+	// Up to here: 151 bytes
+
+	// Information not used in the mixer
 	SmpLength proTrackerOffset;				// Offset for instrument-less notes in ProTracker mode
 	FlagSet<ChannelFlags> dwOldFlags;		// Flags from previous tick
-	int32 newLeftVol, newRightVol;
 	int32 nRealVolume, nRealPan;
-	int32 nVolume, nPan, nFadeOutVol;
+	int32 nVolume, nPan;
 	int32 nPeriod, nC5Speed, nPortamentoDest;
 	int32 cachedPeriod, glissandoPeriod;
 	int32 nCalcVolume;								// Calculated channel volume, 14-Bit (without global volume, pre-amp etc applied) - for MIDI macros
@@ -86,9 +91,7 @@ struct ALIGN(32) ModChannel
 	uint32 nEFxOffset; // offset memory for Invert Loop (EFx, .MOD only)
 	int32 nRetrigCount, nRetrigParam;
 	ROWINDEX nPatternLoop;
-	CHANNELINDEX nMasterChn;
 	// 8-bit members
-	uint8 resamplingMode;
 	uint8 nRestoreResonanceOnNewNote; //Like above
 	uint8 nRestoreCutoffOnNewNote; //Like above
 	uint8 nNote, nNNA;
@@ -220,4 +223,98 @@ struct ALIGN(32) ModChannelSettings
 #pragma warning(default:4324) //structure was padded due to __declspec(align())
 #endif
 
+
+// Set of mixing channels that can be walked in ascending order, skipping unused channels.
+//==============
+class ChannelSet
+//==============
+{
+public:
+	ChannelSet() { Clear(); }
+
+	void Clear() { for(size_t i = 0; i < CountOf(bits); i++) bits[i] = 0; }
+	void Set(CHANNELINDEX chn) { bits[chn / 32] |= (1u << (chn % 32)); }
+	void Reset(CHANNELINDEX chn) { bits[chn / 32] &= ~(1u << (chn % 32)); }
+	bool Test(CHANNELINDEX chn) const { return (bits[chn / 32] & (1u << (chn % 32))) != 0; }
+	// Add or remove all channels from first to last - 1.
+	void SetRange(CHANNELINDEX first, CHANNELINDEX last) { for(CHANNELINDEX chn = first; chn < last; chn++) Set(chn); }
+	void ResetRange(CHANNELINDEX first, CHANNELINDEX last) { for(CHANNELINDEX chn = first; chn < last; chn++) Reset(chn); }
+
+	// Returns the first channel >= chn that is not in the set, or MAX_CHANNELS if there is none.
+	CHANNELINDEX FindNextUnset(CHANNELINDEX chn) const
+	{
+		if(chn >= MAX_CHANNELS)
+		{
+			return MAX_CHANNELS;
+		}
+		size_t word = chn / 32;
+		uint32 w = ~bits[word] & (~0u << (chn % 32));
+		while(w == 0)
+		{
+			if(++word == CountOf(bits))
+			{
+				return MAX_CHANNELS;
+			}
+			w = ~bits[word];
+		}
+		return static_cast<CHANNELINDEX>(word * 32 + LowestBit(w));
+	}
+
+	// Walks over all channels in the set in ascending order.
+	// The set must not be modified while walking over it, except for removing the current channel.
+	//============
+	class Iterator
+	//============
+	{
+	public:
+		explicit Iterator(const ChannelSet &set) : set(set), word(0), pending(set.bits[0]) { Next(); }
+
+		bool IsValid() const { return chn < MAX_CHANNELS; }
+		CHANNELINDEX GetChannel() const { return chn; }
+
+		void Next()
+		{
+			while(pending == 0)
+			{
+				if(++word == CountOf(set.bits))
+				{
+					chn = MAX_CHANNELS;
+					return;
+				}
+				pending = set.bits[word];
+			}
+			chn = static_cast<CHANNELINDEX>(word * 32 + LowestBit(pending));
+			pending &= pending - 1;
+		}
+
+	protected:
+		const ChannelSet &set;
+		size_t word;
+		uint32 pending;	// Channels of the current word that have not been visited yet
+		CHANNELINDEX chn;
+	};
+
+protected:
+	uint32 bits[MAX_CHANNELS / 32];
+
+	// Index of the lowest set bit, w must not be 0.
+	static uint32 LowestBit(uint32 w)
+	{
+#if MPT_COMPILER_GCC || MPT_COMPILER_CLANG
+		return __builtin_ctz(w);
+#else
+		uint32 bit = 0;
+		while(!(w & 1))
+		{
+			w >>= 1;
+			bit++;
+		}
+		return bit;
+#endif
+	}
+};
+
+STATIC_ASSERT(MAX_CHANNELS % 32 == 0);
+
+
 OPENMPT_NAMESPACE_END
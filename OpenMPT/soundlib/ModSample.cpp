@@ -204,7 +204,17 @@ size_t ModSample::GetRealSampleBufferSize(SmpLength numSamples, size_t bytesPerS
 void ModSample::FreeSample()
 //--------------------------
 {
-	FreeSample(pSample);
+	std::vector<uint16>().swap(peaks);
+	peakSource = nullptr;
+	if(pLookahead != nullptr)
+	{
+		// Referenced sample data is not ours to free.
+		delete[] static_cast<char *>(pLookahead);
+		pLookahead = nullptr;
+	} else
+	{
+		FreeSample(pSample);
+	}
 	pSample = nullptr;
 }
 
@@ -219,6 +229,72 @@ void ModSample::FreeSample(void *samplePtr)
 }
 
 
+// Use sample data from an external buffer instead of allocating and copying it.
+bool ModSample::ReferenceSample(const void *sampleData)
+//-----------------------------------------------------
+{
+	FreeSample();
+	if(sampleData == nullptr || nLength < externalMinLength)
+	{
+		return false;
+	}
+
+	// The windows are filled by PrecomputeLoops().
+	const size_t lookaheadSize = (InterpolationMaxLookahead + externalHeadEnd + externalTailStart + externalTailEnd) * GetBytesPerSample();
+	pLookahead = new (std::nothrow) char[lookaheadSize];
+	if(pLookahead == nullptr)
+	{
+		return false;
+	}
+	memset(pLookahead, 0, lookaheadSize);
+	pSample = const_cast<void *>(sampleData);
+	return true;
+}
+
+
+// Copy referenced sample data into a normally allocated sample buffer.
+bool ModSample::UnreferenceSample()
+//---------------------------------
+{
+	if(pLookahead == nullptr)
+	{
+		return pSample != nullptr;
+	}
+	void *newSample = AllocateSample(nLength, GetBytesPerSample());
+	if(newSample != nullptr)
+	{
+		memcpy(newSample, pSample, GetSampleSizeInBytes());
+	}
+	FreeSample();
+	pSample = newSample;
+	return pSample != nullptr;
+}
+
+
+// Returns true if no sampling point in [start, end] has an absolute value above maxPeak.
+bool ModSample::IsQuieterThan(SmpLength start, SmpLength end, uint32 maxPeak) const
+//---------------------------------------------------------------------------------
+{
+	if(peakSource != pSample || pSample == nullptr || nLength == 0 || peaks.size() != ((nLength - 1) >> peakBlockShift) + 1)
+	{
+		return false;
+	}
+	LimitMax(end, nLength - 1);
+	if(start > end)
+	{
+		return false;
+	}
+	for(SmpLength block = start >> peakBlockShift; block <= (end >> peakBlockShift); block++)
+	{
+		if(peaks[block] > maxPeak)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
 // Set loop points and update loop wrap-around buffer
 void ModSample::SetLoop(SmpLength start, SmpLength end, bool enable, bool pingpong, CSoundFile &sndFile)
 //------------------------------------------------------------------------------------------------------
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include "Mixer.h"
+
 OPENMPT_NAMESPACE_BEGIN
 
 class CSoundFile;
@@ -34,10 +36,31 @@ struct ModSample
 	uint8  nVibRate;						// Auto vibrato rate (speed)
 	//char name[MAX_SAMPLENAME];			// Maybe it would be nicer to have sample names here, but that would require some refactoring. Also, the current structure size is 64 Bytes - would adding the sample name here slow down the mixer (cache misses)?
 	char filename [MAX_SAMPLEFILENAME];
+	// Sample data that is referenced instead of copied (see ReferenceSample) has no room for the interpolation lookahead around it.
+	// This buffer holds the first and last few sampling points along with the held sample ends and the pre-computed loops instead.
+	void   *pLookahead;
+
+	// Peak summary of the sample data, used by the mixer to skip voices that are inaudible (see ctrlSmp::PrecomputeLoops).
+	// peaks[i] is the highest absolute value (16-bit scale, all channels) of sampling points [i << peakBlockShift, (i + 1) << peakBlockShift).
+	enum { peakBlockShift = 7 };
+	std::vector<uint16> peaks;
+	const void *peakSource;	// Sample data the summary was computed from; it is ignored if pSample has changed since.
+
+	// Referenced samples: Sampling points [-InterpolationMaxLookahead, externalHeadEnd) are mirrored in the head window of the lookahead buffer,
+	// sampling points [nLength - externalTailStart, nLength + externalTailEnd) are mirrored in its tail window.
+	enum
+	{
+		externalHeadEnd = 2 * InterpolationMaxLookahead,
+		externalTailStart = 4 * InterpolationMaxLookahead,
+		externalTailEnd = 10 * InterpolationMaxLookahead,
+		externalMinLength = 8 * InterpolationMaxLookahead,	// Shorter samples are always copied.
+	};
 
 	ModSample(MODTYPE type = MOD_TYPE_NONE)
 	{
 		pSample = nullptr;
+		pLookahead = nullptr;
+		peakSource = nullptr;
 		Initialize(type);
 	}
 
@@ -74,6 +97,23 @@ struct ModSample
 	void FreeSample();
 	static void FreeSample(void *samplePtr);
 
+	// Use sample data from an external buffer (e.g. a memory-mapped file) instead of allocating and copying it.
+	// The data must be in the native sample format and stay valid and unchanged until the sample is freed.
+	// Returns false if the sample is too short to be referenced or if the lookahead buffer cannot be allocated.
+	bool ReferenceSample(const void *sampleData);
+	// Copy referenced sample data into a normally allocated sample buffer.
+	bool UnreferenceSample();
+	// Returns true if the sample data is referenced rather than owned by this sample.
+	bool IsReferenced() const { return pLookahead != nullptr; }
+	// Pointers to referenced sampling point 0 as seen through the head resp. tail window of the lookahead buffer.
+	// Only indices that lie inside the window may be accessed through them.
+	void *GetExternalHead() const { return static_cast<char *>(pLookahead) + InterpolationMaxLookahead * GetBytesPerSample(); }
+	void *GetExternalTail() const { return static_cast<char *>(pLookahead) + (InterpolationMaxLookahead + externalHeadEnd + externalTailStart) * GetBytesPerSample() - static_cast<ptrdiff_t>(nLength) * GetBytesPerSample(); }
+
+	// Returns true if no sampling point in [start, end] has an absolute value above maxPeak (16-bit scale).
+	// Returns false if there is no up-to-date peak summary.
+	bool IsQuieterThan(SmpLength start, SmpLength end, uint32 maxPeak) const;
+
 	// Set loop points and update loop wrap-around buffer
 	void SetLoop(SmpLength start, SmpLength end, bool enable, bool pingpong, CSoundFile &sndFile);
 	// Set sustain loop points and update loop wrap-around buffer
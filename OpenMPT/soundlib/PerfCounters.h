@@ -0,0 +1,76 @@
+/*
+ * PerfCounters.h
+ * --------------
+ * Purpose: Time spent in and number of calls of each stage of CSoundFile::Read(), for profiling the player.
+ * Notes  : The counters are updated by CSoundFile::Read() and CSoundFile::CreateStereoMix(), see Sndmix.cpp.
+ *          Time is measured in CPU cycles (time stamp counter) on x86 / amd64 and in nanoseconds on other platforms.
+ *          Define NO_PERFCOUNTERS to remove the instrumentation, in which case all counters stay 0.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+//================
+class PerfCounters
+//================
+{
+public:
+
+	enum Stage
+	{
+		stageReadNote = 0,	// Pattern and effect processing of a tick (CSoundFile::ReadNote)
+		stageMix,			// Resampling and mixing of all voices (CSoundFile::CreateStereoMix)
+		stageReverb,		// Built-in reverb
+		stagePlugins,		// Mix plugins
+		stageDSP,			// Master volume, built-in DSP effects and channel layout conversion
+		stageOutput,		// Conversion to the output sample format
+		numStages
+	};
+
+	struct Counter
+	{
+		uint64 cycles;
+		uint64 calls;
+	};
+
+	Counter stages[numStages];
+	uint64 voicesMixed;		// Sum of the number of voices that were mixed in each chunk
+	uint64 framesRendered;	// Number of output frames rendered
+
+	PerfCounters() { Reset(); }
+
+	void Reset()
+	{
+		for(int i = 0; i < numStages; i++)
+		{
+			stages[i].cycles = 0;
+			stages[i].calls = 0;
+		}
+		voicesMixed = 0;
+		framesRendered = 0;
+	}
+
+	// Stage names as used in the libopenmpt ctls (perf.<name>.cycles)
+	static const char *GetStageName(Stage stage)
+	{
+		static const char * const names[numStages] = { "readnote", "mix", "reverb", "plugins", "dsp", "output" };
+		return names[stage];
+	}
+
+	static bool IsEnabled()
+	{
+#ifdef NO_PERFCOUNTERS
+		return false;
+#else
+		return true;
+#endif
+	}
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -57,39 +57,65 @@ public:
 };
 
 
+//====================
+class CResamplerTables
+//====================
+{
+public:
+	CWindowedFIR m_WindowedFIR;
+
+	SINC_TYPE gKaiserSinc[SINC_PHASES * 8];		// Upsampling
+	SINC_TYPE gDownsample13x[SINC_PHASES * 8];	// Downsample 1.333x
+	SINC_TYPE gDownsample2x[SINC_PHASES * 8];	// Downsample 2x
+
+#ifndef MPT_INTMIXER
+	mixsample_t FastSincTablef[256 * 4];	// Cubic spline LUT
+	mixsample_t LinearTablef[256];			// Linear interpolation LUT
+#endif // !defined(MPT_INTMIXER)
+
+	// Returns the tables for the given settings. All resamplers with equivalent settings share the same (immutable) tables,
+	// which are only computed if no other resampler is currently using them. Thread-safe.
+	static MPT_SHARED_PTR<const CResamplerTables> Get(const CResamplerSettings &settings);
+
+	const CResamplerSettings &GetSettings() const { return m_Settings; }
+
+	// Only the windowed FIR settings affect the table contents.
+	static bool IsEquivalent(const CResamplerSettings &a, const CResamplerSettings &b)
+	{
+		return a.gdWFIRCutoff == b.gdWFIRCutoff && a.gbWFIRType == b.gbWFIRType;
+	}
+
+private:
+	CResamplerSettings m_Settings;
+	explicit CResamplerTables(const CResamplerSettings &settings);
+	CResamplerTables(const CResamplerTables &);
+	CResamplerTables & operator= (const CResamplerTables &);
+};
+
+
 //==============
 class CResampler
 //==============
 {
 public:
 	CResamplerSettings m_Settings;
-	CWindowedFIR m_WindowedFIR;
 	static const int16 FastSincTable[256 * 4];
 
-	SINC_TYPE gKaiserSinc[SINC_PHASES * 8];				// Upsampling
-
-#ifdef MODPLUG_TRACKER
-	static bool StaticTablesInitialized;
-	#define RESAMPLER_TABLE static
-#else
-	// no global data which has to be initialized by hand in the library
-	#define RESAMPLER_TABLE 
-#endif // MODPLUG_TRACKER
-
-	RESAMPLER_TABLE SINC_TYPE gDownsample13x[SINC_PHASES * 8];	// Downsample 1.333x
-	RESAMPLER_TABLE SINC_TYPE gDownsample2x[SINC_PHASES * 8];	// Downsample 2x
-
+	// Shortcuts into m_Tables for the mixer
+	const SINC_TYPE *gKaiserSinc;
+	const SINC_TYPE *gDownsample13x;
+	const SINC_TYPE *gDownsample2x;
+	const WFIR_TYPE *WFIRlut;
 #ifndef MPT_INTMIXER
-	RESAMPLER_TABLE mixsample_t FastSincTablef[256 * 4];	// Cubic spline LUT
-	RESAMPLER_TABLE mixsample_t LinearTablef[256];		// Linear interpolation LUT
+	const mixsample_t *FastSincTablef;
+	const mixsample_t *LinearTablef;
 #endif // !defined(MPT_INTMIXER)
 
-#undef RESAMPLER_TABLE
-
 private:
-	CResamplerSettings m_OldSettings;
+	MPT_SHARED_PTR<const CResamplerTables> m_Tables;
 public:
-	CResampler() { InitializeTables(true); }
+	// The tables are only needed for mixing, so they can be initialized later (see CSoundFile::Read()).
+	explicit CResampler(bool initTables = true) { if(initTables) InitializeTables(true); }
 	~CResampler() {}
 	void InitializeTables(bool force=false);
 	bool IsHQ() const { return m_Settings.SrcMode >= SRCMODE_SPLINE && m_Settings.SrcMode < SRCMODE_DEFAULT; }
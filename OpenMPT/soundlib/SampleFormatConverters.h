@@ -903,6 +903,45 @@ void ConvertInterleavedFixedPointToNonInterleaved(Tsample * const * const MPT_RE
 }
 
 
+// Floating point mix buffers (see MPT_FLOATMIXER) are already normalized to [-1, 1].
+template<bool clipOutput>
+void ConvertInterleavedFloatToInterleaved(float * MPT_RESTRICT p, const float * MPT_RESTRICT mixbuffer, std::size_t channels, std::size_t count)
+//--------------------------------------------------------------------------------------------------------------------------------------------
+{
+	count *= channels;
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		float out = mixbuffer[i];
+		if(clipOutput)
+		{
+			if(out < -1.0f) out = -1.0f;
+			if(out > 1.0f) out = 1.0f;
+		}
+		p[i] = out;
+	}
+}
+
+template<bool clipOutput>
+void ConvertInterleavedFloatToNonInterleaved(float * const * const MPT_RESTRICT buffers, const float * MPT_RESTRICT mixbuffer, std::size_t channels, std::size_t count)
+//----------------------------------------------------------------------------------------------------------------------------------------------------------------
+{
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		for(std::size_t channel = 0; channel < channels; ++channel)
+		{
+			float out = *mixbuffer;
+			if(clipOutput)
+			{
+				if(out < -1.0f) out = -1.0f;
+				if(out > 1.0f) out = 1.0f;
+			}
+			buffers[channel][i] = out;
+			mixbuffer++;
+		}
+	}
+}
+
+
 // Copy from an interleaed buffer of #channels.
 template <typename SampleConversion>
 void CopyInterleavedToChannel(typename SampleConversion::output_t * MPT_RESTRICT dst, const typename SampleConversion::input_t * MPT_RESTRICT src, std::size_t channels, std::size_t countChunk, std::size_t channel, SampleConversion conv = SampleConversion())
@@ -325,6 +325,7 @@ bool CSoundFile::ReadSampleFromSong(SAMPLEINDEX targetSample, const CSoundFile &
 	if(sourceSmp.pSample)
 	{
 		Samples[targetSample].pSample = nullptr;	// Don't want to delete the original sample!
+		Samples[targetSample].pLookahead = nullptr;
 		if(Samples[targetSample].AllocateSample())
 		{
 			SmpLength nSize = sourceSmp.GetSampleSizeInBytes();
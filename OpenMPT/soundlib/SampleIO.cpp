@@ -15,6 +15,7 @@
 #include "SampleIO.h"
 #include "SampleFormatConverters.h"
 #include "ITCompression.h"
+#include "MixerThreads.h"
 #include "../common/mptIO.h"
 #ifndef MODPLUG_NO_FILESAVE
 #include "../common/mptFstream.h"
@@ -39,8 +40,8 @@ OPENMPT_NAMESPACE_BEGIN
 #endif
 
 // Read a sample from memory
-size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
-//--------------------------------------------------------------------
+size_t SampleIO::ReadSample(ModSample &sample, FileReader &file, bool referenceData) const
+//----------------------------------------------------------------------------------------
 {
 	if(sample.nLength < 1 || !file.IsValid())
 	{
@@ -55,6 +56,22 @@ size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
 
 	sample.uFlags.set(CHN_16BIT, GetBitDepth() >= 16);
 	sample.uFlags.set(CHN_STEREO, GetChannelFormat() != mono);
+
+#ifdef MPT_PLATFORM_LITTLE_ENDIAN
+	// Sample data that is already stored in our native format can be played straight from the file.
+	if(referenceData
+		&& GetBitDepth() == 16 && GetEndianness() == littleEndian && GetEncoding() == signedPCM
+		&& (GetChannelFormat() == mono || GetChannelFormat() == stereoInterleaved)
+		&& fileSize >= sample.GetSampleSizeInBytes()
+		&& (reinterpret_cast<uintptr_t>(sourceBuf) % sizeof(int16)) == 0
+		&& sample.ReferenceSample(sourceBuf))
+	{
+		bytesRead = sample.GetSampleSizeInBytes();
+		file.Seek(filePosition + bytesRead);
+		return bytesRead;
+	}
+#endif // MPT_PLATFORM_LITTLE_ENDIAN
+
 	size_t sampleSize = sample.AllocateSample();	// Target sample size in bytes
 
 	if(sampleSize == 0)
@@ -591,6 +608,181 @@ size_t SampleIO::ReadSample(ModSample &sample, FileReader &file) const
 #endif
 
 
+SampleReadQueue::SampleReadQueue(uint32 numThreads)
+//-------------------------------------------------
+	: m_numRead(0)
+	, m_numThreads(numThreads)
+{
+}
+
+
+size_t SampleReadQueue::Add(const SampleIO &format, ModSample &sample, const FileReader &file, bool referenceData)
+//---------------------------------------------------------------------------------------------------------------
+{
+	m_samples.push_back(QueuedSample(format, sample, file, referenceData));
+	return m_samples.size() - 1;
+}
+
+
+// Rough amount of sample data that is going to be read, used for distributing the work between threads.
+static size_t EstimateSampleDataSize(const SampleIO &format, const ModSample &sample, const FileReader &file)
+//----------------------------------------------------------------------------------------------------------
+{
+	const uint64 size = static_cast<uint64>(sample.nLength) * (format.GetBitDepth() / 8) * (format.GetChannelFormat() == SampleIO::mono ? 1 : 2);
+	return static_cast<size_t>(std::min<uint64>(size, file.BytesLeft()));
+}
+
+
+void SampleReadQueue::Read()
+//--------------------------
+{
+	const size_t first = m_numRead;
+	m_numRead = m_samples.size();
+
+	const uint32 numThreads = m_numThreads ? m_numThreads : MixerThreads::GetHardwareConcurrency();
+	size_t totalSize = 0;
+	for(size_t i = first; i < m_samples.size(); i++)
+	{
+		totalSize += EstimateSampleDataSize(m_samples[i].format, *m_samples[i].sample, m_samples[i].file);
+	}
+
+	if(numThreads <= 1 || totalSize < minParallelBytes)
+	{
+		for(size_t i = first; i < m_samples.size(); i++)
+		{
+			QueuedSample &queued = m_samples[i];
+			FileReader file = queued.file;
+			queued.bytesRead = queued.format.ReadSample(*queued.sample, file, queued.referenceData);
+		}
+		return;
+	}
+
+	// Worker threads must not read from a std::istream, so the whole file has to be cached first.
+	m_samples[first].file.GetRawData();
+
+	m_jobs.clear();
+	for(size_t i = first; i < m_samples.size(); i++)
+	{
+		const QueuedSample &queued = m_samples[i];
+		if(queued.format.GetEncoding() == SampleIO::IT214 || queued.format.GetEncoding() == SampleIO::IT215)
+		{
+			PrepareCompressedSample(i);
+		} else
+		{
+			m_jobs.push_back(Job(FileReader(), i, EstimateSampleDataSize(queued.format, *queued.sample, queued.file), 0, 0, 0, true));
+		}
+	}
+
+	MixerThreads threads(numThreads, 0);
+
+	// Give each thread a contiguous range of jobs with about the same amount of data.
+	// Which thread decodes a job has no influence on the result.
+	uint64 totalCost = 0;
+	for(size_t j = 0; j < m_jobs.size(); j++)
+	{
+		totalCost += m_jobs[j].cost;
+	}
+	m_firstJob.assign(threads.GetNumThreads() + 1, m_jobs.size());
+	m_firstJob[0] = 0;
+	uint64 cost = 0;
+	uint32 thread = 0;
+	for(size_t j = 0; j < m_jobs.size(); j++)
+	{
+		while(thread + 1 < threads.GetNumThreads() && cost >= totalCost * (thread + 1) / threads.GetNumThreads())
+		{
+			m_firstJob[++thread] = j;
+		}
+		cost += m_jobs[j].cost;
+	}
+
+	threads.Run(ThreadFunc, this);
+
+	// Blocks were decoded at the position they would have had if all previous blocks were complete.
+	// If a block turned out to be corrupted, the whole sample is decoded again the way ITDecompression does it.
+	size_t lastFailed = size_t(-1);
+	for(size_t j = 0; j < m_jobs.size(); j++)
+	{
+		const Job &job = m_jobs[j];
+		if(!job.wholeSample && job.written != job.expected && job.sample != lastFailed)
+		{
+			DecompressSerial(job.sample);
+			lastFailed = job.sample;
+		}
+	}
+}
+
+
+// Do what SampleIO::ReadSample does before decompressing an IT sample, and cut the compressed data into blocks.
+void SampleReadQueue::PrepareCompressedSample(size_t index)
+//---------------------------------------------------------
+{
+	QueuedSample &queued = m_samples[index];
+	ModSample &sample = *queued.sample;
+	FileReader file = queued.file;
+
+	if(sample.nLength < 1 || !file.IsValid())
+	{
+		return;
+	}
+	LimitMax(sample.nLength, MAX_SAMPLE_LENGTH);
+	sample.uFlags.set(CHN_16BIT, queued.format.GetBitDepth() >= 16);
+	sample.uFlags.set(CHN_STEREO, queued.format.GetChannelFormat() != SampleIO::mono);
+	if(sample.AllocateSample() == 0)
+	{
+		sample.nLength = 0;
+		return;
+	}
+
+	const FileReader::off_t startPos = file.GetPosition();
+	const SmpLength blockLength = ITDecompression::GetBlockLength(sample);
+	for(uint8 chn = 0; chn < sample.GetNumChannels(); chn++)
+	{
+		// Same loop as in ITDecompression, assuming that every block contains as many samples as it should.
+		SmpLength position = 0;
+		while(position < sample.nLength && file.AreBytesLeft())
+		{
+			const FileReader block = file.ReadChunk(file.ReadUint16LE());
+			const SmpLength expected = std::min(blockLength, sample.nLength - position);
+			m_jobs.push_back(Job(block, index, static_cast<size_t>(block.GetLength()), position, expected, chn, false));
+			position += expected;
+		}
+	}
+	queued.bytesRead = static_cast<size_t>(file.GetPosition() - startPos);
+}
+
+
+void SampleReadQueue::DecompressSerial(size_t index)
+//--------------------------------------------------
+{
+	QueuedSample &queued = m_samples[index];
+	ModSample &sample = *queued.sample;
+	FileReader file = queued.file;
+	memset(sample.pSample, 0, sample.GetSampleSizeInBytes());
+	ITDecompression(file, sample, queued.format.GetEncoding() == SampleIO::IT215);
+	queued.bytesRead = static_cast<size_t>(file.GetPosition() - queued.file.GetPosition());
+}
+
+
+void SampleReadQueue::ThreadFunc(void *param, uint32 worker)
+//----------------------------------------------------------
+{
+	SampleReadQueue &queue = *static_cast<SampleReadQueue *>(param);
+	for(size_t j = queue.m_firstJob[worker]; j < queue.m_firstJob[worker + 1]; j++)
+	{
+		Job &job = queue.m_jobs[j];
+		QueuedSample &queued = queue.m_samples[job.sample];
+		if(job.wholeSample)
+		{
+			FileReader file = queued.file;
+			queued.bytesRead = queued.format.ReadSample(*queued.sample, file, queued.referenceData);
+		} else
+		{
+			job.written = ITDecompression::DecompressBlock(job.block, *queued.sample, job.chn, job.position, queued.format.GetEncoding() == SampleIO::IT215);
+		}
+	}
+}
+
+
 #ifndef MODPLUG_NO_FILESAVE
 
 // Write a sample to file
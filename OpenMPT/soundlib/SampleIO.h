@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include "FileReader.h"
+#include <vector>
+
 
 OPENMPT_NAMESPACE_BEGIN
 
 
 struct ModSample;
-class FileReader;
 
 // Sample import / export formats
 //============
@@ -165,8 +167,9 @@ public:
 		return static_cast<Encoding>((format & encodingMask) >> encodingOffset);
 	}
 
-	// Read a sample from memory
-	size_t ReadSample(ModSample &sample, FileReader &file) const;
+	// Read a sample from memory.
+	// If referenceData is true, uncompressed samples in the native sample format are not copied but referenced directly from the file's memory (see ModSample::ReferenceSample).
+	size_t ReadSample(ModSample &sample, FileReader &file, bool referenceData = false) const;
 
 #ifndef MODPLUG_NO_FILESAVE
 	// Write a sample to file
@@ -175,4 +178,71 @@ public:
 };
 
 
+// Collects the samples of a module while its headers are being parsed and then decodes all of them at once,
+// using several threads if there is enough sample data.
+// IT compressed samples are split into their compressed blocks, which can be decoded independently.
+// The result is always identical to calling SampleIO::ReadSample for each sample in the order they were added.
+//===================
+class SampleReadQueue
+//===================
+{
+public:
+	// numThreads = 0 uses one thread per CPU.
+	explicit SampleReadQueue(uint32 numThreads);
+
+	// Queue a sample that is read from the current position of file. Returns the queue index of the sample.
+	size_t Add(const SampleIO &format, ModSample &sample, const FileReader &file, bool referenceData = false);
+	size_t GetNumSamples() const { return m_samples.size(); }
+
+	// Decode all samples that have been queued since the last call.
+	void Read();
+
+	// Number of bytes read for a queued sample, as SampleIO::ReadSample would have returned.
+	size_t GetBytesRead(size_t index) const { return m_samples[index].bytesRead; }
+
+	// Below this amount of sample data, starting threads costs more time than it saves.
+	static const size_t minParallelBytes = 256 * 1024;
+
+protected:
+	struct QueuedSample
+	{
+		SampleIO format;
+		ModSample *sample;
+		FileReader file;
+		size_t bytesRead;
+		bool referenceData;
+
+		// SampleIO and FileReader are only copy-constructible
+		QueuedSample(const SampleIO &format, ModSample &sample, const FileReader &file, bool referenceData)
+			: format(format), sample(&sample), file(file), bytesRead(0), referenceData(referenceData) { }
+	};
+
+	// Either a whole sample or a single compressed block of an IT sample
+	struct Job
+	{
+		FileReader block;
+		size_t sample;
+		size_t cost;
+		SmpLength position;		// Sample position of the block
+		SmpLength expected;		// Number of samples the block should contain
+		SmpLength written;		// Number of samples the block actually contained
+		uint8 chn;
+		bool wholeSample;
+
+		Job(const FileReader &block, size_t sample, size_t cost, SmpLength position, SmpLength expected, uint8 chn, bool wholeSample)
+			: block(block), sample(sample), cost(cost), position(position), expected(expected), written(0), chn(chn), wholeSample(wholeSample) { }
+	};
+
+	std::vector<QueuedSample> m_samples;
+	std::vector<Job> m_jobs;
+	std::vector<size_t> m_firstJob;	// First job of each thread, plus the end of the job list
+	size_t m_numRead;				// Number of queued samples that have already been decoded
+	uint32 m_numThreads;
+
+	void PrepareCompressedSample(size_t index);
+	void DecompressSerial(size_t index);
+	static void ThreadFunc(void *param, uint32 worker);
+};
+
+
 OPENMPT_NAMESPACE_END
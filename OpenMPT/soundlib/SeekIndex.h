@@ -0,0 +1,113 @@
+/*
+ * SeekIndex.h
+ * -----------
+ * Purpose: Checkpoints of the song length calculation, so that seeking doesn't have to start from the beginning of the song.
+ * Notes  : The index is filled by CSoundFile::GetLength() while it runs through the song, see Snd_fx.cpp.
+ *          Only the (small) part of the playback state that GetLength() actually modifies is stored.
+ *          Channel states are stored as deltas to the previous checkpoint.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include "Snd_defs.h"
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+//=============
+class SeekIndex
+//=============
+{
+public:
+
+	// Channel memory that is updated by GetLength()
+	struct ChannelState
+	{
+		double patLoop;
+		ROWINDEX patLoopStart;
+		ROWINDEX nPatternLoop;
+		uint32 nOldGlobalVolSlide;
+		int32 nGlobalVol;
+		int32 nPortamentoSlide;
+		CHANNELINDEX channel;
+		uint8 vol;
+		uint8 nNewIns, nLastNote;
+		uint8 nPatternLoopCount;
+		uint8 nOldTempo, nOldHiOffset, nOldOffset;
+		uint8 nOldPortaUpDown, nOldVolumeSlide, nOldChnVolSlide;
+
+		// Compare everything but the channel index
+		bool operator== (const ChannelState &other) const
+		{
+			return patLoop == other.patLoop && patLoopStart == other.patLoopStart && nPatternLoop == other.nPatternLoop
+				&& nOldGlobalVolSlide == other.nOldGlobalVolSlide && nGlobalVol == other.nGlobalVol && nPortamentoSlide == other.nPortamentoSlide
+				&& vol == other.vol && nNewIns == other.nNewIns && nLastNote == other.nLastNote && nPatternLoopCount == other.nPatternLoopCount
+				&& nOldTempo == other.nOldTempo && nOldHiOffset == other.nOldHiOffset && nOldOffset == other.nOldOffset
+				&& nOldPortaUpDown == other.nOldPortaUpDown && nOldVolumeSlide == other.nOldVolumeSlide && nOldChnVolSlide == other.nOldChnVolSlide;
+		}
+		bool operator!= (const ChannelState &other) const { return !(*this == other); }
+	};
+
+	// State of GetLength() at the beginning of a row
+	struct Checkpoint
+	{
+		double elapsedTime;
+		double bufferDiff;
+		uint32 totalSampleCount;
+		uint32 musicSpeed, musicTempo;
+		int32 globalVolume;
+		ROWINDEX nextRow, nextPatStartRow, endRow;
+		ORDERINDEX nextOrder, endOrder;
+		size_t numVisits;		// Number of entries in visits that were recorded before this checkpoint
+		size_t firstChannel;	// First entry in channels belonging to this checkpoint (the entries end at the next checkpoint's firstChannel)
+	};
+
+	std::vector<Checkpoint> checkpoints;
+	std::vector<ChannelState> channels;
+	// All rows that have been marked as visited by GetLength(), in the order in which they were visited.
+	std::vector<std::pair<ORDERINDEX, ROWINDEX> > visits;
+
+	// Parameters that the recorded song positions depend on
+	SEQUENCEINDEX sequence;
+	uint32 mixingFreq;
+	uint32 tempoFactor;
+	// Number of rows between two checkpoints
+	ROWINDEX interval;
+	// The index covers the whole song, i.e. no further checkpoints can be recorded.
+	bool complete;
+
+	SeekIndex() : sequence(0), mixingFreq(0), tempoFactor(0), interval(0), complete(false) { }
+
+	// Forget everything that has been recorded and release the memory.
+	void Clear()
+	{
+		std::vector<Checkpoint>().swap(checkpoints);
+		std::vector<ChannelState>().swap(channels);
+		std::vector<std::pair<ORDERINDEX, ROWINDEX> >().swap(visits);
+		complete = false;
+	}
+
+	// Throw away everything that has been recorded after the given checkpoint, so that recording can be continued from there.
+	void Truncate(size_t checkpoint)
+	{
+		const Checkpoint &cp = checkpoints[checkpoint];
+		visits.resize(cp.numVisits);
+		channels.resize(checkpoint + 1 < checkpoints.size() ? checkpoints[checkpoint + 1].firstChannel : channels.size());
+		checkpoints.resize(checkpoint + 1);
+		complete = false;
+	}
+
+	size_t GetMemoryUsage() const
+	{
+		return checkpoints.capacity() * sizeof(Checkpoint)
+			+ channels.capacity() * sizeof(ChannelState)
+			+ visits.capacity() * sizeof(std::pair<ORDERINDEX, ROWINDEX>);
+	}
+};
+
+
+OPENMPT_NAMESPACE_END
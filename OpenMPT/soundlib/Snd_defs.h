@@ -61,6 +61,9 @@ const CHANNELINDEX MAX_CHANNELS			= 256;	//200 // Maximum number of mixing chann
 
 #define FREQ_FRACBITS		4		// Number of fractional bits in return value of CSoundFile::GetFreqFromPeriod()
 
+#define SAMPLEPOS_FRACBITS	32		// Number of fractional bits in ModChannel::nPosLo and ModChannel::nInc
+#define SAMPLEPOS_ONE		(int64(1) << SAMPLEPOS_FRACBITS)	// Increment for playing one sample per output sample
+
 // String lengths (including trailing null char)
 #define MAX_SAMPLENAME			32
 #define MAX_SAMPLEFILENAME		22
@@ -300,6 +303,8 @@ DECLARE_FLAGSET(SongFlags)
 // Misc Flags (can safely be turned on or off)
 #define SNDMIX_MAXDEFAULTPAN	0x80000		// Used by the MOD loader (currently unused)
 #define SNDMIX_MUTECHNMODE		0x100000	// Notes are not played on muted channels
+#define SNDMIX_NOSIMD			0x200000	// Use the scalar reference code paths instead of the vectorized ones (output is identical)
+#define SNDMIX_NOVOICESKIP		0x400000	// Mix voices even if their sample data is silent (output is identical unless MixerSettings::VoiceSkipThreshold is set)
 
 
 #define MAX_GLOBAL_VOLUME 256u
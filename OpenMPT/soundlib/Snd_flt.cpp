@@ -43,6 +43,44 @@ DWORD CSoundFile::CutOffToFrequency(UINT nCutOff, int flt_modifier) const
 }
 
 
+// Calculate lowpass coefficients of the resonant filter.
+// cutoff is only used for non-IT filters, computedCutoff (cutoff with filter envelope applied) only for IT filters.
+void CSoundFile::CalculateFilterCoefficients(bool itFilter, int cutoff, int computedCutoff, int resonance, int flt_modifier, FilterCache::Coefficients &coeffs) const
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------
+{
+	float d, e;
+
+	if(itFilter)
+	{
+		const float freqParameterMultiplier = 128.0f / (24.0f * 256.0f);
+
+		// 2 ^ (i / 24 * 256)
+		float frequency = 110.0f * pow(2.0f, 0.25f + (float)computedCutoff * freqParameterMultiplier);
+		LimitMax(frequency, (float)(m_MixerSettings.gdwMixingFreq / 2));
+		const float r = (float)m_MixerSettings.gdwMixingFreq / (2.0f * (float)M_PI * frequency);
+
+		d = ITResonanceTable[resonance] * r + ITResonanceTable[resonance] - 1.0f;
+		e = r * r;
+	} else
+	{
+		float fc = (float)CutOffToFrequency(cutoff, flt_modifier);
+		const float dmpfac = pow(10.0f, -((24.0f / 128.0f) * (float)resonance) / 20.0f);
+
+		fc *= (float)(2.0f * (float)M_PI / (float)m_MixerSettings.gdwMixingFreq);
+
+		d = (1.0f - 2.0f * dmpfac) * fc;
+		LimitMax(d, 2.0f);
+		d = (2.0f * dmpfac - d) / fc;
+		e = pow(1.0f / fc, 2.0f);
+	}
+
+	coeffs.fg = 1.0f / (1.0f + d + e);
+	coeffs.fb0 = (d + e + e) / (1 + d + e);
+	coeffs.fb1 = -e / (1.0f + d + e);
+	coeffs.valid = true;
+}
+
+
 // Simple 2-poles resonant filter
 void CSoundFile::SetupChannelFilter(ModChannel *pChn, bool bReset, int flt_modifier) const
 //----------------------------------------------------------------------------------------
@@ -61,8 +99,6 @@ void CSoundFile::SetupChannelFilter(ModChannel *pChn, bool bReset, int flt_modif
 		pChn->nResSwing = 0;
 	}
 
-	float d, e;
-
 	// flt_modifier is in [-256, 256], so cutoff is in [0, 127 * 2] after this calculation.
 	const int computedCutoff = cutoff * (flt_modifier + 256) / 256;
 
@@ -80,33 +116,22 @@ void CSoundFile::SetupChannelFilter(ModChannel *pChn, bool bReset, int flt_modif
 
 	pChn->dwFlags.set(CHN_FILTER);
 
-	if(UseITFilterMode())
-	{
-		const float freqParameterMultiplier = 128.0f / (24.0f * 256.0f);
-
-		// 2 ^ (i / 24 * 256)
-		float frequency = 110.0f * pow(2.0f, 0.25f + (float)computedCutoff * freqParameterMultiplier);
-		LimitMax(frequency, (float)(m_MixerSettings.gdwMixingFreq / 2));
-		const float r = (float)m_MixerSettings.gdwMixingFreq / (2.0f * (float)M_PI * frequency);
+	// The non-IT cutoff frequency depends on the unscaled cutoff and the envelope value, so only coefficients without envelope are cached.
+	const bool itFilter = UseITFilterMode();
+	FilterCache::Coefficients uncached;
+	FilterCache::Coefficients &coeffs = (itFilter || flt_modifier == 256)
+		? m_FilterCache.Get(itFilter ? FilterCache::modeIT : (m_SongFlags[SONG_EXFILTERRANGE] ? FilterCache::modeExtendedRange : FilterCache::modeNormalRange),
+			itFilter ? computedCutoff : cutoff, resonance, m_MixerSettings.gdwMixingFreq)
+		: uncached;
 
-		d = ITResonanceTable[resonance] * r + ITResonanceTable[resonance] - 1.0f;
-		e = r * r;
-	} else
+	if(!coeffs.valid)
 	{
-		float fc = (float)CutOffToFrequency(cutoff, flt_modifier);
-		const float dmpfac = pow(10.0f, -((24.0f / 128.0f) * (float)resonance) / 20.0f);
-
-		fc *= (float)(2.0f * (float)M_PI / (float)m_MixerSettings.gdwMixingFreq);
-
-		d = (1.0f - 2.0f * dmpfac) * fc;
-		LimitMax(d, 2.0f);
-		d = (2.0f * dmpfac - d) / fc;
-		e = pow(1.0f / fc, 2.0f);
+		CalculateFilterCoefficients(itFilter, cutoff, computedCutoff, resonance, flt_modifier, coeffs);
 	}
 
-	float fg = 1.0f / (1.0f + d + e);
-	float fb0 = (d + e + e) / (1 + d + e);
-	float fb1 = -e / (1.0f + d + e);
+	const float fg = coeffs.fg;
+	const float fb0 = coeffs.fb0;
+	const float fb1 = coeffs.fb1;
 
 #if defined(MPT_INTMIXER)
 #define FILTER_CONVERT(x) static_cast<mixsample_t>((x) * (1 << MIXING_FILTER_PRECISION))
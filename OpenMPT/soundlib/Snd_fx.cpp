@@ -81,6 +81,7 @@ public:
 	{
 		elapsedTime = 0.0;
 		state.m_lTotalSampleCount = 0;
+		state.m_dBufferDiff = 0.0;
 		state.m_nMusicSpeed = sndFile.m_nDefaultSpeed;
 		state.m_nMusicTempo = sndFile.m_nDefaultTempo;
 		state.m_nGlobalVolume = sndFile.m_nDefaultGlobalVolume;
@@ -90,12 +91,131 @@ public:
 			state.Chn[chn].Reset(ModChannel::resetTotal, sndFile, chn);
 			state.Chn[chn].nOldGlobalVolSlide = 0;
 			state.Chn[chn].nOldChnVolSlide = 0;
+			// Don't carry over effect memory from the current playback position, so that the results only depend on the song itself.
+			state.Chn[chn].nOldTempo = 0;
+			state.Chn[chn].nOldPortaUpDown = 0;
+			state.Chn[chn].nPortamentoSlide = 0;
+			state.Chn[chn].nOldOffset = 0;
+			state.Chn[chn].nOldVolumeSlide = 0;
 			state.Chn[chn].nNote = state.Chn[chn].nNewNote = state.Chn[chn].nLastNote = NOTE_NONE;
 		}
 	}
+
+	// Retrieve the part of the channel state that is modified by GetLength(), for storing it in the seek index.
+	SeekIndex::ChannelState SaveChannel(CHANNELINDEX chn) const
+	{
+		const ModChannel &c = state.Chn[chn];
+		SeekIndex::ChannelState s;
+		s.channel = chn;
+		s.patLoop = chnSettings[chn].patLoop;
+		s.patLoopStart = chnSettings[chn].patLoopStart;
+		s.vol = chnSettings[chn].vol;
+		s.nPatternLoop = c.nPatternLoop;
+		s.nOldGlobalVolSlide = c.nOldGlobalVolSlide;
+		s.nGlobalVol = c.nGlobalVol;
+		s.nPortamentoSlide = c.nPortamentoSlide;
+		s.nNewIns = c.nNewIns;
+		s.nLastNote = c.nLastNote;
+		s.nPatternLoopCount = c.nPatternLoopCount;
+		s.nOldTempo = c.nOldTempo;
+		s.nOldHiOffset = c.nOldHiOffset;
+		s.nOldOffset = c.nOldOffset;
+		s.nOldPortaUpDown = c.nOldPortaUpDown;
+		s.nOldVolumeSlide = c.nOldVolumeSlide;
+		s.nOldChnVolSlide = c.nOldChnVolSlide;
+		return s;
+	}
+
+	void RestoreChannel(const SeekIndex::ChannelState &s)
+	{
+		ModChannel &c = state.Chn[s.channel];
+		chnSettings[s.channel].patLoop = s.patLoop;
+		chnSettings[s.channel].patLoopStart = s.patLoopStart;
+		chnSettings[s.channel].vol = s.vol;
+		c.nPatternLoop = s.nPatternLoop;
+		c.nOldGlobalVolSlide = s.nOldGlobalVolSlide;
+		c.nGlobalVol = s.nGlobalVol;
+		c.nPortamentoSlide = s.nPortamentoSlide;
+		c.nNewIns = s.nNewIns;
+		c.nLastNote = s.nLastNote;
+		c.nPatternLoopCount = s.nPatternLoopCount;
+		c.nOldTempo = s.nOldTempo;
+		c.nOldHiOffset = s.nOldHiOffset;
+		c.nOldOffset = s.nOldOffset;
+		c.nOldPortaUpDown = s.nOldPortaUpDown;
+		c.nOldVolumeSlide = s.nOldVolumeSlide;
+		c.nOldChnVolSlide = s.nOldChnVolSlide;
+	}
 };
 
 
+// Mark a row as visited in GetLength() and remember it in the seek index if it is being recorded.
+static bool VisitRow(RowVisitor &visitedRows, SeekIndex *recordIndex, ORDERINDEX order, ROWINDEX row)
+//---------------------------------------------------------------------------------------------------
+{
+	if(visitedRows.IsVisited(order, row, true))
+	{
+		return true;
+	}
+	if(recordIndex != nullptr)
+	{
+		recordIndex->visits.push_back(std::make_pair(order, row));
+	}
+	return false;
+}
+
+
+// Find the checkpoint from which GetLength() can resume instead of starting from the beginning of the song.
+// The checkpoint must lie before the point where the target would be reached. Returns false if there is no such checkpoint.
+static bool FindSeekCheckpoint(const CSoundFile &sndFile, const SeekIndex &index, const GetLengthTarget &target, size_t &checkpoint)
+//--------------------------------------------------------------------------------------------------------------------------------
+{
+	if(index.checkpoints.empty())
+	{
+		return false;
+	}
+	checkpoint = index.checkpoints.size() - 1;
+
+	if(target.mode == GetLengthTarget::SeekSeconds)
+	{
+		// Elapsed time never decreases, so the target time can't have been reached before a checkpoint with a smaller timestamp.
+		while(index.checkpoints[checkpoint].elapsedTime >= target.time)
+		{
+			if(checkpoint == 0)
+			{
+				return false;
+			}
+			checkpoint--;
+		}
+	} else if(target.mode == GetLengthTarget::SeekPosition)
+	{
+		// Positions in "+++" or non-existing patterns are handled specially by GetLength(), don't bother with them.
+		if(target.pos.order >= sndFile.Order.GetLength() || !sndFile.Patterns.IsValidPat(sndFile.Order[target.pos.order]))
+		{
+			return false;
+		}
+		// If the target row was visited, it must not have been visited before the checkpoint.
+		// If it was never visited, GetLength() continues past the last checkpoint anyway.
+		for(size_t i = 0; i < index.visits.size(); i++)
+		{
+			if(index.visits[i].first == target.pos.order && index.visits[i].second == target.pos.row)
+			{
+				while(index.checkpoints[checkpoint].numVisits > i)
+				{
+					if(checkpoint == 0)
+					{
+						return false;
+					}
+					checkpoint--;
+				}
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+
 // Get mod length in various cases. Parameters:
 // [in]  adjustMode: See enmGetLengthResetMode for possible adjust modes.
 // [in]  target: Time or position target which should be reached, or no target to get length of the first sub song.
@@ -126,6 +246,77 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 	// Temporary visited rows vector (so that GetLength() won't interfere with the player code if the module is playing at the same time)
 	RowVisitor visitedRows(*this);
 
+	// Resume from the closest checkpoint in the seek index, if possible, and record new checkpoints if we're going past the last one.
+	// Sample position adjustment requires the full channel state, so it cannot be resumed from a checkpoint.
+	SeekIndex *seekIndex = nullptr;
+	bool recordSeekIndex = false;
+	ROWINDEX rowsSinceCheckpoint = 0;
+	std::vector<SeekIndex::ChannelState> seekChnState;	// Channel state at the last checkpoint, for storing only the changed channels
+	if(m_nSeekIndexInterval != 0 && !adjustSamplePos)
+	{
+#ifndef MODPLUG_TRACKER
+		const uint32 tempoFactor = m_nTempoFactor;
+#else
+		const uint32 tempoFactor = 128;
+#endif // !MODPLUG_TRACKER
+		seekIndex = &m_SeekIndex[(adjustMode & eAdjust) ? 1 : 0];
+		if(seekIndex->interval != m_nSeekIndexInterval || seekIndex->sequence != Order.GetCurrentSequenceIndex() || seekIndex->mixingFreq != m_MixerSettings.gdwMixingFreq || seekIndex->tempoFactor != tempoFactor)
+		{
+			seekIndex->Clear();
+			seekIndex->interval = m_nSeekIndexInterval;
+			seekIndex->sequence = Order.GetCurrentSequenceIndex();
+			seekIndex->mixingFreq = m_MixerSettings.gdwMixingFreq;
+			seekIndex->tempoFactor = tempoFactor;
+		}
+
+		size_t checkpoint;
+		if(FindSeekCheckpoint(*this, *seekIndex, target, checkpoint))
+		{
+			const SeekIndex::Checkpoint &cp = seekIndex->checkpoints[checkpoint];
+			memory.elapsedTime = cp.elapsedTime;
+			memory.state.m_dBufferDiff = cp.bufferDiff;
+			memory.state.m_lTotalSampleCount = cp.totalSampleCount;
+			memory.state.m_nMusicSpeed = cp.musicSpeed;
+			memory.state.m_nMusicTempo = cp.musicTempo;
+			memory.state.m_nGlobalVolume = cp.globalVolume;
+			const size_t endChannel = (checkpoint + 1 < seekIndex->checkpoints.size()) ? seekIndex->checkpoints[checkpoint + 1].firstChannel : seekIndex->channels.size();
+			for(size_t i = 0; i < endChannel; i++)
+			{
+				memory.RestoreChannel(seekIndex->channels[i]);
+			}
+			for(size_t i = 0; i < cp.numVisits; i++)
+			{
+				visitedRows.Visit(seekIndex->visits[i].first, seekIndex->visits[i].second);
+			}
+			nNextRow = cp.nextRow;
+			nNextOrder = cp.nextOrder;
+			nNextPatStartRow = cp.nextPatStartRow;
+			retval.endOrder = cp.endOrder;
+			retval.endRow = cp.endRow;
+
+			if(checkpoint == seekIndex->checkpoints.size() - 1 && !seekIndex->complete)
+			{
+				seekIndex->Truncate(checkpoint);
+				recordSeekIndex = true;
+			}
+		} else
+		{
+			recordSeekIndex = seekIndex->checkpoints.empty() && !seekIndex->complete;
+			if(recordSeekIndex)
+			{
+				seekIndex->visits.clear();
+			}
+		}
+		if(recordSeekIndex)
+		{
+			seekChnState.resize(GetNumChannels());
+			for(CHANNELINDEX chn = 0; chn < GetNumChannels(); chn++)
+			{
+				seekChnState[chn] = memory.SaveChannel(chn);
+			}
+		}
+	}
+
 	// Optimize away channels for which it's pointless to adjust sample positions
 	std::vector<bool> adjustSampleChn(GetNumChannels(), true);
 	if(adjustSamplePos && target.mode == GetLengthTarget::SeekPosition)
@@ -155,6 +346,35 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 
 	for (;;)
 	{
+		if(recordSeekIndex && rowsSinceCheckpoint >= seekIndex->interval)
+		{
+			SeekIndex::Checkpoint cp;
+			cp.elapsedTime = memory.elapsedTime;
+			cp.bufferDiff = memory.state.m_dBufferDiff;
+			cp.totalSampleCount = memory.state.m_lTotalSampleCount;
+			cp.musicSpeed = memory.state.m_nMusicSpeed;
+			cp.musicTempo = memory.state.m_nMusicTempo;
+			cp.globalVolume = memory.state.m_nGlobalVolume;
+			cp.nextRow = nNextRow;
+			cp.nextOrder = nNextOrder;
+			cp.nextPatStartRow = nNextPatStartRow;
+			cp.endRow = retval.endRow;
+			cp.endOrder = retval.endOrder;
+			cp.numVisits = seekIndex->visits.size();
+			cp.firstChannel = seekIndex->channels.size();
+			for(CHANNELINDEX chn = 0; chn < GetNumChannels(); chn++)
+			{
+				const SeekIndex::ChannelState chnState = memory.SaveChannel(chn);
+				if(chnState != seekChnState[chn])
+				{
+					seekIndex->channels.push_back(chnState);
+					seekChnState[chn] = chnState;
+				}
+			}
+			seekIndex->checkpoints.push_back(cp);
+			rowsSinceCheckpoint = 0;
+		}
+
 		uint32 rowDelay = 0, tickDelay = 0;
 		nRow = nNextRow;
 		nCurrentOrder = nNextOrder;
@@ -190,7 +410,7 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 			}
 			nPattern = (nCurrentOrder < Order.size()) ? Order[nCurrentOrder] : Order.GetInvalidPatIndex();
 			nNextOrder = nCurrentOrder;
-			if((!Patterns.IsValidPat(nPattern)) && visitedRows.IsVisited(nCurrentOrder, 0, true))
+			if((!Patterns.IsValidPat(nPattern)) && VisitRow(visitedRows, recordSeekIndex ? seekIndex : nullptr, nCurrentOrder, 0))
 			{
 				if(!hasSearchTarget || !visitedRows.GetFirstUnvisitedRow(nNextOrder, nNextRow, true))
 				{
@@ -199,6 +419,12 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 				} else
 				{
 					// We haven't found the target row yet, but we found some other unplayed row... continue searching from here.
+					// This is where a search without target would have stopped, so the seek index is complete.
+					if(recordSeekIndex)
+					{
+						seekIndex->complete = true;
+						recordSeekIndex = false;
+					}
 					memory.Reset();
 					nRow = nNextRow;
 					nCurrentOrder = nNextOrder;
@@ -220,6 +446,11 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 				} else
 				{
 					// We haven't found the target row yet, but we found some other unplayed row... continue searching from here.
+					if(recordSeekIndex)
+					{
+						seekIndex->complete = true;
+						recordSeekIndex = false;
+					}
 					memory.Reset();
 					continue;
 				}
@@ -239,7 +470,7 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 			break;
 		}
 
-		if(visitedRows.IsVisited(nCurrentOrder, nRow, true))
+		if(VisitRow(visitedRows, recordSeekIndex ? seekIndex : nullptr, nCurrentOrder, nRow))
 		{
 			if(!hasSearchTarget || !visitedRows.GetFirstUnvisitedRow(nNextOrder, nNextRow, true))
 			{
@@ -248,6 +479,11 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 			} else
 			{
 				// We haven't found the target row yet, but we found some other unplayed row... continue searching from here.
+				if(recordSeekIndex)
+				{
+					seekIndex->complete = true;
+					recordSeekIndex = false;
+				}
 				memory.Reset();
 				continue;
 			}
@@ -255,6 +491,7 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 
 		retval.endOrder = nCurrentOrder;
 		retval.endRow = nRow;
+		rowsSinceCheckpoint++;
 
 		// Update next position
 		nNextRow = nRow + 1;
@@ -572,7 +809,10 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 			rowsPerBeat = Patterns[nPattern].GetRowsPerBeat();
 		}
 
+		// The modern tempo mode accumulates rounding errors in the play state, so use the simulated play state for this.
+		std::swap(m_PlayState.m_dBufferDiff, memory.state.m_dBufferDiff);
 		const uint32 tickDuration = GetTickDuration(memory.state.m_nMusicTempo, memory.state.m_nMusicSpeed, rowsPerBeat);
+		std::swap(m_PlayState.m_dBufferDiff, memory.state.m_dBufferDiff);
 		const uint32 numTicks = (memory.state.m_nMusicSpeed + tickDelay) * MAX(rowDelay, 1);
 		const uint32 rowDuration = tickDuration * numTicks;
 		memory.elapsedTime += static_cast<double>(rowDuration) / static_cast<double>(m_MixerSettings.gdwMixingFreq);
@@ -660,7 +900,7 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 						if(!pChn->nPos && pChn->nLength && (p->IsNote() || !pChn->dwFlags[CHN_LOOP]))
 						{
 							pChn->nPos = pChn->nLength - 1;
-							pChn->nPosLo = 0xFFFF;
+							pChn->nPosLo = 0xFFFFFFFF;
 						}
 					}
 				}
@@ -725,11 +965,11 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 
 						if(updateInc) pChn->nInc = GetChannelIncrement(pChn, pChn->nPeriod, 0);
 
-						int32 inc = pChn->nInc;
+						int64 inc = pChn->nInc;
 						if(pChn->dwFlags[CHN_PINGPONGFLAG]) inc = -inc;
-						pChn->nPosLo += inc * tickDuration;
-						pChn->nPos += ((int32)pChn->nPosLo >> 16);
-						pChn->nPosLo &= 0xFFFF;
+						const int64 pos = static_cast<int64>(pChn->nPosLo) + inc * tickDuration;
+						pChn->nPos += static_cast<int32>(pos >> SAMPLEPOS_FRACBITS);
+						pChn->nPosLo = static_cast<uint32>(pos);
 					}
 					if(pChn->pModSample->uFlags[CHN_SUSTAINLOOP | CHN_LOOP])
 					{
@@ -808,6 +1048,12 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 		}
 	}
 
+	if(recordSeekIndex && !retval.targetReached)
+	{
+		// We went through the whole song.
+		seekIndex->complete = true;
+	}
+
 	if(retval.targetReached || target.mode == GetLengthTarget::NoTarget)
 	{
 		retval.lastOrder = nCurrentOrder;
@@ -857,6 +1103,36 @@ GetLengthType CSoundFile::GetLength(enmGetLengthResetMode adjustMode, GetLengthT
 }
 
 
+void CSoundFile::SetSeekIndexInterval(ROWINDEX rows)
+//--------------------------------------------------
+{
+	m_nSeekIndexInterval = rows;
+	InvalidateSeekIndex();
+}
+
+
+void CSoundFile::InvalidateSeekIndex()
+//------------------------------------
+{
+	for(size_t i = 0; i < CountOf(m_SeekIndex); i++)
+	{
+		m_SeekIndex[i].Clear();
+	}
+}
+
+
+size_t CSoundFile::GetSeekIndexMemoryUsage() const
+//------------------------------------------------
+{
+	size_t usage = 0;
+	for(size_t i = 0; i < CountOf(m_SeekIndex); i++)
+	{
+		usage += m_SeekIndex[i].GetMemoryUsage();
+	}
+	return usage;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Effects
 
@@ -1543,9 +1819,13 @@ CHANNELINDEX CSoundFile::GetNNAChannel(CHANNELINDEX nChn) const
 //-------------------------------------------------------------
 {
 	const ModChannel *pChn = &m_PlayState.Chn[nChn];
-	// Check for empty channel
+	// Check for empty channel. Channels that are not in the set of playing voices are known to be empty,
+	// but the ones before the first of them may have stopped playing as well.
+	const CHANNELINDEX firstUnused = m_PlayState.m_PlayingVoices.FindNextUnset(m_nChannels);
 	const ModChannel *pi = &m_PlayState.Chn[m_nChannels];
-	for (CHANNELINDEX i=m_nChannels; i<MAX_CHANNELS; i++, pi++) if (!pi->nLength) return i;
+	for (CHANNELINDEX i=m_nChannels; i<firstUnused; i++, pi++) if (!pi->nLength) return i;
+	if (firstUnused < MAX_CHANNELS) return firstUnused;
+	// All channels are in use, so looking for the best channel to steal has to look at all of them anyway.
 	if (!pChn->nFadeOutVol) return 0;
 	// All channels are used: check for lowest volume
 	CHANNELINDEX result = 0;
@@ -1589,9 +1869,11 @@ void CSoundFile::CheckNNA(CHANNELINDEX nChn, UINT instr, int note, bool forceCut
 			return;
 		}
 
+		UpdateBackgroundVoices();
 		CHANNELINDEX n = GetNNAChannel(nChn);
 		if(!n) return;
 		ModChannel &chn = m_PlayState.Chn[n];
+		AddBackgroundVoice(n, nChn);
 		// Copy Channel
 		chn = *pChn;
 		chn.dwFlags.reset(CHN_VIBRATO | CHN_TREMOLO | CHN_PANBRELLO | CHN_MUTE | CHN_PORTAMENTO);
@@ -1633,15 +1915,20 @@ void CSoundFile::CheckNNA(CHANNELINDEX nChn, UINT instr, int note, bool forceCut
 			}
 		} else pSample = nullptr;
 	}
-	ModChannel *p = pChn;
 	//if (!pIns) return;
 	if (pChn->dwFlags[CHN_MUTE]) return;
 
+	UpdateBackgroundVoices();
+
 	bool applyDNAtoPlug;	//rewbs.VSTiNNA
 
-	for(CHANNELINDEX i = nChn; i < MAX_CHANNELS; p++, i++)
-	if(i >= m_nChannels || p == pChn)
+	// Check this channel and all background channels that belong to it.
+	ChannelSet dnaVoices = m_PlayState.m_OwnedVoices[nChn];
+	dnaVoices.Set(nChn);
+	for(ChannelSet::Iterator it(dnaVoices); it.IsValid(); it.Next())
 	{
+		const CHANNELINDEX i = it.GetChannel();
+		ModChannel *p = &m_PlayState.Chn[i];
 		applyDNAtoPlug = false; //rewbs.VSTiNNA
 		if((p->nMasterChn == nChn + 1 || p == pChn) && p->pModInstrument != nullptr)
 		{
@@ -1757,6 +2044,7 @@ void CSoundFile::CheckNNA(CHANNELINDEX nChn, UINT instr, int note, bool forceCut
 		if(n != 0)
 		{
 			ModChannel *p = &m_PlayState.Chn[n];
+			AddBackgroundVoice(n, nChn);
 			// Copy Channel
 			*p = *pChn;
 			p->dwFlags.reset(CHN_VIBRATO | CHN_TREMOLO | CHN_PANBRELLO | CHN_MUTE | CHN_PORTAMENTO);
@@ -1810,6 +2098,42 @@ void CSoundFile::CheckNNA(CHANNELINDEX nChn, UINT instr, int note, bool forceCut
 }
 
 
+void CSoundFile::AddBackgroundVoice(CHANNELINDEX nChn, CHANNELINDEX nMasterChn)
+//------------------------------------------------------------------------------
+{
+	m_PlayState.m_PlayingVoices.Set(nChn);
+	if(nMasterChn < MAX_BASECHANNELS)
+	{
+		const CHANNELINDEX oldMaster = m_PlayState.Chn[nChn].nMasterChn;
+		if(oldMaster > 0 && oldMaster <= MAX_BASECHANNELS)
+		{
+			m_PlayState.m_OwnedVoices[oldMaster - 1].Reset(nChn);
+		}
+		m_PlayState.m_OwnedVoices[nMasterChn].Set(nChn);
+	}
+}
+
+
+void CSoundFile::UpdateBackgroundVoices()
+//---------------------------------------
+{
+	if(m_nChannels < m_PlayState.m_nVoiceSetStart)
+	{
+		// Former pattern channels may still be playing
+		m_PlayState.m_PlayingVoices.SetRange(m_nChannels, m_PlayState.m_nVoiceSetStart);
+	} else if(m_nChannels > m_PlayState.m_nVoiceSetStart)
+	{
+		// The voice sets only contain background channels
+		m_PlayState.m_PlayingVoices.ResetRange(m_PlayState.m_nVoiceSetStart, m_nChannels);
+		for(CHANNELINDEX i = 0; i < MAX_BASECHANNELS; i++)
+		{
+			m_PlayState.m_OwnedVoices[i].ResetRange(m_PlayState.m_nVoiceSetStart, m_nChannels);
+		}
+	}
+	m_PlayState.m_nVoiceSetStart = m_nChannels;
+}
+
+
 bool CSoundFile::ProcessEffects()
 //-------------------------------
 {
@@ -3851,9 +4175,10 @@ void CSoundFile::ExtendedS3MCommands(CHANNELINDEX nChn, UINT param)
 				case 1:
 				case 2:
 					{
-						ModChannel *bkp = &m_PlayState.Chn[m_nChannels];
-						for (CHANNELINDEX i=m_nChannels; i<MAX_CHANNELS; i++, bkp++)
+						UpdateBackgroundVoices();
+						for (ChannelSet::Iterator it(m_PlayState.m_OwnedVoices[nChn]); it.IsValid(); it.Next())
 						{
+							ModChannel *bkp = &m_PlayState.Chn[it.GetChannel()];
 							if (bkp->nMasterChn == nChn+1)
 							{
 								if (param == 1)
@@ -4001,7 +4326,7 @@ void CSoundFile::ExtendedChannelEffect(ModChannel *pChn, UINT param)
 		if(!pChn->nPos && pChn->nLength && (pChn->rowCommand.IsNote() || !pChn->dwFlags[CHN_LOOP]))
 		{
 			pChn->nPos = pChn->nLength - 1;
-			pChn->nPosLo = 0xFFFF;
+			pChn->nPosLo = 0xFFFFFFFF;
 		}
 		pChn->dwFlags.set(CHN_PINGPONGFLAG);
 		break;
@@ -4034,120 +4359,129 @@ void CSoundFile::InvertLoop(ModChannel *pChn)
 }
 
 
-// Process a MIDI Macro.
+// Translate a compiled MIDI Macro into the bytes to be sent.
 // Parameters:
 // [in] nChn: Mod channel to apply macro on
-// [in] isSmooth: If true, internal macros are interpolated between two rows
-// [in] macro: Actual MIDI Macro string
+// [in] macro: Compiled MIDI Macro
 // [in] param: Parameter for parametric macros (Z00 - Z7F)
-// [in] plugin: Plugin to send MIDI message to (if not specified but needed, it is autodetected)
-void CSoundFile::ProcessMIDIMacro(CHANNELINDEX nChn, bool isSmooth, char *macro, uint8 param, PLUGINDEX plugin)
-//-------------------------------------------------------------------------------------------------------------
+// [out] out: Output bytes. The buffer is big enough for one additional byte, in case a SysEx message has to be terminated.
+// Returns the number of bytes written to out.
+size_t CSoundFile::EvaluateMIDIMacro(CHANNELINDEX nChn, const CompiledMIDIMacro &macro, uint8 param, unsigned char (&out)[MACRO_LENGTH]) const
+//-------------------------------------------------------------------------------------------------------------------------------------------
 {
 	const ModChannel *pChn = &m_PlayState.Chn[nChn];
 	const ModInstrument *pIns = GetNumInstruments() ? pChn->pModInstrument : nullptr;
 
-	unsigned char out[MACRO_LENGTH];
-	size_t outPos = 0;	// output buffer position, which also equals the number of complete bytes
-	bool firstNibble = true;
+	uint8 midiChannel = 0;
+	bool haveMidiChannel = false;
 
-	for(size_t pos = 0; pos < (MACRO_LENGTH - 1) && macro[pos]; pos++)
+	for(size_t i = 0; i < macro.numOps; i++)
 	{
-		bool isNibble = false;		// did we parse a nibble or a byte value?
-		unsigned char data = 0;		// data that has just been parsed
+		const CompiledMIDIMacro::Op &op = macro.ops[i];
+		unsigned char data = 0;
 
-		// Parse next macro byte... See Impulse Tracker's MIDI.TXT for detailed information on each possible character.
-		if(macro[pos] >= '0' && macro[pos] <= '9')
-		{
-			isNibble = true;
-			data = (unsigned char)macro[pos] - '0';
-		}
-		else if(macro[pos] >= 'A' && macro[pos] <= 'F')
-		{
-			isNibble = true;
-			data = (unsigned char)macro[pos] - 'A' + 0x0A;
-		} else if(macro[pos] == 'c')		// c: MIDI channel
-		{
-			isNibble = true;
-			data = (unsigned char)GetBestMidiChannel(nChn);
-		} else if(macro[pos] == 'n')		// n: note value (last triggered note)
+		switch(op.type)
 		{
+		case CompiledMIDIMacro::opConstant:
+			data = op.value;
+			break;
+
+		case CompiledMIDIMacro::opChannelLow:
+		case CompiledMIDIMacro::opChannelHigh:
+		case CompiledMIDIMacro::opChannelBoth:
+		case CompiledMIDIMacro::opChannel:
+			if(!haveMidiChannel)
+			{
+				midiChannel = GetBestMidiChannel(nChn);
+				haveMidiChannel = true;
+			}
+			switch(op.type)
+			{
+			case CompiledMIDIMacro::opChannelLow: data = (unsigned char)((op.value << 4) | midiChannel); break;
+			case CompiledMIDIMacro::opChannelHigh: data = (unsigned char)((midiChannel << 4) | op.value); break;
+			case CompiledMIDIMacro::opChannelBoth: data = (unsigned char)((midiChannel << 4) | midiChannel); break;
+			default: data = midiChannel; break;
+			}
+			break;
+
+		case CompiledMIDIMacro::opNote:
 			if(ModCommand::IsNote(pChn->nLastNote))
 			{
 				data = (unsigned char)(pChn->nLastNote - NOTE_MIN);
 			}
-		} else if(macro[pos] == 'v')		// v: velocity
-		{
-			// This is "almost" how IT does it - apparently, IT seems to lag one row behind on global volume or channel volume changes.
-			const int swing = (IsCompatibleMode(TRK_IMPULSETRACKER) || GetModFlag(MSF_OLDVOLSWING)) ? pChn->nVolSwing : 0;
-			const int vol = Util::muldiv((pChn->nVolume + swing) * m_PlayState.m_nGlobalVolume, pChn->nGlobalVol * pChn->nInsVol, 1 << 20);
-			data = (unsigned char)Clamp(vol / 2, 1, 127);
-			//data = (unsigned char)MIN((pChn->nVolume * pChn->nGlobalVol * m_nGlobalVolume) >> (1 + 6 + 8), 127);
-		} else if(macro[pos] == 'u')		// u: volume (calculated)
-		{
-			// Same note as with velocity applies here, but apparently also for instrument / sample volumes?
-			const int vol = Util::muldiv(pChn->nCalcVolume * m_PlayState.m_nGlobalVolume, pChn->nGlobalVol * pChn->nInsVol, 1 << 26);
-			data = (unsigned char)Clamp(vol / 2, 1, 127);
-			//data = (unsigned char)MIN((pChn->nCalcVolume * pChn->nGlobalVol * m_nGlobalVolume) >> (7 + 6 + 8), 127);
-		} else if(macro[pos] == 'x')		// x: pan set
-		{
+			break;
+
+		case CompiledMIDIMacro::opVelocity:
+			{
+				// This is "almost" how IT does it - apparently, IT seems to lag one row behind on global volume or channel volume changes.
+				const int swing = (IsCompatibleMode(TRK_IMPULSETRACKER) || GetModFlag(MSF_OLDVOLSWING)) ? pChn->nVolSwing : 0;
+				const int vol = Util::muldiv((pChn->nVolume + swing) * m_PlayState.m_nGlobalVolume, pChn->nGlobalVol * pChn->nInsVol, 1 << 20);
+				data = (unsigned char)Clamp(vol / 2, 1, 127);
+				//data = (unsigned char)MIN((pChn->nVolume * pChn->nGlobalVol * m_nGlobalVolume) >> (1 + 6 + 8), 127);
+			}
+			break;
+
+		case CompiledMIDIMacro::opVolume:
+			{
+				// Same note as with velocity applies here, but apparently also for instrument / sample volumes?
+				const int vol = Util::muldiv(pChn->nCalcVolume * m_PlayState.m_nGlobalVolume, pChn->nGlobalVol * pChn->nInsVol, 1 << 26);
+				data = (unsigned char)Clamp(vol / 2, 1, 127);
+				//data = (unsigned char)MIN((pChn->nCalcVolume * pChn->nGlobalVol * m_nGlobalVolume) >> (7 + 6 + 8), 127);
+			}
+			break;
+
+		case CompiledMIDIMacro::opPan:
 			data = (unsigned char)std::min(pChn->nPan / 2, 127);
-		} else if(macro[pos] == 'y')		// y: calculated pan
-		{
+			break;
+
+		case CompiledMIDIMacro::opRealPan:
 			data = (unsigned char)std::min(pChn->nRealPan / 2, 127);
-		} else if(macro[pos] == 'a')		// a: high byte of bank select
-		{
+			break;
+
+		case CompiledMIDIMacro::opBankHigh:
 			if(pIns && pIns->wMidiBank)
 			{
 				data = (unsigned char)(((pIns->wMidiBank - 1) >> 7) & 0x7F);
 			}
-		} else if(macro[pos] == 'b')		// b: low byte of bank select
-		{
+			break;
+
+		case CompiledMIDIMacro::opBankLow:
 			if(pIns && pIns->wMidiBank)
 			{
 				data = (unsigned char)((pIns->wMidiBank - 1) & 0x7F);
 			}
-		} else if(macro[pos] == 'p')		// p: program select
-		{
+			break;
+
+		case CompiledMIDIMacro::opProgram:
 			if(pIns && pIns->nMidiProgram)
 			{
 				data = (unsigned char)((pIns->nMidiProgram - 1) & 0x7F);
 			}
-		} else if(macro[pos] == 'z')		// z: macro data
-		{
+			break;
+
+		case CompiledMIDIMacro::opParam:
 			data = (unsigned char)(param & 0x7F);
-		} else								// unrecognized byte (e.g. space char)
-		{
-			continue;
+			break;
 		}
 
-		// Append parsed data
-		if(isNibble)	// parsed a nibble (constant or 'c' variable)
-		{
-			if(firstNibble)
-			{
-				out[outPos] = data;
-			} else
-			{
-				out[outPos] = (out[outPos] << 4) | data;
-				outPos++;
-			}
-			firstNibble = !firstNibble;
-		} else			// parsed a byte (variable)
-		{
-			if(!firstNibble)	// From MIDI.TXT: '9n' is exactly the same as '09 n' or '9 n' -- so finish current byte first
-			{
-				outPos++;
-			}
-			out[outPos++] = data;
-			firstNibble = true;
-		}
-	}
-	if(!firstNibble)
-	{
-		// Finish current byte
-		outPos++;
+		out[i] = data;
 	}
+	return macro.numOps;
+}
+
+
+// Process a MIDI Macro.
+// Parameters:
+// [in] nChn: Mod channel to apply macro on
+// [in] isSmooth: If true, internal macros are interpolated between two rows
+// [in] macro: Compiled MIDI Macro, see CompiledMIDIMacroConfig
+// [in] param: Parameter for parametric macros (Z00 - Z7F)
+// [in] plugin: Plugin to send MIDI message to (if not specified but needed, it is autodetected)
+void CSoundFile::ProcessMIDIMacro(CHANNELINDEX nChn, bool isSmooth, const CompiledMIDIMacro &macro, uint8 param, PLUGINDEX plugin)
+//--------------------------------------------------------------------------------------------------------------------------------
+{
+	unsigned char out[MACRO_LENGTH];
+	size_t outPos = EvaluateMIDIMacro(nChn, macro, param, out);
 
 	if(outPos == 0)
 	{
@@ -571,6 +571,7 @@ CTuningCollection* CSoundFile::s_pTuningsSharedLocal(0);
 CSoundFile::CSoundFile() :
 	m_pTuningsTuneSpecific(nullptr),
 	m_pModSpecs(&ModSpecs::itEx),
+	m_Resampler(false),
 	Patterns(*this),
 	Order(*this),
 #ifdef MODPLUG_TRACKER
@@ -583,9 +584,10 @@ CSoundFile::CSoundFile() :
 #endif
 //----------------------
 {
-	MemsetZero(MixSoundBuffer);
-	MemsetZero(MixRearBuffer);
-	MemsetZero(MixFloatBuffer);
+	m_MixBufferSize = 0;
+	m_nSkippedVoiceFrames = 0;
+	m_nVoiceSkipLevel = 0;
+	ResizeMixBuffers(m_MixerSettings.GetMixBufferSize());
 	gnDryLOfsVol = 0;
 	gnDryROfsVol = 0;
 	m_nType = MOD_TYPE_NONE;
@@ -600,8 +602,11 @@ CSoundFile::CSoundFile() :
 	m_nMinPeriod = MIN_PERIOD;
 	m_nMaxPeriod = 0x7FFF;
 	m_nRepeatCount = 0;
+	m_nSeekIndexInterval = 0;
+	m_nLoaderThreads = 0;
 	m_PlayState.m_nSeqOverride = ORDERINDEX_INVALID;
 	m_PlayState.m_bPatternTransitionOccurred = false;
+	m_PlayState.m_nVoiceSetStart = MAX_CHANNELS;
 	m_nTempoMode = tempo_mode_classic;
 	m_bIsRendering = false;
 
@@ -715,6 +720,107 @@ void CSoundFile::InitializeChannels()
 }
 
 
+// All module loaders, in the order in which they are tried if several of them accept a file with the same confidence.
+struct ModuleLoader
+{
+	CSoundFile::ProbeFunc probe;
+	CSoundFile::LoadFunc load;
+};
+
+static const ModuleLoader moduleLoaders[] =
+{
+	{ CSoundFile::ProbeFileHeaderXM, &CSoundFile::ReadXM },
+	{ CSoundFile::ProbeFileHeaderITP, &CSoundFile::ReadITProject },
+	{ CSoundFile::ProbeFileHeaderIT, &CSoundFile::ReadIT },
+	{ CSoundFile::ProbeFileHeaderS3M, &CSoundFile::ReadS3M },
+#ifdef MODPLUG_TRACKER
+	// this makes little sense for a module player library
+	{ CSoundFile::ProbeFileHeaderWAV, &CSoundFile::ReadWav },
+#endif // MODPLUG_TRACKER
+	{ CSoundFile::ProbeFileHeaderSTM, &CSoundFile::ReadSTM },
+	{ CSoundFile::ProbeFileHeaderMED, &CSoundFile::ReadMed },
+	{ CSoundFile::ProbeFileHeaderMTM, &CSoundFile::ReadMTM },
+	{ CSoundFile::ProbeFileHeaderMDL, &CSoundFile::ReadMDL },
+	{ CSoundFile::ProbeFileHeaderDBM, &CSoundFile::ReadDBM },
+	{ CSoundFile::ProbeFileHeader669, &CSoundFile::Read669 },
+	{ CSoundFile::ProbeFileHeaderFAR, &CSoundFile::ReadFAR },
+	{ CSoundFile::ProbeFileHeaderAMS, &CSoundFile::ReadAMS },
+	{ CSoundFile::ProbeFileHeaderAMS2, &CSoundFile::ReadAMS2 },
+	{ CSoundFile::ProbeFileHeaderOKT, &CSoundFile::ReadOKT },
+	{ CSoundFile::ProbeFileHeaderPTM, &CSoundFile::ReadPTM },
+	{ CSoundFile::ProbeFileHeaderULT, &CSoundFile::ReadUlt },
+	{ CSoundFile::ProbeFileHeaderDMF, &CSoundFile::ReadDMF },
+	{ CSoundFile::ProbeFileHeaderDSM, &CSoundFile::ReadDSM },
+	{ CSoundFile::ProbeFileHeaderUMX, &CSoundFile::ReadUMX },
+	{ CSoundFile::ProbeFileHeaderAMF_Asylum, &CSoundFile::ReadAMF_Asylum },
+	{ CSoundFile::ProbeFileHeaderAMF_DSMI, &CSoundFile::ReadAMF_DSMI },
+	{ CSoundFile::ProbeFileHeaderPSM, &CSoundFile::ReadPSM },
+	{ CSoundFile::ProbeFileHeaderPSM16, &CSoundFile::ReadPSM16 },
+	{ CSoundFile::ProbeFileHeaderMT2, &CSoundFile::ReadMT2 },
+#ifdef MODPLUG_TRACKER
+	{ CSoundFile::ProbeFileHeaderMID, &CSoundFile::ReadMID },
+#endif // MODPLUG_TRACKER
+	{ CSoundFile::ProbeFileHeaderGDM, &CSoundFile::ReadGDM },
+	{ CSoundFile::ProbeFileHeaderIMF, &CSoundFile::ReadIMF },
+	{ CSoundFile::ProbeFileHeaderDIGI, &CSoundFile::ReadDIGI },
+	{ CSoundFile::ProbeFileHeaderAM, &CSoundFile::ReadAM },
+	{ CSoundFile::ProbeFileHeaderJ2B, &CSoundFile::ReadJ2B },
+	{ CSoundFile::ProbeFileHeaderMO3, &CSoundFile::ReadMO3 },
+	{ CSoundFile::ProbeFileHeaderMOD, &CSoundFile::ReadMod },
+	{ CSoundFile::ProbeFileHeaderM15, &CSoundFile::ReadM15 },
+};
+
+
+// Unpack XPK / PP20 / MMCMP compressed modules. If the file was compressed, it is replaced by a reader for the unpacked data.
+static MODCONTAINERTYPE UnpackContainer(FileReader &file, std::vector<char> &unpackedData)
+//----------------------------------------------------------------------------------------
+{
+	MODCONTAINERTYPE packedContainerType = MOD_CONTAINERTYPE_NONE;
+	if(packedContainerType == MOD_CONTAINERTYPE_NONE && UnpackXPK(unpackedData, file)) packedContainerType = MOD_CONTAINERTYPE_XPK;
+	if(packedContainerType == MOD_CONTAINERTYPE_NONE && UnpackPP20(unpackedData, file)) packedContainerType = MOD_CONTAINERTYPE_PP20;
+	if(packedContainerType == MOD_CONTAINERTYPE_NONE && UnpackMMCMP(unpackedData, file)) packedContainerType = MOD_CONTAINERTYPE_MMCMP;
+	if(packedContainerType != MOD_CONTAINERTYPE_NONE)
+	{
+		file = FileReader(&(unpackedData[0]), unpackedData.size());
+	}
+	return packedContainerType;
+}
+
+
+CSoundFile::ProbeResult CSoundFile::Probe(FileReader file)
+//--------------------------------------------------------
+{
+	ProbeResult result;
+	if(!file.IsValid())
+	{
+		return result;
+	}
+
+#ifndef NO_ARCHIVE_SUPPORT
+	CUnarchiver unarchiver(file);
+	if(unarchiver.ExtractBestFile(GetSupportedExtensions(true)))
+	{
+		file = unarchiver.GetOutputFile();
+	}
+#endif
+
+	std::vector<char> unpackedData;
+	UnpackContainer(file, unpackedData);
+
+	// If no loader accepts the file, return the largest header size so that callers with incomplete data know how much more to read.
+	for(size_t i = 0; i < CountOf(moduleLoaders); i++)
+	{
+		const ProbeResult loaderResult = moduleLoaders[i].probe(file);
+		if(loaderResult.confidence > result.confidence
+			|| (result.confidence == ProbeFailure && loaderResult.confidence == ProbeFailure && loaderResult.requiredBytes > result.requiredBytes))
+		{
+			result = loaderResult;
+		}
+	}
+	return result;
+}
+
+
 #ifdef MODPLUG_TRACKER
 bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags, CModDoc *pModDoc)
 //-----------------------------------------------------------------------------------
@@ -762,62 +868,28 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 		}
 #endif
 
-		MODCONTAINERTYPE packedContainerType = MOD_CONTAINERTYPE_NONE;
 		std::vector<char> unpackedData;
-		if(packedContainerType == MOD_CONTAINERTYPE_NONE && UnpackXPK(unpackedData, file)) packedContainerType = MOD_CONTAINERTYPE_XPK;
-		if(packedContainerType == MOD_CONTAINERTYPE_NONE && UnpackPP20(unpackedData, file)) packedContainerType = MOD_CONTAINERTYPE_PP20;
-		if(packedContainerType == MOD_CONTAINERTYPE_NONE && UnpackMMCMP(unpackedData, file)) packedContainerType = MOD_CONTAINERTYPE_MMCMP;
-		if(packedContainerType != MOD_CONTAINERTYPE_NONE)
+		const MODCONTAINERTYPE packedContainerType = UnpackContainer(file, unpackedData);
+
+		// Run the header checks of all loaders first and only try to load the file with loaders that accept it.
+		// Loaders that found their signature are tried before loaders that only found a plausible header.
+		ProbeConfidence confidence[CountOf(moduleLoaders)];
+		for(size_t i = 0; i < CountOf(moduleLoaders); i++)
 		{
-			file = FileReader(&(unpackedData[0]), unpackedData.size());
+			confidence[i] = moduleLoaders[i].probe(file).confidence;
 		}
-
-		file.Rewind();
-		const uint8 *lpStream = reinterpret_cast<const unsigned char*>(file.GetRawData());
-		DWORD dwMemLength = file.GetLength();
-
-		if(!ReadXM(file, loadFlags)
-// -> CODE#0023
-// -> DESC="IT project files (.itp)"
-		 && !ReadITProject(file, loadFlags)
-// -! NEW_FEATURE#0023
-		 && !ReadIT(file, loadFlags)
-		 && !ReadS3M(file, loadFlags)
-#ifdef MODPLUG_TRACKER
-		// this makes little sense for a module player library
-		 && !ReadWav(file, loadFlags)
-#endif // MODPLUG_TRACKER
-		 && !ReadSTM(file, loadFlags)
-		 && !ReadMed(lpStream, dwMemLength, loadFlags)
-		 && !ReadMTM(file, loadFlags)
-		 && !ReadMDL(lpStream, dwMemLength, loadFlags)
-		 && !ReadDBM(file, loadFlags)
-		 && !Read669(file, loadFlags)
-		 && !ReadFAR(file, loadFlags)
-		 && !ReadAMS(file, loadFlags)
-		 && !ReadAMS2(file, loadFlags)
-		 && !ReadOKT(file, loadFlags)
-		 && !ReadPTM(file, loadFlags)
-		 && !ReadUlt(file, loadFlags)
-		 && !ReadDMF(file, loadFlags)
-		 && !ReadDSM(file, loadFlags)
-		 && !ReadUMX(file, loadFlags)
-		 && !ReadAMF_Asylum(file, loadFlags)
-		 && !ReadAMF_DSMI(file, loadFlags)
-		 && !ReadPSM(file, loadFlags)
-		 && !ReadPSM16(file, loadFlags)
-		 && !ReadMT2(file, loadFlags)
-#ifdef MODPLUG_TRACKER
-		 && !ReadMID(lpStream, dwMemLength, loadFlags)
-#endif // MODPLUG_TRACKER
-		 && !ReadGDM(file, loadFlags)
-		 && !ReadIMF(file, loadFlags)
-		 && !ReadDIGI(file, loadFlags)
-		 && !ReadAM(file, loadFlags)
-		 && !ReadJ2B(file, loadFlags)
-		 && !ReadMO3(file, loadFlags)
-		 && !ReadMod(file, loadFlags)
-		 && !ReadM15(file, loadFlags))
+		bool loaded = false;
+		for(int level = ProbeSuccess; level > ProbeFailure && !loaded; level--)
+		{
+			for(size_t i = 0; i < CountOf(moduleLoaders) && !loaded; i++)
+			{
+				if(confidence[i] == level)
+				{
+					loaded = (this->*moduleLoaders[i].load)(file, loadFlags);
+				}
+			}
+		}
+		if(!loaded)
 		{
 			m_nType = MOD_TYPE_NONE;
 			m_ContainerType = MOD_CONTAINERTYPE_NONE;
@@ -908,6 +980,9 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags)
 		UpgradeSong();
 	}
 
+	// Translate the MIDI macros once, so that they don't have to be parsed during playback.
+	m_MidiCfgCompiled.Compile(m_MidiCfg);
+
 	// plugin loader
 	std::string notFoundText;
 	std::vector<PLUGINDEX> notFoundIDs;
@@ -1004,6 +1079,7 @@ bool CSoundFile::Destroy()
 	}
 
 	Patterns.DestroyPatterns();
+	InvalidateSeekIndex();
 
 	songName.clear();
 	songArtist.clear();
@@ -1039,11 +1115,6 @@ bool CSoundFile::Destroy()
 void CSoundFile::SetDspEffects(DWORD DSPMask)
 //-------------------------------------------
 {
-#ifdef ENABLE_ASM
-#ifndef NO_REVERB
-	if(!(GetProcSupport() & PROCSUPPORT_MMX)) DSPMask &= ~SNDDSP_REVERB;
-#endif
-#endif
 	m_MixerSettings.DSPMask = DSPMask;
 	InitPlayer(false);
 }
@@ -2381,6 +2452,11 @@ void CSoundFile::UpgradeSong()
 		// Convert ANSI plugin path names to UTF-8 (irrelevant in probably 99% of all cases anyway, I think I've never seen a VST plugin with a non-ASCII file name)
 		for(PLUGINDEX i = 0; i < MAX_MIXPLUGINS; i++)
 		{
+			if(!m_MixPlugins[i].Info.szLibraryName[0])
+			{
+				// Nothing to convert, and the conversion is not exactly cheap.
+				continue;
+			}
 #if defined(MODPLUG_TRACKER)
 			const std::string name = mpt::ToCharset(mpt::CharsetUTF8, mpt::CharsetLocale, m_MixPlugins[i].Info.szLibraryName);
 #else
@@ -46,6 +46,9 @@
 #include "modcommand.h"
 #include "plugins/PlugInterface.h"
 #include "RowVisitor.h"
+#include "SeekIndex.h"
+#include "FilterCache.h"
+#include "PerfCounters.h"
 #include "Message.h"
 #include "pattern.h"
 #include "patternContainer.h"
@@ -56,6 +59,7 @@ OPENMPT_NAMESPACE_BEGIN
 
 
 class FileReader;
+class MixerThreads;
 // -----------------------------------------------------------------------------------------
 // MODULAR ModInstrument FIELD ACCESS : body content at the (near) top of Sndfile.cpp !!!
 // -----------------------------------------------------------------------------------------
@@ -237,7 +241,7 @@ struct TimingInfo
 class IAudioReadTarget
 {
 public:
-	virtual void DataCallback(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk) = 0;
+	virtual void DataCallback(mixsample_t *MixSoundBuffer, std::size_t channels, std::size_t countChunk) = 0;
 };
 
 
@@ -337,12 +341,21 @@ private: //Misc data
 
 private:
 	// Interleaved Front Mix Buffer (Also room for interleaved rear mix)
-	mixsample_t MixSoundBuffer[MIXBUFFERSIZE * 4];
-	mixsample_t MixRearBuffer[MIXBUFFERSIZE * 2];
+	// All mix buffers hold m_MixBufferSize frames, see MixerSettings::MixBufferSize.
+	AlignedMixBuffer<mixsample_t> MixSoundBuffer;
+	AlignedMixBuffer<mixsample_t> MixRearBuffer;
 	// Non-interleaved plugin processing buffer
-	float MixFloatBuffer[2][MIXBUFFERSIZE];
+	AlignedMixBuffer<float> MixFloatBuffer[2];
 	mixsample_t gnDryLOfsVol;
 	mixsample_t gnDryROfsVol;
+#ifndef MPT_INTMIXER
+	// Fixed point copies of the mix buffers for the DSP effects, which only work on fixed point data
+	AlignedMixBuffer<int32> MixIntBuffer;
+	AlignedMixBuffer<int32> MixIntRearBuffer;
+#endif // !MPT_INTMIXER
+	uint32 m_MixBufferSize;
+	// Worker threads for mixing voices in parallel (only present if MixerSettings::NumMixerThreads > 1)
+	MPT_SHARED_PTR<MixerThreads> m_MixerThreads;
 
 public:
 	MixerSettings m_MixerSettings;
@@ -382,6 +395,9 @@ public:
 	CHANNELINDEX m_nMixChannels;
 private:
 	CHANNELINDEX m_nMixStat;
+	uint64 m_nSkippedVoiceFrames;	// Number of voice frames that were not mixed because they were inaudible
+	uint32 m_nVoiceSkipLevel;		// Voices that are provably quieter than this (in fixed point mix scale) are not mixed, see MixerSettings::VoiceSkipThreshold
+	PerfCounters m_PerfCounters;
 public:
 	ROWINDEX m_nDefaultRowsPerBeat, m_nDefaultRowsPerMeasure;	// default rows per beat and measure for this module // rewbs.betterBPM
 	tempoMode m_nTempoMode;
@@ -409,6 +425,7 @@ protected:
 public:
 	ModInstrument *Instruments[MAX_INSTRUMENTS];		// Instrument Headers
 	MIDIMacroConfig m_MidiCfg;							// MIDI Macro config table
+	CompiledMIDIMacroConfig m_MidiCfgCompiled;			// Compiled version of m_MidiCfg that is evaluated during playback
 	SNDMIXPLUGIN m_MixPlugins[MAX_MIXPLUGINS];			// Mix plugins
 	char m_szNames[MAX_SAMPLES][MAX_SAMPLENAME];		// Song and sample names
 
@@ -424,6 +441,7 @@ public:
 	struct PlayState
 	{
 		friend class CSoundFile;
+		friend class GetLengthMemory;
 	protected:
 		samplecount_t m_nBufferCount;
 		double m_dBufferDiff;
@@ -463,6 +481,11 @@ public:
 		CHANNELINDEX ChnMix[MAX_CHANNELS];					// Channels to be mixed
 	public:
 		ModChannel Chn[MAX_CHANNELS];						// Mixing channels... First m_nChannel channels are master channels (i.e. they are never NNA channels)!
+		// Background channels that may be playing (nLength != 0), and background channels that may belong to each master channel (nMasterChn == index + 1).
+		// They may still contain channels that have stopped or were reused since, but never miss any channel that is in use. See AddBackgroundVoice().
+		ChannelSet m_PlayingVoices;
+		ChannelSet m_OwnedVoices[MAX_BASECHANNELS];
+		CHANNELINDEX m_nVoiceSetStart;	// Number of pattern channels the voice sets were last updated for
 
 	protected:
 		bool m_bPatternTransitionOccurred;
@@ -475,6 +498,12 @@ public:
 protected:
 	// For handling backwards jumps and stuff to prevent infinite loops when counting the mod length or rendering to wav.
 	RowVisitor visitedSongRows;
+	// Checkpoints recorded by GetLength() (without / with eAdjust), see SetSeekIndexInterval()
+	SeekIndex m_SeekIndex[2];
+	ROWINDEX m_nSeekIndexInterval;
+	uint32 m_nLoaderThreads;
+	// Resonant filter coefficients for the current mixing frequency, filled by SetupChannelFilter()
+	mutable FilterCache m_FilterCache;
 
 public:
 #ifdef MODPLUG_TRACKER
@@ -530,11 +559,34 @@ public:
 		loadPatternData		= 0x01,	// If unset, advise loaders to not process any pattern data (if possible)
 		loadSampleData		= 0x02,	// If unset, advise loaders to not process any sample data (if possible)
 		loadPluginData		= 0x04,	// If unset, plugins are not instanciated.
+		referenceSampleData	= 0x08,	// If set, loaders may reference sample data in the file instead of copying it. The file data must stay valid and unchanged until the module is destroyed.
+		loadMetadata		= 0x10,	// Header fields, song message and names. Loaders always read these, the flag only tells this apart from onlyVerifyHeader.
 		// Shortcuts
-		loadCompleteModule	= loadSampleData | loadPatternData | loadPluginData,
-		loadNoPatternOrPluginData	= loadSampleData,
+		loadCompleteModule	= loadMetadata | loadSampleData | loadPatternData | loadPluginData,
+		loadNoPatternOrPluginData	= loadMetadata | loadSampleData,
+		loadMetadataOnly	= loadMetadata,
 	};
 
+	// How sure a loader's header check is that a file is in its format
+	enum ProbeConfidence
+	{
+		ProbeFailure = 0,	// The file is definitely not in this format
+		ProbeWeak,			// The header is plausible, but the format has no (or only a very short) signature
+		ProbeSuccess,		// Signature and header fields match
+	};
+
+	// Result of a format probe. Probing never modifies the CSoundFile and only looks at the file header.
+	struct ProbeResult
+	{
+		ProbeConfidence confidence;
+		uint32 requiredBytes;	// Minimum number of bytes from the start of the file that the check looks at. Shorter files always fail.
+
+		ProbeResult(ProbeConfidence confidence_ = ProbeFailure, uint32 requiredBytes_ = 0) : confidence(confidence_), requiredBytes(requiredBytes_) { }
+	};
+
+	// Run the header checks of all loaders (after unpacking containers) and return the best match.
+	static ProbeResult Probe(FileReader file);
+
 #ifdef MODPLUG_TRACKER
 	// Get parent CModDoc. Can be nullptr if previewing from tree view, and is always nullptr if we're not actually compiling OpenMPT.
 	CModDoc *GetpModDoc() const { return m_pModDoc; }
@@ -544,6 +596,10 @@ public:
 	bool Create(FileReader file, ModLoadingFlags loadFlags);
 #endif // MODPLUG_TRACKER
 
+	// Number of threads used for decoding sample data in Create() (0 = one thread per CPU), see SampleReadQueue.
+	void SetLoaderThreads(uint32 threads) { m_nLoaderThreads = threads; }
+	uint32 GetLoaderThreads() const { return m_nLoaderThreads; }
+
 	bool Destroy();
 	MODTYPE GetType() const { return m_nType; }
 	bool TypeIsIT_MPT() const { return (m_nType & (MOD_TYPE_IT | MOD_TYPE_MPT)) != 0; }
@@ -582,6 +638,9 @@ public:
 	void DontLoopPattern(PATTERNINDEX nPat, ROWINDEX nRow = 0);		//rewbs.playSongFromCursor
 	CHANNELINDEX GetMixStat() const { return m_nMixStat; }
 	void ResetMixStat() { m_nMixStat = 0; }
+	uint64 GetSkippedVoiceFrames() const { return m_nSkippedVoiceFrames; }
+	const PerfCounters &GetPerfCounters() const { return m_PerfCounters; }
+	void ResetPerfCounters() { m_PerfCounters.Reset(); }
 	void SetCurrentPos(UINT nPos);
 	void SetCurrentOrder(ORDERINDEX nOrder);
 	std::string GetTitle() const { return songName; }
@@ -598,6 +657,15 @@ public:
 
 	void InitializeVisitedRows() { visitedSongRows.Initialize(true); }
 
+	// Let GetLength() record a checkpoint every n rows, so that subsequent seeks don't have to start from the beginning of the song.
+	// 0 disables the seek index. The index must not be enabled if the song is being edited.
+	void SetSeekIndexInterval(ROWINDEX rows);
+	ROWINDEX GetSeekIndexInterval() const { return m_nSeekIndexInterval; }
+	// Throw away all recorded checkpoints, e.g. after the song has been modified.
+	void InvalidateSeekIndex();
+	// Returns the amount of memory used by the seek index in bytes.
+	size_t GetSeekIndexMemoryUsage() const;
+
 public:
 	//Returns song length in seconds.
 	double GetSongTime() { return GetLength(eNoAdjust).duration; }
@@ -619,11 +687,49 @@ public:
 	void InitializeChannels();
 
 	// Module Loaders
+	typedef ProbeResult (*ProbeFunc)(FileReader file);
+	typedef bool (CSoundFile::*LoadFunc)(FileReader &file, ModLoadingFlags loadFlags);
+
+	static ProbeResult ProbeFileHeaderXM(FileReader file);
+	static ProbeResult ProbeFileHeaderS3M(FileReader file);
+	static ProbeResult ProbeFileHeaderMOD(FileReader file);
+	static ProbeResult ProbeFileHeaderM15(FileReader file);
+	static ProbeResult ProbeFileHeaderMED(FileReader file);
+	static ProbeResult ProbeFileHeaderMTM(FileReader file);
+	static ProbeResult ProbeFileHeaderSTM(FileReader file);
+	static ProbeResult ProbeFileHeaderIT(FileReader file);
+	static ProbeResult ProbeFileHeaderITP(FileReader file);
+	static ProbeResult ProbeFileHeader669(FileReader file);
+	static ProbeResult ProbeFileHeaderULT(FileReader file);
+	static ProbeResult ProbeFileHeaderWAV(FileReader file);
+	static ProbeResult ProbeFileHeaderDSM(FileReader file);
+	static ProbeResult ProbeFileHeaderFAR(FileReader file);
+	static ProbeResult ProbeFileHeaderAMS(FileReader file);
+	static ProbeResult ProbeFileHeaderAMS2(FileReader file);
+	static ProbeResult ProbeFileHeaderMDL(FileReader file);
+	static ProbeResult ProbeFileHeaderOKT(FileReader file);
+	static ProbeResult ProbeFileHeaderDMF(FileReader file);
+	static ProbeResult ProbeFileHeaderPTM(FileReader file);
+	static ProbeResult ProbeFileHeaderDBM(FileReader file);
+	static ProbeResult ProbeFileHeaderAMF_Asylum(FileReader file);
+	static ProbeResult ProbeFileHeaderAMF_DSMI(FileReader file);
+	static ProbeResult ProbeFileHeaderMT2(FileReader file);
+	static ProbeResult ProbeFileHeaderPSM(FileReader file);
+	static ProbeResult ProbeFileHeaderPSM16(FileReader file);
+	static ProbeResult ProbeFileHeaderUMX(FileReader file);
+	static ProbeResult ProbeFileHeaderMO3(FileReader file);
+	static ProbeResult ProbeFileHeaderGDM(FileReader file);
+	static ProbeResult ProbeFileHeaderIMF(FileReader file);
+	static ProbeResult ProbeFileHeaderAM(FileReader file);
+	static ProbeResult ProbeFileHeaderJ2B(FileReader file);
+	static ProbeResult ProbeFileHeaderDIGI(FileReader file);
+	static ProbeResult ProbeFileHeaderMID(FileReader file);
+
 	bool ReadXM(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadS3M(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadMod(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadM15(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
-	bool ReadMed(const uint8 *lpStream, const DWORD dwMemLength, ModLoadingFlags loadFlags = loadCompleteModule);
+	bool ReadMed(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadMTM(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadSTM(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadIT(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
@@ -635,7 +741,7 @@ public:
 	bool ReadFAR(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadAMS(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadAMS2(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
-	bool ReadMDL(const uint8 *lpStream, const DWORD dwMemLength, ModLoadingFlags loadFlags = loadCompleteModule);
+	bool ReadMDL(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadOKT(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadDMF(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadPTM(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
@@ -652,7 +758,7 @@ public:
 	bool ReadAM(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadJ2B(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 	bool ReadDIGI(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
-	bool ReadMID(const uint8 *lpStream, DWORD dwMemLength, ModLoadingFlags loadFlags = loadCompleteModule);
+	bool ReadMID(FileReader &file, ModLoadingFlags loadFlags = loadCompleteModule);
 
 	static std::vector<const char *> GetSupportedExtensions(bool otherFormats);
 	static mpt::Charset GetCharsetFromModType(MODTYPE modtype);
@@ -707,9 +813,12 @@ public:
 	samplecount_t Read(samplecount_t count, IAudioReadTarget &target);
 private:
 	void CreateStereoMix(int count);
+	bool MixVoice(ModChannel &chn, mixsample_t *pbuffer, int count, mixsample_t &ofsR, mixsample_t &ofsL, uint64 &skippedFrames, bool skipMixing);
+	static void MixVoicesParallel(void *param, uint32 worker);
 public:
 	bool FadeSong(UINT msec);
 private:
+	void ResizeMixBuffers(uint32 frames);
 	void ProcessDSP(std::size_t countChunk);
 	void ProcessPlugins(UINT nCount);
 public:
@@ -735,6 +844,11 @@ public:
 	bool ProcessEffects();
 	CHANNELINDEX GetNNAChannel(CHANNELINDEX nChn) const;
 	void CheckNNA(CHANNELINDEX nChn, UINT instr, int note, bool forceCut);
+	// Any code that starts playing a note on a background channel (>= m_nChannels) has to register it here.
+	// If the channel is going to belong to a master channel, this has to be called before its nMasterChn is changed.
+	void AddBackgroundVoice(CHANNELINDEX nChn, CHANNELINDEX nMasterChn = CHANNELINDEX_INVALID);
+	// Update the voice sets if the number of pattern channels has changed.
+	void UpdateBackgroundVoices();
 	void NoteChange(ModChannel *pChn, int note, bool bPorta = false, bool bResetEnv = true, bool bManual = false) const;
 	void InstrumentChange(ModChannel *pChn, UINT instr, bool bPorta = false, bool bUpdVol = true, bool bResetEnv = true) const;
 
@@ -772,7 +886,7 @@ protected:
 
 	void ProcessRamping(ModChannel *pChn) const;
 
-	uint32 GetChannelIncrement(ModChannel *pChn, uint32 period, int periodFrac) const;
+	uint64 GetChannelIncrement(ModChannel *pChn, uint32 period, int periodFrac) const;
 
 protected:
 	// Channel Effects
@@ -806,11 +920,10 @@ protected:
 	void InvertLoop(ModChannel* pChn);
 
 	void ProcessMacroOnChannel(CHANNELINDEX nChn);
-	void ProcessMIDIMacro(CHANNELINDEX nChn, bool isSmooth, char *macro, uint8 param = 0, PLUGINDEX plugin = 0);
+	void ProcessMIDIMacro(CHANNELINDEX nChn, bool isSmooth, const CompiledMIDIMacro &macro, uint8 param = 0, PLUGINDEX plugin = 0);
 	float CalculateSmoothParamChange(float currentValue, float param) const;
 	size_t SendMIDIData(CHANNELINDEX nChn, bool isSmooth, const unsigned char *macro, size_t macroLen, PLUGINDEX plugin);
 
-	void SetupChannelFilter(ModChannel *pChn, bool bReset, int flt_modifier = 256) const;
 	// Low-Level effect processing
 	void DoFreqSlide(ModChannel *pChn, LONG nFreqSlide) const;
 	void GlobalVolSlide(UINT param, UINT &nOldGlobalVolSlide);
@@ -891,7 +1004,7 @@ public:
 #ifdef MODPLUG_TRACKER
 	void ProcessMidiOut(CHANNELINDEX nChn);
 #endif // MODPLUG_TRACKER
-	void ApplyGlobalVolume(int *SoundBuffer, int *RearBuffer, long countChunk);
+	void ApplyGlobalVolume(mixsample_t *SoundBuffer, mixsample_t *RearBuffer, long countChunk);
 
 private:
 	PLUGINDEX GetChannelPlugin(CHANNELINDEX nChn, PluginMutePriority respectMutes) const;
@@ -903,6 +1016,9 @@ private:
 public:
 	PLUGINDEX GetBestPlugin(CHANNELINDEX nChn, PluginPriority priority, PluginMutePriority respectMutes) const;
 	uint8 GetBestMidiChannel(CHANNELINDEX nChn) const;
+	size_t EvaluateMIDIMacro(CHANNELINDEX nChn, const CompiledMIDIMacro &macro, uint8 param, unsigned char (&out)[MACRO_LENGTH]) const;
+	void SetupChannelFilter(ModChannel *pChn, bool bReset, int flt_modifier = 256) const;
+	void CalculateFilterCoefficients(bool itFilter, int cutoff, int computedCutoff, int resonance, int flt_modifier, FilterCache::Coefficients &coeffs) const;
 
 };
 
@@ -16,9 +16,21 @@
 #include "MIDIEvents.h"
 #include "tuning.h"
 #include "Tables.h"
+#include "MixerThreads.h"
 #ifdef MODPLUG_TRACKER
 #include "../mptrack/TrackerSettings.h"
 #endif
+#ifndef NO_PERFCOUNTERS
+#if MPT_COMPILER_MSVC && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#elif (MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#elif MPT_OS_WINDOWS
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif // NO_PERFCOUNTERS
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -51,6 +63,55 @@ static const UINT PreAmpAGCTable[16] =
 };
 #endif
 
+
+#ifndef NO_PERFCOUNTERS
+
+// Time stamp for the performance counters: CPU cycles on x86 / amd64, nanoseconds elsewhere.
+static forceinline uint64 GetPerfTimestamp()
+//------------------------------------------
+{
+#if (MPT_COMPILER_MSVC && (defined(_M_IX86) || defined(_M_X64))) || ((MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && (defined(__i386__) || defined(__x86_64__)))
+	return __rdtsc();
+#elif MPT_OS_WINDOWS
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	const uint64 ticks = counter.QuadPart, ticksPerSecond = frequency.QuadPart;
+	return ticks / ticksPerSecond * 1000000000 + ticks % ticksPerSecond * 1000000000 / ticksPerSecond;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64>(ts.tv_sec) * 1000000000 + static_cast<uint64>(ts.tv_nsec);
+#endif
+}
+
+#endif // NO_PERFCOUNTERS
+
+
+// Adds the time spent in the current scope to one stage of the performance counters.
+//=============
+class PerfScope
+//=============
+{
+#ifndef NO_PERFCOUNTERS
+protected:
+	PerfCounters::Counter &m_counter;
+	const uint64 m_start;
+
+public:
+	PerfScope(PerfCounters &counters, PerfCounters::Stage stage) : m_counter(counters.stages[stage]), m_start(GetPerfTimestamp()) { }
+	~PerfScope()
+	{
+		m_counter.cycles += GetPerfTimestamp() - m_start;
+		m_counter.calls++;
+	}
+#else
+public:
+	PerfScope(PerfCounters &, PerfCounters::Stage) { }
+#endif // NO_PERFCOUNTERS
+};
+
+
 typedef CTuning::RATIOTYPE RATIOTYPE;
 
 static const RATIOTYPE TwoToPowerXOver12Table[16] =
@@ -80,11 +141,29 @@ void CSoundFile::SetMixerSettings(const MixerSettings &mixersettings)
 		||
 		(mixersettings.MixerFlags != m_MixerSettings.MixerFlags))
 		reset = true;
+	if(mixersettings.gdwMixingFreq != m_MixerSettings.gdwMixingFreq)
+		m_FilterCache.Clear();
 	m_MixerSettings = mixersettings;
 	InitPlayer(reset);
 }
 
 
+// (Re)allocate all mix buffers for mixing the given number of frames at once.
+void CSoundFile::ResizeMixBuffers(uint32 frames)
+//----------------------------------------------
+{
+	m_MixBufferSize = frames;
+	MixSoundBuffer.Resize(frames * 4);
+	MixRearBuffer.Resize(frames * 2);
+	MixFloatBuffer[0].Resize(frames);
+	MixFloatBuffer[1].Resize(frames);
+#ifndef MPT_INTMIXER
+	MixIntBuffer.Resize(frames * 4);
+	MixIntRearBuffer.Resize(frames * 2);
+#endif // !MPT_INTMIXER
+}
+
+
 void CSoundFile::SetResamplerSettings(const CResamplerSettings &resamplersettings)
 //--------------------------------------------------------------------------------
 {
@@ -103,14 +182,32 @@ void CSoundFile::InitPlayer(bool bReset)
 		gnDryROfsVol = 0;
 	}
 	m_Resampler.InitializeTables();
+	if(m_MixerSettings.GetMixBufferSize() != m_MixBufferSize)
+	{
+		ResizeMixBuffers(m_MixerSettings.GetMixBufferSize());
+	}
+	m_nVoiceSkipLevel = 0;
+	if(m_MixerSettings.VoiceSkipThreshold < 0)
+	{
+		m_nVoiceSkipLevel = Util::Round<uint32>(MIXING_SCALEF * std::pow(10.0f, m_MixerSettings.VoiceSkipThreshold / 20.0f));
+	}
+	if(m_MixerSettings.NumMixerThreads <= 1)
+	{
+		m_MixerThreads = MPT_SHARED_PTR<MixerThreads>();
+	} else if(!m_MixerThreads || m_MixerThreads->GetNumThreads() != std::min<uint32>(m_MixerSettings.NumMixerThreads, MixerThreads::maxThreads) || m_MixerThreads->GetBufferSize() != m_MixBufferSize)
+	{
+		// Stop the old threads before starting new ones
+		m_MixerThreads = MPT_SHARED_PTR<MixerThreads>();
+		m_MixerThreads = MPT_SHARED_PTR<MixerThreads>(new MixerThreads(m_MixerSettings.NumMixerThreads, m_MixBufferSize));
+	}
 #ifndef NO_REVERB
-	m_Reverb.Initialize(bReset, m_MixerSettings.gdwMixingFreq);
+	m_Reverb.Initialize(bReset, m_MixerSettings.gdwMixingFreq, !(m_MixerSettings.MixerFlags & SNDMIX_NOSIMD), m_MixBufferSize);
 #endif
 #ifndef NO_DSP
-	m_DSP.Initialize(bReset, m_MixerSettings.gdwMixingFreq, m_MixerSettings.DSPMask);
+	m_DSP.Initialize(bReset, m_MixerSettings.gdwMixingFreq, m_MixerSettings.DSPMask, !(m_MixerSettings.MixerFlags & SNDMIX_NOSIMD));
 #endif
 #ifndef NO_EQ
-	m_EQ.Initialize(bReset, m_MixerSettings.gdwMixingFreq);
+	m_EQ.Initialize(bReset, m_MixerSettings.gdwMixingFreq, !(m_MixerSettings.MixerFlags & SNDMIX_NOSIMD));
 #endif
 #ifndef NO_AGC
 	m_AGC.Initialize(bReset, m_MixerSettings.gdwMixingFreq);
@@ -148,6 +245,9 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 {
 	ALWAYS_ASSERT(m_MixerSettings.IsValid());
 
+	// Resampler tables are not created when constructing the CSoundFile, as they are not needed for loading.
+	m_Resampler.InitializeTables();
+
 	bool mixPlugins = false;
 	for(PLUGINDEX i = 0; i < MAX_MIXPLUGINS; ++i)
 	{
@@ -219,43 +319,63 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 		ASSERT(m_PlayState.m_nBufferCount > 0); // assert that we have actually something to do
 
-		const samplecount_t countChunk = std::min<samplecount_t>(MIXBUFFERSIZE, std::min<samplecount_t>(m_PlayState.m_nBufferCount, countToRender));
+		// Mix up to m_MixBufferSize frames at once, but never more than what is left of the current tick or the requested output.
+		// Plugins are set up for a block size of MIXBUFFERSIZE, so chunks are capped to that while plugins are active.
+		const samplecount_t maxChunk = mixPlugins ? std::min<samplecount_t>(MIXBUFFERSIZE, m_MixBufferSize) : m_MixBufferSize;
+		const samplecount_t countChunk = std::min<samplecount_t>(maxChunk, std::min<samplecount_t>(m_PlayState.m_nBufferCount, countToRender));
 
-		CreateStereoMix(countChunk);
+		{
+			PerfScope perfScope(m_PerfCounters, PerfCounters::stageMix);
+			CreateStereoMix(countChunk);
+		}
 
 		#ifndef NO_REVERB
+		{
+			PerfScope perfScope(m_PerfCounters, PerfCounters::stageReverb);
 			m_Reverb.Process(MixSoundBuffer, countChunk);
+		}
 		#endif // NO_REVERB
 
 		if(mixPlugins)
 		{
+			PerfScope perfScope(m_PerfCounters, PerfCounters::stagePlugins);
 			ProcessPlugins(countChunk);
 		}
 
-		if(m_MixerSettings.gnChannels == 1)
 		{
-			MonoFromStereo(MixSoundBuffer, countChunk);
-		}
+			PerfScope perfScope(m_PerfCounters, PerfCounters::stageDSP);
 
-		if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
-		{
-			ApplyGlobalVolume(MixSoundBuffer, MixRearBuffer, countChunk);
-		}
+			if(m_MixerSettings.gnChannels == 1)
+			{
+				MonoFromStereo(MixSoundBuffer, countChunk);
+			}
 
-		if(m_MixerSettings.DSPMask)
-		{
-			ProcessDSP(countChunk);
+			if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
+			{
+				ApplyGlobalVolume(MixSoundBuffer, MixRearBuffer, countChunk);
+			}
+
+			if(m_MixerSettings.DSPMask)
+			{
+				ProcessDSP(countChunk);
+			}
+
+			if(m_MixerSettings.gnChannels == 4)
+			{
+				InterleaveFrontRear(MixSoundBuffer, MixRearBuffer, countChunk);
+			}
 		}
 
-		if(m_MixerSettings.gnChannels == 4)
 		{
-			InterleaveFrontRear(MixSoundBuffer, MixRearBuffer, countChunk);
+			PerfScope perfScope(m_PerfCounters, PerfCounters::stageOutput);
+			target.DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
 		}
 
-		target.DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
-
 		// Buffer ready
 		countRendered += countChunk;
+#ifndef NO_PERFCOUNTERS
+		m_PerfCounters.framesRendered += countChunk;
+#endif // NO_PERFCOUNTERS
 		countToRender -= countChunk;
 		m_PlayState.m_nBufferCount -= countChunk;
 		m_PlayState.m_lTotalSampleCount += countChunk;		// increase sample count for VSTTimeInfo.
@@ -287,28 +407,49 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 void CSoundFile::ProcessDSP(std::size_t countChunk)
 //-------------------------------------------------
 {
+	#ifdef MPT_INTMIXER
+		int32 *soundBuffer = MixSoundBuffer;
+		int32 *rearBuffer = MixRearBuffer;
+	#else
+		// The DSP effects only work on fixed point data
+		const uint32 frontSamples = static_cast<uint32>(countChunk) * std::min<uint32>(m_MixerSettings.gnChannels, 2);
+		const uint32 rearSamples = (m_MixerSettings.gnChannels > 2) ? static_cast<uint32>(countChunk) * 2 : 0;
+		int32 *soundBuffer = MixIntBuffer;
+		int32 *rearBuffer = MixIntRearBuffer;
+		FloatToMonoMix(MixSoundBuffer, soundBuffer, frontSamples, MIXING_SCALEF);
+		if(rearSamples) FloatToMonoMix(MixRearBuffer, rearBuffer, rearSamples, MIXING_SCALEF);
+	#endif // MPT_INTMIXER
+
 	#ifndef NO_DSP
 		if(m_MixerSettings.DSPMask & (SNDDSP_SURROUND|SNDDSP_MEGABASS))
 		{
-			m_DSP.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels, m_MixerSettings.DSPMask);
+			m_DSP.Process(soundBuffer, rearBuffer, countChunk, m_MixerSettings.gnChannels, m_MixerSettings.DSPMask);
 		}
 	#endif // NO_DSP
 
 	#ifndef NO_EQ
 		if(m_MixerSettings.DSPMask & SNDDSP_EQ)
 		{
-			m_EQ.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_EQ.Process(soundBuffer, rearBuffer, countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_EQ
 
 	#ifndef NO_AGC
 		if(m_MixerSettings.DSPMask & SNDDSP_AGC)
 		{
-			m_AGC.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_AGC.Process(soundBuffer, rearBuffer, countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_AGC
+
+	#ifndef MPT_INTMIXER
+		MonoMixToFloat(soundBuffer, MixSoundBuffer, frontSamples, 1.0f / MIXING_SCALEF);
+		if(rearSamples) MonoMixToFloat(rearBuffer, MixRearBuffer, rearSamples, 1.0f / MIXING_SCALEF);
+	#endif // !MPT_INTMIXER
+
 	#if defined(NO_DSP) && defined(NO_EQ) && defined(NO_AGC)
 		MPT_UNREFERENCED_PARAMETER(countChunk);
+		MPT_UNREFERENCED_PARAMETER(soundBuffer);
+		MPT_UNREFERENCED_PARAMETER(rearBuffer);
 	#endif
 }
 
@@ -1637,7 +1778,7 @@ void CSoundFile::ProcessRamping(ModChannel *pChn) const
 }
 
 
-uint32 CSoundFile::GetChannelIncrement(ModChannel *pChn, uint32 period, int periodFrac) const
+uint64 CSoundFile::GetChannelIncrement(ModChannel *pChn, uint32 period, int periodFrac) const
 //-------------------------------------------------------------------------------------------
 {
 	uint32 freq;
@@ -1665,7 +1806,9 @@ uint32 CSoundFile::GetChannelIncrement(ModChannel *pChn, uint32 period, int peri
 		pChn->nCalcVolume = 0;
 	}
 
-	return Util::muldivr(freq, 0x10000, m_MixerSettings.gdwMixingFreq << FREQ_FRACBITS);
+	// 32.32 fixed point increment, rounded
+	const uint64 divisor = static_cast<uint64>(m_MixerSettings.gdwMixingFreq) << FREQ_FRACBITS;
+	return ((static_cast<uint64>(freq) << SAMPLEPOS_FRACBITS) + divisor / 2) / divisor;
 }
 
 
@@ -1675,6 +1818,8 @@ uint32 CSoundFile::GetChannelIncrement(ModChannel *pChn, uint32 period, int peri
 bool CSoundFile::ReadNote()
 //-------------------------
 {
+	PerfScope perfScope(m_PerfCounters, PerfCounters::stageReadNote);
+
 #ifdef MODPLUG_TRACKER
 	// Checking end of row ?
 	if(m_SongFlags[SONG_PAUSED])
@@ -1733,10 +1878,15 @@ bool CSoundFile::ReadNote()
 
 	////////////////////////////////////////////////////////////////////////////////////
 	// Update channels data
+	// Background channels that are not in the set of playing voices are known to be silent and are skipped.
 	m_nMixChannels = 0;
-	ModChannel *pChn = m_PlayState.Chn;
-	for (CHANNELINDEX nChn = 0; nChn < MAX_CHANNELS; nChn++, pChn++)
+	UpdateBackgroundVoices();
+	ChannelSet updateChannels = m_PlayState.m_PlayingVoices;
+	updateChannels.SetRange(0, m_nChannels);
+	for (ChannelSet::Iterator it(updateChannels); it.IsValid(); it.Next())
 	{
+		const CHANNELINDEX nChn = it.GetChannel();
+		ModChannel *pChn = &m_PlayState.Chn[nChn];
 		// FT2 Compatibility: Prevent notes to be stopped after a fadeout. This way, a portamento effect can pick up a faded instrument which is long enough.
 		// This occours for example in the bassline (channel 11) of jt_burn.xm. I hope this won't break anything else...
 		// I also suppose this could decrease mixing performance a bit, but hey, which CPU can't handle 32 muted channels these days... :-)
@@ -1752,6 +1902,9 @@ bool CSoundFile::ReadNote()
 			{
 				// Process MIDI macros on channels that are currently muted.
 				ProcessMacroOnChannel(nChn);
+			} else if(!pChn->nLength)
+			{
+				m_PlayState.m_PlayingVoices.Reset(nChn);
 			}
 			pChn->nLeftVU = pChn->nRightVU = 0;
 			continue;
@@ -1936,9 +2089,9 @@ bool CSoundFile::ReadNote()
 			}
 
 
-			uint32 ninc = GetChannelIncrement(pChn, period, nPeriodFrac);
+			uint64 ninc = GetChannelIncrement(pChn, period, nPeriodFrac);
 #ifndef MODPLUG_TRACKER
-			ninc = Util::muldivr(ninc, m_nFreqFactor, 128);
+			ninc = (ninc * m_nFreqFactor + 64) / 128;
 #endif // !MODPLUG_TRACKER
 			if(ninc == 0)
 			{
@@ -2047,7 +2200,7 @@ bool CSoundFile::ReadNote()
 			//if (pChn->nNewRightVol > 0xFFFF) pChn->nNewRightVol = 0xFFFF;
 			//if (pChn->nNewLeftVol > 0xFFFF) pChn->nNewLeftVol = 0xFFFF;
 
-			if(pChn->nInc == 0x10000)
+			if(pChn->nInc == SAMPLEPOS_ONE)
 			{
 				// exact samplerate match, do not resample at all, regardless of selected resampler
 				pChn->resamplingMode = SRCMODE_NEAREST;
@@ -2126,9 +2279,9 @@ void CSoundFile::ProcessMacroOnChannel(CHANNELINDEX nChn)
 		if((pChn->rowCommand.command == CMD_MIDI && m_SongFlags[SONG_FIRSTTICK]) || pChn->rowCommand.command == CMD_SMOOTHMIDI)
 		{
 			if(pChn->rowCommand.param < 0x80)
-				ProcessMIDIMacro(nChn, (pChn->rowCommand.command == CMD_SMOOTHMIDI), m_MidiCfg.szMidiSFXExt[pChn->nActiveMacro], pChn->rowCommand.param);
+				ProcessMIDIMacro(nChn, (pChn->rowCommand.command == CMD_SMOOTHMIDI), m_MidiCfgCompiled.GetParameteredMacro(m_MidiCfg, pChn->nActiveMacro), pChn->rowCommand.param);
 			else
-				ProcessMIDIMacro(nChn, (pChn->rowCommand.command == CMD_SMOOTHMIDI), m_MidiCfg.szMidiZXXExt[(pChn->rowCommand.param & 0x7F)], 0);
+				ProcessMIDIMacro(nChn, (pChn->rowCommand.command == CMD_SMOOTHMIDI), m_MidiCfgCompiled.GetFixedMacro(m_MidiCfg, (pChn->rowCommand.param & 0x7F)), 0);
 		}
 	}
 }
@@ -2237,8 +2390,19 @@ void CSoundFile::ProcessMidiOut(CHANNELINDEX nChn)
 #endif // MODPLUG_TRACKER
 
 
+static forceinline int32 ScaleByGlobalVolume(int32 sample, int32 volume, int32 maxVolume)
+{
+	return Util::muldiv(sample, volume, maxVolume);
+}
+
+static forceinline float ScaleByGlobalVolume(float sample, int32 volume, int32 maxVolume)
+{
+	return sample * (static_cast<float>(volume) / static_cast<float>(maxVolume));
+}
+
+
 template<int channels>
-forceinline void ApplyGlobalVolumeWithRamping(int *SoundBuffer, int *RearBuffer, int32 lCount, int32 m_nGlobalVolume, int32 step, int32 &m_nSamplesToGlobalVolRampDest, int32 &m_lHighResRampingGlobalVolume)
+forceinline void ApplyGlobalVolumeWithRamping(mixsample_t *SoundBuffer, mixsample_t *RearBuffer, int32 lCount, int32 m_nGlobalVolume, int32 step, int32 &m_nSamplesToGlobalVolRampDest, int32 &m_lHighResRampingGlobalVolume)
 {
 	const bool isStereo = (channels >= 2);
 	const bool hasRear = (channels >= 4);
@@ -2248,17 +2412,17 @@ forceinline void ApplyGlobalVolumeWithRamping(int *SoundBuffer, int *RearBuffer,
 		{
 			// Ramping required
 			m_lHighResRampingGlobalVolume += step;
-			             SoundBuffer[0] = Util::muldiv(SoundBuffer[0], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
-			if(isStereo) SoundBuffer[1] = Util::muldiv(SoundBuffer[1], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
-			if(hasRear)  RearBuffer[0]  = Util::muldiv(RearBuffer[0] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
-			if(hasRear)  RearBuffer[1]  = Util::muldiv(RearBuffer[1] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			             SoundBuffer[0] = ScaleByGlobalVolume(SoundBuffer[0], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			if(isStereo) SoundBuffer[1] = ScaleByGlobalVolume(SoundBuffer[1], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			if(hasRear)  RearBuffer[0]  = ScaleByGlobalVolume(RearBuffer[0] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			if(hasRear)  RearBuffer[1]  = ScaleByGlobalVolume(RearBuffer[1] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
 			m_nSamplesToGlobalVolRampDest--;
 		} else
 		{
-			             SoundBuffer[0] = Util::muldiv(SoundBuffer[0], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
-			if(isStereo) SoundBuffer[1] = Util::muldiv(SoundBuffer[1], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
-			if(hasRear)  RearBuffer[0]  = Util::muldiv(RearBuffer[0] , m_nGlobalVolume, MAX_GLOBAL_VOLUME);
-			if(hasRear)  RearBuffer[1]  = Util::muldiv(RearBuffer[1] , m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			             SoundBuffer[0] = ScaleByGlobalVolume(SoundBuffer[0], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			if(isStereo) SoundBuffer[1] = ScaleByGlobalVolume(SoundBuffer[1], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			if(hasRear)  RearBuffer[0]  = ScaleByGlobalVolume(RearBuffer[0] , m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			if(hasRear)  RearBuffer[1]  = ScaleByGlobalVolume(RearBuffer[1] , m_nGlobalVolume, MAX_GLOBAL_VOLUME);
 			m_lHighResRampingGlobalVolume = m_nGlobalVolume << VOLUMERAMPPRECISION;
 		}
 		SoundBuffer += isStereo ? 2 : 1;
@@ -2267,8 +2431,8 @@ forceinline void ApplyGlobalVolumeWithRamping(int *SoundBuffer, int *RearBuffer,
 }
 
 
-void CSoundFile::ApplyGlobalVolume(int *SoundBuffer, int *RearBuffer, long lCount)
-//--------------------------------------------------------------------------------
+void CSoundFile::ApplyGlobalVolume(mixsample_t *SoundBuffer, mixsample_t *RearBuffer, long lCount)
+//------------------------------------------------------------------------------------------------
 {
 
 	// should we ramp?
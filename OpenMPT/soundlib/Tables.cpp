@@ -16,6 +16,8 @@
 
 #include "Resampler.h"
 #include "WindowedFIR.h"
+#include "../common/mutex.h"
+#include <vector>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -906,56 +908,84 @@ static void getdownsample2x(short int *psinc)
 #endif
 
 
-#ifdef MODPLUG_TRACKER
-bool CResampler::StaticTablesInitialized = false;
-SINC_TYPE CResampler::gDownsample13x[SINC_PHASES*8];	// Downsample 1.333x
-SINC_TYPE CResampler::gDownsample2x[SINC_PHASES*8];		// Downsample 2x
+CResamplerTables::CResamplerTables(const CResamplerSettings &settings)
+//--------------------------------------------------------------------
+	: m_Settings(settings)
+{
+	//ericus' downsampling improvement.
+	//getsinc(gDownsample13x, 8.5, 3.0/4.0);
+	//getdownsample2x(gDownsample2x);
+	getsinc(gDownsample13x, 8.5, 0.5);
+	getsinc(gDownsample2x, 2.7625, 0.425);
+	//end ericus' downsampling improvement.
+
 #ifndef MPT_INTMIXER
-mixsample_t CResampler::FastSincTablef[256 * 4];		// Cubic spline LUT
-mixsample_t CResampler::LinearTablef[256];				// Linear interpolation LUT
+	// Prepare fast sinc coefficients for floating point mixer
+	for(size_t i = 0; i < CountOf(FastSincTablef); i++)
+	{
+		FastSincTablef[i] = static_cast<mixsample_t>(CResampler::FastSincTable[i] * mixsample_t(1.0f / 16384.0f));
+	}
+
+	// Prepare linear interpolation coefficients for floating point mixer
+	for(size_t i = 0; i < CountOf(LinearTablef); i++)
+	{
+		LinearTablef[i] = static_cast<mixsample_t>(i * mixsample_t(1.0f / CountOf(LinearTablef)));
+	}
 #endif // !defined(MPT_INTMIXER)
-#endif // MODPLUG_TRACKER
+
+	m_WindowedFIR.InitTable(settings.gdWFIRCutoff, settings.gbWFIRType);
+	getsinc(gKaiserSinc, 9.6377, settings.gdWFIRCutoff);
+}
 
 
-void CResampler::InitializeTables(bool force)
+// All table sets that are currently in use. Expired entries are removed on the next lookup.
+static Util::mutex resamplerTablesMutex;
+static std::vector<MPT_WEAK_PTR<const CResamplerTables> > resamplerTables;
+
+
+MPT_SHARED_PTR<const CResamplerTables> CResamplerTables::Get(const CResamplerSettings &settings)
+//----------------------------------------------------------------------------------------------
 {
-#ifdef MODPLUG_TRACKER
-	if((m_OldSettings == m_Settings) && !force && StaticTablesInitialized) return;
-	if(!StaticTablesInitialized)
-#else
-	if((m_OldSettings == m_Settings) && !force) return;
-#endif // MODPLUG_TRACKER
+	Util::lock_guard<Util::mutex> guard(resamplerTablesMutex);
+	MPT_SHARED_PTR<const CResamplerTables> result;
+	for(size_t i = 0; i < resamplerTables.size(); )
 	{
-		//ericus' downsampling improvement.
-		//getsinc(gDownsample13x, 8.5, 3.0/4.0);
-		//getdownsample2x(gDownsample2x);
-		getsinc(gDownsample13x, 8.5, 0.5);
-		getsinc(gDownsample2x, 2.7625, 0.425);
-		//end ericus' downsampling improvement.
-
-#ifndef MPT_INTMIXER
-		// Prepare fast sinc coefficients for floating point mixer
-		for(size_t i = 0; i < CountOf(FastSincTable); i++)
+		MPT_SHARED_PTR<const CResamplerTables> tables = resamplerTables[i].lock();
+		if(!tables)
 		{
-			FastSincTablef[i] = static_cast<mixsample_t>(FastSincTable[i] * mixsample_t(1.0f / 16384.0f));
+			resamplerTables.erase(resamplerTables.begin() + i);
+			continue;
 		}
-
-		// Prepare linear interpolation coefficients for floating point mixer
-		for(size_t i = 0; i < CountOf(LinearTablef); i++)
+		if(!result && IsEquivalent(tables->m_Settings, settings))
 		{
-			LinearTablef[i] = static_cast<mixsample_t>(i * mixsample_t(1.0f / CountOf(LinearTablef)));
+			result = tables;
 		}
-#endif // !defined(MPT_INTMIXER)
+		i++;
+	}
+	if(!result)
+	{
+		result = MPT_SHARED_PTR<const CResamplerTables>(new CResamplerTables(settings));
+		resamplerTables.push_back(result);
 	}
+	return result;
+}
 
-	m_WindowedFIR.InitTable(m_Settings.gdWFIRCutoff, m_Settings.gbWFIRType);
-	getsinc(gKaiserSinc, 9.6377, m_Settings.gdWFIRCutoff);
 
-#ifdef MODPLUG_TRACKER
-	StaticTablesInitialized = true;
-#endif // MODPLUG_TRACKER
+void CResampler::InitializeTables(bool force)
+//-------------------------------------------
+{
+	if(m_Tables && !force && CResamplerTables::IsEquivalent(m_Settings, m_Tables->GetSettings())) return;
 
-	m_OldSettings = m_Settings;
+	m_Tables = CResamplerTables::Get(m_Settings);
+
+	gKaiserSinc = m_Tables->gKaiserSinc;
+	gDownsample13x = m_Tables->gDownsample13x;
+	gDownsample2x = m_Tables->gDownsample2x;
+	WFIRlut = m_Tables->m_WindowedFIR.lut;
+#ifndef MPT_INTMIXER
+	FastSincTablef = m_Tables->FastSincTablef;
+	LinearTablef = m_Tables->LinearTablef;
+#endif // !defined(MPT_INTMIXER)
 }
 
 
@@ -738,30 +738,43 @@ static bool ConvertAMPattern(FileReader chunk, PATTERNINDEX pat, bool isAM, CSou
 }
 
 
-bool CSoundFile::ReadAM(FileReader &file, ModLoadingFlags loadFlags)
-//------------------------------------------------------------------
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderAM(FileReader file)
+//--------------------------------------------------------------------
 {
 	file.Rewind();
 	AMFFRiffChunk fileHeader;
-	if(!file.ReadConvertEndianness(fileHeader))
+	if(!file.ReadConvertEndianness(fileHeader)
+		|| fileHeader.id != AMFFRiffChunk::idRIFF)
 	{
-		return false;
+		return ProbeResult(ProbeFailure, sizeof(AMFFRiffChunk) + 4);
 	}
 
-	if(fileHeader.id != AMFFRiffChunk::idRIFF)
+	const uint32 format = file.ReadUint32LE();
+	if(format != AMFFRiffChunk::idAMFF && format != AMFFRiffChunk::idAM__)
 	{
-		return false;
+		return ProbeResult(ProbeFailure, sizeof(AMFFRiffChunk) + 4);
 	}
+	return ProbeResult(ProbeSuccess, sizeof(AMFFRiffChunk) + 4);
+}
 
-	bool isAM; // false: AMFF, true: AM
 
-	uint32 format = file.ReadUint32LE();
-	if(format == AMFFRiffChunk::idAMFF)
-		isAM = false; // "AMFF"
-	else if(format == AMFFRiffChunk::idAM__)
-		isAM = true; // "AM  "
-	else
+bool CSoundFile::ReadAM(FileReader &file, ModLoadingFlags loadFlags)
+//------------------------------------------------------------------
+{
+	if(ProbeFileHeaderAM(file).confidence == ProbeFailure)
+	{
 		return false;
+	} else if(loadFlags == onlyVerifyHeader)
+	{
+		return true;
+	}
+
+	file.Rewind();
+	AMFFRiffChunk fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+
+	// false: AMFF, true: AM
+	const bool isAM = (file.ReadUint32LE() == AMFFRiffChunk::idAM__);
 
 	ChunkReader chunkFile(file);
 	// RIFF AM has a padding byte so that all chunks have an even size.
@@ -987,6 +1000,37 @@ bool CSoundFile::ReadAM(FileReader &file, ModLoadingFlags loadFlags)
 	return true;
 }
 
+CSoundFile::ProbeResult CSoundFile::ProbeFileHeaderJ2B(FileReader file)
+//---------------------------------------------------------------------
+{
+
+#if defined(NO_ZLIB) && defined(NO_MINIZ)
+
+	MPT_UNREFERENCED_PARAMETER(file);
+	return ProbeResult(ProbeFailure, sizeof(J2BFileHeader));
+
+#else
+
+	// The checksum is not verified here, as that requires reading the whole file.
+	file.Rewind();
+	J2BFileHeader fileHeader;
+	if(!file.ReadConvertEndianness(fileHeader)
+		|| memcmp(fileHeader.signature, "MUSE", 4)
+		|| (fileHeader.deadbeaf != J2BFileHeader::magicDEADBEAF // 0xDEADBEAF (RIFF AM)
+			&& fileHeader.deadbeaf != J2BFileHeader::magicDEADBABE) // 0xDEADBABE (RIFF AMFF)
+		|| fileHeader.fileLength != file.GetLength()
+		|| fileHeader.packedLength != file.BytesLeft()
+		|| fileHeader.packedLength == 0)
+	{
+		return ProbeResult(ProbeFailure, sizeof(J2BFileHeader));
+	}
+	return ProbeResult(ProbeSuccess, sizeof(J2BFileHeader));
+
+#endif
+
+}
+
+
 bool CSoundFile::ReadJ2B(FileReader &file, ModLoadingFlags loadFlags)
 //-------------------------------------------------------------------
 {
@@ -999,21 +1043,15 @@ bool CSoundFile::ReadJ2B(FileReader &file, ModLoadingFlags loadFlags)
 
 #else
 
-	file.Rewind();
-	J2BFileHeader fileHeader;
-	if(!file.ReadConvertEndianness(fileHeader))
+	if(ProbeFileHeaderJ2B(file).confidence == ProbeFailure)
 	{
 		return false;
 	}
 
-	if(memcmp(fileHeader.signature, "MUSE", 4)
-		|| (fileHeader.deadbeaf != J2BFileHeader::magicDEADBEAF // 0xDEADBEAF (RIFF AM)
-			&& fileHeader.deadbeaf != J2BFileHeader::magicDEADBABE) // 0xDEADBABE (RIFF AMFF)
-		|| fileHeader.fileLength != file.GetLength()
-		|| fileHeader.packedLength != file.BytesLeft()
-		|| fileHeader.packedLength == 0
-		|| fileHeader.crc32 != crc32(0, reinterpret_cast<const Bytef *>(file.GetRawData()), fileHeader.packedLength)
-		)
+	file.Rewind();
+	J2BFileHeader fileHeader;
+	file.ReadConvertEndianness(fileHeader);
+	if(fileHeader.crc32 != crc32(0, reinterpret_cast<const Bytef *>(file.GetRawData()), fileHeader.packedLength))
 	{
 		return false;
 	} else if(loadFlags == onlyVerifyHeader)
@@ -37,7 +37,15 @@ void ReplaceSample(ModSample &smp, void *pNewSample, const SmpLength nNewLength,
 	ctrlChn::ReplaceSample(sndFile.m_PlayState.Chn, &smp, pNewSample, nNewLength, setFlags, resetFlags);
 	smp.pSample = pNewSample;
 	smp.nLength = nNewLength;
-	ModSample::FreeSample(pOldSmp);
+	if(smp.IsReferenced())
+	{
+		// Only the lookahead buffer belongs to the sample.
+		delete[] static_cast<char *>(smp.pLookahead);
+		smp.pLookahead = nullptr;
+	} else
+	{
+		ModSample::FreeSample(pOldSmp);
+	}
 }
 
 
@@ -134,20 +142,60 @@ namespace // Unnamed namespace for local implementation functions.
 {
 
 
+// Sample data that is referenced from an external buffer (see ModSample::ReferenceSample).
+// Indices near the sample start and end are redirected to the lookahead buffer, so that the loop pre-computation
+// can work exactly as if the lookahead was stored right next to the sample data.
 template<typename T>
-class PrecomputeLoop
+class ExternalSampleBuffer
 {
 protected:
-	T *target;
+	T *head;
+	T *tail;
 	const T *sampleData;
+	std::ptrdiff_t headEnd;
+	std::ptrdiff_t tailStart;
+
+public:
+	ExternalSampleBuffer(const ModSample &smp)
+		: head(static_cast<T *>(smp.GetExternalHead()))
+		, tail(static_cast<T *>(smp.GetExternalTail()))
+		, sampleData(static_cast<const T *>(smp.pSample))
+		, headEnd(static_cast<std::ptrdiff_t>(ModSample::externalHeadEnd) * smp.GetNumChannels())
+		, tailStart((static_cast<std::ptrdiff_t>(smp.nLength) - ModSample::externalTailStart) * smp.GetNumChannels())
+	{
+		// Initialize both windows from the sample data
+		memcpy(head, sampleData, headEnd * sizeof(T));
+		memcpy(tail + tailStart, sampleData + tailStart, (ModSample::externalTailStart * smp.GetNumChannels()) * sizeof(T));
+	}
+
+	T &operator[] (std::ptrdiff_t i) const
+	{
+		if(i < headEnd)
+			return head[i];
+		else if(i >= tailStart)
+			return tail[i];
+		// Sample data itself is never written to.
+		return const_cast<T &>(sampleData[i]);
+	}
+};
+
+
+// Buffer is either a plain pointer to the sample data or an ExternalSampleBuffer. All offsets are in elementary samples.
+template<typename T, typename Buffer>
+class PrecomputeLoop
+{
+protected:
+	const Buffer &sampleBuffer;
+	std::ptrdiff_t target;
+	std::ptrdiff_t sampleData;
 	SmpLength loopEnd;
 	int numChannels;
 	bool pingpong;
 	bool ITPingPongMode;
 
 public:
-	PrecomputeLoop(T *target, const T *sampleData, SmpLength loopEnd, int numChannels, bool pingpong, bool ITPingPongMode)
-		: target(target), sampleData(sampleData), loopEnd(loopEnd), numChannels(numChannels), pingpong(pingpong), ITPingPongMode(ITPingPongMode)
+	PrecomputeLoop(const Buffer &sampleBuffer, std::ptrdiff_t target, std::ptrdiff_t sampleData, SmpLength loopEnd, int numChannels, bool pingpong, bool ITPingPongMode)
+		: sampleBuffer(sampleBuffer), target(target), sampleData(sampleData), loopEnd(loopEnd), numChannels(numChannels), pingpong(pingpong), ITPingPongMode(ITPingPongMode)
 	{
 		if(loopEnd > 0)
 		{
@@ -161,7 +209,7 @@ public:
 	{
 		// Direction: true = start reading and writing forward, false = start reading and writing backward (write direction never changes)
 		const int numSamples = 2 * InterpolationMaxLookahead + (direction ? 1 : 0);	// Loop point is included in forward loop expansion
-		T *dest = target + numChannels * (2 * InterpolationMaxLookahead - 1);		// Write buffer offset
+		std::ptrdiff_t dest = target + numChannels * (2 * InterpolationMaxLookahead - 1);		// Write buffer offset
 		SmpLength readPosition = loopEnd - 1;
 		const int writeIncrement = direction ? 1 : -1;
 		int readIncrement = writeIncrement;
@@ -171,7 +219,7 @@ public:
 			// Copy sample over to lookahead buffer
 			for(int c = 0; c < numChannels; c++)
 			{
-				dest[c] = sampleData[readPosition * numChannels + c];
+				sampleBuffer[dest + c] = sampleBuffer[sampleData + readPosition * numChannels + c];
 			}
 			dest += writeIncrement * numChannels;
 
@@ -208,9 +256,9 @@ public:
 };
 
 
-template<typename T>
-void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
-//-----------------------------------------------------------------
+template<typename T, typename Buffer>
+void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile, const Buffer &sampleData)
+//-------------------------------------------------------------------------------------------
 {
 	const int numChannels = smp.GetNumChannels();
 	const int copySamples = numChannels * InterpolationMaxLookahead;
@@ -218,10 +266,9 @@ void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
 	// Note that we can't do this for sustain loops, as we would get clicks at the sample end after releasing the loop.
 	const bool loopEndsAtSampleEnd = smp.uFlags[CHN_LOOP] && smp.nLoopEnd == smp.nLength;
 	
-	T *sampleData = static_cast<T *>(smp.pSample);
-	T *afterSampleStart = sampleData + smp.nLength * numChannels;
-	T *loopLookAheadStart = afterSampleStart + (loopEndsAtSampleEnd ? -2 * copySamples : copySamples);
-	T *sustainLookAheadStart = loopLookAheadStart + 4 * copySamples;
+	const std::ptrdiff_t afterSampleStart = static_cast<std::ptrdiff_t>(smp.nLength) * numChannels;
+	const std::ptrdiff_t loopLookAheadStart = afterSampleStart + (loopEndsAtSampleEnd ? -2 * copySamples : copySamples);
+	const std::ptrdiff_t sustainLookAheadStart = loopLookAheadStart + 4 * copySamples;
 
 	// Hold sample on the same level as the last sampling point at the end to prevent extra pops with interpolation.
 	// Do the same at the sample start, too.
@@ -229,15 +276,16 @@ void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
 	{
 		for(int c = 0; c < numChannels; c++)
 		{
-			afterSampleStart[i * numChannels + c] = afterSampleStart[-numChannels + c];
+			sampleData[afterSampleStart + i * numChannels + c] = sampleData[afterSampleStart - numChannels + c];
 			sampleData[-(i + 1) * numChannels + c] = sampleData[c];
 		}
 	}
 
 	if(smp.uFlags[CHN_LOOP])
 	{
-		PrecomputeLoop<T>(loopLookAheadStart,
-			sampleData + smp.nLoopStart * numChannels,
+		PrecomputeLoop<T, Buffer>(sampleData,
+			loopLookAheadStart,
+			smp.nLoopStart * numChannels,
 			smp.nLoopEnd - smp.nLoopStart,
 			numChannels,
 			smp.uFlags[CHN_PINGPONGLOOP],
@@ -245,8 +293,9 @@ void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
 	}
 	if(smp.uFlags[CHN_SUSTAINLOOP])
 	{
-		PrecomputeLoop<T>(sustainLookAheadStart,
-			sampleData + smp.nSustainStart * numChannels,
+		PrecomputeLoop<T, Buffer>(sampleData,
+			sustainLookAheadStart,
+			smp.nSustainStart * numChannels,
 			smp.nSustainEnd - smp.nSustainStart,
 			numChannels,
 			smp.uFlags[CHN_PINGPONGSUSTAIN],
@@ -254,6 +303,47 @@ void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
 	}
 }
 
+
+// Build the peak summary that the mixer uses for skipping inaudible voices.
+template<typename T>
+void ComputePeaks(ModSample &smp)
+//-------------------------------
+{
+	const T * const sampleData = static_cast<const T *>(smp.pSample);
+	const int numChannels = smp.GetNumChannels();
+	const int shift = 16 - 8 * sizeof(T);
+	smp.peaks.assign(((smp.nLength - 1) >> ModSample::peakBlockShift) + 1, 0);
+	for(size_t block = 0; block < smp.peaks.size(); block++)
+	{
+		const SmpLength start = static_cast<SmpLength>(block << ModSample::peakBlockShift);
+		const SmpLength end = std::min<SmpLength>(start + (1 << ModSample::peakBlockShift), smp.nLength);
+		int minVal = 0, maxVal = 0;
+		for(SmpLength i = start * numChannels; i < end * numChannels; i++)
+		{
+			minVal = std::min<int>(minVal, sampleData[i]);
+			maxVal = std::max<int>(maxVal, sampleData[i]);
+		}
+		smp.peaks[block] = static_cast<uint16>(std::max(-minVal, maxVal) << shift);
+	}
+	smp.peakSource = smp.pSample;
+}
+
+
+template<typename T>
+void PrecomputeLoopsImpl(ModSample &smp, const CSoundFile &sndFile)
+//-----------------------------------------------------------------
+{
+	if(smp.IsReferenced())
+	{
+		PrecomputeLoopsImpl<T>(smp, sndFile, ExternalSampleBuffer<T>(smp));
+	} else
+	{
+		T * const sampleData = static_cast<T *>(smp.pSample);
+		PrecomputeLoopsImpl<T>(smp, sndFile, sampleData);
+	}
+	ComputePeaks<T>(smp);
+}
+
 } // unnamed namespace.
 
 
@@ -263,6 +353,10 @@ bool PrecomputeLoops(ModSample &smp, CSoundFile &sndFile, bool updateChannels)
 	if(smp.nLength == 0 || smp.pSample == nullptr)
 		return false;
 
+	// The lookahead buffer of referenced samples is laid out for a minimum sample length.
+	if(smp.IsReferenced() && smp.nLength < ModSample::externalMinLength && !smp.UnreferenceSample())
+		return false;
+
 	smp.SanitizeLoops();
 
 	// Update channels with possibly changed loop values
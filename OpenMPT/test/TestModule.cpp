@@ -0,0 +1,109 @@
+/*
+ * TestModule.cpp
+ * --------------
+ * Purpose: Generated modules for the unit tests and benchmarks.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "TestModule.h"
+
+
+#ifdef ENABLE_TESTS
+
+
+#include "../soundlib/FileReader.h"
+#include "../soundlib/modsmp_ctrl.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Test {
+
+
+void CreateModule(CSoundFile &sndFile, MODTYPE type, CHANNELINDEX numChannels, PATTERNINDEX numPatterns, ROWINDEX numRows)
+//------------------------------------------------------------------------------------------------------------------------
+{
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.ChangeModTypeTo(type);
+	sndFile.m_nChannels = numChannels;
+
+	sndFile.Order.resize(numPatterns);
+	for(PATTERNINDEX pat = 0; pat < numPatterns; pat++)
+	{
+		sndFile.Patterns.Insert(pat, numRows);
+		sndFile.Order[pat] = pat;
+	}
+}
+
+
+SAMPLEINDEX AddSample(CSoundFile &sndFile, const SampleSpec &spec, Random &rng)
+//-----------------------------------------------------------------------------
+{
+	const SAMPLEINDEX smp = ++sndFile.m_nSamples;
+	ModSample &sample = sndFile.GetSample(smp);
+	sample.Initialize(sndFile.GetType());
+	sample.uFlags = static_cast<ChannelFlags>(spec.flags);
+	sample.nLength = spec.length;
+	sample.nLoopStart = spec.loopStart;
+	sample.nLoopEnd = spec.loopEnd;
+	sample.nSustainStart = spec.sustainStart;
+	sample.nSustainEnd = spec.sustainEnd;
+	sample.nC5Speed = spec.c5Speed;
+	sample.AllocateSample();
+
+	const uint8 numChannels = sample.GetNumChannels();
+	for(SmpLength i = 0; i < sample.nLength; i++)
+	{
+		for(uint8 chn = 0; chn < numChannels; chn++)
+		{
+			int value = static_cast<int16>(rng.Next());
+			if(i >= spec.silenceStart && i < spec.silenceEnd)
+			{
+				value = 0;
+			} else if(i >= spec.silenceEnd)
+			{
+				value /= (1 << spec.tailShift);
+			}
+			if(sample.uFlags[CHN_16BIT])
+				static_cast<int16 *>(sample.pSample)[i * numChannels + chn] = static_cast<int16>(value);
+			else
+				static_cast<int8 *>(sample.pSample)[i * numChannels + chn] = static_cast<int8>(value / 256);
+		}
+	}
+	ctrlSmp::PrecomputeLoops(sample, sndFile, false);
+	return smp;
+}
+
+
+MixerSettings GetMixerSettings(const CSoundFile &sndFile)
+//-------------------------------------------------------
+{
+	MixerSettings mixerSettings = sndFile.m_MixerSettings;
+	mixerSettings.gdwMixingFreq = 44100;
+	mixerSettings.gnChannels = 2;
+	return mixerSettings;
+}
+
+
+void SetMixerSettings(CSoundFile &sndFile, const MixerSettings &mixerSettings, ResamplingMode srcMode)
+//---------------------------------------------------------------------------------------------------
+{
+	sndFile.SetMixerSettings(mixerSettings);
+	CResamplerSettings resamplerSettings = sndFile.m_Resampler.m_Settings;
+	resamplerSettings.SrcMode = srcMode;
+	sndFile.SetResamplerSettings(resamplerSettings);
+}
+
+
+} // namespace Test
+
+
+OPENMPT_NAMESPACE_END
+
+
+#endif // ENABLE_TESTS
@@ -0,0 +1,87 @@
+/*
+ * TestModule.h
+ * ------------
+ * Purpose: Generated modules for the unit tests and benchmarks.
+ * Notes  : All data is generated with a portable random number generator from fixed seeds,
+ *          so that the modules are identical on all platforms.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+
+#ifdef ENABLE_TESTS
+
+
+#include "../soundlib/Sndfile.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Test {
+
+
+// Linear congruential generator
+//==========
+class Random
+//==========
+{
+protected:
+	uint32 m_state;
+
+public:
+	explicit Random(uint32 seed) : m_state(seed) { }
+
+	// Returns a number between 0 and 65535
+	uint32 Next()
+	{
+		m_state = m_state * 1103515245u + 12345u;
+		return m_state >> 16;
+	}
+
+	// Returns a number between 0 and range - 1
+	uint32 Next(uint32 range) { return Next() % range; }
+};
+
+
+// Properties of a sample created by AddSample()
+struct SampleSpec
+{
+	uint32 flags;							// Combination of CHN_16BIT, CHN_STEREO and the loop flags
+	SmpLength length;
+	SmpLength loopStart, loopEnd;			// Only used with CHN_LOOP, the loop end defaults to the sample length
+	SmpLength sustainStart, sustainEnd;		// Only used with CHN_SUSTAINLOOP
+	uint32 c5Speed;
+	SmpLength silenceStart, silenceEnd;		// All sampling points in this range are 0
+	int tailShift;							// Sampling points after the silent range are attenuated by 6 dB per step
+
+	SampleSpec(SmpLength length, uint32 flags = 0, uint32 c5Speed = 8363)
+		: flags(flags), length(length), loopStart(0), loopEnd(length), sustainStart(0), sustainEnd(0), c5Speed(c5Speed)
+		, silenceStart(length), silenceEnd(length), tailShift(0)
+	{ }
+};
+
+
+// Creates an empty module with numPatterns patterns of numRows rows, which are played in order.
+void CreateModule(CSoundFile &sndFile, MODTYPE type, CHANNELINDEX numChannels, PATTERNINDEX numPatterns = 1, ROWINDEX numRows = 64);
+
+// Adds a sample filled with random data (white noise at full scale) and returns its index.
+SAMPLEINDEX AddSample(CSoundFile &sndFile, const SampleSpec &spec, Random &rng);
+
+// The module's current mixer settings, changed to 44.1 kHz stereo output.
+MixerSettings GetMixerSettings(const CSoundFile &sndFile);
+
+// Applies mixer settings (e.g. returned by GetMixerSettings()) and the resampling mode.
+void SetMixerSettings(CSoundFile &sndFile, const MixerSettings &mixerSettings, ResamplingMode srcMode);
+
+
+} // namespace Test
+
+
+OPENMPT_NAMESPACE_END
+
+
+#endif // ENABLE_TESTS
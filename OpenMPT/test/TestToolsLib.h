@@ -175,9 +175,29 @@ public:
 		}
 	}
 
+	// Compares with a tolerance: passes if x and y differ by at most eps
+	template <typename Tx, typename Ty, typename Teps>
+	noinline void operator () (const Tx &x, const Ty &y, const Teps &eps)
+	{
+		ShowStart();
+		try
+		{
+			if((x > y ? x - y : y - x) > eps)
+			{
+				throw TestFailed();
+			}
+			ReportPassed();
+		} catch(...)
+		{
+			ReportFailed();
+		}
+	}
+
 	#define VERIFY_EQUAL(x,y)	Test::Testcase(Test::FatalityContinue, Test::VerbosityNormal, #x " == " #y , MPT_TEST_CONTEXT_CURRENT() )( (x) , (y) )
 	#define VERIFY_EQUAL_NONCONT(x,y)	Test::Testcase(Test::FatalityStop, Test::VerbosityNormal, #x " == " #y , MPT_TEST_CONTEXT_CURRENT() )( (x) , (y) )
 	#define VERIFY_EQUAL_QUIET_NONCONT(x,y)	Test::Testcase(Test::FatalityStop, Test::VerbosityQuiet, #x " == " #y , MPT_TEST_CONTEXT_CURRENT() )( (x) , (y) )
+	#define VERIFY_EQUAL_EPS(x,y,eps)	Test::Testcase(Test::FatalityContinue, Test::VerbosityNormal, #x " == " #y , MPT_TEST_CONTEXT_CURRENT() )( (x) , (y) , (eps) )
+	#define VERIFY_EQUAL_QUIET_EPS(x,y,eps)	Test::Testcase(Test::FatalityContinue, Test::VerbosityQuiet, #x " == " #y , MPT_TEST_CONTEXT_CURRENT() )( (x) , (y) , (eps) )
 
 #endif
 
@@ -46,6 +46,18 @@ namespace Test {
 // Like VERIFY_EQUAL, only differs for libopenmpt
 #define VERIFY_EQUAL_QUIET_NONCONT VERIFY_EQUAL
 
+// Verify that given parameters differ by at most eps. Break directly into the debugger if not.
+#define VERIFY_EQUAL_EPS(x,y,eps)	\
+	do { \
+		if(((x) > (y) ? (x) - (y) : (y) - (x)) > (eps)) { \
+			MyDebugBreak(); \
+		} \
+	} while(0) \
+/**/
+
+// Like VERIFY_EQUAL_EPS, only differs for libopenmpt
+#define VERIFY_EQUAL_QUIET_EPS VERIFY_EQUAL_EPS
+
 
 #define DO_TEST(func) \
 	do { \
@@ -0,0 +1,552 @@
+/*
+ * bench.cpp
+ * ---------
+ * Purpose: Benchmarks for module loading, rendering, DSP effects, MIDI macros and seeking.
+ * Notes  : All modules are generated with fixed random seeds, so that results of different builds can be compared.
+ *          For each configuration, the fastest of several runs is reported.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "bench.h"
+
+
+#ifdef ENABLE_TESTS
+
+
+#include "../common/version.h"
+#include "../common/misc_util.h"
+#include "../common/StringFixer.h"
+#include "../common/mptFstream.h"
+#include "../soundlib/Sndfile.h"
+#include "../soundlib/FileReader.h"
+#include "TestModule.h"
+#include <algorithm>
+#include <iterator>
+#include <locale>
+#include <ostream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#if MPT_OS_WINDOWS
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace Bench {
+
+
+static double GetTimeSeconds()
+//----------------------------
+{
+#if MPT_OS_WINDOWS
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+
+// Collects the durations of several runs of the same benchmark.
+//===========
+class Timings
+//===========
+{
+protected:
+	std::vector<double> m_seconds;
+
+public:
+	void Add(double seconds) { m_seconds.push_back(seconds); }
+
+	double GetBest() const
+	{
+		return m_seconds.empty() ? 0.0 : std::max(*std::min_element(m_seconds.begin(), m_seconds.end()), 1e-9);
+	}
+
+	double GetMedian() const
+	{
+		if(m_seconds.empty())
+		{
+			return 0.0;
+		}
+		std::vector<double> sorted = m_seconds;
+		std::sort(sorted.begin(), sorted.end());
+		return sorted[sorted.size() / 2];
+	}
+};
+
+
+// Discards the rendered audio
+//===========================================
+class NullAudioTarget : public IAudioReadTarget
+//===========================================
+{
+public:
+	virtual void DataCallback(mixsample_t *, std::size_t, std::size_t) { }
+};
+
+
+static const ROWINDEX rowsPerPattern = 64;
+
+
+// Create a module with numPatterns random patterns and a few looped samples.
+// If filters is true, every second channel sweeps the resonant filter using Zxx (IT / MPTM only).
+static void GenerateModule(CSoundFile &sndFile, MODTYPE type, CHANNELINDEX numChannels, PATTERNINDEX numPatterns, bool filters, uint32 seed)
+//-----------------------------------------------------------------------------------------------------------------------------------------
+{
+	Test::Random rng(seed);
+	Test::CreateModule(sndFile, type, numChannels, numPatterns, rowsPerPattern);
+
+	for(uint32 smp = 1; smp <= 4; smp++)
+	{
+		Test::SampleSpec spec(2000 + smp * 3000, (type != MOD_TYPE_MOD && smp % 2 == 0) ? CHN_16BIT | CHN_LOOP : CHN_LOOP, 8363 * (1 + smp % 3));
+		spec.loopStart = spec.length / 4;
+		Test::AddSample(sndFile, spec, rng);
+	}
+
+	for(PATTERNINDEX pat = 0; pat < numPatterns; pat++)
+	{
+		for(ROWINDEX row = 0; row < rowsPerPattern; row++)
+		{
+			for(CHANNELINDEX chn = 0; chn < numChannels; chn++)
+			{
+				ModCommand &m = *sndFile.Patterns[pat].GetpModCommand(row, chn);
+				if(rng.Next(100) < 60)
+				{
+					m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 24 + rng.Next(48));
+					m.instr = static_cast<ModCommand::INSTR>(1 + rng.Next(sndFile.GetNumSamples()));
+				}
+				if(type != MOD_TYPE_MOD && rng.Next(100) < 50)
+				{
+					m.volcmd = VOLCMD_VOLUME;
+					m.vol = static_cast<ModCommand::VOL>(16 + rng.Next(49));
+				}
+				if(filters && chn % 2 == 0)
+				{
+					m.command = CMD_MIDI;
+					m.param = static_cast<ModCommand::PARAM>(rng.Next(128));
+					continue;
+				}
+				switch(rng.Next(8))
+				{
+				case 0: m.command = CMD_ARPEGGIO; m.param = 0x37; break;
+				case 1: m.command = CMD_PORTAMENTOUP; m.param = 0x02; break;
+				case 2: m.command = CMD_VIBRATO; m.param = 0x46; break;
+				case 3: m.command = CMD_VOLUMESLIDE; m.param = 0x02; break;
+				}
+			}
+		}
+	}
+}
+
+
+static const char *GetResamplingModeName(ResamplingMode mode)
+//-----------------------------------------------------------
+{
+	switch(mode)
+	{
+	case SRCMODE_NEAREST: return "nearest";
+	case SRCMODE_LINEAR: return "linear";
+	case SRCMODE_SPLINE: return "spline";
+	case SRCMODE_POLYPHASE: return "polyphase";
+	case SRCMODE_FIRFILTER: return "firfilter";
+	default: return "unknown";
+	}
+}
+
+
+static void RemoveFile(const mpt::PathString &filename)
+//-----------------------------------------------------
+{
+#if MPT_OS_WINDOWS
+	DeleteFileW(filename.AsNative().c_str());
+#else
+	remove(filename.AsNative().c_str());
+#endif
+}
+
+
+// Load time of each supported format. The modules are saved once and then loaded from memory.
+static void BenchLoad(std::ostream &json, std::ostream &log, const Settings &settings)
+//-----------------------------------------------------------------------------------
+{
+	struct Format
+	{
+		MODTYPE type;
+		const char *extension;
+		CHANNELINDEX channels;
+	};
+	static const Format formats[] =
+	{
+		{ MOD_TYPE_MOD, "mod", 4 },
+		{ MOD_TYPE_S3M, "s3m", 16 },
+		{ MOD_TYPE_XM, "xm", 16 },
+		{ MOD_TYPE_IT, "it", 16 },
+		{ MOD_TYPE_MPT, "mptm", 16 },
+	};
+	const PATTERNINDEX numPatterns = 32;
+	const uint32 numLoads = 10 * settings.repeat;
+
+	json << "\t\"load\": [\n";
+	for(std::size_t i = 0; i < CountOf(formats); i++)
+	{
+		const Format &format = formats[i];
+		log << "load " << format.extension << std::endl;
+
+		const mpt::PathString filename = MPT_PATHSTRING("./bench.") + mpt::PathString::FromUTF8(format.extension);
+		{
+			CSoundFile *sndFile = new CSoundFile();
+			GenerateModule(*sndFile, format.type, format.channels, numPatterns, false, i + 1);
+			switch(format.type)
+			{
+			case MOD_TYPE_MOD: sndFile->SaveMod(filename); break;
+			case MOD_TYPE_S3M: sndFile->SaveS3M(filename); break;
+			case MOD_TYPE_XM: sndFile->SaveXM(filename); break;
+			default: sndFile->SaveIT(filename); break;
+			}
+			sndFile->Destroy();
+			delete sndFile;
+		}
+		std::vector<char> data;
+		{
+			mpt::ifstream f(filename, std::ios::binary);
+			data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+		}
+		RemoveFile(filename);
+
+		Timings timings;
+		bool loaded = true;
+		for(uint32 run = 0; run < numLoads && !data.empty(); run++)
+		{
+			CSoundFile *sndFile = new CSoundFile();
+			const double start = GetTimeSeconds();
+			loaded = sndFile->Create(FileReader(&data[0], data.size()), CSoundFile::loadCompleteModule) && loaded;
+			timings.Add(GetTimeSeconds() - start);
+			sndFile->Destroy();
+			delete sndFile;
+		}
+
+		json << "\t\t{ \"format\": \"" << format.extension << "\""
+			<< ", \"channels\": " << format.channels
+			<< ", \"patterns\": " << numPatterns
+			<< ", \"bytes\": " << data.size()
+			<< ", \"loaded\": " << ((loaded && !data.empty()) ? "true" : "false")
+			<< ", \"runs\": " << numLoads
+			<< ", \"best_ms\": " << timings.GetBest() * 1000.0
+			<< ", \"median_ms\": " << timings.GetMedian() * 1000.0
+			<< ", \"megabytes_per_second\": " << data.size() / timings.GetBest() / 1000000.0
+			<< " }" << (i + 1 < CountOf(formats) ? "," : "") << "\n";
+	}
+	json << "\t],\n";
+}
+
+
+// Rendering speed for each resampling mode and different numbers of channels, with and without filters and volume ramping.
+static void BenchRender(std::ostream &json, std::ostream &log, const Settings &settings)
+//-------------------------------------------------------------------------------------
+{
+	static const ResamplingMode srcModes[] = { SRCMODE_NEAREST, SRCMODE_LINEAR, SRCMODE_SPLINE, SRCMODE_POLYPHASE, SRCMODE_FIRFILTER };
+	static const CHANNELINDEX channelCounts[] = { 4, 16, 64 };
+	const uint32 sampleRate = 44100;
+	const CSoundFile::samplecount_t frames = static_cast<CSoundFile::samplecount_t>(settings.renderSeconds * sampleRate);
+	// 64 rows at speed 6 and 125 BPM take 7.68 seconds
+	const PATTERNINDEX numPatterns = static_cast<PATTERNINDEX>(settings.renderSeconds / 7.68) + 2;
+
+	json << "\t\"render\": [\n";
+	bool first = true;
+	for(std::size_t chnIndex = 0; chnIndex < CountOf(channelCounts); chnIndex++)
+	{
+		for(std::size_t mode = 0; mode < CountOf(srcModes); mode++)
+		{
+			for(int variant = 0; variant < 4; variant++)
+			{
+				const CHANNELINDEX channels = channelCounts[chnIndex];
+				const bool filters = (variant & 1) != 0;
+				const bool ramping = (variant & 2) != 0;
+				log << "render " << GetResamplingModeName(srcModes[mode]) << ", " << channels << " channels"
+					<< (filters ? ", filters" : "") << (ramping ? ", ramping" : "") << std::endl;
+
+				Timings timings;
+				CSoundFile::samplecount_t rendered = 0;
+				uint64 voicesMixed = 0;
+				for(uint32 run = 0; run < settings.repeat; run++)
+				{
+					CSoundFile *sndFile = new CSoundFile();
+					GenerateModule(*sndFile, MOD_TYPE_IT, channels, numPatterns, filters, channels);
+
+					MixerSettings mixerSettings = Test::GetMixerSettings(*sndFile);
+					mixerSettings.NumMixerThreads = 1;
+					if(!ramping)
+					{
+						mixerSettings.SetVolumeRampUpMicroseconds(0);
+						mixerSettings.SetVolumeRampDownMicroseconds(0);
+					}
+					Test::SetMixerSettings(*sndFile, mixerSettings, srcModes[mode]);
+					// Lookup tables are created on the first call to Read(), which should not be measured.
+					sndFile->m_Resampler.InitializeTables();
+
+					NullAudioTarget target;
+					const double start = GetTimeSeconds();
+					rendered = sndFile->Read(frames, target);
+					timings.Add(GetTimeSeconds() - start);
+					voicesMixed = sndFile->GetPerfCounters().voicesMixed;
+
+					sndFile->Destroy();
+					delete sndFile;
+				}
+
+				json << (first ? "" : ",\n")
+					<< "\t\t{ \"resampling\": \"" << GetResamplingModeName(srcModes[mode]) << "\""
+					<< ", \"channels\": " << channels
+					<< ", \"filters\": " << (filters ? "true" : "false")
+					<< ", \"ramping\": " << (ramping ? "true" : "false")
+					<< ", \"frames\": " << rendered
+					<< ", \"voices_mixed\": " << voicesMixed
+					<< ", \"best_seconds\": " << timings.GetBest()
+					<< ", \"median_seconds\": " << timings.GetMedian()
+					<< ", \"frames_per_second\": " << rendered / timings.GetBest()
+					<< ", \"realtime_factor\": " << rendered / timings.GetBest() / sampleRate
+					<< " }";
+				first = false;
+			}
+		}
+	}
+	json << "\n\t],\n";
+}
+
+
+// Rendering speed of the DSP effects, using the SIMD and the portable code.
+static void BenchDSP(std::ostream &json, std::ostream &log, const Settings &settings)
+//----------------------------------------------------------------------------------
+{
+	struct Effect
+	{
+		const char *name;
+		DWORD DSPMask;
+	};
+	static const Effect effects[] =
+	{
+		{ "none", 0 },
+#ifndef NO_REVERB
+		{ "reverb", SNDDSP_REVERB },
+#endif // NO_REVERB
+#ifndef NO_DSP
+		{ "megabass", SNDDSP_MEGABASS },
+		{ "surround", SNDDSP_SURROUND },
+#endif // NO_DSP
+	};
+	const CHANNELINDEX channels = 16;
+	const uint32 sampleRate = 44100;
+	const CSoundFile::samplecount_t frames = static_cast<CSoundFile::samplecount_t>(settings.renderSeconds * sampleRate);
+	const PATTERNINDEX numPatterns = static_cast<PATTERNINDEX>(settings.renderSeconds / 7.68) + 2;
+
+	json << "\t\"dsp\": [\n";
+	bool first = true;
+	for(std::size_t effect = 0; effect < CountOf(effects); effect++)
+	{
+		for(int simd = 1; simd >= 0; simd--)
+		{
+			log << "dsp " << effects[effect].name << (simd ? ", simd" : "") << std::endl;
+
+			Timings timings;
+			CSoundFile::samplecount_t rendered = 0;
+			for(uint32 run = 0; run < settings.repeat; run++)
+			{
+				CSoundFile *sndFile = new CSoundFile();
+				GenerateModule(*sndFile, MOD_TYPE_IT, channels, numPatterns, false, channels);
+
+				MixerSettings mixerSettings = Test::GetMixerSettings(*sndFile);
+				mixerSettings.NumMixerThreads = 1;
+				mixerSettings.DSPMask = effects[effect].DSPMask;
+				if(simd)
+					mixerSettings.MixerFlags &= ~SNDMIX_NOSIMD;
+				else
+					mixerSettings.MixerFlags |= SNDMIX_NOSIMD;
+				Test::SetMixerSettings(*sndFile, mixerSettings, SRCMODE_LINEAR);
+				sndFile->m_Resampler.InitializeTables();
+
+				NullAudioTarget target;
+				const double start = GetTimeSeconds();
+				rendered = sndFile->Read(frames, target);
+				timings.Add(GetTimeSeconds() - start);
+
+				sndFile->Destroy();
+				delete sndFile;
+			}
+
+			json << (first ? "" : ",\n")
+				<< "\t\t{ \"effect\": \"" << effects[effect].name << "\""
+				<< ", \"simd\": " << (simd ? "true" : "false")
+				<< ", \"channels\": " << channels
+				<< ", \"frames\": " << rendered
+				<< ", \"best_seconds\": " << timings.GetBest()
+				<< ", \"median_seconds\": " << timings.GetMedian()
+				<< ", \"frames_per_second\": " << rendered / timings.GetBest()
+				<< " }";
+			first = false;
+		}
+	}
+	json << "\n\t],\n";
+}
+
+
+// Evaluation time of compiled MIDI macros, as done by Zxx and \xx on every tick.
+static void BenchMacros(std::ostream &json, std::ostream &log, const Settings &settings)
+//-------------------------------------------------------------------------------------
+{
+	static const char * const macros[] = { "F0F000z", "9c n v", "Bc 0A x", "F0 7F 01 02 03 z a b p F7" };
+	const uint32 numEvaluations = 1000000;
+
+	CSoundFile *sndFile = new CSoundFile();
+	Test::CreateModule(*sndFile, MOD_TYPE_IT, 1);
+	ModChannel &chn = sndFile->m_PlayState.Chn[0];
+	chn.nLastNote = NOTE_MIDDLEC;
+	chn.nVolume = 192;
+	chn.nPan = 96;
+
+	json << "\t\"macros\": [\n";
+	for(std::size_t i = 0; i < CountOf(macros); i++)
+	{
+		log << "macro " << macros[i] << std::endl;
+
+		char macro[MACRO_LENGTH];
+		MemsetZero(macro);
+		mpt::String::CopyN(macro, macros[i]);
+		CompiledMIDIMacro compiled;
+		compiled.Compile(macro);
+
+		Timings timings;
+		uint32 checksum = 0;
+		for(uint32 run = 0; run < settings.repeat; run++)
+		{
+			unsigned char out[MACRO_LENGTH];
+			const double start = GetTimeSeconds();
+			for(uint32 eval = 0; eval < numEvaluations; eval++)
+			{
+				checksum += static_cast<uint32>(sndFile->EvaluateMIDIMacro(0, compiled, static_cast<uint8>(eval & 0x7F), out));
+				checksum += out[0];
+			}
+			timings.Add(GetTimeSeconds() - start);
+		}
+
+		json << "\t\t{ \"macro\": \"" << macros[i] << "\""
+			<< ", \"evaluations\": " << numEvaluations
+			<< ", \"checksum\": " << checksum
+			<< ", \"best_ns\": " << timings.GetBest() / numEvaluations * 1e9
+			<< ", \"median_ns\": " << timings.GetMedian() / numEvaluations * 1e9
+			<< " }" << (i + 1 < CountOf(macros) ? "," : "") << "\n";
+	}
+	json << "\t],\n";
+
+	sndFile->Destroy();
+	delete sndFile;
+}
+
+
+// Latency of seeking to a time position the way libopenmpt does, with and without the seek index.
+static void BenchSeek(std::ostream &json, std::ostream &log, const Settings &settings)
+//-----------------------------------------------------------------------------------
+{
+	const PATTERNINDEX numPatterns = 64;
+	const uint32 numSeeks = 20;
+
+	json << "\t\"seek\": [\n";
+	for(int useIndex = 0; useIndex < 2; useIndex++)
+	{
+		log << "seek" << (useIndex ? ", seek index" : "") << std::endl;
+
+		Timings lengthTimings, seekTimings;
+		double seekTotal = 0.0, duration = 0.0;
+		ROWINDEX interval = 0;
+		for(uint32 run = 0; run < settings.repeat; run++)
+		{
+			CSoundFile *sndFile = new CSoundFile();
+			GenerateModule(*sndFile, MOD_TYPE_IT, 16, numPatterns, false, 1);
+			// 64 rows is the default interval in libopenmpt
+			sndFile->SetSeekIndexInterval(useIndex ? 64 : 0);
+			interval = sndFile->GetSeekIndexInterval();
+
+			double start = GetTimeSeconds();
+			duration = sndFile->GetLength(eNoAdjust).duration;
+			lengthTimings.Add(GetTimeSeconds() - start);
+
+			Test::Random rng(1);
+			for(uint32 seek = 0; seek < numSeeks; seek++)
+			{
+				const double target = duration * rng.Next(1000) / 1000.0;
+				start = GetTimeSeconds();
+				GetLengthType t = sndFile->GetLength(eNoAdjust, GetLengthTarget(target));
+				sndFile->InitializeVisitedRows();
+				sndFile->m_PlayState.m_nCurrentOrder = t.lastOrder;
+				sndFile->SetCurrentOrder(t.lastOrder);
+				sndFile->m_PlayState.m_nNextRow = t.lastRow;
+				sndFile->GetLength(eAdjust, GetLengthTarget(t.lastOrder, t.lastRow));
+				const double elapsed = GetTimeSeconds() - start;
+				seekTimings.Add(elapsed);
+				seekTotal += elapsed;
+			}
+
+			sndFile->Destroy();
+			delete sndFile;
+		}
+
+		json << "\t\t{ \"seek_index_interval\": " << interval
+			<< ", \"duration_seconds\": " << duration
+			<< ", \"seeks\": " << numSeeks * settings.repeat
+			<< ", \"length_best_ms\": " << lengthTimings.GetBest() * 1000.0
+			<< ", \"seek_best_ms\": " << seekTimings.GetBest() * 1000.0
+			<< ", \"seek_median_ms\": " << seekTimings.GetMedian() * 1000.0
+			<< ", \"seek_mean_ms\": " << seekTotal / (numSeeks * settings.repeat) * 1000.0
+			<< " }" << (useIndex ? "" : ",") << "\n";
+	}
+	json << "\t]\n";
+}
+
+
+void RunBenchmarks(std::ostream &out, std::ostream &log, const Settings &settings)
+//--------------------------------------------------------------------------------
+{
+	std::ostringstream json;
+	json.imbue(std::locale::classic());
+	json.precision(6);
+
+	json << "{\n";
+	json << "\t\"version\": \"" << MptVersion::GetVersionStringExtended() << "\",\n";
+#ifdef MPT_INTMIXER
+	json << "\t\"mixer\": \"integer\",\n";
+#else
+	json << "\t\"mixer\": \"float\",\n";
+#endif
+	json << "\t\"render_seconds\": " << settings.renderSeconds << ",\n";
+	json << "\t\"repeat\": " << settings.repeat << ",\n";
+
+	BenchLoad(json, log, settings);
+	BenchRender(json, log, settings);
+	BenchDSP(json, log, settings);
+	BenchMacros(json, log, settings);
+	BenchSeek(json, log, settings);
+
+	json << "}\n";
+	out << json.str();
+}
+
+
+} // namespace Bench
+
+
+OPENMPT_NAMESPACE_END
+
+
+#endif // ENABLE_TESTS
@@ -0,0 +1,32 @@
+/*
+ * bench.h
+ * -------
+ * Purpose: Benchmarks for module loading, rendering, DSP effects, MIDI macros and seeking.
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include <iosfwd>
+
+OPENMPT_NAMESPACE_BEGIN
+
+namespace Bench {
+
+struct Settings
+{
+	double renderSeconds;	// Length of audio rendered per measurement
+	uint32 repeat;			// Number of measurements per configuration, the fastest one is reported
+
+	Settings() : renderSeconds(5.0), repeat(3) { }
+};
+
+// Runs all benchmarks and writes the results as JSON to out. Progress is reported on log.
+void RunBenchmarks(std::ostream &out, std::ostream &log, const Settings &settings = Settings());
+
+} // namespace Bench
+
+OPENMPT_NAMESPACE_END
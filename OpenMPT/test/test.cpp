@@ -25,20 +25,30 @@
 #include "../soundlib/MIDIMacros.h"
 #include "../soundlib/SampleFormatConverters.h"
 #include "../soundlib/ITCompression.h"
+#include "../soundlib/SampleIO.h"
+#include "../soundlib/ITTools.h"
+#include "../soundlib/AudioReadTarget.h"
+#include "../soundlib/Dither.h"
+#include "TestModule.h"
 #ifdef MODPLUG_TRACKER
 #include "../mptrack/mptrack.h"
 #include "../mptrack/moddoc.h"
 #include "../mptrack/MainFrm.h"
 #include "../mptrack/Settings.h"
 #endif // MODPLUG_TRACKER
-#ifndef MODPLUG_TRACKER
+#ifdef LIBOPENMPT_BUILD
+#include "../libopenmpt/libopenmpt.hpp"
+#endif // LIBOPENMPT_BUILD
 #include "../common/mptFstream.h"
-#endif // !MODPLUG_TRACKER
 #include <limits>
+#include <map>
+#include <iostream>
 #include <istream>
+#include <iterator>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
+#include <cstdlib>
 #if MPT_OS_WINDOWS
 #include <windows.h>
 #endif
@@ -71,8 +81,26 @@ static noinline void TestStringIO();
 static noinline void TestMIDIEvents();
 static noinline void TestSampleConversion();
 static noinline void TestITCompression();
+static noinline void TestSampleReadQueue();
 static noinline void TestPCnoteSerialization();
 static noinline void TestLoadSaveFile();
+static noinline void TestMixerSIMD();
+static noinline void TestReverbRouting();
+static noinline void TestMixerThreads();
+static noinline void TestMixChunkSize();
+static noinline void TestVoiceSkipping();
+static noinline void TestSeekIndex();
+static noinline void TestSubsongDurations();
+static noinline void TestFileDataContainerMappedFile();
+static noinline void TestLoaderProbing();
+static noinline void TestMetadataOnlyLoading();
+static noinline void TestReferencedSamples();
+static noinline void TestResamplerTables();
+static noinline void TestMIDIMacroCompiler();
+static noinline void TestFilterCache();
+static noinline void TestVoiceSets();
+static noinline void TestPerfCounters();
+static noinline void TestRenderHashes();
 
 
 
@@ -111,10 +139,28 @@ void DoTests(std::string pathprefix)
 	DO_TEST(TestMIDIEvents);
 	DO_TEST(TestSampleConversion);
 	DO_TEST(TestITCompression);
+	DO_TEST(TestSampleReadQueue);
 
 	// slower tests, require opening a CModDoc
 	DO_TEST(TestPCnoteSerialization);
 	DO_TEST(TestLoadSaveFile);
+	DO_TEST(TestMixerSIMD);
+	DO_TEST(TestReverbRouting);
+	DO_TEST(TestMixerThreads);
+	DO_TEST(TestMixChunkSize);
+	DO_TEST(TestVoiceSkipping);
+	DO_TEST(TestSeekIndex);
+	DO_TEST(TestSubsongDurations);
+	DO_TEST(TestFileDataContainerMappedFile);
+	DO_TEST(TestLoaderProbing);
+	DO_TEST(TestMetadataOnlyLoading);
+	DO_TEST(TestReferencedSamples);
+	DO_TEST(TestResamplerTables);
+	DO_TEST(TestMIDIMacroCompiler);
+	DO_TEST(TestFilterCache);
+	DO_TEST(TestVoiceSets);
+	DO_TEST(TestPerfCounters);
+	DO_TEST(TestRenderHashes);
 
 	delete PathPrefix;
 	PathPrefix = nullptr;
@@ -1641,6 +1687,12 @@ static TSoundFileContainer CreateSoundFileContainer(const mpt::PathString &filen
 	return pModDoc;
 }
 
+static TSoundFileContainer CreateSoundFileContainer()
+{
+	CModDoc *pModDoc = (CModDoc *)theApp.GetModDocTemplate()->OpenDocumentFile(mpt::PathString(), FALSE);
+	return pModDoc;
+}
+
 static void DestroySoundFileContainer(TSoundFileContainer &sndFile)
 {
 	sndFile->OnCloseDocument();
@@ -1700,6 +1752,11 @@ static TSoundFileContainer CreateSoundFileContainer(const mpt::PathString &filen
 	return pSndFile;
 }
 
+static TSoundFileContainer CreateSoundFileContainer()
+{
+	return std::shared_ptr<CSoundFile>(new CSoundFile());
+}
+
 static void DestroySoundFileContainer(TSoundFileContainer & /* sndFile */ )
 {
 	return;
@@ -1830,6 +1887,1466 @@ static noinline void TestLoadSaveFile()
 }
 
 
+// Collects the raw mixer output of CSoundFile::Read
+class TestAudioReadTarget : public IAudioReadTarget
+{
+public:
+	std::vector<int> output;
+	virtual void DataCallback(mixsample_t *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
+	{
+#ifdef MPT_INTMIXER
+		output.insert(output.end(), MixSoundBuffer, MixSoundBuffer + channels * countChunk);
+#else
+		// Compare in fixed point, so that the tests work the same for both mixers
+		for(std::size_t i = 0; i < channels * countChunk; i++)
+		{
+			output.push_back(static_cast<int>(MixSoundBuffer[i] * MIXING_SCALEF));
+		}
+#endif // MPT_INTMIXER
+	}
+};
+
+
+static void RenderTestFile(std::vector<int> &output, const mpt::PathString &filename, ResamplingMode srcMode, bool simd, DWORD DSPMask = 0, uint32 mixerThreads = 1)
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer(filename);
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+
+	MixerSettings mixerSettings = GetMixerSettings(sndFile);
+	if(simd)
+		mixerSettings.MixerFlags &= ~SNDMIX_NOSIMD;
+	else
+		mixerSettings.MixerFlags |= SNDMIX_NOSIMD;
+	mixerSettings.DSPMask = DSPMask;
+	mixerSettings.NumMixerThreads = mixerThreads;
+	SetMixerSettings(sndFile, mixerSettings, srcMode);
+#ifndef NO_EQ
+	if(DSPMask & SNDDSP_EQ)
+	{
+		// Boost bass and treble, cut the mids
+		static const UINT gains[MAX_EQ_BANDS] = { 28, 22, 8, 12, 24, 30 };
+		static const UINT freqs[MAX_EQ_BANDS] = { 120, 600, 1200, 3000, 6000, 10000 };
+		sndFile.SetEQGains(gains, MAX_EQ_BANDS, freqs, true);
+	}
+#endif // NO_EQ
+
+	TestAudioReadTarget target;
+	sndFile.Read(44100 * 2, target);
+	output.swap(target.output);
+
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+
+// Largest difference between two renderings of the same module
+static int MaxRenderDifference(const std::vector<int> &output1, const std::vector<int> &output2)
+//---------------------------------------------------------------------------------------------
+{
+	VERIFY_EQUAL_NONCONT(output1.size(), output2.size());
+	int maxDiff = 0;
+	for(std::size_t i = 0; i < std::min(output1.size(), output2.size()); i++)
+	{
+		maxDiff = std::max(maxDiff, std::abs(output1[i] - output2[i]));
+	}
+	return maxDiff;
+}
+
+
+// Render a module with many simultaneously playing voices, generated on the fly
+static void RenderDenseModule(std::vector<int> &output, ResamplingMode srcMode, bool simd, DWORD DSPMask, uint32 mixerThreads, uint32 mixBufferSize = MIXBUFFERSIZE)
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	CreateModule(sndFile, MOD_TYPE_IT, 24);
+
+	Random rng(1);
+	const uint32 sampleFlags[] = { CHN_LOOP, CHN_16BIT | CHN_LOOP, CHN_16BIT | CHN_STEREO | CHN_LOOP | CHN_PINGPONGLOOP };
+	for(uint32 i = 1; i <= CountOf(sampleFlags); i++)
+	{
+		SampleSpec spec(1000 + i * 700, sampleFlags[i - 1], 11025 * i);
+		spec.loopStart = 100 * i;
+		AddSample(sndFile, spec, rng);
+	}
+
+	for(ROWINDEX row = 0; row < 64; row += 2)
+	{
+		for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+		{
+			if((row / 2 + chn) % 5 == 0)
+			{
+				continue;
+			}
+			ModCommand &m = *sndFile.Patterns[0].GetpModCommand(row, chn);
+			m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 30 + (row * 7 + chn * 5) % 60);
+			m.instr = static_cast<ModCommand::INSTR>(1 + (row + chn) % sndFile.GetNumSamples());
+			m.volcmd = VOLCMD_VOLUME;
+			m.vol = static_cast<ModCommand::VOL>((row + chn * 3) % 65);
+			if(chn % 7 == 3)
+			{
+				// Resonant filter
+				m.command = CMD_MIDI;
+				m.param = static_cast<ModCommand::PARAM>(0x20 + (row * 3) % 0x60);
+			} else if(chn % 7 == 5)
+			{
+				// Surround
+				m.command = CMD_S3MCMDEX;
+				m.param = 0x91;
+			}
+		}
+	}
+
+	MixerSettings mixerSettings = GetMixerSettings(sndFile);
+	if(simd)
+		mixerSettings.MixerFlags &= ~SNDMIX_NOSIMD;
+	else
+		mixerSettings.MixerFlags |= SNDMIX_NOSIMD;
+	mixerSettings.DSPMask = DSPMask;
+	mixerSettings.NumMixerThreads = mixerThreads;
+	mixerSettings.MixBufferSize = mixBufferSize;
+	SetMixerSettings(sndFile, mixerSettings, srcMode);
+
+	TestAudioReadTarget target;
+	sndFile.Read(44100 * 4, target);
+	output.swap(target.output);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+
+// Test that the vectorized mixer produces exactly the same output as the scalar mixer
+static noinline void TestMixerSIMD()
+//----------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+	const mpt::PathString filenameBase = GetTestFilenameBase();
+	const mpt::PathString extensions[] = { MPT_PATHSTRING("xm"), MPT_PATHSTRING("s3m"), MPT_PATHSTRING("mptm") };
+	const ResamplingMode srcModes[] = { SRCMODE_NEAREST, SRCMODE_LINEAR, SRCMODE_SPLINE, SRCMODE_POLYPHASE, SRCMODE_FIRFILTER };
+
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		for(std::size_t mode = 0; mode < CountOf(srcModes); mode++)
+		{
+			std::vector<int> scalarOutput, simdOutput;
+			RenderTestFile(scalarOutput, filenameBase + extensions[ext], srcModes[mode], false);
+			RenderTestFile(simdOutput, filenameBase + extensions[ext], srcModes[mode], true);
+			VERIFY_EQUAL_NONCONT(scalarOutput.empty(), false);
+#ifdef MPT_INTMIXER
+			VERIFY_EQUAL_NONCONT(scalarOutput == simdOutput, true);
+#else
+			// The vectorized floating point interpolation adds up the filter taps in a different order
+			VERIFY_EQUAL_NONCONT(MaxRenderDifference(scalarOutput, simdOutput) < (MIXING_CLIPMAX >> 16), true);
+#endif // MPT_INTMIXER
+		}
+	}
+
+	// Only test.s3m is audible, so also compare a dense generated module with 8-bit and 16-bit, mono and stereo voices
+	for(std::size_t mode = 0; mode < CountOf(srcModes); mode++)
+	{
+		std::vector<int> scalarOutput, simdOutput;
+		RenderDenseModule(scalarOutput, srcModes[mode], false, 0, 1);
+		RenderDenseModule(simdOutput, srcModes[mode], true, 0, 1);
+		VERIFY_EQUAL_NONCONT(std::count(scalarOutput.begin(), scalarOutput.end(), 0) != static_cast<std::ptrdiff_t>(scalarOutput.size()), true);
+#ifdef MPT_INTMIXER
+		VERIFY_EQUAL_NONCONT(scalarOutput == simdOutput, true);
+#else
+		VERIFY_EQUAL_NONCONT(MaxRenderDifference(scalarOutput, simdOutput) < (MIXING_CLIPMAX >> 16), true);
+#endif // MPT_INTMIXER
+	}
+
+#ifndef NO_REVERB
+	// Reverb
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		std::vector<int> dryOutput, scalarOutput, simdOutput;
+		RenderTestFile(dryOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, true);
+		RenderTestFile(scalarOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, false, SNDDSP_REVERB);
+		RenderTestFile(simdOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, true, SNDDSP_REVERB);
+		// Some of the test modules are silent at the beginning, so only expect the reverb to be audible if the dry signal is.
+		if(std::count(dryOutput.begin(), dryOutput.end(), 0) != static_cast<std::ptrdiff_t>(dryOutput.size()))
+		{
+			VERIFY_EQUAL_NONCONT(dryOutput == scalarOutput, false);
+		}
+		VERIFY_EQUAL_NONCONT(scalarOutput == simdOutput, true);
+	}
+#endif // NO_REVERB
+
+#ifndef NO_DSP
+	// Bass expansion and surround
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		std::vector<int> dryOutput, scalarOutput, simdOutput;
+		RenderTestFile(dryOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, true);
+		RenderTestFile(scalarOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, false, SNDDSP_MEGABASS | SNDDSP_SURROUND);
+		RenderTestFile(simdOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, true, SNDDSP_MEGABASS | SNDDSP_SURROUND);
+		if(std::count(dryOutput.begin(), dryOutput.end(), 0) != static_cast<std::ptrdiff_t>(dryOutput.size()))
+		{
+			VERIFY_EQUAL_NONCONT(dryOutput == scalarOutput, false);
+		}
+		VERIFY_EQUAL_NONCONT(scalarOutput == simdOutput, true);
+	}
+#endif // NO_DSP
+
+#ifndef NO_EQ
+	// Equalizer
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		std::vector<int> dryOutput, scalarOutput, simdOutput;
+		RenderTestFile(dryOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, true);
+		RenderTestFile(scalarOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, false, SNDDSP_EQ);
+		RenderTestFile(simdOutput, filenameBase + extensions[ext], SRCMODE_LINEAR, true, SNDDSP_EQ);
+		if(std::count(dryOutput.begin(), dryOutput.end(), 0) != static_cast<std::ptrdiff_t>(dryOutput.size()))
+		{
+			VERIFY_EQUAL_NONCONT(dryOutput == scalarOutput, false);
+		}
+#if defined(__FAST_MATH__) || defined(_M_FP_FAST)
+		// Both versions evaluate the same float operations in the same order, but optimized builds use -ffast-math or /fp:fast,
+		// which allows the compiler to reassociate the scalar filter expression. The intrinsics are evaluated as written.
+		VERIFY_EQUAL_NONCONT(MaxRenderDifference(scalarOutput, simdOutput) < (MIXING_CLIPMAX >> 14), true);
+#else
+		VERIFY_EQUAL_NONCONT(scalarOutput == simdOutput, true);
+#endif
+	}
+#endif // NO_EQ
+}
+
+
+#ifndef NO_REVERB
+
+// Render a single looped voice, optionally with an S9x command on its first row
+static void RenderReverbModule(std::vector<int> &output, DWORD DSPMask, ModCommand::PARAM extendedParam)
+//------------------------------------------------------------------------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	CreateModule(sndFile, MOD_TYPE_IT, 1);
+
+	Random rng(1);
+	AddSample(sndFile, SampleSpec(2000, CHN_16BIT | CHN_LOOP, 22050), rng);
+
+	ModCommand &m = *sndFile.Patterns[0].GetpModCommand(0, 0);
+	m.note = NOTE_MIDDLEC;
+	m.instr = 1;
+	if(extendedParam)
+	{
+		m.command = CMD_S3MCMDEX;
+		m.param = extendedParam;
+	}
+
+	MixerSettings mixerSettings = GetMixerSettings(sndFile);
+	mixerSettings.DSPMask = DSPMask;
+	SetMixerSettings(sndFile, mixerSettings, SRCMODE_LINEAR);
+
+	TestAudioReadTarget target;
+	sndFile.Read(44100, target);
+	output.swap(target.output);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+#endif // NO_REVERB
+
+
+// Test which voices are sent to the reverb
+static noinline void TestReverbRouting()
+//--------------------------------------
+{
+#ifndef NO_REVERB
+	std::vector<int> dryOutput, output;
+	RenderReverbModule(dryOutput, 0, 0);
+	VERIFY_EQUAL_NONCONT(std::count(dryOutput.begin(), dryOutput.end(), 0) != static_cast<std::ptrdiff_t>(dryOutput.size()), true);
+
+	// Global reverb
+	RenderReverbModule(output, SNDDSP_REVERB, 0);
+	VERIFY_EQUAL_NONCONT(dryOutput == output, false);
+
+	// S98 excludes the channel from the global reverb
+	RenderReverbModule(output, SNDDSP_REVERB, 0x98);
+	VERIFY_EQUAL_NONCONT(dryOutput == output, true);
+
+	// S99 sends the channel to the reverb even if the global reverb is disabled
+	RenderReverbModule(output, 0, 0x99);
+	VERIFY_EQUAL_NONCONT(dryOutput == output, false);
+	std::vector<int> globalOutput;
+	RenderReverbModule(globalOutput, SNDDSP_REVERB, 0x99);
+	VERIFY_EQUAL_NONCONT(globalOutput == output, true);
+#endif // NO_REVERB
+}
+
+
+// Test that mixing voices in parallel produces exactly the same output as mixing them in one thread
+static noinline void TestMixerThreads()
+//-------------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	const ResamplingMode denseSrcModes[] = { SRCMODE_NEAREST, SRCMODE_LINEAR, SRCMODE_SPLINE, SRCMODE_POLYPHASE, SRCMODE_FIRFILTER };
+	for(std::size_t mode = 0; mode < CountOf(denseSrcModes); mode++)
+	{
+		std::vector<int> serialOutput, parallelOutput;
+		RenderDenseModule(serialOutput, denseSrcModes[mode], true, 0, 1);
+		VERIFY_EQUAL_NONCONT(std::count(serialOutput.begin(), serialOutput.end(), 0) != static_cast<std::ptrdiff_t>(serialOutput.size()), true);
+		RenderDenseModule(parallelOutput, denseSrcModes[mode], true, 0, 2);
+		VERIFY_EQUAL_NONCONT(serialOutput == parallelOutput, true);
+		RenderDenseModule(parallelOutput, denseSrcModes[mode], true, 0, 5);
+		VERIFY_EQUAL_NONCONT(serialOutput == parallelOutput, true);
+#ifndef NO_REVERB
+		// Voices with reverb are mixed in the calling thread
+		RenderDenseModule(serialOutput, denseSrcModes[mode], false, SNDDSP_REVERB, 1);
+		RenderDenseModule(parallelOutput, denseSrcModes[mode], false, SNDDSP_REVERB, 3);
+		VERIFY_EQUAL_NONCONT(serialOutput == parallelOutput, true);
+#endif // NO_REVERB
+	}
+
+	// Modules with only a few voices are mixed in the calling thread
+	const mpt::PathString filenameBase = GetTestFilenameBase();
+	const mpt::PathString extensions[] = { MPT_PATHSTRING("xm"), MPT_PATHSTRING("s3m"), MPT_PATHSTRING("mptm") };
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		std::vector<int> serialOutput, parallelOutput;
+		RenderTestFile(serialOutput, filenameBase + extensions[ext], SRCMODE_POLYPHASE, true);
+		RenderTestFile(parallelOutput, filenameBase + extensions[ext], SRCMODE_POLYPHASE, true, 0, 2);
+		VERIFY_EQUAL_NONCONT(serialOutput == parallelOutput, true);
+	}
+}
+
+
+// Test that the mix chunk size has no influence on the output
+static noinline void TestMixChunkSize()
+//-------------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	const uint32 chunkSizes[] = { MIXBUFFERSIZE_MIN, 100, 4096, MIXBUFFERSIZE_MAX };
+	const DWORD dspMasks[] = { 0, SNDDSP_REVERB, SNDDSP_MEGABASS | SNDDSP_SURROUND };
+	for(std::size_t dsp = 0; dsp < CountOf(dspMasks); dsp++)
+	{
+		std::vector<int> refOutput, output;
+		RenderDenseModule(refOutput, SRCMODE_POLYPHASE, true, dspMasks[dsp], 1);
+		for(std::size_t size = 0; size < CountOf(chunkSizes); size++)
+		{
+			RenderDenseModule(output, SRCMODE_POLYPHASE, true, dspMasks[dsp], 1, chunkSizes[size]);
+			VERIFY_EQUAL_NONCONT(refOutput == output, true);
+		}
+	}
+
+	// Worker thread buffers are resized as well
+	std::vector<int> refOutput, output;
+	RenderDenseModule(refOutput, SRCMODE_FIRFILTER, true, 0, 1);
+	RenderDenseModule(output, SRCMODE_FIRFILTER, true, 0, 3, 4096);
+	VERIFY_EQUAL_NONCONT(refOutput == output, true);
+}
+
+
+// Render a module whose samples contain long silent and very quiet parts
+static uint64 RenderQuietModule(std::vector<int> &output, ResamplingMode srcMode, DWORD mixerFlags, int32 skipThreshold)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	CreateModule(sndFile, MOD_TYPE_IT, 8);
+
+	Random rng(1);
+	const uint32 sampleFlags[] = { CHN_16BIT | CHN_LOOP, CHN_STEREO | CHN_LOOP };
+	for(uint32 i = 1; i <= CountOf(sampleFlags); i++)
+	{
+		// Loud start, then silence, then a quiet tail (-42 dB)
+		SampleSpec spec(6000 * i, sampleFlags[i - 1], 8363 * i);
+		spec.loopStart = spec.length / 2;
+		spec.silenceStart = spec.length / 4;
+		spec.silenceEnd = spec.length * 3 / 4;
+		spec.tailShift = 7;
+		AddSample(sndFile, spec, rng);
+	}
+
+	for(ROWINDEX row = 0; row < 64; row += 8)
+	{
+		for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+		{
+			ModCommand &m = *sndFile.Patterns[0].GetpModCommand(row + chn % 4, chn);
+			m.note = static_cast<ModCommand::NOTE>(NOTE_MIDDLEC - 24 + (row + chn * 5) % 48);
+			m.instr = static_cast<ModCommand::INSTR>(1 + chn % 2);
+			m.volcmd = VOLCMD_VOLUME;
+			m.vol = static_cast<ModCommand::VOL>(16 + (row + chn * 7) % 49);
+			if(chn % 4 == 3)
+			{
+				// Resonant filter
+				m.command = CMD_MIDI;
+				m.param = static_cast<ModCommand::PARAM>(0x30 + row);
+			}
+		}
+	}
+
+	MixerSettings mixerSettings = GetMixerSettings(sndFile);
+	mixerSettings.MixerFlags = mixerFlags;
+	mixerSettings.VoiceSkipThreshold = skipThreshold;
+	SetMixerSettings(sndFile, mixerSettings, srcMode);
+
+	TestAudioReadTarget target;
+	sndFile.Read(44100 * 4, target);
+	output.swap(target.output);
+	const uint64 skipped = sndFile.GetSkippedVoiceFrames();
+	DestroySoundFileContainer(sndFileContainer);
+	return skipped;
+}
+
+
+// Test that voices with silent sample data are not mixed, without changing the output
+static noinline void TestVoiceSkipping()
+//--------------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	const ResamplingMode srcModes[] = { SRCMODE_NEAREST, SRCMODE_LINEAR, SRCMODE_SPLINE, SRCMODE_POLYPHASE, SRCMODE_FIRFILTER };
+	for(std::size_t mode = 0; mode < CountOf(srcModes); mode++)
+	{
+		std::vector<int> refOutput, output;
+		VERIFY_EQUAL_NONCONT(RenderQuietModule(refOutput, srcModes[mode], SNDMIX_NOVOICESKIP, 0), 0u);
+		VERIFY_EQUAL_NONCONT(RenderQuietModule(output, srcModes[mode], 0, 0) > 0, true);
+		VERIFY_EQUAL_NONCONT(refOutput == output, true);
+		std::vector<int> scalarOutput;
+		RenderQuietModule(scalarOutput, srcModes[mode], SNDMIX_NOSIMD | SNDMIX_NOVOICESKIP, 0);
+		VERIFY_EQUAL_NONCONT(RenderQuietModule(output, srcModes[mode], SNDMIX_NOSIMD, 0) > 0, true);
+		VERIFY_EQUAL_NONCONT(scalarOutput == output, true);
+
+		// With a threshold, quiet parts are skipped as well, and each voice may be off by up to the threshold level.
+		const uint64 skippedSilent = RenderQuietModule(output, srcModes[mode], 0, 0);
+		VERIFY_EQUAL_NONCONT(RenderQuietModule(output, srcModes[mode], 0, -40) > skippedSilent, true);
+		VERIFY_EQUAL_NONCONT(MaxRenderDifference(refOutput, output) <= 8 * static_cast<int>(MIXING_SCALEF / 100), true);
+	}
+}
+
+
+static void CompareSeekResults(CSoundFile &sndFileRef, CSoundFile &sndFileIndexed, enmGetLengthResetMode adjustMode, GetLengthTarget target)
+//-----------------------------------------------------------------------------------------------------------------------------------------
+{
+	const GetLengthType ref = sndFileRef.GetLength(adjustMode, target);
+	const GetLengthType indexed = sndFileIndexed.GetLength(adjustMode, target);
+	VERIFY_EQUAL_NONCONT(indexed.duration, ref.duration);
+	VERIFY_EQUAL_NONCONT(indexed.targetReached, ref.targetReached);
+	VERIFY_EQUAL_NONCONT(indexed.lastOrder, ref.lastOrder);
+	VERIFY_EQUAL_NONCONT(indexed.lastRow, ref.lastRow);
+	if(target.mode == GetLengthTarget::NoTarget)
+	{
+		VERIFY_EQUAL_NONCONT(indexed.endOrder, ref.endOrder);
+		VERIFY_EQUAL_NONCONT(indexed.endRow, ref.endRow);
+	}
+	if(adjustMode & eAdjust)
+	{
+		VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.m_nMusicSpeed, sndFileRef.m_PlayState.m_nMusicSpeed);
+		VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.m_nMusicTempo, sndFileRef.m_PlayState.m_nMusicTempo);
+		VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.m_nGlobalVolume, sndFileRef.m_PlayState.m_nGlobalVolume);
+		for(CHANNELINDEX chn = 0; chn < sndFileRef.GetNumChannels(); chn++)
+		{
+			VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.Chn[chn].nGlobalVol, sndFileRef.m_PlayState.Chn[chn].nGlobalVol);
+			VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.Chn[chn].nVolume, sndFileRef.m_PlayState.Chn[chn].nVolume);
+			VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.Chn[chn].nNewNote, sndFileRef.m_PlayState.Chn[chn].nNewNote);
+			VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.Chn[chn].nNewIns, sndFileRef.m_PlayState.Chn[chn].nNewIns);
+			VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.Chn[chn].nOldOffset, sndFileRef.m_PlayState.Chn[chn].nOldOffset);
+			VERIFY_EQUAL_NONCONT(sndFileIndexed.m_PlayState.Chn[chn].nOldVolumeSlide, sndFileRef.m_PlayState.Chn[chn].nOldVolumeSlide);
+		}
+	}
+}
+
+
+// Test that seeking with the help of the seek index gives the same results as seeking from the beginning of the song
+static noinline void TestSeekIndex()
+//----------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+	const mpt::PathString filenameBase = GetTestFilenameBase();
+	const mpt::PathString extensions[] = { MPT_PATHSTRING("xm"), MPT_PATHSTRING("s3m"), MPT_PATHSTRING("mptm") };
+
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		TSoundFileContainer containerRef = CreateSoundFileContainer(filenameBase + extensions[ext]);
+		TSoundFileContainer containerIndexed = CreateSoundFileContainer(filenameBase + extensions[ext]);
+		CSoundFile &sndFileRef = GetrSoundFile(containerRef);
+		CSoundFile &sndFileIndexed = GetrSoundFile(containerIndexed);
+		sndFileRef.SetSeekIndexInterval(0);
+		// Use a very short interval so that there are many checkpoints even in short test modules.
+		sndFileIndexed.SetSeekIndexInterval(1);
+
+		// Seek before the index has been built, then build the index while calculating the song length
+		CompareSeekResults(sndFileRef, sndFileIndexed, eNoAdjust, GetLengthTarget(1.0));
+		CompareSeekResults(sndFileRef, sndFileIndexed, eNoAdjust, GetLengthTarget());
+		VERIFY_EQUAL_NONCONT(sndFileIndexed.GetSeekIndexMemoryUsage() > 0, true);
+		VERIFY_EQUAL_NONCONT(sndFileRef.GetSeekIndexMemoryUsage(), 0);
+
+		const double duration = sndFileRef.GetLength(eNoAdjust).duration;
+		for(int i = 0; i <= 10; i++)
+		{
+			const double seconds = duration * i / 8.0;
+			CompareSeekResults(sndFileRef, sndFileIndexed, eNoAdjust, GetLengthTarget(seconds));
+			CompareSeekResults(sndFileRef, sndFileIndexed, eAdjust, GetLengthTarget(seconds));
+		}
+
+		for(ORDERINDEX ord = 0; ord < sndFileRef.Order.GetLengthTailTrimmed(); ord++)
+		{
+			const PATTERNINDEX pat = sndFileRef.Order[ord];
+			const ROWINDEX numRows = sndFileRef.Patterns.IsValidPat(pat) ? sndFileRef.Patterns[pat].GetNumRows() : 1;
+			const ROWINDEX rows[] = { 0, numRows / 2, numRows - 1 };
+			for(std::size_t row = 0; row < CountOf(rows); row++)
+			{
+				CompareSeekResults(sndFileRef, sndFileIndexed, eNoAdjust, GetLengthTarget(ord, rows[row]));
+				CompareSeekResults(sndFileRef, sndFileIndexed, eAdjust, GetLengthTarget(ord, rows[row]));
+			}
+		}
+
+		CompareSeekResults(sndFileRef, sndFileIndexed, eAdjust, GetLengthTarget());
+
+		// Changing the interval throws away the index
+		sndFileIndexed.SetSeekIndexInterval(0);
+		VERIFY_EQUAL_NONCONT(sndFileIndexed.GetSeekIndexMemoryUsage(), 0);
+
+		DestroySoundFileContainer(containerIndexed);
+		DestroySoundFileContainer(containerRef);
+	}
+}
+
+
+// Test that the durations of all subsongs returned by libopenmpt match the durations of the individually selected subsongs,
+// and that seeking in the current subsong is still correct after they have been calculated.
+static noinline void TestSubsongDurations()
+//-----------------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+#ifdef LIBOPENMPT_BUILD
+	// The MPTM test file contains two sequences, which are exposed as subsongs
+	mpt::ifstream stream(GetTestFilenameBase() + MPT_PATHSTRING("mptm"), std::ios::binary);
+	const std::vector<char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	VERIFY_EQUAL_NONCONT(data.empty(), false);
+	std::ostringstream log;
+
+	openmpt::module mod(data, log);
+	VERIFY_EQUAL_NONCONT(mod.get_num_subsongs(), 2);
+	mod.select_subsong(1);
+	const std::vector<double> durations = mod.get_subsong_durations_seconds();
+	VERIFY_EQUAL_NONCONT(durations.size(), 2u);
+	for(std::size_t i = 0; i < durations.size(); i++)
+	{
+		openmpt::module modRef(data, log);
+		modRef.select_subsong(static_cast<std::int32_t>(i));
+		VERIFY_EQUAL_NONCONT(durations[i] > 0.0, true);
+		VERIFY_EQUAL_EPS(durations[i], modRef.get_duration_seconds(), 1e-9);
+	}
+	VERIFY_EQUAL_EPS(mod.get_duration_seconds(), durations[1], 1e-9);
+
+	// Seeking must still happen in the selected subsong
+	openmpt::module modRef(data, log);
+	modRef.select_subsong(1);
+	const double targets[] = { durations[1] * 0.5, durations[1] * 0.25, durations[1] * 0.75, 0.0 };
+	for(std::size_t i = 0; i < CountOf(targets); i++)
+	{
+		VERIFY_EQUAL_EPS(mod.set_position_seconds(targets[i]), modRef.set_position_seconds(targets[i]), 1e-9);
+		VERIFY_EQUAL_EPS(mod.get_position_seconds(), modRef.get_position_seconds(), 1e-9);
+		VERIFY_EQUAL_NONCONT(mod.get_current_order(), modRef.get_current_order());
+		VERIFY_EQUAL_NONCONT(mod.get_current_row(), modRef.get_current_row());
+	}
+	VERIFY_EQUAL_EPS(mod.get_duration_seconds(), durations[1], 1e-9);
+#endif // LIBOPENMPT_BUILD
+}
+
+
+static noinline void TestFileDataContainerMappedFile()
+//----------------------------------------------------
+{
+#if defined(MPT_FILEREADER_MMAP)
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+	const mpt::PathString filename = GetTestFilenameBase() + MPT_PATHSTRING("xm");
+
+	mpt::ifstream stream(filename, std::ios::binary);
+	FileReader streamFile(&stream);
+	MPT_SHARED_PTR<IFileDataContainer> mapping(new FileDataContainerMappedFile(filename.AsNative().c_str()));
+	VERIFY_EQUAL_NONCONT(mapping->IsValid(), true);
+	FileReader mappedFile(mapping);
+	VERIFY_EQUAL_NONCONT(mappedFile.GetLength(), streamFile.GetLength());
+	VERIFY_EQUAL_NONCONT(memcmp(mappedFile.GetRawData(), streamFile.GetRawData(), mappedFile.GetLength()), 0);
+
+	// Windows into the mapping read directly from the mapped file
+	FileReader chunk = mappedFile.GetChunk(17, 20);
+	VERIFY_EQUAL_NONCONT(chunk.GetRawData(), mappedFile.GetRawData() + 17);
+
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	VERIFY_EQUAL_NONCONT(sndFile.Create(mappedFile, CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL_NONCONT(sndFile.GetType(), MOD_TYPE_XM);
+	DestroySoundFileContainer(sndFileContainer);
+
+	// Files that cannot be mapped
+	VERIFY_EQUAL_NONCONT(FileDataContainerMappedFile((filename + MPT_PATHSTRING(".does-not-exist")).AsNative().c_str()).IsValid(), false);
+	VERIFY_EQUAL_NONCONT(FileDataContainerMappedFile(".").IsValid(), false);
+#endif // MPT_FILEREADER_MMAP
+}
+
+
+static noinline void TestLoaderProbing()
+//--------------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+	const mpt::PathString filenameBase = GetTestFilenameBase();
+
+	{
+		mpt::ifstream stream(filenameBase + MPT_PATHSTRING("xm"), std::ios::binary);
+		FileReader file(&stream);
+		VERIFY_EQUAL_NONCONT(CSoundFile::Probe(file).confidence, CSoundFile::ProbeSuccess);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderXM(file).confidence, CSoundFile::ProbeSuccess);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderS3M(file).confidence, CSoundFile::ProbeFailure);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderIT(file).confidence, CSoundFile::ProbeFailure);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderMOD(file).confidence, CSoundFile::ProbeFailure);
+		// Probing does not move the file position
+		VERIFY_EQUAL_NONCONT(file.GetPosition(), 0u);
+
+		// Truncated header
+		FileReader truncated = file.GetChunk(0, 16);
+		const CSoundFile::ProbeResult result = CSoundFile::Probe(truncated);
+		VERIFY_EQUAL_NONCONT(result.confidence, CSoundFile::ProbeFailure);
+		VERIFY_EQUAL_NONCONT(result.requiredBytes > 16, true);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderXM(truncated).requiredBytes > 16, true);
+	}
+	{
+		mpt::ifstream stream(filenameBase + MPT_PATHSTRING("s3m"), std::ios::binary);
+		FileReader file(&stream);
+		VERIFY_EQUAL_NONCONT(CSoundFile::Probe(file).confidence, CSoundFile::ProbeSuccess);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderS3M(file).confidence, CSoundFile::ProbeSuccess);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderXM(file).confidence, CSoundFile::ProbeFailure);
+	}
+	{
+		mpt::ifstream stream(filenameBase + MPT_PATHSTRING("mptm"), std::ios::binary);
+		FileReader file(&stream);
+		VERIFY_EQUAL_NONCONT(CSoundFile::Probe(file).confidence, CSoundFile::ProbeSuccess);
+		VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderIT(file).confidence, CSoundFile::ProbeSuccess);
+	}
+
+	// Nothing accepts an empty file or zeroes
+	VERIFY_EQUAL_NONCONT(CSoundFile::Probe(FileReader()).confidence, CSoundFile::ProbeFailure);
+	std::vector<char> data(1084 + 64 * 4 * 4, 0);
+	VERIFY_EQUAL_NONCONT(CSoundFile::Probe(FileReader(&data[0], data.size())).confidence, CSoundFile::ProbeFailure);
+
+	// A file that only passes the 669 header checks is a weak match, which is still accepted by the header checks in libopenmpt
+	data[0] = 'i';
+	data[1] = 'f';
+	data[950] = 1;
+	VERIFY_EQUAL_NONCONT(CSoundFile::Probe(FileReader(&data[0], data.size())).confidence, CSoundFile::ProbeWeak);
+#ifdef LIBOPENMPT_BUILD
+	{
+		const double efforts[] = { 0.2, 0.3, 0.5, 0.59 };
+		const std::string weakData(data.begin(), data.end()), zeroData(data.size(), 0);
+		std::ostringstream log;
+		for(std::size_t i = 0; i < CountOf(efforts); i++)
+		{
+			std::istringstream weakStream(weakData), zeroStream(zeroData);
+			VERIFY_EQUAL_NONCONT(openmpt::could_open_propability(weakStream, efforts[i], log), 0.6);
+			VERIFY_EQUAL_NONCONT(openmpt::could_open_propability(zeroStream, efforts[i], log), 0.0);
+		}
+	}
+#endif // LIBOPENMPT_BUILD
+
+	// A file that passes the 669 header checks but also has MOD magic bytes is loaded by the loader with the stronger match
+	memcpy(&data[1080], "M.K.", 4);
+	FileReader file(&data[0], data.size());
+	VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeader669(file).confidence, CSoundFile::ProbeWeak);
+	VERIFY_EQUAL_NONCONT(CSoundFile::ProbeFileHeaderMOD(file).confidence, CSoundFile::ProbeSuccess);
+	VERIFY_EQUAL_NONCONT(CSoundFile::Probe(file).confidence, CSoundFile::ProbeSuccess);
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	VERIFY_EQUAL_NONCONT(sndFile.Create(file, CSoundFile::loadCompleteModule), true);
+	VERIFY_EQUAL_NONCONT(sndFile.GetType(), MOD_TYPE_MOD);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+
+static noinline void TestMetadataOnlyLoading()
+//--------------------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+	const mpt::PathString filenameBase = GetTestFilenameBase();
+	const mpt::PathString extensions[] = { MPT_PATHSTRING("xm"), MPT_PATHSTRING("s3m"), MPT_PATHSTRING("mptm") };
+
+	for(size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		mpt::ifstream stream(filenameBase + extensions[ext], std::ios::binary);
+		FileReader file(&stream);
+		TSoundFileContainer completeContainer = CreateSoundFileContainer();
+		TSoundFileContainer metadataContainer = CreateSoundFileContainer();
+		CSoundFile &complete = GetrSoundFile(completeContainer);
+		CSoundFile &metadata = GetrSoundFile(metadataContainer);
+		VERIFY_EQUAL_NONCONT(complete.Create(file, CSoundFile::loadCompleteModule), true);
+		VERIFY_EQUAL_NONCONT(metadata.Create(file, CSoundFile::loadMetadataOnly), true);
+
+		VERIFY_EQUAL_NONCONT(metadata.GetType(), complete.GetType());
+		VERIFY_EQUAL_NONCONT(metadata.GetTitle(), complete.GetTitle());
+		VERIFY_EQUAL_NONCONT(metadata.madeWithTracker, complete.madeWithTracker);
+		VERIFY_EQUAL_NONCONT(metadata.songArtist, complete.songArtist);
+		VERIFY_EQUAL_NONCONT(metadata.songMessage.GetFormatted(SongMessage::leLF), complete.songMessage.GetFormatted(SongMessage::leLF));
+		VERIFY_EQUAL_NONCONT(metadata.GetNumChannels(), complete.GetNumChannels());
+		VERIFY_EQUAL_NONCONT(metadata.GetNumSamples(), complete.GetNumSamples());
+		VERIFY_EQUAL_NONCONT(metadata.GetNumInstruments(), complete.GetNumInstruments());
+		for(CHANNELINDEX chn = 0; chn < complete.GetNumChannels(); chn++)
+		{
+			VERIFY_EQUAL_NONCONT(std::string(metadata.ChnSettings[chn].szName), std::string(complete.ChnSettings[chn].szName));
+		}
+		for(SAMPLEINDEX smp = 1; smp <= complete.GetNumSamples(); smp++)
+		{
+			VERIFY_EQUAL_NONCONT(std::string(metadata.GetSampleName(smp)), std::string(complete.GetSampleName(smp)));
+			// No sample data is decoded
+			VERIFY_EQUAL_NONCONT(metadata.GetSample(smp).pSample == nullptr, true);
+		}
+		for(INSTRUMENTINDEX ins = 1; ins <= complete.GetNumInstruments(); ins++)
+		{
+			VERIFY_EQUAL_NONCONT(std::string(metadata.GetInstrumentName(ins)), std::string(complete.GetInstrumentName(ins)));
+		}
+
+		DestroySoundFileContainer(completeContainer);
+		DestroySoundFileContainer(metadataContainer);
+	}
+}
+
+
+#ifndef MODPLUG_NO_FILESAVE
+
+static void RenderReferencedSamplesFile(std::vector<int> &output, const char *data, std::size_t size, bool referenceSamples, ResamplingMode srcMode)
+//------------------------------------------------------------------------------------------------------------------------------------------------
+{
+	FileReader file(data, size);
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	const int loadFlags = CSoundFile::loadCompleteModule | (referenceSamples ? CSoundFile::referenceSampleData : 0);
+	VERIFY_EQUAL_NONCONT(sndFile.Create(file, static_cast<CSoundFile::ModLoadingFlags>(loadFlags)), true);
+
+	// Everything but the too short sample 5 can be referenced
+	for(SAMPLEINDEX smp = 1; smp <= sndFile.GetNumSamples(); smp++)
+	{
+		const ModSample &sample = sndFile.GetSample(smp);
+		const bool inFile = static_cast<const char *>(sample.pSample) >= data && static_cast<const char *>(sample.pSample) < data + size;
+		VERIFY_EQUAL_NONCONT(sample.IsReferenced(), referenceSamples && smp != 5);
+		VERIFY_EQUAL_NONCONT(inFile, sample.IsReferenced());
+	}
+
+	SetMixerSettings(sndFile, GetMixerSettings(sndFile), srcMode);
+
+	TestAudioReadTarget target;
+	sndFile.Read(44100 * 4, target);
+	output.swap(target.output);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+#endif // MODPLUG_NO_FILESAVE
+
+
+// Test that samples played straight from the file data sound exactly like copied samples
+static noinline void TestReferencedSamples()
+//------------------------------------------
+{
+#ifndef MODPLUG_NO_FILESAVE
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+	const mpt::PathString filename = GetTempFilenameBase() + MPT_PATHSTRING("referenced.it");
+
+	// Generate an IT file with 16-bit samples using all kinds of loops, which are played at very different speeds.
+	{
+		TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+		CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+		CreateModule(sndFile, MOD_TYPE_IT, 4);
+
+		// Length, loop start, loop end, sustain start, sustain end, sample flags
+		static const struct { SmpLength length, loopStart, loopEnd, sustainStart, sustainEnd; uint32 flags; } samples[] =
+		{
+			{ 3000, 500, 3000, 0, 0, CHN_LOOP },
+			{ 2500, 300, 1800, 100, 400, CHN_LOOP | CHN_PINGPONGLOOP | CHN_SUSTAINLOOP },
+			{ 1200, 0, 0, 0, 0, 0 },
+			{ 40, 0, 40, 0, 0, CHN_LOOP | CHN_PINGPONGLOOP },
+			{ 20, 2, 20, 0, 0, CHN_LOOP },
+		};
+		Random rng(1);
+		for(std::size_t i = 0; i < CountOf(samples); i++)
+		{
+			SampleSpec spec(samples[i].length, CHN_16BIT | samples[i].flags, 22050);
+			spec.loopStart = samples[i].loopStart;
+			spec.loopEnd = samples[i].loopEnd;
+			spec.sustainStart = samples[i].sustainStart;
+			spec.sustainEnd = samples[i].sustainEnd;
+			AddSample(sndFile, spec, rng);
+		}
+
+		static const ModCommand::NOTE notes[] = { NOTE_MIDDLEC - 36, NOTE_MIDDLEC, NOTE_MIDDLEC + 19, NOTE_MIDDLEC + 43 };
+		for(ROWINDEX row = 0; row < 64; row += 4)
+		{
+			for(CHANNELINDEX chn = 0; chn < 4; chn++)
+			{
+				ModCommand &m = *sndFile.Patterns[0].GetpModCommand(row, chn);
+				m.note = notes[(row / 4 + chn) % CountOf(notes)];
+				m.instr = static_cast<ModCommand::INSTR>(1 + (row / 4 + chn * 3) % sndFile.GetNumSamples());
+				if(row % 16 == 8)
+				{
+					// Start close to the sample end
+					m.command = CMD_OFFSET;
+					m.param = 0x09;
+				}
+			}
+			// Release the sustain loop
+			sndFile.Patterns[0].GetpModCommand(row + 2, 1)->note = NOTE_KEYOFF;
+		}
+		SaveIT(sndFileContainer, filename);
+		DestroySoundFileContainer(sndFileContainer);
+	}
+
+	std::vector<char> fileData;
+	{
+		mpt::ifstream stream(filename, std::ios::binary);
+		FileReader file(&stream);
+		fileData.assign(file.GetRawData(), file.GetRawData() + file.GetLength());
+	}
+	RemoveFile(filename);
+
+	// 16-bit sample data can only be referenced at an even address
+	ITFileHeader fileHeader;
+	ITSample sampleHeader;
+	FileReader file(&fileData[0], fileData.size());
+	VERIFY_EQUAL_NONCONT(file.ReadConvertEndianness(fileHeader), true);
+	file.Skip(fileHeader.ordnum + fileHeader.insnum * 4);
+	VERIFY_EQUAL_NONCONT(file.Seek(file.ReadUint32LE()), true);
+	VERIFY_EQUAL_NONCONT(file.ReadConvertEndianness(sampleHeader), true);
+	std::vector<int16> alignedData(fileData.size() / 2 + 1);
+	char *data = reinterpret_cast<char *>(&alignedData[0]) + (sampleHeader.samplepointer & 1);
+	memcpy(data, &fileData[0], fileData.size());
+
+	const ResamplingMode srcModes[] = { SRCMODE_NEAREST, SRCMODE_LINEAR, SRCMODE_SPLINE, SRCMODE_POLYPHASE, SRCMODE_FIRFILTER };
+	for(std::size_t mode = 0; mode < CountOf(srcModes); mode++)
+	{
+		std::vector<int> copiedOutput, referencedOutput;
+		RenderReferencedSamplesFile(copiedOutput, data, fileData.size(), false, srcModes[mode]);
+		RenderReferencedSamplesFile(referencedOutput, data, fileData.size(), true, srcModes[mode]);
+		VERIFY_EQUAL_NONCONT(copiedOutput.empty(), false);
+		VERIFY_EQUAL_NONCONT(copiedOutput == referencedOutput, true);
+	}
+#endif // MODPLUG_NO_FILESAVE
+}
+
+
+static noinline void TestResamplerTables()
+//----------------------------------------
+{
+	CResampler resampler1, resampler2;
+
+	// Resamplers with equivalent settings share their tables
+	VERIFY_EQUAL(resampler1.gKaiserSinc == resampler2.gKaiserSinc, true);
+	VERIFY_EQUAL(resampler1.WFIRlut == resampler2.WFIRlut, true);
+
+	// The resampling mode does not affect the tables
+	resampler2.m_Settings.SrcMode = SRCMODE_LINEAR;
+	resampler2.InitializeTables();
+	VERIFY_EQUAL(resampler1.gKaiserSinc == resampler2.gKaiserSinc, true);
+
+	// Different filter settings result in different tables, but the settings of the other resampler must not change
+	const SINC_TYPE oldSinc = resampler1.gKaiserSinc[SINC_WIDTH * (SINC_PHASES / 2) + 3];
+	resampler2.m_Settings.gdWFIRCutoff = 0.5;
+	resampler2.InitializeTables();
+	VERIFY_EQUAL(resampler1.gKaiserSinc == resampler2.gKaiserSinc, false);
+	VERIFY_EQUAL(resampler1.gKaiserSinc[SINC_WIDTH * (SINC_PHASES / 2) + 3], oldSinc);
+	VERIFY_EQUAL(resampler2.gKaiserSinc[SINC_WIDTH * (SINC_PHASES / 2) + 3] == oldSinc, false);
+
+	// Tables that are no longer used are released and computed again with identical contents
+	CResamplerSettings settings = resampler2.m_Settings;
+	std::vector<SINC_TYPE> sinc(resampler2.gKaiserSinc, resampler2.gKaiserSinc + SINC_PHASES * SINC_WIDTH);
+	resampler2.m_Settings = resampler1.m_Settings;
+	resampler2.InitializeTables();
+	VERIFY_EQUAL(resampler1.gKaiserSinc == resampler2.gKaiserSinc, true);
+	{
+		CResampler resampler3;
+		resampler3.m_Settings = settings;
+		resampler3.InitializeTables();
+		VERIFY_EQUAL(std::equal(sinc.begin(), sinc.end(), resampler3.gKaiserSinc), true);
+	}
+}
+
+
+static size_t EvaluateTestMacro(CSoundFile &sndFile, const char *macroString, uint8 param, unsigned char (&out)[MACRO_LENGTH])
+//-------------------------------------------------------------------------------------------------------------------------
+{
+	char macro[MACRO_LENGTH];
+	MemsetZero(macro);
+	mpt::String::CopyN(macro, macroString);
+	CompiledMIDIMacro compiled;
+	compiled.Compile(macro);
+	return sndFile.EvaluateMIDIMacro(0, compiled, param, out);
+}
+
+
+static noinline void TestMIDIMacroCompiler()
+//------------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.ChangeModTypeTo(MOD_TYPE_IT);
+	sndFile.m_nChannels = 4;
+	sndFile.m_nInstruments = 1;
+	ModInstrument *ins = sndFile.AllocateInstrument(1);
+	ins->nMidiChannel = 6;
+	ins->wMidiBank = 0x1235;
+	ins->nMidiProgram = 10;
+
+	ModChannel &chn = sndFile.m_PlayState.Chn[0];
+	chn.pModInstrument = ins;
+	chn.nLastNote = NOTE_MIDDLEC;
+	chn.nPan = 64;
+	chn.nRealPan = 300;
+
+	unsigned char out[MACRO_LENGTH];
+
+	// Internal filter macro
+	VERIFY_EQUAL(EvaluateTestMacro(sndFile, "F0F000z", 0xC5, out), 4);
+	VERIFY_EQUAL(out[0], 0xF0);
+	VERIFY_EQUAL(out[1], 0xF0);
+	VERIFY_EQUAL(out[2], 0x00);
+	VERIFY_EQUAL(out[3], 0x45);
+
+	// MIDI channel as low, high and single nibble, variables finishing incomplete bytes
+	VERIFY_EQUAL(EvaluateTestMacro(sndFile, "9c n c0 cc 3c c x 7 y", 0, out), 9);
+	VERIFY_EQUAL(out[0], 0x95);
+	VERIFY_EQUAL(out[1], NOTE_MIDDLEC - NOTE_MIN);
+	VERIFY_EQUAL(out[2], 0x50);
+	VERIFY_EQUAL(out[3], 0x55);
+	VERIFY_EQUAL(out[4], 0x35);
+	VERIFY_EQUAL(out[5], 0x05);
+	VERIFY_EQUAL(out[6], 32);
+	VERIFY_EQUAL(out[7], 0x07);
+	VERIFY_EQUAL(out[8], 127);
+
+	// Bank and program, unknown characters and unterminated nibbles
+	VERIFY_EQUAL(EvaluateTestMacro(sndFile, "a b p G-1 2 3", 0, out), 5);
+	VERIFY_EQUAL(out[0], 0x24);
+	VERIFY_EQUAL(out[1], 0x34);
+	VERIFY_EQUAL(out[2], 9);
+	VERIFY_EQUAL(out[3], 0x12);
+	VERIFY_EQUAL(out[4], 0x03);
+
+	VERIFY_EQUAL(EvaluateTestMacro(sndFile, "", 0, out), 0);
+
+	// Edited macros are recompiled on access
+	sndFile.m_MidiCfg.Reset();
+	sndFile.m_MidiCfgCompiled.Compile(sndFile.m_MidiCfg);
+	VERIFY_EQUAL(sndFile.m_MidiCfgCompiled.GetFixedMacro(sndFile.m_MidiCfg, 0).numOps, 4);
+	mpt::String::Copy(sndFile.m_MidiCfg.szMidiZXXExt[0], "9c n");
+	const CompiledMIDIMacro &edited = sndFile.m_MidiCfgCompiled.GetFixedMacro(sndFile.m_MidiCfg, 0);
+	VERIFY_EQUAL(edited.numOps, 2);
+	VERIFY_EQUAL(sndFile.EvaluateMIDIMacro(0, edited, 0, out), 2);
+	VERIFY_EQUAL(out[0], 0x95);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+
+// Check that the coefficients set up by SetupChannelFilter() are identical to freshly calculated ones, whether they come from the cache or not.
+static void CheckFilterCoefficients(CSoundFile &sndFile)
+//-----------------------------------------------------
+{
+	const int modifiers[] = { 256, 0, -256, 100 };
+	for(int pass = 0; pass < 2; pass++)
+	{
+		for(size_t mod = 0; mod < CountOf(modifiers); mod++)
+		{
+			for(int cutoff = 0; cutoff < 128; cutoff += (pass ? 3 : 1))
+			{
+				for(int resonance = 0; resonance < 128; resonance += 7)
+				{
+					ModChannel &chn = sndFile.m_PlayState.Chn[0];
+					chn.nCutOff = static_cast<uint8>(cutoff);
+					chn.nResonance = static_cast<uint8>(resonance);
+					chn.nCutSwing = chn.nResSwing = 0;
+					chn.nFilterMode = (cutoff & 1) ? FLTMODE_HIGHPASS : FLTMODE_LOWPASS;
+					chn.dwFlags.reset(CHN_FILTER);
+					sndFile.SetupChannelFilter(&chn, true, modifiers[mod]);
+					if(!chn.dwFlags[CHN_FILTER])
+					{
+						continue;
+					}
+
+					FilterCache::Coefficients coeffs;
+					sndFile.CalculateFilterCoefficients(sndFile.UseITFilterMode(), cutoff, cutoff * (modifiers[mod] + 256) / 256, resonance, modifiers[mod], coeffs);
+#ifdef MPT_INTMIXER
+					const mixsample_t a0 = static_cast<mixsample_t>(((cutoff & 1) ? (1.0f - coeffs.fg) : coeffs.fg) * (1 << MIXING_FILTER_PRECISION));
+					const mixsample_t b0 = static_cast<mixsample_t>(coeffs.fb0 * (1 << MIXING_FILTER_PRECISION));
+					const mixsample_t b1 = static_cast<mixsample_t>(coeffs.fb1 * (1 << MIXING_FILTER_PRECISION));
+					// Both are converted from the same float coefficients
+					const mixsample_t epsilon = 0;
+#else
+					const mixsample_t a0 = (cutoff & 1) ? (1.0f - coeffs.fg) : coeffs.fg;
+					const mixsample_t b0 = coeffs.fb0;
+					const mixsample_t b1 = coeffs.fb1;
+					// The compiler may evaluate 1 - fg with different precision in the two code paths
+					const mixsample_t epsilon = 1e-6f;
+#endif
+					VERIFY_EQUAL_QUIET_EPS(chn.nFilter_A0, a0, epsilon);
+					VERIFY_EQUAL_QUIET_EPS(chn.nFilter_B0, b0, epsilon);
+					VERIFY_EQUAL_QUIET_EPS(chn.nFilter_B1, b1, epsilon);
+				}
+			}
+		}
+	}
+}
+
+
+static noinline void TestFilterCache()
+//------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.ChangeModTypeTo(MOD_TYPE_IT);
+
+	sndFile.SetModFlag(MSF_COMPATIBLE_PLAY, true);
+	VERIFY_EQUAL(sndFile.UseITFilterMode(), true);
+	CheckFilterCoefficients(sndFile);
+
+	sndFile.SetModFlag(MSF_COMPATIBLE_PLAY, false);
+	CheckFilterCoefficients(sndFile);
+
+	sndFile.m_SongFlags.set(SONG_EXFILTERRANGE);
+	CheckFilterCoefficients(sndFile);
+
+	// The cache must not return coefficients for the previous mixing frequency
+	MixerSettings mixerSettings = sndFile.m_MixerSettings;
+	mixerSettings.gdwMixingFreq = 22050;
+	sndFile.SetMixerSettings(mixerSettings);
+	CheckFilterCoefficients(sndFile);
+
+	sndFile.m_SongFlags.reset(SONG_EXFILTERRANGE);
+	sndFile.SetModFlag(MSF_COMPATIBLE_PLAY, true);
+	CheckFilterCoefficients(sndFile);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+
+static noinline void TestVoiceSets()
+//----------------------------------
+{
+	ChannelSet set;
+	set.Set(3);
+	set.Set(40);
+	set.Set(MAX_CHANNELS - 1);
+	std::vector<CHANNELINDEX> channels;
+	for(ChannelSet::Iterator it(set); it.IsValid(); it.Next())
+	{
+		channels.push_back(it.GetChannel());
+	}
+	VERIFY_EQUAL(channels.size(), 3);
+	VERIFY_EQUAL(channels[0], 3);
+	VERIFY_EQUAL(channels[1], 40);
+	VERIFY_EQUAL(channels[2], MAX_CHANNELS - 1);
+	set.SetRange(0, 64);
+	VERIFY_EQUAL(set.FindNextUnset(0), 64);
+	set.ResetRange(32, 64);
+	VERIFY_EQUAL(set.Test(40), false);
+	VERIFY_EQUAL(set.FindNextUnset(30), 32);
+	set.SetRange(0, MAX_CHANNELS);
+	VERIFY_EQUAL(set.FindNextUnset(0), MAX_CHANNELS);
+
+	// New background voices have to be allocated on the same channels as with a linear search
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	sndFile.Create(FileReader(), CSoundFile::loadCompleteModule);
+	sndFile.ChangeModTypeTo(MOD_TYPE_IT);
+	sndFile.m_nChannels = 4;
+	sndFile.UpdateBackgroundVoices();
+	// Silent voices are normally removed by ReadNote()
+	sndFile.m_PlayState.m_PlayingVoices.Clear();
+	for(CHANNELINDEX i = 4; i < 100; i++)
+	{
+		sndFile.AddBackgroundVoice(i, 0);
+		sndFile.m_PlayState.Chn[i].nLength = 1;
+	}
+	VERIFY_EQUAL(sndFile.GetNNAChannel(0), 100);
+	sndFile.m_PlayState.Chn[50].nLength = 0;
+	VERIFY_EQUAL(sndFile.GetNNAChannel(0), 50);
+
+	// Voices that became background channels because the number of pattern channels was reduced may still be playing
+	sndFile.m_PlayState.Chn[2].nLength = 1;
+	sndFile.m_nChannels = 2;
+	sndFile.UpdateBackgroundVoices();
+	VERIFY_EQUAL(sndFile.GetNNAChannel(0), 3);
+	sndFile.m_nChannels = 4;
+	sndFile.UpdateBackgroundVoices();
+	VERIFY_EQUAL(sndFile.m_PlayState.m_PlayingVoices.Test(2), false);
+	VERIFY_EQUAL(sndFile.m_PlayState.m_OwnedVoices[0].Test(10), true);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+
+static noinline void TestPerfCounters()
+//-------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+	CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+	CreateModule(sndFile, MOD_TYPE_IT, 4);
+	Random rng(1);
+	AddSample(sndFile, SampleSpec(1000, CHN_LOOP), rng);
+
+	for(CHANNELINDEX chn = 0; chn < 2; chn++)
+	{
+		ModCommand &m = *sndFile.Patterns[0].GetpModCommand(0, chn);
+		m.note = NOTE_MIDDLEC;
+		m.instr = 1;
+	}
+
+	TestAudioReadTarget target;
+	const CSoundFile::samplecount_t rendered = sndFile.Read(10000, target);
+	const PerfCounters &counters = sndFile.GetPerfCounters();
+	if(PerfCounters::IsEnabled())
+	{
+		VERIFY_EQUAL(counters.framesRendered, rendered);
+		VERIFY_EQUAL(counters.stages[PerfCounters::stageReadNote].calls > 0, true);
+		VERIFY_EQUAL(counters.stages[PerfCounters::stageMix].calls, counters.stages[PerfCounters::stageOutput].calls);
+		VERIFY_EQUAL(counters.stages[PerfCounters::stagePlugins].calls, 0);
+		// Two voices are playing during every chunk
+		VERIFY_EQUAL(counters.voicesMixed, counters.stages[PerfCounters::stageMix].calls * 2);
+	}
+
+	sndFile.ResetPerfCounters();
+	VERIFY_EQUAL(counters.framesRendered, 0);
+	VERIFY_EQUAL(counters.voicesMixed, 0);
+	for(int stage = 0; stage < PerfCounters::numStages; stage++)
+	{
+		VERIFY_EQUAL(counters.stages[stage].cycles, 0);
+		VERIFY_EQUAL(counters.stages[stage].calls, 0);
+	}
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+
+// Digest of a rendering: A hash of the exact output, and the RMS level of a few equally long parts of it,
+// which is used for comparing renderings that are not expected to be bit-identical.
+struct RenderDigest
+{
+	enum { numParts = 8 };
+	uint64 hash;
+	uint32 rms[numParts];
+};
+
+
+static RenderDigest GetRenderDigest(const std::vector<int> &output)
+//-----------------------------------------------------------------
+{
+	RenderDigest digest;
+	// FNV-1a over the little-endian sample values
+	digest.hash = 14695981039346656037ull;
+	for(std::size_t i = 0; i < output.size(); i++)
+	{
+		const uint32 value = static_cast<uint32>(output[i]);
+		for(int byte = 0; byte < 4; byte++)
+		{
+			digest.hash ^= (value >> (byte * 8)) & 0xFF;
+			digest.hash *= 1099511628211ull;
+		}
+	}
+	const std::size_t partLength = output.size() / RenderDigest::numParts;
+	for(std::size_t part = 0; part < RenderDigest::numParts; part++)
+	{
+		double sum = 0.0;
+		for(std::size_t i = part * partLength; i < (part + 1) * partLength; i++)
+		{
+			sum += static_cast<double>(output[i]) * static_cast<double>(output[i]);
+		}
+		digest.rms[part] = partLength ? Util::Round<uint32>(std::sqrt(sum / partLength)) : 0;
+	}
+	return digest;
+}
+
+
+static std::string FormatRenderDigest(const std::string &name, const RenderDigest &digest)
+//----------------------------------------------------------------------------------------
+{
+	std::string s = name + " " + mpt::fmt::hex0<16>(digest.hash);
+	for(std::size_t part = 0; part < RenderDigest::numParts; part++)
+	{
+		s += " " + mpt::ToString(digest.rms[part]);
+	}
+	return s;
+}
+
+
+// Read the digests from a file with one FormatRenderDigest() line per rendering. Lines starting with # are ignored.
+static std::map<std::string, RenderDigest> ReadRenderDigests(const mpt::PathString &filename)
+//-------------------------------------------------------------------------------------------
+{
+	std::map<std::string, RenderDigest> digests;
+	mpt::ifstream f(filename);
+	std::string line;
+	while(std::getline(f, line))
+	{
+		if(line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+		std::istringstream ls(line);
+		ls.imbue(std::locale::classic());
+		std::string name;
+		RenderDigest digest;
+		ls >> name >> std::hex >> digest.hash >> std::dec;
+		for(std::size_t part = 0; part < RenderDigest::numParts; part++)
+		{
+			ls >> digest.rms[part];
+		}
+		if(!ls.fail())
+		{
+			digests[name] = digest;
+		}
+	}
+	return digests;
+}
+
+
+// Renderings are either bit-identical, or (in tolerant mode) each part's level may differ by 1% plus one 16-bit LSB.
+static bool RenderDigestMatches(const RenderDigest &expected, const RenderDigest &actual, bool tolerant, uint32 lsb)
+//-----------------------------------------------------------------------------------------------------------------
+{
+	if(!tolerant)
+	{
+		return expected.hash == actual.hash;
+	}
+	for(std::size_t part = 0; part < RenderDigest::numParts; part++)
+	{
+		const uint32 diff = std::max(expected.rms[part], actual.rms[part]) - std::min(expected.rms[part], actual.rms[part]);
+		if(diff > expected.rms[part] / 100 + lsb)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+static void SetupRenderHashSettings(CSoundFile &sndFile, ResamplingMode srcMode, bool ramping)
+//--------------------------------------------------------------------------------------------
+{
+	MixerSettings mixerSettings = GetMixerSettings(sndFile);
+	mixerSettings.DSPMask = 0;
+	mixerSettings.NumMixerThreads = 1;
+	if(!ramping)
+	{
+		mixerSettings.SetVolumeRampUpMicroseconds(0);
+		mixerSettings.SetVolumeRampDownMicroseconds(0);
+	}
+	SetMixerSettings(sndFile, mixerSettings, srcMode);
+}
+
+
+// A module that uses all kinds of samples (8 / 16 bit, mono / stereo, forward / ping-pong / no loop),
+// very high and low notes, pitch and volume effects and optionally resonant filter sweeps on every second channel.
+static void GenerateStressModule(CSoundFile &sndFile, CHANNELINDEX numChannels, bool filters)
+//-------------------------------------------------------------------------------------------
+{
+	CreateModule(sndFile, MOD_TYPE_IT, numChannels);
+
+	Random rng(numChannels);
+	const uint32 sampleFlags[] = { CHN_LOOP, CHN_16BIT | CHN_LOOP | CHN_PINGPONGLOOP, CHN_16BIT | CHN_STEREO | CHN_LOOP, 0 };
+	for(uint32 i = 1; i <= CountOf(sampleFlags); i++)
+	{
+		SampleSpec spec(1500 * i + 700, sampleFlags[i - 1], 8363 * i);
+		spec.loopStart = spec.length / 3;
+		if(!(spec.flags & CHN_LOOP))
+		{
+			// The one-shot sample ends with silence
+			spec.silenceStart = spec.length / 2;
+		}
+		AddSample(sndFile, spec, rng);
+	}
+
+	for(ROWINDEX row = 0; row < 64; row++)
+	{
+		for(CHANNELINDEX chn = 0; chn < numChannels; chn++)
+		{
+			const uint32 rnd = rng.Next();
+			ModCommand &m = *sndFile.Patterns[0].GetpModCommand(row, chn);
+			if((rnd & 3) == 0)
+			{
+				m.note = static_cast<ModCommand::NOTE>(NOTE_MIN + 12 + (rnd >> 2) % 108);
+				m.instr = static_cast<ModCommand::INSTR>(1 + (rnd >> 9) % sndFile.GetNumSamples());
+				m.volcmd = VOLCMD_VOLUME;
+				m.vol = static_cast<ModCommand::VOL>((rnd >> 4) % 65);
+			}
+			if(filters && chn % 2 == 0)
+			{
+				m.command = CMD_MIDI;
+				m.param = static_cast<ModCommand::PARAM>((row * 5 + chn) % 128);
+				continue;
+			}
+			switch((rnd >> 12) % 8)
+			{
+			case 0: m.command = CMD_PORTAMENTOUP; m.param = 0x08; break;
+			case 1: m.command = CMD_PORTAMENTODOWN; m.param = 0x08; break;
+			case 2: m.command = CMD_VIBRATO; m.param = 0x8F; break;
+			case 3: m.command = CMD_VOLUMESLIDE; m.param = 0x04; break;
+			case 4: m.command = CMD_PANNING8; m.param = static_cast<ModCommand::PARAM>(rnd & 0xFF); break;
+			case 5: m.command = CMD_OFFSET; m.param = 0x04; break;
+			}
+		}
+	}
+}
+
+
+// The digests in test/test.renderhashes are only bit-exact for the platform they were generated on: GCC on amd64 with -ffast-math,
+// i.e. the default Makefile build. Resampler tables and filter coefficients are calculated with floating point math,
+// which other compilers, architectures or floating point options may round differently.
+#if MPT_COMPILER_GCC && (defined(__x86_64__) || defined(__amd64__)) && defined(__FAST_MATH__)
+#define RENDER_HASHES_REFERENCE_PLATFORM
+#endif
+
+// Render test.s3m and some generated modules with each resampler, filter and volume ramping setting (test.xm and test.mptm are completely silent),
+// and compare the output with the digests in test/test.renderhashes, so that optimizations of the mixer cannot change the output unnoticed.
+// Set the environment variable OPENMPT_RENDER_HASHES to "update" to write the current digests to that file instead,
+// or to "tolerant" to only compare the levels of the renderings. Tolerant mode is the default on other platforms than the reference platform,
+// where "exact" enforces bit-exact output. Tolerant mode is always used with the floating point mixer,
+// which also skips the resonant filter cases, as its filters do not saturate like the fixed point ones.
+static noinline void TestRenderHashes()
+//-------------------------------------
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	const char *env = std::getenv("OPENMPT_RENDER_HASHES");
+	const std::string mode = env ? env : "";
+#if !defined(MPT_INTMIXER)
+	const bool tolerant = true;
+#elif defined(RENDER_HASHES_REFERENCE_PLATFORM)
+	const bool tolerant = (mode == "tolerant");
+#else
+	const bool tolerant = (mode != "exact");
+#endif
+
+	const mpt::PathString filenameBase = GetTestFilenameBase();
+	const ResamplingMode srcModes[] = { SRCMODE_NEAREST, SRCMODE_LINEAR, SRCMODE_SPLINE, SRCMODE_POLYPHASE, SRCMODE_FIRFILTER };
+	const char * const srcModeNames[] = { "nearest", "linear", "spline", "polyphase", "firfilter" };
+	const CSoundFile::samplecount_t renderLength = 44100 * 2;
+
+	std::vector<std::pair<std::string, RenderDigest> > digests;
+
+	for(std::size_t srcMode = 0; srcMode < CountOf(srcModes); srcMode++)
+	{
+		for(int ramping = 0; ramping < 2; ramping++)
+		{
+			TSoundFileContainer sndFileContainer = CreateSoundFileContainer(filenameBase + MPT_PATHSTRING("s3m"));
+			CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+			SetupRenderHashSettings(sndFile, srcModes[srcMode], ramping != 0);
+			TestAudioReadTarget target;
+			sndFile.Read(renderLength, target);
+			DestroySoundFileContainer(sndFileContainer);
+			const std::string name = std::string("s3m.") + srcModeNames[srcMode] + (ramping ? ".ramp" : ".noramp");
+			digests.push_back(std::make_pair(name, GetRenderDigest(target.output)));
+		}
+	}
+
+	const CHANNELINDEX stressChannels[] = { 4, 32 };
+	for(std::size_t chn = 0; chn < CountOf(stressChannels); chn++)
+	{
+		for(std::size_t srcMode = 0; srcMode < CountOf(srcModes); srcMode++)
+		{
+			for(int variant = 0; variant < 4; variant++)
+			{
+				const bool filters = (variant & 1) != 0, ramping = (variant & 2) != 0;
+				TSoundFileContainer sndFileContainer = CreateSoundFileContainer();
+				CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+				GenerateStressModule(sndFile, stressChannels[chn], filters);
+				SetupRenderHashSettings(sndFile, srcModes[srcMode], ramping);
+				TestAudioReadTarget target;
+				sndFile.Read(renderLength, target);
+				DestroySoundFileContainer(sndFileContainer);
+				const std::string name = "stress" + mpt::ToString(stressChannels[chn]) + "." + srcModeNames[srcMode] + (filters ? ".filter" : ".nofilter") + (ramping ? ".ramp" : ".noramp");
+				digests.push_back(std::make_pair(name, GetRenderDigest(target.output)));
+			}
+		}
+	}
+
+	// 16-bit output with each dither mode
+	for(int ditherMode = 0; ditherMode < NumDitherModes; ditherMode++)
+	{
+		TSoundFileContainer sndFileContainer = CreateSoundFileContainer(filenameBase + MPT_PATHSTRING("s3m"));
+		CSoundFile &sndFile = GetrSoundFile(sndFileContainer);
+		SetupRenderHashSettings(sndFile, SRCMODE_POLYPHASE, true);
+		Dither dither;
+		dither.SetMode(static_cast<DitherMode>(ditherMode));
+		std::vector<int16> buffer(renderLength * 2);
+		AudioReadTargetBuffer<int16> target(dither, &buffer[0], nullptr);
+		sndFile.Read(renderLength, target);
+		DestroySoundFileContainer(sndFileContainer);
+		const std::vector<int> output(buffer.begin(), buffer.begin() + target.GetRenderedCount() * 2);
+		digests.push_back(std::make_pair("s3m.dither" + mpt::ToString(ditherMode), GetRenderDigest(output)));
+	}
+
+	const mpt::PathString digestFilename = filenameBase + MPT_PATHSTRING("renderhashes");
+	if(mode == "update")
+	{
+		mpt::ofstream f(digestFilename);
+		f << "# Render digests for TestRenderHashes() in test.cpp: name, FNV-1a hash of the output, RMS level of " << RenderDigest::numParts << " parts of the output" << std::endl;
+		f << "# The hashes are only expected to match on the reference platform (GCC on amd64 with -ffast-math, the default Makefile build)," << std::endl;
+		f << "# other platforms only compare the levels by default." << std::endl;
+		for(std::size_t i = 0; i < digests.size(); i++)
+		{
+			f << FormatRenderDigest(digests[i].first, digests[i].second) << std::endl;
+		}
+		return;
+	}
+
+	// Report all renderings that differ before failing
+	const std::map<std::string, RenderDigest> expected = ReadRenderDigests(digestFilename);
+	std::size_t mismatches = 0;
+	for(std::size_t i = 0; i < digests.size(); i++)
+	{
+		const std::string &name = digests[i].first;
+		std::map<std::string, RenderDigest>::const_iterator it = expected.find(name);
+#ifndef MPT_INTMIXER
+		if(name.find(".filter.") != std::string::npos && it != expected.end())
+		{
+			continue;
+		}
+#endif // !MPT_INTMIXER
+		// One LSB of 16-bit output in mix buffer scale
+		const uint32 lsb = (name.find(".dither") != std::string::npos) ? 1 : (1 << (MIXING_FRACTIONAL_BITS - 15));
+		if(it == expected.end())
+		{
+			std::cerr << "Render digest missing: " << FormatRenderDigest(name, digests[i].second) << std::endl;
+			mismatches++;
+		} else if(!RenderDigestMatches(it->second, digests[i].second, tolerant, lsb))
+		{
+			std::cerr << "Render digest mismatch: " << FormatRenderDigest(name, digests[i].second) << " (expected: " << FormatRenderDigest(name, it->second) << ")" << std::endl;
+			mismatches++;
+		}
+	}
+	VERIFY_EQUAL(expected.size(), digests.size());
+	VERIFY_EQUAL(mismatches, 0);
+}
+
+
 static void RunITCompressionTest(const std::vector<int8> &sampleData, ChannelFlags smpFormat, bool it215)
 //-------------------------------------------------------------------------------------------------------
 {
@@ -1883,6 +3400,92 @@ static noinline void TestITCompression()
 }
 
 
+static noinline void TestSampleReadQueue()
+//----------------------------------------
+{
+	// Samples decoded by several threads have to be identical to samples decoded one after another,
+	// including an IT compressed sample with a broken block, which cannot be split into blocks.
+	const SampleIO formats[] =
+	{
+		SampleIO(SampleIO::_16bit, SampleIO::mono, SampleIO::littleEndian, SampleIO::IT214),
+		SampleIO(SampleIO::_8bit, SampleIO::stereoSplit, SampleIO::littleEndian, SampleIO::IT214),
+		SampleIO(SampleIO::_16bit, SampleIO::stereoSplit, SampleIO::littleEndian, SampleIO::IT215),
+		SampleIO(SampleIO::_16bit, SampleIO::mono, SampleIO::littleEndian, SampleIO::signedPCM),
+		SampleIO(SampleIO::_8bit, SampleIO::mono, SampleIO::littleEndian, SampleIO::IT214),
+	};
+	const SmpLength lengths[] = { 200000, 70000, 50000, 10000, 100000 };
+	const size_t numSamples = CountOf(formats);
+	const size_t brokenSample = numSamples - 1;
+
+	std::srand(0);
+	std::vector<int8> sourceData[numSamples];
+	std::string fileData;
+	FileReader::off_t offsets[numSamples];
+	for(size_t i = 0; i < numSamples; i++)
+	{
+		ModSample smp;
+		smp.uFlags.set(CHN_16BIT, formats[i].GetBitDepth() == 16);
+		smp.uFlags.set(CHN_STEREO, formats[i].GetChannelFormat() != SampleIO::mono);
+		smp.nLength = lengths[i];
+		sourceData[i].resize(smp.GetSampleSizeInBytes());
+		for(size_t j = 0; j < sourceData[i].size(); j++)
+		{
+			sourceData[i][j] = (int8)std::rand();
+		}
+		smp.pSample = &sourceData[i][0];
+
+		offsets[i] = fileData.size();
+		if(formats[i].GetEncoding() == SampleIO::signedPCM)
+		{
+			fileData.append(sourceData[i].begin(), sourceData[i].end());
+		} else
+		{
+			std::ostringstream f;
+			ITCompression compression(smp, formats[i].GetEncoding() == SampleIO::IT215, &f);
+			fileData.append(f.str());
+		}
+	}
+
+	// Truncate the second block of the last sample
+	const size_t firstBlockSize = static_cast<uint8>(fileData[offsets[brokenSample]]) | (static_cast<uint8>(fileData[offsets[brokenSample] + 1]) << 8);
+	fileData[offsets[brokenSample] + 2 + firstBlockSize] = 16;
+	fileData[offsets[brokenSample] + 3 + firstBlockSize] = 0;
+
+	ModSample samples[2][numSamples];
+	size_t bytesRead[2][numSamples];
+	for(size_t pass = 0; pass < 2; pass++)
+	{
+		SampleReadQueue queue(pass == 0 ? 1 : 4);
+		for(size_t i = 0; i < numSamples; i++)
+		{
+			samples[pass][i].nLength = lengths[i];
+			FileReader file(fileData.data(), fileData.size());
+			file.Seek(offsets[i]);
+			queue.Add(formats[i], samples[pass][i], file);
+		}
+		queue.Read();
+		for(size_t i = 0; i < numSamples; i++)
+		{
+			bytesRead[pass][i] = queue.GetBytesRead(i);
+		}
+	}
+
+	for(size_t i = 0; i < numSamples; i++)
+	{
+		VERIFY_EQUAL_NONCONT(samples[1][i].nLength, samples[0][i].nLength);
+		VERIFY_EQUAL_NONCONT(samples[1][i].GetBytesPerSample(), samples[0][i].GetBytesPerSample());
+		VERIFY_EQUAL_NONCONT(bytesRead[1][i], bytesRead[0][i]);
+		VERIFY_EQUAL_NONCONT(memcmp(samples[1][i].pSample, samples[0][i].pSample, samples[0][i].GetSampleSizeInBytes()), 0);
+		if(i != brokenSample)
+		{
+			VERIFY_EQUAL_NONCONT(memcmp(samples[1][i].pSample, &sourceData[i][0], sourceData[i].size()), 0);
+		}
+		samples[0][i].FreeSample();
+		samples[1][i].FreeSample();
+	}
+}
+
+
 static double Rand01() {return rand() / double(RAND_MAX);}
 
 template <class T>